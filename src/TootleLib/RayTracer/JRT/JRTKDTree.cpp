@@ -92,13 +92,13 @@ bool JRTKDTree::FindFirstHit(const Vec3f& rOrigin, const Vec3f& rDirection, JRTH
     // compute ray direction inverse here to avoid a divide during traversal
     Vec3f inv_direction = Vec3f(1.0f / rDirection.x, 1.0f / rDirection.y, 1.0f / rDirection.z);
 
-    static float barycentrics[3];
+    float barycentrics[3];
 
     // rather than using recursion, we're using iteration and handling the stack ourselves
-    static float   tmin_stack[MAX_TREE_DEPTH];
-    static float   tmax_stack[MAX_TREE_DEPTH];
-    static UINT    node_stack[MAX_TREE_DEPTH];
-    static UINT    stack_offs = 0;
+    float   tmin_stack[MAX_TREE_DEPTH];
+    float   tmax_stack[MAX_TREE_DEPTH];
+    UINT    node_stack[MAX_TREE_DEPTH];
+    UINT    stack_offs = 0;
 
     // set up the traversal stack
     UINT start_node = 0;
@@ -419,7 +419,7 @@ UINT JRTKDTree::FindAllHits(const Vec3f& rOrigin, const Vec3f& rDirection, Tootl
     // compute ray direction inverse here to avoid a divide during traversal
     Vec3f inv_direction = Vec3f(1.0f / rDirection.x, 1.0f / rDirection.y, 1.0f / rDirection.z);
 
-    static float barycentrics[3];
+    float barycentrics[3];
 
     // rather than using recursion, we're using iteration and handling the stack ourselves
     //static float   tmin_stack[MAX_TREE_DEPTH];
@@ -433,7 +433,7 @@ UINT JRTKDTree::FindAllHits(const Vec3f& rOrigin, const Vec3f& rDirection, Tootl
         UINT  NextNode;
     };
 
-    static StackFrame traversal_stack [MAX_TREE_DEPTH];
+    StackFrame traversal_stack [MAX_TREE_DEPTH];
 
     // set up the traversal stack
     //node_stack[0] = 0;
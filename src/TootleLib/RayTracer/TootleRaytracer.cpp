@@ -14,6 +14,7 @@
 #include "JRTMesh.h"
 #include "JRTOrthoCamera.h"
 #include "JRTBoundingBox.h"
+#include <algorithm>
 
 #ifdef DEBUG_IMAGES
     #include "JRTPPMImage.h"
@@ -87,22 +88,56 @@ bool TootleRaytracer::Init(const float* pVertexPositions, const UINT* pIndices,
 }
 
 
+//=================================================================================================================================
+/// \brief The ray hits of the pixels of one tile of the test image, and the scratch space used to process them
+//=================================================================================================================================
+struct TootleTileHits
+{
+    /// A cluster that covers every pixel of a tile
+    struct Occluder
+    {
+        UINT  nCluster;   ///< The cluster
+        float fDepth;     ///< The farthest of its nearest hits over the tile, which is the depth of the tile once it is drawn
+    };
+
+    /// A ray hit of a tile, with the pixel it belongs to
+    struct Fragment
+    {
+        UINT  nFaceID;
+        UINT  nPixel;
+        float t;
+
+        bool operator<(const Fragment& rOther) const { return nFaceID < rOther.nFaceID; }
+    };
+
+    std::vector<float>        coords;       ///< The camera coordinate of each row and column of the image
+    std::vector<TootleRayHit> hits;         ///< The hits of all pixels of the tile, each pixel's hits sorted by depth
+    std::vector<UINT>         pixelStart;   ///< The first hit of each pixel, followed by the number of hits
+    std::vector<Occluder>     occluders;
+    std::vector<Fragment>     fragments;
+    std::vector<float>        depth;
+};
+
+
 //=================================================================================================================================
 /// Calculates an overdraw table for a particular set of viewpoints
 /// \param pViewpoints  Array of viewpoints to use
 /// \param nViewpoints  The size of this array
 /// \param nImageSize   The size of the pixel grid on each axis
+/// \param eCostModel   The model of the cost of the fragments.  TOOTLE_OVERDRAW_COST_PLAIN counts every pair of hits along a
+///                     ray.  TOOTLE_OVERDRAW_COST_HIZ and TOOTLE_OVERDRAW_COST_PREPASS count the fragments a cluster rejects
+///                     through the hierarchical Z buffer, when it covers a whole tile in front of them.
 /// \param pODArray     A table that will hold the computed per-cluster overdraw.  The table must be resized so that it is
 ///                     nClusters by nClusters and contains 0 in each element.  After this function returns, pODArray[i][j] will
 ///                     contain the number of pixels in cluster i that are overdrawn by cluster j, summed over all viewpoints
 /// \return        True if successful, false if out of memory.
 //=================================================================================================================================
 bool TootleRaytracer::CalculateOverdraw(const float* pViewpoints, UINT nViewpoints, UINT nImageSize,
-                                        bool bCullCCW, TootleOverdrawTable* pODArray)
+                                        bool bCullCCW, TootleOverdrawCostModel eCostModel, TootleOverdrawTable* pODArray)
 {
     for (UINT i = 0; i < nViewpoints; i++)
     {
-        if (!ProcessViewpoint(pViewpoints, nImageSize, bCullCCW, pODArray))
+        if (!ProcessViewpoint(pViewpoints, nImageSize, bCullCCW, eCostModel, pODArray))
         {
             return false;
         }
@@ -119,16 +154,19 @@ bool TootleRaytracer::CalculateOverdraw(const float* pViewpoints, UINT nViewpoin
 /// \param nViewpoints  The size of this array
 /// \param nImageSize   The size of the pixel grid on each axis
 /// \param bCullCCW     Set to true to cull CCW faces, otherwise cull CW faces.
+/// \param eCostModel   The model of the cost of the fragments.  With TOOTLE_OVERDRAW_COST_PREPASS, every pixel is shaded once
+///                     and the fragments of the depth pass cost TOOTLE_PREPASS_DEPTH_COST each.
 /// \param fAvgODOut    A variable to receive the average overdraw per pixel.
 /// \param fMaxODOut    A variable to receive the maximum overdraw per pixel.
 /// \return        True if successful, false if out of memory.
 //=================================================================================================================================
-bool TootleRaytracer::MeasureOverdraw(const float* pViewpoints,
-                                      UINT         nViewpoints,
-                                      UINT         nImageSize,
-                                      bool         bCullCCW,
-                                      float&       fAvgODOut,
-                                      float&       fMaxODOut)
+bool TootleRaytracer::MeasureOverdraw(const float*            pViewpoints,
+                                      UINT                    nViewpoints,
+                                      UINT                    nImageSize,
+                                      bool                    bCullCCW,
+                                      TootleOverdrawCostModel eCostModel,
+                                      float&                  fAvgODOut,
+                                      float&                  fMaxODOut)
 {
     assert(pViewpoints);
 
@@ -140,14 +178,18 @@ bool TootleRaytracer::MeasureOverdraw(const float* pViewpoints,
     fAvgODOut = 0;
     fMaxODOut = 0;
 
-    UINT nTotalPixelHit   = 0;
-    UINT nTotalPixelDrawn = 0;
+    // a 512x512 image holds 2^18 pixels, so the totals of many viewpoints need 64 bits
+    unsigned long long nTotalPixelHit   = 0;
+    unsigned long long nTotalPixelDrawn = 0;
     UINT nPixelHit;
     UINT nPixelDrawn;
 
+    // the depth pass of the prepass draws the fragments, and the color pass shades each pixel once
+    const bool bPrepass = (eCostModel == TOOTLE_OVERDRAW_COST_PREPASS);
+
     for (UINT i = 0; i < nViewpoints; i++)
     {
-        if (!ProcessViewpoint(pViewpoints, nImageSize, bCullCCW, nPixelHit, nPixelDrawn))
+        if (!ProcessViewpoint(pViewpoints, nImageSize, bCullCCW, eCostModel, nPixelHit, nPixelDrawn))
         {
             return false;
         }
@@ -157,7 +199,10 @@ bool TootleRaytracer::MeasureOverdraw(const float* pViewpoints,
 
         if (nPixelHit > 0)
         {
-            fMaxODOut = std::max(fMaxODOut, (float) nPixelDrawn / nPixelHit);
+            const float fOD = bPrepass ? 1.0f + TOOTLE_PREPASS_DEPTH_COST * nPixelDrawn / nPixelHit :
+                                         (float) nPixelDrawn / nPixelHit;
+
+            fMaxODOut = std::max(fMaxODOut, fOD);
         }
 
         pViewpoints += 3;
@@ -165,7 +210,8 @@ bool TootleRaytracer::MeasureOverdraw(const float* pViewpoints,
 
     if (nTotalPixelHit > 0)
     {
-        fAvgODOut = (float)(nTotalPixelDrawn) / nTotalPixelHit;
+        fAvgODOut = bPrepass ? 1.0f + TOOTLE_PREPASS_DEPTH_COST * nTotalPixelDrawn / nTotalPixelHit :
+                               (float)(nTotalPixelDrawn) / nTotalPixelHit;
     }
     else
     {
@@ -188,26 +234,18 @@ void TootleRaytracer::Cleanup()
 
 
 //=================================================================================================================================
-/// Computes overdraw from a particular viewpoint
+/// Builds the orthographic camera for a viewpoint, and culls the faces that face away from it
 /// \param pCameraPosition  Camera position to use for this viewpoint.  The camera will be looking at the origin
-/// \param nImageSize       Size of the pixel grid on each axis
 /// \param bCullCCW         Set to true to cull CCW faces, otherwise cull CW faces.
-/// \param pODArray         A table that will be updated with per-cluster overdraw
-/// \return            False if out of memory.  True otherwise
+/// \return            The camera
 //=================================================================================================================================
-bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition, UINT nImageSize, bool bCullCCW, TootleOverdrawTable* pODArray)
+JRTOrthoCamera TootleRaytracer::SetupCamera(const float* pCameraPosition, bool bCullCCW)
 {
     assert(pCameraPosition);
 
-    if (nImageSize < 1)
-    {
-        nImageSize = 1;   // a strange 1x1 image
-    }
-
     // build camera basis vectors
     Vec3f position(pCameraPosition);
-    position      = position;
-    Vec3f viewDir = Normalize(position) * -1.;
+    Vec3f viewDir = Normalize(position) * -1.0;
     Vec3f up;
 
     // Compute the up vector by performing 90 degree 2D rotation on the position vector
@@ -227,6 +265,8 @@ bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition, UINT nImage
 
     up = Normalize(up);
 
+    Matrix4f mLookAt = MatrixLookAt(position, Vec3f(0, 0, 0), up);
+
     // choose viewport size:
     // transform bounding box corners into viewing space
     // as we do this, track the bounding square of the x and y coordinates
@@ -234,8 +274,10 @@ bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition, UINT nImage
     Vec3f corners[8];
     m_pCore->GetSceneBB().GetCorners(corners);
 
-    Matrix4f mLookAt = MatrixLookAt(position, Vec3f(0, 0, 0), up);
-    float xmin = FLT_MAX, xmax = -FLT_MAX, ymin = FLT_MAX, ymax = -FLT_MAX;
+    float xmin =  FLT_MAX;
+    float xmax = -FLT_MAX;
+    float ymin =  FLT_MAX;
+    float ymax = -FLT_MAX;
 
     for (int i = 0; i < 8; i++)
     {
@@ -249,28 +291,39 @@ bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition, UINT nImage
     float fViewSize = Max(xmax - xmin, ymax - ymin) * 2;
     //float fViewSize = sqrt(pow(xmax-xmin,2) + pow(ymax-ymin,2)); //Max( xmax - xmin, ymax - ymin );
 
-    // build the camera
-    JRTOrthoCamera camera(position, viewDir, up, fViewSize);
-
     // cull backfaces
     m_pCore->CullBackfaces(viewDir, bCullCCW);
 
-    // iterate over the pixels that we're interested in
-    float delta = 1.0f / nImageSize;
-    float s = 0;
-    float t = 0;
+    return JRTOrthoCamera(position, viewDir, up, fViewSize);
+}
 
-#ifdef DEBUG_IMAGES
-    JRTPPMImage img(nImageSize, nImageSize);
-#endif
+//=================================================================================================================================
+/// Finds the ray hits of the pixels of a tile of the test image.  Pixel (i, j) is on row i and column j of the image, and the
+///  pixels of the tile are stored row by row.
+/// \param rCamera          The camera of the viewpoint
+/// \param nImageSize       Size of the pixel grid on each axis
+/// \param nRow             The first row of the tile
+/// \param nColumn          The first column of the tile
+/// \param nTileSize        The size of the tile on each axis.  The tile is clipped to the image.
+/// \param rTile            Receives the hits.  Its coords must hold the camera coordinate of each row and column.
+/// \return            False if out of memory.  True otherwise
+//=================================================================================================================================
+bool TootleRaytracer::TraceTile(const JRTOrthoCamera& rCamera, UINT nImageSize, UINT nRow, UINT nColumn, UINT nTileSize,
+                                TootleTileHits& rTile)
+{
+    const UINT nLastRow    = std::min(nRow + nTileSize, nImageSize);
+    const UINT nLastColumn = std::min(nColumn + nTileSize, nImageSize);
+
+    rTile.hits.clear();
+    rTile.pixelStart.clear();
 
-    for (int i = 0; i < (int)nImageSize; i++)
+    for (UINT i = nRow; i < nLastRow; i++)
     {
-        for (int j = 0; j < (int)nImageSize; j++)
+        for (UINT j = nColumn; j < nLastColumn; j++)
         {
             // compute the camera ray for this pixel
             Vec3f rayOrigin, rayDirection;
-            camera.GetRay(s, t, &rayOrigin, &rayDirection);
+            rCamera.GetRay(rTile.coords[j], rTile.coords[i], &rayOrigin, &rayDirection);
 
             // trace through the scene data structures to find all hits
             TootleRayHit* pHitArray = 0;
@@ -282,31 +335,104 @@ bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition, UINT nImage
                 return false;
             }
 
+            // the hit array is reused by the next ray
+            rTile.pixelStart.push_back((UINT) rTile.hits.size());
+            rTile.hits.insert(rTile.hits.end(), pHitArray, pHitArray + nHits);
+        }
+    }
 
+    rTile.pixelStart.push_back((UINT) rTile.hits.size());
+
+    return true;
+}
+
+//=================================================================================================================================
+/// Sets up the traversal of the test image of a viewpoint.  The camera coordinates are accumulated the way the pixels have
+///  always been stepped, so that every cost model traces the same rays.
+/// \param nImageSize   Size of the pixel grid on each axis
+/// \param eCostModel   The cost model, which decides the size of the tiles
+/// \param rTile        Receives the camera coordinate of each row and column
+/// \return        The size of the tiles
+//=================================================================================================================================
+static UINT BeginImage(UINT nImageSize, TootleOverdrawCostModel eCostModel, TootleTileHits& rTile)
+{
+    float delta = 1.0f / nImageSize;
+    float s = 0;
+
+    rTile.coords.resize(nImageSize);
+
+    for (UINT i = 0; i < nImageSize; i++)
+    {
+        rTile.coords[i] = s;
+        s += delta;
+    }
+
+    // the plain model is per pixel, the others need all the pixels of a tile of the hierarchical Z buffer at once
+    return (eCostModel == TOOTLE_OVERDRAW_COST_PLAIN) ? 1 : TOOTLE_HIZ_TILE_SIZE;
+}
+
+//=================================================================================================================================
+/// Computes overdraw from a particular viewpoint
+/// \param pCameraPosition  Camera position to use for this viewpoint.  The camera will be looking at the origin
+/// \param nImageSize       Size of the pixel grid on each axis
+/// \param bCullCCW         Set to true to cull CCW faces, otherwise cull CW faces.
+/// \param eCostModel       The model of the cost of the fragments
+/// \param pODArray         A table that will be updated with per-cluster overdraw
+/// \return            False if out of memory.  True otherwise
+//=================================================================================================================================
+bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition, UINT nImageSize, bool bCullCCW,
+                                       TootleOverdrawCostModel eCostModel, TootleOverdrawTable* pODArray)
+{
+    assert(pCameraPosition);
+
+    if (nImageSize < 1)
+    {
+        nImageSize = 1;   // a strange 1x1 image
+    }
+
+    JRTOrthoCamera camera = SetupCamera(pCameraPosition, bCullCCW);
+
+    TootleTileHits tile;
+    const UINT     nTileSize = BeginImage(nImageSize, eCostModel, tile);
 
 #ifdef DEBUG_IMAGES
-            float clr = nHits / 8.f;
+    JRTPPMImage img(nImageSize, nImageSize);
+#endif
 
-            img.SetPixel(j, i, clr, clr, clr);
+    // iterate over the pixels that we're interested in
+    for (UINT i = 0; i < nImageSize; i += nTileSize)
+    {
+        for (UINT j = 0; j < nImageSize; j += nTileSize)
+        {
+            if (!TraceTile(camera, nImageSize, i, j, nTileSize, tile))
+            {
+                // ran out of memory
+                return false;
+            }
+
+#ifdef DEBUG_IMAGES
+            const UINT nColumns = std::min(nTileSize, nImageSize - j);
 
-            /*if( nHits > 0 )
+            for (UINT p = 0; p + 1 < tile.pixelStart.size(); p++)
             {
-               UINT nTriIndex = pHitArray[0].nFaceID;
-               Vec3f normal = m_pMesh->GetFaceNormal( nTriIndex );
-               normal /= 2;
-               normal += Vec3f(0.5,0.5,0.5);
-               img.SetPixel( j, i, normal.x, normal.y, normal.z );
-            }*/
+                float clr = (tile.pixelStart[p + 1] - tile.pixelStart[p]) / 8.f;
+
+                img.SetPixel(j + p % nColumns, i + p / nColumns, clr, clr, clr);
+            }
 
 #endif
 
-            ProcessPixel(pHitArray, nHits, pODArray);
+            if (nTileSize == 1)
+            {
+                const UINT nHits = tile.pixelStart[1];
 
-            s += delta;
+                ProcessPixel(nHits > 0 ? &tile.hits[0] : NULL, nHits, pODArray);
+            }
+            else
+            {
+                ProcessTile(tile, pODArray);
+            }
         }
-
-        t += delta;
-        s = 0;
     }
 
 #ifdef DEBUG_IMAGES
@@ -326,15 +452,18 @@ bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition, UINT nImage
 /// \param pCameraPosition  Camera position to use for this viewpoint.  The camera will be looking at the origin
 /// \param nImageSize       Size of the pixel grid on each axis
 /// \param bCullCCW         Set to true to cull CCW faces, otherwise cull CW faces.
-/// \param fAvgODOut        A variable to receive the average overdraw per pixel.
+/// \param eCostModel       The model of the cost of the fragments
+/// \param nPixelHit        A variable to receive the number of pixels covered by the mesh.
+/// \param nPixelDrawn      A variable to receive the number of fragments drawn: shaded, or in the depth pass of the prepass.
 ///
 /// \return                 False if out of memory.  True otherwise
 //=================================================================================================================================
-bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition,
-                                       UINT         nImageSize,
-                                       bool         bCullCCW,
-                                       UINT&        nPixelHit,
-                                       UINT&        nPixelDrawn)
+bool TootleRaytracer::ProcessViewpoint(const float*            pCameraPosition,
+                                       UINT                    nImageSize,
+                                       bool                    bCullCCW,
+                                       TootleOverdrawCostModel eCostModel,
+                                       UINT&                   nPixelHit,
+                                       UINT&                   nPixelDrawn)
 {
     assert(pCameraPosition);
 
@@ -343,132 +472,54 @@ bool TootleRaytracer::ProcessViewpoint(const float* pCameraPosition,
         nImageSize = 1;   // a strange 1x1 image
     }
 
-    // build camera basis vectors
-    Vec3f position(pCameraPosition);
-    Vec3f viewDir = Normalize(position) * -1.0;
-    Vec3f up;
-
-    // Compute the up vector by performing 90 degree 2D rotation on the position vector
-    //  (choose two good component vectors).
-    if ((position[ 1 ] * position[ 1 ]) < (position[ 0 ] * position[ 0 ]))
-    {
-        up[ 0 ] = -position[ 2 ];
-        up[ 1 ] =  0;
-        up[ 2 ] =  position[ 0 ];
-    }
-    else
-    {
-        up[ 0 ] =  0;
-        up[ 1 ] =  position[ 2 ];
-        up[ 2 ] = -position[ 1 ];
-    }
-
-    up = Normalize(up);
-
-    Matrix4f mLookAt = MatrixLookAt(position, Vec3f(0, 0, 0), up);
-
-    // choose viewport size:
-    // transform bounding box corners into viewing space
-    // as we do this, track the bounding square of the x and y coordinates
-    // we will take the size of the larger dimension to be the viewport size
-    Vec3f corners[8];
-    m_pCore->GetSceneBB().GetCorners(corners);
-
-    float xmin =  FLT_MAX;
-    float xmax = -FLT_MAX;
-    float ymin =  FLT_MAX;
-    float ymax = -FLT_MAX;
-
-    for (int i = 0; i < 8; i++)
-    {
-        TransformVector(&corners[i], &mLookAt, &corners[i]);
-        xmin = Min(xmin, corners[i].x);
-        xmax = Max(xmax, corners[i].x);
-        ymin = Min(ymin, corners[i].y);
-        ymax = Max(ymax, corners[i].y);
-    }
-
-    float fViewSize = Max(xmax - xmin, ymax - ymin) * 2;
-    //float fViewSize = sqrt(pow(xmax-xmin,2) + pow(ymax-ymin,2)); //Max( xmax - xmin, ymax - ymin );
-
-    // build the camera
-    JRTOrthoCamera camera(position, viewDir, up, fViewSize);
+    JRTOrthoCamera camera = SetupCamera(pCameraPosition, bCullCCW);
 
-    // cull backfaces
-    m_pCore->CullBackfaces(viewDir, bCullCCW);
-
-    // iterate over the pixels that we're interested in
-    float delta = 1.0f / nImageSize;
-    float s = 0;
-    float t = 0;
-#ifdef DEBUG_IMAGES
-    JRTPPMImage img(nImageSize, nImageSize);
-#endif
+    TootleTileHits tile;
+    const UINT     nTileSize = BeginImage(nImageSize, eCostModel, tile);
 
     UINT nPixelDrawnTmp;
 
     nPixelHit   = 0;
     nPixelDrawn = 0;
 
-    for (int i = 0; i < (int) nImageSize; i++)
+    // iterate over the pixels that we're interested in
+    for (UINT i = 0; i < nImageSize; i += nTileSize)
     {
-        for (int j = 0; j < (int) nImageSize; j++)
+        for (UINT j = 0; j < nImageSize; j += nTileSize)
         {
-            // compute the camera ray for this pixel
-            Vec3f rayOrigin, rayDirection;
-            camera.GetRay(s, t, &rayOrigin, &rayDirection);
-
-            // trace through the scene data structures to find all hits
-            TootleRayHit* pHitArray = 0;
-            UINT nHits = 0;
-
-            if (!m_pCore->FindAllHits(rayOrigin, rayDirection, &pHitArray, &nHits))
+            if (!TraceTile(camera, nImageSize, i, j, nTileSize, tile))
             {
                 // ran out of memory
                 return false;
             }
 
-            if (nHits > 0)
+            for (UINT p = 0; p + 1 < tile.pixelStart.size(); p++)
             {
-                nPixelHit++;
-
-                // compute the number of triangles overdrawn for the pixel
-                GetPixelDrawn(pHitArray, nHits, nPixelDrawnTmp);
-
-                nPixelDrawn += nPixelDrawnTmp;
+                if (tile.pixelStart[p + 1] > tile.pixelStart[p])
+                {
+                    nPixelHit++;
+                }
             }
 
-#ifdef DEBUG_IMAGES
-            float clr = nHits / 8.f;
-
-            img.SetPixel(j, i, clr, clr, clr);
-
-            /*if( nHits > 0 )
+            if (tile.hits.empty())
             {
-               UINT nTriIndex = pHitArray[0].nFaceID;
-               Vec3f normal = m_pMesh->GetFaceNormal( nTriIndex );
-               normal /= 2;
-               normal += Vec3f(0.5,0.5,0.5);
-               img.SetPixel( j, i, normal.x, normal.y, normal.z );
-            }*/
+                continue;
+            }
 
-#endif
+            // compute the number of triangles overdrawn for the pixel, or the tile
+            if (nTileSize == 1)
+            {
+                GetPixelDrawn(&tile.hits[0], (UINT) tile.hits.size(), nPixelDrawnTmp);
+            }
+            else
+            {
+                GetTileDrawn(tile, nPixelDrawnTmp);
+            }
 
-            s += delta;
+            nPixelDrawn += nPixelDrawnTmp;
         }
-
-        t += delta;
-        s = 0;
     }
 
-#ifdef DEBUG_IMAGES
-    static int nFrameNum = 0;
-    char filename[100];
-    sprintf(filename, "C:/tmp/images/view_%d.ppm", nFrameNum);
-    img.SaveFile(filename);
-    nFrameNum++;
-#endif
-
     return true;
 }
 
@@ -500,6 +551,75 @@ void TootleRaytracer::ProcessPixel(TootleRayHit* pRayHits, UINT nHits, TootleOve
 
 }
 
+//=================================================================================================================================
+/// Updates the overdraw table for a tile of the hierarchical Z buffer.  The buffer keeps the farthest depth of each tile, so a
+///  cluster rejects the fragments behind it only where it covers the whole tile, and only those behind its farthest point in
+///  the tile.  pODArray[b][a] counts the fragments of cluster a that cluster b rejects when it is drawn first.
+///
+/// \param rTile     The hits of the pixels of the tile
+/// \param pODArray  A table that will be updated to take into account per-cluster overdraw discovered in this tile
+//=================================================================================================================================
+void TootleRaytracer::ProcessTile(TootleTileHits& rTile, TootleOverdrawTable* pODArray)
+{
+    const UINT nPixels = (UINT) rTile.pixelStart.size() - 1;
+
+    // a cluster that covers the tile covers its first pixel, so the candidates are the clusters hit there
+    rTile.occluders.clear();
+
+    for (UINT h = rTile.pixelStart[0]; h < rTile.pixelStart[1]; h++)
+    {
+        const UINT nCluster = m_pFaceClusters[rTile.hits[h].nFaceID];
+        bool       bCovers  = true;
+        float      fDepth   = rTile.hits[h].t;
+
+        // a cluster hit twice is a candidate once, at its nearest hit
+        for (UINT k = rTile.pixelStart[0]; k < h && bCovers; k++)
+        {
+            bCovers = (m_pFaceClusters[rTile.hits[k].nFaceID] != nCluster);
+        }
+
+        for (UINT p = 1; p < nPixels && bCovers; p++)
+        {
+            UINT k = rTile.pixelStart[p];
+
+            while (k < rTile.pixelStart[p + 1] && m_pFaceClusters[rTile.hits[k].nFaceID] != nCluster)
+            {
+                k++;
+            }
+
+            if (k < rTile.pixelStart[p + 1])
+            {
+                fDepth = std::max(fDepth, rTile.hits[k].t);
+            }
+            else
+            {
+                bCovers = false;
+            }
+        }
+
+        if (bCovers)
+        {
+            TootleTileHits::Occluder occluder = { nCluster, fDepth };
+            rTile.occluders.push_back(occluder);
+        }
+    }
+
+    for (UINT h = 0; h < (UINT) rTile.hits.size(); h++)
+    {
+        const UINT a = m_pFaceClusters[rTile.hits[h].nFaceID];
+
+        for (UINT o = 0; o < (UINT) rTile.occluders.size(); o++)
+        {
+            const UINT b = rTile.occluders[o].nCluster;
+
+            if (a != b && rTile.occluders[o].fDepth < rTile.hits[h].t)
+            {
+                pODArray->at(b)[a]++;
+            }
+        }
+    }
+}
+
 //=================================================================================================================================
 /// Compute the number of times for a particular pixel is drawn.
 /// \param pRayHits         Array of ray hits that occurred in this pixel.  They will be sorted by depth
@@ -535,4 +655,57 @@ void TootleRaytracer::GetPixelDrawn(TootleRayHit* pRayHits, UINT nHits, UINT& nP
             nPixelDrawn++;
         }
     }
-}
\ No newline at end of file
+}
+
+//=================================================================================================================================
+/// Compute the number of fragments drawn in a tile of the hierarchical Z buffer.  The faces are drawn in the order of their IDs.
+///  Each face is tested against the farthest depth of the tile before it writes, and its fragments behind that depth are
+///  rejected.  The depth of a tile stays at the far plane until every pixel of the tile is covered.
+/// \param rTile            The hits of the pixels of the tile
+/// \param nTileDrawn       The number of fragments that are not rejected.
+//=================================================================================================================================
+void TootleRaytracer::GetTileDrawn(TootleTileHits& rTile, UINT& nTileDrawn)
+{
+    const UINT nPixels = (UINT) rTile.pixelStart.size() - 1;
+
+    rTile.fragments.clear();
+
+    for (UINT p = 0; p < nPixels; p++)
+    {
+        for (UINT h = rTile.pixelStart[p]; h < rTile.pixelStart[p + 1]; h++)
+        {
+            TootleTileHits::Fragment fragment = { rTile.hits[h].nFaceID, p, rTile.hits[h].t };
+            rTile.fragments.push_back(fragment);
+        }
+    }
+
+    std::sort(rTile.fragments.begin(), rTile.fragments.end());
+
+    rTile.depth.assign(nPixels, FLT_MAX);
+    float fTileDepth = FLT_MAX;
+
+    nTileDrawn = 0;
+
+    for (UINT i = 0; i < (UINT) rTile.fragments.size();)
+    {
+        UINT nEnd = i;
+
+        while (nEnd < (UINT) rTile.fragments.size() && rTile.fragments[nEnd].nFaceID == rTile.fragments[i].nFaceID)
+        {
+            nEnd++;
+        }
+
+        for (; i < nEnd; i++)
+        {
+            const TootleTileHits::Fragment& rFragment = rTile.fragments[i];
+
+            if (rFragment.t <= fTileDepth)
+            {
+                nTileDrawn++;
+                rTile.depth[rFragment.nPixel] = std::min(rTile.depth[rFragment.nPixel], rFragment.t);
+            }
+        }
+
+        fTileDepth = *std::max_element(rTile.depth.begin(), rTile.depth.end());
+    }
+}
@@ -13,8 +13,16 @@ class JRTMesh;
 class JRTOrthoCamera;
 
 #include <vector>
+#include "tootlelib.h"
 
 struct TootleRayHit;
+struct TootleTileHits;
+
+/// The size, in pixels, of the square tiles of the hierarchical Z buffer modelled by TOOTLE_OVERDRAW_COST_HIZ
+#define TOOTLE_HIZ_TILE_SIZE 8
+
+/// The cost of a depth-only fragment of the depth prepass modelled by TOOTLE_OVERDRAW_COST_PREPASS, relative to a shaded one
+#define TOOTLE_PREPASS_DEPTH_COST 0.25f
 
 /// An overdraw table is a table that determines, for a pair of faces, how much one face overdraws the other
 typedef std::vector< std::vector<unsigned int> > TootleOverdrawTable;
@@ -34,10 +42,11 @@ public:
 
     /// Computes an overdraw table for a set of viewpoints.
     bool CalculateOverdraw(const float* pViewpoints, unsigned int nViewpoints, unsigned int nImageSize,
-                           bool bCullCCW, TootleOverdrawTable* pODArray);
+                           bool bCullCCW, TootleOverdrawCostModel eCostModel, TootleOverdrawTable* pODArray);
 
     // Measure the overdraw for a set of viewpoints.
-    bool MeasureOverdraw(const float* pViewpoints, UINT nViewpoints, UINT nImageSize, bool bCullCCW, float& fAvgODOut, float& fMaxODOut);
+    bool MeasureOverdraw(const float* pViewpoints, UINT nViewpoints, UINT nImageSize, bool bCullCCW,
+                         TootleOverdrawCostModel eCostModel, float& fAvgODOut, float& fMaxODOut);
 
     /// Cleans up the internal data structures
     void Cleanup();
@@ -46,18 +55,32 @@ private:
 
 
     /// Renders the scene from a particular camera position and updates the overdraw array
-    bool ProcessViewpoint(const float* pCameraPosition, unsigned int nImageSize, bool bCullCCW, TootleOverdrawTable* pODArray);
+    bool ProcessViewpoint(const float* pCameraPosition, unsigned int nImageSize, bool bCullCCW,
+                          TootleOverdrawCostModel eCostModel, TootleOverdrawTable* pODArray);
 
     /// Renders the scene from a particular camera position and measures the overdraw
     bool ProcessViewpoint(const float* pCameraPosition, unsigned int nImageSize, bool bCullCCW,
-                          unsigned int& nPixelHit, unsigned int& nPixelDrawn);
+                          TootleOverdrawCostModel eCostModel, unsigned int& nPixelHit, unsigned int& nPixelDrawn);
+
+    /// Builds the camera for a viewpoint and culls the faces that face away from it
+    JRTOrthoCamera SetupCamera(const float* pCameraPosition, bool bCullCCW);
+
+    /// Finds the ray hits of the pixels of one tile of the image
+    bool TraceTile(const JRTOrthoCamera& rCamera, unsigned int nImageSize, unsigned int nRow, unsigned int nColumn,
+                   unsigned int nTileSize, TootleTileHits& rTile);
 
     /// Updates the overdraw table with overdraw that occurs for a particular pixel in the test image
     void ProcessPixel(TootleRayHit* pRayHit, unsigned int nHits, TootleOverdrawTable* pODArray);
 
+    /// Updates the overdraw table with the fragments that the hierarchical Z buffer rejects in a tile of the test image
+    void ProcessTile(TootleTileHits& rTile, TootleOverdrawTable* pODArray);
+
     /// Compute the number of times for a particular pixel is drawn by the mesh
     void GetPixelDrawn(TootleRayHit* pRayHits, UINT nHits, UINT& nPixelOverdrawn);
 
+    /// Compute the number of fragments drawn in a tile that the hierarchical Z buffer does not reject
+    void GetTileDrawn(TootleTileHits& rTile, UINT& nTileDrawn);
+
     const unsigned int*    m_pFaceClusters;
     JRTCore* m_pCore;
     JRTMesh* m_pMesh;
@@ -210,6 +210,8 @@ UINT Face::GetEdge(Face* pNeighbor)
 FaceManager::FaceManager(void)
 {
     m_nFaceRemapCount = 0;
+    m_nCacheSize = 0;
+    m_nCacheMisses = 0;
 }
 
 FaceManager::~FaceManager(void)
@@ -346,7 +348,8 @@ bool FaceManager::Stripify(void)
             stripIndex++;
             strips.push_back(FaceStrip());
 
-            pCurFace = NULL;
+            // continue next to the vertices that are still in the cache if possible
+            pCurFace = FindCachedFace();
 
             // stop when a face with lowest degree is found
             // this means we'll start along edges and the strip will work its way inward
@@ -749,6 +752,83 @@ int FaceManager::GetFaceAdjacency(const Face& cFace1, const Face& cFace2)
     return -1;
 }
 
+//=================================================================================================================================
+/// Returns the unprocessed face with the most vertices in the simulated cache.  Only the faces at the back of the degree bins
+/// are examined; those are the neighbors of the most recently added faces.  Ties go to the face with the lowest degree.
+///
+/// \return NULL if the cache size is not known or no examined face has a vertex in the cache
+//=================================================================================================================================
+Face* FaceManager::FindCachedFace(void)
+{
+    if (m_nCacheSize == 0)
+    {
+        return NULL;
+    }
+
+    Face* pBestFace = NULL;
+    UINT nBestCached = 0;
+
+    for (UINT uDegree = 0; uDegree < 4; uDegree++)
+    {
+        UINT nExamined = 0;
+
+        for (FaceRefList::reverse_iterator iter = m_degreeBins[uDegree].rbegin();
+             iter != m_degreeBins[uDegree].rend() && nExamined < 2 * m_nCacheSize;
+             iter++, nExamined++)
+        {
+            Face* pFace = *iter;
+
+            if (pFace == NULL || pFace->WasProcessed())
+            {
+                continue;
+            }
+
+            UINT nCached = 0;
+
+            for (UINT i = 0; i < 3; i++)
+            {
+                UINT nTime = m_vertexCacheTime[ pFace->VertexByIndex(i) ];
+
+                if (nTime != 0 && m_nCacheMisses - nTime < m_nCacheSize)
+                {
+                    nCached++;
+                }
+            }
+
+            if (nCached > nBestCached)
+            {
+                nBestCached = nCached;
+                pBestFace = pFace;
+            }
+        }
+    }
+
+    return pBestFace;
+}
+
+//=================================================================================================================================
+/// Simulates the transform of the vertices of a face in a FIFO cache of m_nCacheSize vertices
+///
+/// \param rFace The face that was added to a strip
+//=================================================================================================================================
+void FaceManager::TransformFace(const Face& rFace)
+{
+    if (m_nCacheSize == 0)
+    {
+        return;
+    }
+
+    for (UINT i = 0; i < 3; i++)
+    {
+        UINT& rTime = m_vertexCacheTime[ rFace.VertexByIndex(i) ];
+
+        if (rTime == 0 || m_nCacheMisses - rTime >= m_nCacheSize)
+        {
+            rTime = ++m_nCacheMisses;
+        }
+    }
+}
+
 //=================================================================================================================================
 /// Adds the face to the specified list and to the efficient list
 ///
@@ -810,6 +890,8 @@ bool FaceManager::AddFaceToStrip(Face* pFace, FaceStrip& rStrip, UINT uDirection
 
     m_faceRemap[ pFace->GetID() ] = m_nFaceRemapCount++;
 
+    TransformFace(*pFace);
+
     rStrip.push_back(pFace);
     pFace->Processed();
 
@@ -834,16 +916,34 @@ void FaceManager::ResizeFaceRemap(UINT nFaces)
     m_faceRemap.resize(nFaces);
 }
 
+//=================================================================================================================================
+/// Makes the strips start next to the vertices that are still in a vertex cache, instead of at the faces with the fewest
+/// neighbors only.  Must be called before Stripify().
+///
+/// \param nCacheSize  The number of vertices that fit in the cache.  0 disables the cache simulation.
+/// \param nVertices   The number of vertices.  All vertex indices of the faces must be less than nVertices.
+///
+/// \return none
+//=================================================================================================================================
+void FaceManager::SetCacheSize(UINT nCacheSize, UINT nVertices)
+{
+    m_nCacheSize = nCacheSize;
+    m_nCacheMisses = 0;
+    m_vertexCacheTime.assign(nCacheSize > 0 ? nVertices : 0, 0);
+}
+
 //=================================================================================================================================
 /// Generates an efficient vertex index buffer from the input vertex indices
 ///
 /// \param pVertexIndicesIN Input vertex index buffer
 /// \param uiTriangleCount The number of triangles specified within the input buffer
+/// \param uiCacheSize The number of vertices that fit in the vertex cache.  New strips start next to the cached vertices.
 /// \param pVertexIndicesOUT Output efficient vertex index buffer
 ///
 //=================================================================================================================================
 void Stripifier::Process(const unsigned int* pVertexIndicesIN,
                          const unsigned int uiTriangleCount,
+                         const unsigned int uiCacheSize,
                          unsigned int* pVertexIndicesOUT,
                          unsigned int* pnFaceRemapOut)
 {
@@ -859,6 +959,18 @@ void Stripifier::Process(const unsigned int* pVertexIndicesIN,
 
     faceManager.ResizeFaceRemap(uiTriangleCount);
 
+    UINT uVertexCount = 0;
+
+    for (UINT u = 0; u < uVertIndexSize; u++)
+    {
+        if (pVertexIndicesIN[u] >= uVertexCount)
+        {
+            uVertexCount = pVertexIndicesIN[u] + 1;
+        }
+    }
+
+    faceManager.SetCacheSize(uiCacheSize, uVertexCount);
+
 #ifdef _TIMING
     _TIME tStart = GetTime();
     faceManager.m_tMakeNeighbors = 0;
@@ -920,3 +1032,148 @@ void Stripifier::Process(const unsigned int* pVertexIndicesIN,
         }
     }
 }
+
+//=================================================================================================================================
+/// Returns the vertex that completes the triangle (uFirst, uSecond, *) if the face contains that edge in this direction
+///
+/// \param pFace    The vertex indices of the face
+/// \param uFirst   The first vertex of the edge
+/// \param uSecond  The second vertex of the edge
+/// \param rThird   Receives the third vertex of the face
+///
+/// \return true if the face winds through uFirst then uSecond; false otherwise
+//=================================================================================================================================
+static bool FindThirdVertex(const UINT* pFace, UINT uFirst, UINT uSecond, UINT& rThird)
+{
+    for (UINT i = 0; i < 3; i++)
+    {
+        if (pFace[i] == uFirst && pFace[(i + 1) % 3] == uSecond)
+        {
+            rThird = pFace[(i + 2) % 3];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//=================================================================================================================================
+/// Generates triangle strips from the input vertex indices.  The faces are ordered as by Process(), except that new strips
+/// start next to the vertices that are still in a vertex cache of uiCacheSize vertices.  Consecutive faces are joined into a
+/// strip whenever the second one continues the strip with the winding it expects; otherwise a restart index starts a new
+/// strip.  Every face keeps its winding.
+///
+/// \param pVertexIndicesIN       Input vertex index buffer
+/// \param uiTriangleCount        The number of triangles specified within the input buffer
+/// \param uiVertexCount          The number of vertices.  All input indices must be less than this.
+/// \param uiCacheSize            The number of vertices that fit in the vertex cache
+/// \param uiRestartIndex         The index that separates two strips
+/// \param pStripIndicesOUT       Output strip index buffer.  Must have room for 4*uiTriangleCount-1 indices.
+/// \param puiStripIndexCountOUT  Receives the number of indices in pStripIndicesOUT
+/// \param pVertexIndicesOUT      Output triangle list with the faces in strip order.  May be NULL.
+/// \param pnFaceRemapOut         Output face remapping.  May be NULL.
+///
+/// \return false if the faces could not be created; true otherwise
+//=================================================================================================================================
+bool Stripifier::ProcessStrips(const unsigned int* pVertexIndicesIN,
+                               const unsigned int uiTriangleCount,
+                               const unsigned int uiVertexCount,
+                               const unsigned int uiCacheSize,
+                               const unsigned int uiRestartIndex,
+                               unsigned int* pStripIndicesOUT,
+                               unsigned int* puiStripIndexCountOUT,
+                               unsigned int* pVertexIndicesOUT,
+                               unsigned int* pnFaceRemapOut)
+{
+    assert(pVertexIndicesIN && pStripIndicesOUT && puiStripIndexCountOUT);
+
+    FaceManager faceManager;
+
+    faceManager.ResizeFaceRemap(uiTriangleCount);
+    faceManager.SetCacheSize(uiCacheSize, uiVertexCount);
+
+    for (UINT u = 0; u < uiTriangleCount; u++)
+    {
+        if (false == faceManager.MakeFace(pVertexIndicesIN[3 * u], pVertexIndicesIN[3 * u + 1], pVertexIndicesIN[3 * u + 2], u))
+        {
+            return false;
+        }
+    }
+
+    faceManager.Stripify();
+
+    VertList vl = faceManager.GetStrippedList();
+
+    // join the faces into strips.  Triangle k of a strip is (s[k], s[k+1], s[k+2]) if k is even and (s[k+1], s[k], s[k+2])
+    // if k is odd, so the next face must wind through the last two indices, in reverse order after an odd number of faces.
+    UINT nStripIndices = 0;
+    UINT nStripFaces = 0;
+
+    for (UINT u = 0; u < uiTriangleCount; u++)
+    {
+        const UINT* pFace = &vl[ 3 * u ];
+        UINT uThird;
+
+        if (nStripFaces > 0)
+        {
+            UINT uPrev = pStripIndicesOUT[ nStripIndices - 2 ];
+            UINT uLast = pStripIndicesOUT[ nStripIndices - 1 ];
+
+            bool bJoined = (nStripFaces % 2 == 0) ? FindThirdVertex(pFace, uPrev, uLast, uThird) :
+                                                    FindThirdVertex(pFace, uLast, uPrev, uThird);
+
+            if (bJoined)
+            {
+                pStripIndicesOUT[ nStripIndices++ ] = uThird;
+                nStripFaces++;
+                continue;
+            }
+
+            pStripIndicesOUT[ nStripIndices++ ] = uiRestartIndex;
+        }
+
+        // start a new strip.  Rotate the face so that it ends with the edge the next face winds through in reverse, if any.
+        UINT uRotation = 0;
+
+        if (u + 1 < uiTriangleCount)
+        {
+            const UINT* pNextFace = &vl[ 3 * (u + 1) ];
+
+            for (UINT i = 0; i < 3; i++)
+            {
+                if (FindThirdVertex(pNextFace, pFace[(i + 2) % 3], pFace[(i + 1) % 3], uThird))
+                {
+                    uRotation = i;
+                    break;
+                }
+            }
+        }
+
+        pStripIndicesOUT[ nStripIndices++ ] = pFace[ uRotation ];
+        pStripIndicesOUT[ nStripIndices++ ] = pFace[(uRotation + 1) % 3 ];
+        pStripIndicesOUT[ nStripIndices++ ] = pFace[(uRotation + 2) % 3 ];
+        nStripFaces = 1;
+    }
+
+    *puiStripIndexCountOUT = nStripIndices;
+
+    if (pVertexIndicesOUT)
+    {
+        for (UINT u = 0; u < 3 * uiTriangleCount; u++)
+        {
+            pVertexIndicesOUT[ u ] = vl[ u ];
+        }
+    }
+
+    if (pnFaceRemapOut)
+    {
+        std::vector<UINT> pnFaceRemap = faceManager.GetFaceRemap();
+
+        for (UINT i = 0; i < uiTriangleCount; i++)
+        {
+            pnFaceRemapOut[ i ] = pnFaceRemap[ i ];
+        }
+    }
+
+    return true;
+}
@@ -186,6 +186,11 @@ public:
     /// \brief reserve nFaces space for the m_faceRemap vector.
     //===================================================================//
     void ResizeFaceRemap(UINT nFaces);
+
+    //===================================================================//
+    /// \brief start new strips next to the vertices in a cache of nCacheSize vertices
+    //===================================================================//
+    void SetCacheSize(UINT nCacheSize, UINT nVertices);
 #ifdef _TIMING
     _TIME m_tMakeNeighbors; /// Time spent in the call to MakeFace
     _TIME m_tAdjLoop;       /// Time spent in the loop calculating face adjacency (expensive)
@@ -212,6 +217,22 @@ private:
     UINT m_nFaceRemapCount;                 // used to create ID for adding face into the strips
     std::vector<UINT> m_faceRemap;
 
+    // a simulated FIFO vertex cache used to choose where new strips start.  Entry i contains the miss count at which
+    // vertex i was loaded, or 0.  Empty if the cache size is not known.
+    UINT m_nCacheSize;
+    UINT m_nCacheMisses;
+    std::vector<UINT> m_vertexCacheTime;
+
+    //===================================================================//
+    /// \brief returns the unprocessed face with the most vertices in the cache, or NULL if there is none
+    //===================================================================//
+    Face* FindCachedFace(void);
+
+    //===================================================================//
+    /// \brief simulates the transform of the vertices of the face
+    //===================================================================//
+    void TransformFace(const Face& rFace);
+
     //===================================================================//
     /// \brief returns the edge index that is shared by the two faces;
     //===================================================================//
@@ -241,8 +262,22 @@ public:
     //===================================================================//
     static void Process(const unsigned int* pVertexIndicesIN,
                         const unsigned int uiTriangleCount,
+                        const unsigned int uiCacheSize,
                         unsigned int* pVertexIndicesOUT,
                         unsigned int* pnFaceRemapOut);
+
+    //===================================================================//
+    /// \brief Generates triangle strips, separated by a restart index, from the input vertex indices
+    //===================================================================//
+    static bool ProcessStrips(const unsigned int* pVertexIndicesIN,
+                              const unsigned int uiTriangleCount,
+                              const unsigned int uiVertexCount,
+                              const unsigned int uiCacheSize,
+                              const unsigned int uiRestartIndex,
+                              unsigned int* pStripIndicesOUT,
+                              unsigned int* puiStripIndexCountOUT,
+                              unsigned int* pVertexIndicesOUT,
+                              unsigned int* pnFaceRemapOut);
 };
 
 #endif // _TOOTLE_STRIPIFIER_H_
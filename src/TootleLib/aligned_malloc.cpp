@@ -4,10 +4,10 @@
 /// \file
 ****************************************************************************************/
 // This is the implementation of address-aligned malloc and free using a linked list (inserting at front).
-// These functions are not thread-safe because there is an access to the addressList global variable.
-// Use a mutex when you access the global variable to make it thread-safe.
+// The addressList global variable is guarded by a mutex, so that the ray tracer can run on several threads at once.
 #include <stdlib.h>
 #include <stdio.h>
+#include <mutex>
 
 // a linked list node to store a coupled memory address of the original and aligned address.
 typedef struct llnode
@@ -18,6 +18,7 @@ typedef struct llnode
 } node;
 
 static node* s_addressList = NULL;
+static std::mutex s_addressListLock;
 static void PrintList();
 template <typename T>
 static T GetNextPowerOfTwo(T nValue);
@@ -82,6 +83,7 @@ void* aligned_malloc(size_t bytes, size_t alignment)
     // Store a coupled entry of address and aligned address into a linked list so we can free the memory with the correct
     //  address in aligned_free() function.  The new coupled entry is prepended into the linked list.  The next code makes sure
     //  that the linked list does not store multiple entry of the same memory address.
+    std::lock_guard<std::mutex> lock(s_addressListLock);
     node* addressEntry;
 
     for (addressEntry = s_addressList;
@@ -113,6 +115,7 @@ void* aligned_malloc(size_t bytes, size_t alignment)
 //=================================================================================================================================
 void PrintList()
 {
+    std::lock_guard<std::mutex> lock(s_addressListLock);
     node* addressEntry;
 
     fprintf(stderr, "List = ");
@@ -142,6 +145,7 @@ void aligned_free(void* p)
         return;
     }
 
+    std::lock_guard<std::mutex> lock(s_addressListLock);
     node* addressEntry;
     node* prevAddressEntry;
 
@@ -4,12 +4,14 @@
 /// \file
 ****************************************************************************************/
 #include "TootlePCH.h"
+#include <algorithm>
 
 
 #include "soup.h"
 #include "mesh.h"
 #include "souptomesh.h"
 #include "clustering.h"
+#include "geometry.h"
 #include "error.h"
 
 using namespace std;
@@ -295,31 +297,202 @@ static void MoveSeeds(Mesh& mesh, std::vector<int>& seeds, std::vector<int>& clu
     // this will be the last face that was reached during the flood
 
     std::vector<float> seeddist;
+    std::vector<char> isSeed(mesh.t().size(), 0);
 
     for (int i = 0; i < nseeds; i++)
     {
         seeddist.push_back(cost[seeds[i]]);
+        isSeed[seeds[i]] = 1;
     }
 
     for (int i = 0; i < static_cast<int>(mesh.t().size()); i++)
     {
-        if (cost[i] > seeddist[cluster[i]])
+        // do not change seeds if the seed we have chosen is the seed of another cluster
+        if (cost[i] > seeddist[cluster[i]] && !isSeed[i])
         {
-            // do not change seeds if the seed we have chosen is the seed of another cluster
-            bool bMove = true;
+            isSeed[seeds[cluster[i]]] = 0;
+            isSeed[i] = 1;
+            seeddist[cluster[i]] = cost[i];
+            seeds[cluster[i]] = i;
+        }
+    }
+}
+
+// the number of grid cells per seed used by FarthestPointSeeds
+#define SEED_GRID_CELLS_PER_SEED 2
+
+// the weight of the face centers, relative to the size of the mesh, against the face normals in FarthestPointSeeds
+#define SEED_POSITION_WEIGHT 2.0f
+
+/// Places up to nSeeds seeds on faces spread over the mesh, by farthest point sampling.  Each new seed is the face farthest
+///  from the seeds placed so far, measuring the distance between the face centers and between the face normals, so that
+///  curved parts of the mesh receive more seeds like they do when the seeds are added one at a time.  The face centers are
+///  binned in a uniform grid, so that placing a seed only updates the faces of the cells that it can be closer to, and the
+///  farthest face is found through a heap of the farthest distance in each cell.
+/// \param tc      The face centers
+/// \param tn      The face normals
+/// \param nFirst  The first seed
+/// \param nSeeds  The number of seeds to place.  Fewer are placed if several faces have the same center and normal.
+/// \param seeds   Receives the seeds
+static void FarthestPointSeeds(std::vector<Vector3>& tc, std::vector<Vector3>& tn, int nFirst, int nSeeds, std::vector<int>& seeds)
+{
+    const int nFaces = static_cast<int>(tc.size());
+
+    // size the cells so that there are a few cells per seed
+    Vector3 vMin = tc[0];
+    Vector3 vMax = tc[0];
+
+    for (int i = 1; i < nFaces; i++)
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            vMin[a] = min(vMin[a], tc[i][a]);
+            vMax[a] = max(vMax[a], tc[i][a]);
+        }
+    }
+
+    float fExtent = max(max(vMax[0] - vMin[0], vMax[1] - vMin[1]), vMax[2] - vMin[2]);
+    float fScale = (fExtent > 0.f) ? SEED_POSITION_WEIGHT / fExtent : 0.f;
+
+    // the distance between two faces is the distance between the scaled centers and the normals, so the grid of the
+    //  scaled centers finds all the faces closer than a given distance
+    std::vector<Vector3> pos(nFaces);
+
+    for (int i = 0; i < nFaces; i++)
+    {
+        pos[i] = (tc[i] - vMin) * fScale;
+    }
+
+    float fCellSize = fExtent * fScale / max(1.0f, (float) pow((double) SEED_GRID_CELLS_PER_SEED * nSeeds, 1.0 / 3.0));
+
+    int res[3];
+
+    for (int a = 0; a < 3; a++)
+    {
+        res[a] = (fCellSize > 0.f) ? min(1024, max(1, (int) ceil((vMax[a] - vMin[a]) * fScale / fCellSize))) : 1;
+    }
+
+    // bin the faces
+    std::vector<int> faceCell(nFaces);
+    std::vector<int> cellStart(res[0] * res[1] * res[2] + 1, 0);
+    std::vector<int> cellFaces(nFaces);
+
+    for (int i = 0; i < nFaces; i++)
+    {
+        int c = 0;
+
+        for (int a = 2; a >= 0; a--)
+        {
+            int x = (fCellSize > 0.f) ? (int)(pos[i][a] / fCellSize) : 0;
+            c = c * res[a] + min(res[a] - 1, max(0, x));
+        }
+
+        faceCell[i] = c;
+        cellStart[c + 1]++;
+    }
+
+    for (UINT c = 1; c < cellStart.size(); c++)
+    {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    {
+        std::vector<int> cellFill(cellStart.begin(), cellStart.end() - 1);
+
+        for (int i = 0; i < nFaces; i++)
+        {
+            cellFaces[cellFill[faceCell[i]]++] = i;
+        }
+    }
+
+    // the squared distance of each face to the nearest seed, and the largest one in each cell.  The heap holds the largest
+    //  distance of each cell; entries that no longer match the cell are stale and skipped.
+    std::vector<float> dist(nFaces, BIGFLOAT);
+    std::vector<float> cellMax(cellStart.size() - 1, BIGFLOAT);
+    priority_queue<QNode> q;
+
+    int nSeed = nFirst;
+
+    seeds.clear();
+
+    while (static_cast<int>(seeds.size()) < nSeeds)
+    {
+        seeds.push_back(nSeed);
 
-            for (int j = 0; j < nseeds; j++)
+        // only the faces closer to the new seed than to all others change, and those are within the largest distance
+        const Vector3 p = pos[nSeed];
+        const Vector3 n = tn[nSeed];
+        const float fRadius = (dist[nSeed] == BIGFLOAT) ? BIGFLOAT : sqrt(dist[nSeed]);
+
+        int lo[3];
+        int hi[3];
+
+        for (int a = 0; a < 3; a++)
+        {
+            if (fRadius == BIGFLOAT || fCellSize <= 0.f)
             {
-                if (i == seeds[j])
+                lo[a] = 0;
+                hi[a] = res[a] - 1;
+            }
+            else
+            {
+                lo[a] = max(0, (int) floor((p[a] - fRadius) / fCellSize));
+                hi[a] = min(res[a] - 1, (int) floor((p[a] + fRadius) / fCellSize));
+            }
+        }
+
+        for (int z = lo[2]; z <= hi[2]; z++)
+        {
+            for (int y = lo[1]; y <= hi[1]; y++)
+            {
+                for (int x = lo[0]; x <= hi[0]; x++)
                 {
-                    bMove = false;
+                    int c = (z * res[1] + y) * res[0] + x;
+
+                    if (cellStart[c] == cellStart[c + 1])
+                    {
+                        continue;
+                    }
+
+                    float fCellMax = 0.f;
+
+                    for (int j = cellStart[c]; j < cellStart[c + 1]; j++)
+                    {
+                        int f = cellFaces[j];
+                        Vector3 d = pos[f] - p;
+                        Vector3 dn = tn[f] - n;
+                        dist[f] = min(dist[f], Dot(d, d) + Dot(dn, dn));
+                        fCellMax = max(fCellMax, dist[f]);
+                    }
+
+                    if (fCellMax != cellMax[c])
+                    {
+                        cellMax[c] = fCellMax;
+                        q.push(QNode(fCellMax, c));
+                    }
                 }
             }
+        }
 
-            if (bMove)
+        // the next seed is the farthest face of the cell with the farthest face
+        while (!q.empty() && q.top().weight != cellMax[q.top().value])
+        {
+            q.pop();
+        }
+
+        if (q.empty() || q.top().weight <= 0.f)
+        {
+            break;
+        }
+
+        int c = q.top().value;
+
+        for (int j = cellStart[c]; j < cellStart[c + 1]; j++)
+        {
+            if (dist[cellFaces[j]] == cellMax[c])
             {
-                seeddist[cluster[i]] = cost[i];
-                seeds[cluster[i]] = i;
+                nSeed = cellFaces[j];
+                break;
             }
         }
     }
@@ -346,13 +519,6 @@ static int FingerPrint(Mesh& mesh, std::vector<int>& cluster)
 /// \return  One of the ClusterResult return codes
 ClusterResult Cluster(Soup* soup, UINT& nClusters, std::vector<int>& cluster)
 {
-
-    // compute face normals
-    if (!soup->ComputeNormals())
-    {
-        return CLUSTER_OUT_OF_MEMORY;
-    }
-
     const int nFaces = static_cast<int> (soup->t().size());
 
     Mesh mesh;
@@ -378,20 +544,15 @@ ClusterResult Cluster(Soup* soup, UINT& nClusters, std::vector<int>& cluster)
         return CLUSTER_OUT_OF_MEMORY;
     }
 
-    // compute face normals
-    std::vector<Vector3> tn;
+    // compute face normals and centers
+    std::vector<Vector3> tn(nFaces);
+    std::vector<Vector3> tc(nFaces);
 
-    if (!mesh.ComputeTriNormals(tn))
+    if (nFaces > 0)
     {
-        return CLUSTER_OUT_OF_MEMORY;
-    }
-
-    // compute face centers
-    std::vector<Vector3> tc;
-
-    if (!mesh.ComputeTriCenters(tc))
-    {
-        return CLUSTER_OUT_OF_MEMORY;
+        SoAPositions positions;
+        positions.Load(mesh.v());
+        ComputeFaceGeometry(positions, (const UINT*) &mesh.t(0)[0], nFaces, &tn[0][0], &tc[0][0]);
     }
 
 
@@ -418,16 +579,31 @@ ClusterResult Cluster(Soup* soup, UINT& nClusters, std::vector<int>& cluster)
         nClusters = (UINT)mesh.t().size();
     }
 
-    srand(982748); //in order to get reproducible results
-    int last = rand() % mesh.t().size();
+    // in order to get reproducible results, the first seed is always drawn from the same random number.  It is only drawn
+    //  once, so that clustering does not touch the global random number generator on every call and can run on several
+    //  threads at once.
+    static const int nFirstRandom = (srand(982748), rand());
+    int last = nFirstRandom % mesh.t().size();
 
     bool bHasUnassignedFaces = true;
 
+    // when the number of clusters is known, place all the seeds at once, spread over the mesh, so that the iterations only
+    //  need to refine them until they converge instead of adding one seed per iteration
+    if (nClusters > 1 && nFaces > 2)
+    {
+        FarthestPointSeeds(tc, tn, last, min((int) nClusters, nFaces - 1), seeds);
+        nCurClusters = (int) seeds.size();
+    }
+
     for (int i = 0;; i++)
     {
         fp.push_back(FingerPrint(mesh, cluster));
 
-        if (bHasUnassignedFaces || nCurClusters < (int)nClusters || nClusters == 0)
+        if (i == 0 && nCurClusters > 0)
+        {
+            // the initial seeds are placed already
+        }
+        else if (bHasUnassignedFaces || nCurClusters < (int)nClusters || nClusters == 0)
         {
             seeds.push_back(last);
             nCurClusters++;
@@ -459,7 +635,7 @@ ClusterResult Cluster(Soup* soup, UINT& nClusters, std::vector<int>& cluster)
             return CLUSTER_OK;
         }
 
-        if (nCurClusters > 1)
+        if (nCurClusters > 1 && i > 0)
         {
             MoveSeeds(mesh, seeds, cluster, fixed, tc);
         }
@@ -518,20 +694,20 @@ ClusterResult Cluster(Soup* soup, UINT& nClusters, std::vector<int>& cluster)
 
 
 
-// array of clusters for each face, needed for cluster sorting
-static int* g_pCluster;
-
-
-// comparison function to sort by cluster ID
-int __cdecl SortByClusterID(const void* a, const void* b)
+// orders faces by cluster ID, keeping faces of the same cluster in their original order
+class ClusterIDLess
 {
-    int* ia = (int*) a;
-    int* ib = (int*) b;
+public:
+    ClusterIDLess(const std::vector<int>& rClusterIDs) : m_rClusterIDs(rClusterIDs) {}
 
-    if (g_pCluster[*ia] < g_pCluster[*ib]) { return -1; }
-    else if (g_pCluster[*ia] > g_pCluster[*ib]) { return 1; }
-    else { return 0; }
-}
+    bool operator()(UINT a, UINT b) const
+    {
+        return (m_rClusterIDs[a] != m_rClusterIDs[b]) ? (m_rClusterIDs[a] < m_rClusterIDs[b]) : (a < b);
+    }
+
+private:
+    const std::vector<int>& m_rClusterIDs;
+};
 
 
 
@@ -553,8 +729,7 @@ bool SortFacesByCluster(Soup& soup, std::vector<int>& clusterIDs, UINT* pRemapAr
     t = soup.t();
     c = clusterIDs;
 
-    g_pCluster = &clusterIDs[0];
-    qsort(pRemapArray, soup.t().size(), sizeof(int), SortByClusterID);
+    std::sort(pRemapArray, pRemapArray + soup.t().size(), ClusterIDLess(clusterIDs));
 
     for (int i = 0; i < static_cast<int>(soup.t().size()); i++)
     {
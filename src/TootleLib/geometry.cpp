@@ -0,0 +1,245 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+/**
+Per-face geometry kernels used by the clustering and the overdraw passes.
+
+The faces are processed four at a time: the corners of four faces are gathered from the SoA position arrays into one
+register per coordinate, so that the normals and centroids of the four faces take the same instructions as one face
+in scalar code.  The operations are done in the same order as the Vector3 code they replace, one IEEE operation per
+step, so the results are bit-identical to it and the clustering does not change.  The remaining faces, and targets
+without SSE, use the scalar version of the same code.
+*/
+
+#include "TootlePCH.h"
+#include "geometry.h"
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #include <xmmintrin.h>
+    #define GEOMETRY_SSE
+#endif
+
+/// Meshes are only split over several threads if each thread gets at least this many faces
+#define GEOMETRY_FACES_PER_THREAD  65536
+
+//=================================================================================================================================
+//
+//          Internal functions
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Computes the normal and the centroid of one face.
+//=================================================================================================================================
+static inline void ComputeFace(const SoAPositions& rPositions, const unsigned int* pnFace, float* pfNormalOut,
+                               float* pfCenterOut)
+{
+    const float* px = &rPositions.x[0];
+    const float* py = &rPositions.y[0];
+    const float* pz = &rPositions.z[0];
+
+    unsigned int i0 = pnFace[0];
+    unsigned int i1 = pnFace[1];
+    unsigned int i2 = pnFace[2];
+
+    if (pfNormalOut)
+    {
+        float ax = px[i0] - px[i1], ay = py[i0] - py[i1], az = pz[i0] - pz[i1];
+        float bx = px[i1] - px[i2], by = py[i1] - py[i2], bz = pz[i1] - pz[i2];
+
+        float nx = ay * bz - az * by;
+        float ny = az * bx - ax * bz;
+        float nz = ax * by - ay * bx;
+
+        float fInvLength = 1.0f / sqrtf(nx * nx + ny * ny + nz * nz);
+
+        pfNormalOut[0] = nx * fInvLength;
+        pfNormalOut[1] = ny * fInvLength;
+        pfNormalOut[2] = nz * fInvLength;
+    }
+
+    if (pfCenterOut)
+    {
+        const float fThird = 1.0f / 3.0f;
+
+        pfCenterOut[0] = (px[i0] + px[i1] + px[i2]) * fThird;
+        pfCenterOut[1] = (py[i0] + py[i1] + py[i2]) * fThird;
+        pfCenterOut[2] = (pz[i0] + pz[i1] + pz[i2]) * fThird;
+    }
+}
+
+#ifdef GEOMETRY_SSE
+
+//=================================================================================================================================
+/// Gathers one coordinate of corner k of four consecutive faces.
+//=================================================================================================================================
+static inline __m128 GatherCorner(const float* pfCoordinate, const unsigned int* pnFaces, int k)
+{
+    return _mm_setr_ps(pfCoordinate[ pnFaces[k] ], pfCoordinate[ pnFaces[3 + k] ], pfCoordinate[ pnFaces[6 + k] ],
+                       pfCoordinate[ pnFaces[9 + k] ]);
+}
+
+//=================================================================================================================================
+/// Writes four vectors held as one register per coordinate to 12 consecutive floats.
+//=================================================================================================================================
+static inline void StoreVectors(__m128 x, __m128 y, __m128 z, float* pfOut)
+{
+    float pfX[4], pfY[4], pfZ[4];
+    _mm_storeu_ps(pfX, x);
+    _mm_storeu_ps(pfY, y);
+    _mm_storeu_ps(pfZ, z);
+
+    for (int k = 0; k < 4; k++)
+    {
+        pfOut[ 3 * k ]     = pfX[k];
+        pfOut[ 3 * k + 1 ] = pfY[k];
+        pfOut[ 3 * k + 2 ] = pfZ[k];
+    }
+}
+
+#endif
+
+//=================================================================================================================================
+/// Computes the normals and centroids of faces [nBegin, nEnd).
+//=================================================================================================================================
+static void ComputeFaceRange(const SoAPositions* pPositions, const unsigned int* pnIB, unsigned int nBegin, unsigned int nEnd,
+                             float* pfNormalsOut, float* pfCentersOut)
+{
+    unsigned int f = nBegin;
+
+#ifdef GEOMETRY_SSE
+    const float* px = &pPositions->x[0];
+    const float* py = &pPositions->y[0];
+    const float* pz = &pPositions->z[0];
+    const __m128 vOne   = _mm_set1_ps(1.0f);
+    const __m128 vThird = _mm_set1_ps(1.0f / 3.0f);
+
+    for (; f + 4 <= nEnd; f += 4)
+    {
+        const unsigned int* pnFaces = &pnIB[ 3 * f ];
+
+        __m128 x0 = GatherCorner(px, pnFaces, 0), y0 = GatherCorner(py, pnFaces, 0), z0 = GatherCorner(pz, pnFaces, 0);
+        __m128 x1 = GatherCorner(px, pnFaces, 1), y1 = GatherCorner(py, pnFaces, 1), z1 = GatherCorner(pz, pnFaces, 1);
+        __m128 x2 = GatherCorner(px, pnFaces, 2), y2 = GatherCorner(py, pnFaces, 2), z2 = GatherCorner(pz, pnFaces, 2);
+
+        if (pfNormalsOut)
+        {
+            __m128 ax = _mm_sub_ps(x0, x1), ay = _mm_sub_ps(y0, y1), az = _mm_sub_ps(z0, z1);
+            __m128 bx = _mm_sub_ps(x1, x2), by = _mm_sub_ps(y1, y2), bz = _mm_sub_ps(z1, z2);
+
+            __m128 nx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+            __m128 ny = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+            __m128 nz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+
+            __m128 vLength2   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+            __m128 vInvLength = _mm_div_ps(vOne, _mm_sqrt_ps(vLength2));
+
+            StoreVectors(_mm_mul_ps(nx, vInvLength), _mm_mul_ps(ny, vInvLength), _mm_mul_ps(nz, vInvLength),
+                         &pfNormalsOut[ 3 * f ]);
+        }
+
+        if (pfCentersOut)
+        {
+            StoreVectors(_mm_mul_ps(_mm_add_ps(_mm_add_ps(x0, x1), x2), vThird),
+                         _mm_mul_ps(_mm_add_ps(_mm_add_ps(y0, y1), y2), vThird),
+                         _mm_mul_ps(_mm_add_ps(_mm_add_ps(z0, z1), z2), vThird),
+                         &pfCentersOut[ 3 * f ]);
+        }
+    }
+
+#endif
+
+    for (; f < nEnd; f++)
+    {
+        ComputeFace(*pPositions, &pnIB[ 3 * f ], pfNormalsOut ? &pfNormalsOut[ 3 * f ] : NULL,
+                    pfCentersOut ? &pfCentersOut[ 3 * f ] : NULL);
+    }
+}
+
+//=================================================================================================================================
+//
+//          Geometry functions
+//
+//=================================================================================================================================
+
+void SoAPositions::Load(const void* pVB, unsigned int nVertices, unsigned int nVBStride)
+{
+    x.resize(nVertices);
+    y.resize(nVertices);
+    z.resize(nVertices);
+
+    const char* pVBuffer = (const char*) pVB;
+
+    for (unsigned int i = 0; i < nVertices; i++)
+    {
+        float pfPosition[3];
+        memcpy(pfPosition, pVBuffer, sizeof(pfPosition));
+        x[i] = pfPosition[0];
+        y[i] = pfPosition[1];
+        z[i] = pfPosition[2];
+        pVBuffer += nVBStride;
+    }
+}
+
+void SoAPositions::Load(const std::vector<Vector3>& rPositions)
+{
+    // Vector3 is 3 packed floats
+    if (rPositions.empty())
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        return;
+    }
+
+    Load(&rPositions[0][0], (unsigned int) rPositions.size(), sizeof(Vector3));
+}
+
+void ComputeFaceGeometry(const SoAPositions& rPositions,
+                         const unsigned int* pnIB,
+                         unsigned int        nFaces,
+                         float*              pfNormalsOut,
+                         float*              pfCentersOut)
+{
+    if (nFaces == 0)
+    {
+        return;
+    }
+
+    unsigned int nThreads = std::max(std::min(std::thread::hardware_concurrency(), nFaces / GEOMETRY_FACES_PER_THREAD), 1u);
+
+    std::vector<std::thread> workers;
+    unsigned int nBegin = 0;
+
+    for (unsigned int i = 1; i < nThreads; i++)
+    {
+        // a multiple of 4 faces per thread, so that only the last range has a scalar tail
+        unsigned int nEnd = (unsigned int)(((unsigned long long) nFaces * i / nThreads) & ~3ull);
+
+        try
+        {
+            workers.push_back(std::thread(ComputeFaceRange, &rPositions, pnIB, nBegin, nEnd, pfNormalsOut, pfCentersOut));
+        }
+        catch (const std::system_error&)
+        {
+            // the calling thread does the rest
+            break;
+        }
+
+        nBegin = nEnd;
+    }
+
+    ComputeFaceRange(&rPositions, pnIB, nBegin, nFaces, pfNormalsOut, pfCentersOut);
+
+    for (unsigned int i = 0; i < workers.size(); i++)
+    {
+        workers[ i ].join();
+    }
+}
@@ -0,0 +1,36 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _TOOTLE_GEOMETRY_H_
+#define _TOOTLE_GEOMETRY_H_
+
+#include <vector>
+#include "vector.h"
+
+/// Vertex positions stored as separate arrays of X, Y and Z coordinates, so that the kernels in geometry.cpp can
+/// load the same coordinate of several vertices into one register
+struct SoAPositions
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    /// Copies the positions of a vertex buffer.  The position must be the first 3 floats of each vertex.
+    void Load(const void* pVB, unsigned int nVertices, unsigned int nVBStride);
+
+    /// Copies the positions of a soup or a mesh.
+    void Load(const std::vector<Vector3>& rPositions);
+};
+
+/// Computes the unit normal and the centroid of each face, 3 floats per face.  Either output may be NULL.
+/// The normal of face (p0, p1, p2) is Normalize(Cross(p0 - p1, p1 - p2)) and its centroid is (p0 + p1 + p2) / 3, computed
+/// exactly as with Vector3.  Large meshes are split over several threads.
+void ComputeFaceGeometry(const SoAPositions& rPositions,
+                         const unsigned int* pnIB,
+                         unsigned int        nFaces,
+                         float*              pfNormalsOut,
+                         float*              pfCentersOut);
+
+#endif
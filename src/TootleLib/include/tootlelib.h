@@ -7,6 +7,8 @@
 #ifndef _TOOTLE_LIB_H_
 #define _TOOTLE_LIB_H_
 
+#include <stddef.h>
+
 #ifdef _LINUX
     #define TOOTLE_DLL
 #else
@@ -25,11 +27,33 @@
 /// The maximum allowed number of vertices in the mesh
 #define TOOTLE_MAX_VERTICES         0x7fffffff
 
+/// The maximum number of viewpoints TootleGenerateViewpoints can place on the whole sphere
+#define TOOTLE_MAX_VIEWPOINTS       0x1000000
+
+/// The default index that separates two triangle strips (the primitive restart index of 32 bit index buffers)
+#define TOOTLE_DEFAULT_RESTART_INDEX     0xffffffff
+
+/// The largest vertex stride, in bytes, that TootleMeasureVertexFetch accepts.  Each fetched vertex walks every cache line it
+///  covers, so larger strides would take very long to simulate.
+#define TOOTLE_MAX_FETCH_VERTEX_STRIDE   0x10000
+
+/// The default cache line size, in bytes, used by TootleMeasureVertexFetch
+#define TOOTLE_DEFAULT_FETCH_LINE_SIZE   64
+
+/// The default size of the vertex fetch cache, in bytes, used by TootleMeasureVertexFetch
+#define TOOTLE_DEFAULT_FETCH_CACHE_SIZE  (16 * 1024)
+
+/// The default associativity of the vertex fetch cache used by TootleMeasureVertexFetch
+#define TOOTLE_DEFAULT_FETCH_CACHE_WAYS  4
+
 /// The parameter for TootleFastOptimize to create more clusters (lower number generates more clusters).
 /// This parameter decides where to put extra breaks to create more clusters (refer to the SIGGRAPH 2007 paper
 /// for the full description of the parameter.
 #define TOOTLE_DEFAULT_ALPHA        0.75f
 
+/// The default weight of the overdraw against the vertex cache misses in TootleFastOptimizeAutoAlpha
+#define TOOTLE_DEFAULT_OVERDRAW_WEIGHT  1.0f
+
 /// Enumeration for Tootle return codes
 enum TootleResult
 {
@@ -58,7 +82,8 @@ enum TootleVCacheOptimizer
     TOOTLE_VCACHE_AUTO,           ///< If vertex cache size is less than 7, use TSTRIPS algorithm otherwise TIPSY.
     TOOTLE_VCACHE_DIRECT3D,       ///< Use D3DXOptimizeFaces to optimize faces.
     TOOTLE_VCACHE_LSTRIPS,        ///< Build a list like triangle strips to optimize faces.
-    TOOTLE_VCACHE_TIPSY           ///< Use TIPSY (the algorithm from SIGGRAPH 2007) to optimize faces.
+    TOOTLE_VCACHE_TIPSY,          ///< Use TIPSY (the algorithm from SIGGRAPH 2007) to optimize faces.
+    TOOTLE_VCACHE_TIPSY_COMPRESS  ///< Use TIPSY, ordering faces for a smaller TootleEncodeIndexBuffer output.
 };
 
 /// Enumeration for the algorithm for overdraw optimization.
@@ -71,11 +96,144 @@ enum TootleOverdrawOptimizer
     TOOTLE_OVERDRAW_FAST           ///< Use a fast approximation algorithm (from SIGGRAPH 2007) to reorder clusters.
 };
 
+/// Enumeration for the model of the cost of the fragments that overdraw optimization minimizes and overdraw measurement reports.
+///  Only the ray tracer models the hierarchical Z buffer, so the other models are computed with TOOTLE_OVERDRAW_RAYTRACE.
+enum TootleOverdrawCostModel
+{
+    NA_TOOTLE_OVERDRAW_COST,        ///< Default invalid choice.
+    TOOTLE_OVERDRAW_COST_PLAIN,     ///< Every fragment behind a nearer one of an earlier cluster is rejected by early Z.
+    TOOTLE_OVERDRAW_COST_HIZ,       ///< A hierarchical Z buffer keeps the farthest depth of each 8x8 pixel tile, and rejects the
+                                    ///<  fragments behind it.  A cluster hides another only where it covers whole tiles.
+    TOOTLE_OVERDRAW_COST_PREPASS    ///< A depth-only pass with the hierarchical Z buffer, then a color pass that shades each
+                                    ///<  pixel once.  The depth fragments cost a quarter of a shaded one.
+};
+
+/// Enumeration for the algorithm for vertex memory optimization
+enum TootleVertexMemoryOptimizer
+{
+    NA_TOOTLE_VMEMORY_OPTIMIZER,   ///< Default invalid choice
+    TOOTLE_VMEMORY_FIRST_USE,      ///< Number the vertices in the order they are first referenced by the index buffer.
+    TOOTLE_VMEMORY_FETCH_AWARE     ///< Place vertices that are fetched close together in the index buffer in the same cache line.
+};
+
+/// Enumeration of the functions whose peak memory TootleEstimateMemory can predict
+enum TootleFunction
+{
+    NA_TOOTLE_FUNCTION,                  ///< Default invalid choice
+    TOOTLE_FUNCTION_OPTIMIZE_VCACHE,     ///< TootleOptimizeVCache
+    TOOTLE_FUNCTION_CLUSTER_MESH,        ///< TootleClusterMesh
+    TOOTLE_FUNCTION_VCACHE_CLUSTERS,     ///< TootleVCacheClusters
+    TOOTLE_FUNCTION_OPTIMIZE_OVERDRAW,   ///< TootleOptimizeOverdraw
+    TOOTLE_FUNCTION_MEASURE_OVERDRAW,    ///< TootleMeasureOverdraw
+    TOOTLE_FUNCTION_OPTIMIZE,            ///< TootleOptimize
+    TOOTLE_FUNCTION_FAST_OPTIMIZE        ///< TootleFastOptimize
+};
+
+/// Enumeration for the sampling of the viewpoint sphere made by TootleGenerateViewpoints
+enum TootleViewpointSampling
+{
+    NA_TOOTLE_VIEWPOINT_SAMPLING,   ///< Default invalid choice
+    TOOTLE_VIEWPOINT_GEODESIC,      ///< The vertices of a subdivided icosahedron.  The whole sphere has 10*N*N+2 viewpoints
+                                    ///<  (12, 42, 92, 162, ...).  The default viewpoint set is close to the one with 642.
+    TOOTLE_VIEWPOINT_FIBONACCI      ///< A Fibonacci spiral, which covers the sphere or the cone almost uniformly with any
+                                    ///<  number of viewpoints.
+};
+
+/// Enumeration for the output format of a vertex attribute, see TootleVertexLayout
+enum TootleVertexFormat
+{
+    NA_TOOTLE_VERTEX_FORMAT,          ///< Default invalid choice
+    TOOTLE_VERTEX_COPY,               ///< Copy nSize bytes unchanged.
+    TOOTLE_VERTEX_POSITION_UNORM16,   ///< 3 floats, stored as 3 16-bit unsigned normalized values relative to the bounds of
+                                      ///<  the attribute over all vertices (6 bytes).
+    TOOTLE_VERTEX_NORMAL_OCT8,        ///< A unit vector of 3 floats, octahedrally encoded as 2 8-bit signed normalized values
+                                      ///<  (2 bytes).
+    TOOTLE_VERTEX_NORMAL_OCT16,       ///< A unit vector of 3 floats, octahedrally encoded as 2 16-bit signed normalized values
+                                      ///<  (4 bytes).
+    TOOTLE_VERTEX_TEXCOORD_HALF2      ///< 2 floats, stored as 2 half floats (4 bytes).
+};
+
+/// One attribute of a TootleVertexLayout
+struct TootleVertexAttribute
+{
+    TootleVertexFormat eFormat;    ///< The output format.  The input is 32-bit floats unless the format is TOOTLE_VERTEX_COPY.
+    unsigned int       nOffset;    ///< The offset of the attribute in an input vertex, in bytes.
+    unsigned int       nOutOffset; ///< The offset of the attribute in an output vertex, in bytes.
+    unsigned int       nSize;      ///< The number of bytes to copy.  Only used by TOOTLE_VERTEX_COPY.
+};
+
+/// Describes how TootleOptimizeVertexMemory and TootleOptimizeVertexStreams convert the vertices they write.  The output
+///  bytes that no attribute writes are set to zero.
+struct TootleVertexLayout
+{
+    const TootleVertexAttribute* pAttributes;   ///< The attributes written to each output vertex
+    unsigned int                 nAttributes;   ///< The number of attributes
+    unsigned int                 nVBOutStride;  ///< The distance between successive output vertices, in bytes
+    float*                       pfBoundsOut;   ///< Receives the minimum X,Y,Z followed by the maximum X,Y,Z of every
+                                                ///<  TOOTLE_VERTEX_POSITION_UNORM16 attribute, in attribute order.  A value
+                                                ///<  q is decoded as min + (max - min) * q / 65535.  May be NULL.
+};
+
+/// One vertex stream for TootleOptimizeVertexStreams
+struct TootleVertexStream
+{
+    const void*               pVB;         ///< The vertex data of the stream
+    void*                     pVBOut;      ///< Receives the reordered vertex data.  May be NULL.  May equal pVB.
+    unsigned int              nVBStride;   ///< The distance between successive vertices in the stream, in bytes.  Must be non-zero.
+    const TootleVertexLayout* pVBOutLayout; ///< If not NULL, the vertices are converted to this layout while they are written to
+                                            ///<  pVBOut, which then holds pVBOutLayout->nVBOutStride bytes per vertex.
+};
+
+/// One level of detail for TootleOptimizeLODChain
+struct TootleLODLevel
+{
+    const unsigned int* pnIB;          ///< The index buffer of the level.  Must be a triangle list.
+    unsigned int        nFaces;        ///< The number of faces in the level.  Must be non-zero and less than TOOTLE_MAX_FACES.
+    unsigned int*       pnIBOut;       ///< Receives the optimized index buffer, which refers to the re-ordered vertices.  May not
+                                       ///<  be NULL.  May equal pnIB.
+    unsigned int        nVerticesOut;  ///< Receives the number of vertices referenced by this level and the coarser levels.
+                                       ///<  These vertices occupy the first nVerticesOut locations of the output vertex buffer.
+};
+
 //=================================================================================================================================
 /// \brief Performs one-time initialization required by Tootle
 //=================================================================================================================================
 TootleResult TOOTLE_DLL TootleInit();
 
+//=================================================================================================================================
+/// This function predicts the peak amount of memory that a Tootle function allocates, so that an application can check that a
+///  job fits on a machine before it starts.  The prediction covers the memory that Tootle allocates itself, not the buffers
+///  that the application passes in.  It is an estimate measured on typical meshes: it grows linearly with the number of faces
+///  and vertices, and with the square of the number of clusters for the ray traced overdraw optimization.  Meshes with very
+///  uneven vertex valences may need somewhat more.  The algorithms are chosen as the function itself would choose them for
+///  nMemoryBudgetMB.
+///
+/// \param eFunction          The function to estimate.
+/// \param nVertices          The number of vertices in the mesh.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+/// \param nFaces             The number of faces in the mesh.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param nCacheSize         The vertex cache size that will be passed to the function.  Ignored by the functions that do not
+///                            take one.
+/// \param nClusters          The number of clusters: nTargetClusters for TootleClusterMesh, or the number of clusters of the
+///                            input to TootleOptimizeOverdraw.  Pass 0 if it is not known, and a typical count for automatic
+///                            clustering is assumed.
+/// \param eVCacheOptimizer   The vertex cache algorithm that will be passed to the function, if it takes one.
+/// \param eOverdrawOptimizer The overdraw algorithm that will be passed to the function, if it takes one.
+/// \param nMemoryBudgetMB    The memory budget that will be passed to the function, in megabytes, or 0 for no limit.
+/// \param pnKilobytesOut     A pointer to receive the predicted peak memory, in kilobytes.  May not be NULL.
+///
+/// \return  TOOTLE_OUT_OF_MEMORY if the function would fail because the prediction exceeds nMemoryBudgetMB, even with the
+///           smallest algorithms.  The prediction is returned in either case.  Otherwise TOOTLE_INVALID_ARGS or TOOTLE_OK.
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleEstimateMemory(TootleFunction          eFunction,
+                                             unsigned int            nVertices,
+                                             unsigned int            nFaces,
+                                             unsigned int            nCacheSize,
+                                             unsigned int            nClusters,
+                                             TootleVCacheOptimizer   eVCacheOptimizer,
+                                             TootleOverdrawOptimizer eOverdrawOptimizer,
+                                             unsigned int            nMemoryBudgetMB,
+                                             unsigned int*           pnKilobytesOut);
+
 //=================================================================================================================================
 /// This function performs vertex cache optimization on an index buffer.  It returns a face re-mapping if requested.
 ///  There are several choices for the vertex cache optimization:
@@ -83,6 +241,8 @@ TootleResult TOOTLE_DLL TootleInit();
 ///  (2) TOOTLE_VCACHE_DIRECT3D : use D3DXOptimizeFaces to optimize indices.
 ///  (3) TOOTLE_VCACHE_LSTRIPS  : use LSTRIPS (a list like triangle strips) to optimize indices.
 ///  (4) TOOTLE_VCACHE_TIPSY    : use TIPSY (a new algorithm from SIGGRAPH 2007) to optimize indices.
+///  (5) TOOTLE_VCACHE_TIPSY_COMPRESS : use TIPSY, emitting the triangles around each vertex in adjacency order so that
+///                               TootleEncodeIndexBuffer compresses the result better.
 ///
 /// \param pnIB             The index buffer to optimize.  Must be a triangle list.
 /// \param nFaces           The number of faces in the index buffer.  This must non-zero and less than TOOTLE_MAX_FACES.
@@ -93,11 +253,28 @@ TootleResult TOOTLE_DLL TootleInit();
 /// \param pnFaceRemapOut   A pointer to an array that will be filled with a face re-mapping.  May be NULL.  This is an array of
 ///                          nFaces elements.
 ///                          Element i in the array will contain the position of input face i in the output face ordering.
-/// \param eVCacheOptimizer The selection for choosing the algorithm to optimize vertex cache.  There are four choices:
-///                          TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_DIRECT3D, TOOTLE_VCACHE_LSTRIPS or TOOTLE_VCACHE_TIPSY.
+/// \param eVCacheOptimizer The selection for choosing the algorithm to optimize vertex cache.  There are five choices:
+///                          TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_DIRECT3D, TOOTLE_VCACHE_LSTRIPS, TOOTLE_VCACHE_TIPSY or
+///                          TOOTLE_VCACHE_TIPSY_COMPRESS.
+/// \param nMemoryBudgetMB  The largest amount of memory the function may allocate, in megabytes, or 0 for no limit.  If
+///                          TOOTLE_VCACHE_LSTRIPS (or TOOTLE_VCACHE_AUTO with a small cache) would not fit, TOOTLE_VCACHE_TIPSY
+///                          is used instead.  If nothing fits, the function fails before allocating.  See TootleEstimateMemory.
 ///
 /// \return                 Possible return codes:  TOOTLE_OK, TOOTLE_OUT_OF_MEMORY, TOOTLE_INVALID_ARGS
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeVCacheEx(const unsigned int*   pnIB,
+                                               unsigned int          nFaces,
+                                               unsigned int          nVertices,
+                                               unsigned int          nCacheSize,
+                                               unsigned int*         pnIBOut,
+                                               unsigned int*         pnFaceRemapOut,
+                                               TootleVCacheOptimizer eVCacheOptimizer = TOOTLE_VCACHE_AUTO,
+                                               unsigned int          nMemoryBudgetMB  = 0);
+
+//=================================================================================================================================
+/// Calls TootleOptimizeVCacheEx with nMemoryBudgetMB = 0.  This is the signature exported by earlier versions of Tootle, and is
+///  kept so that applications built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
                                              unsigned int          nFaces,
                                              unsigned int          nVertices,
@@ -106,6 +283,136 @@ TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
                                              unsigned int*         pnFaceRemapOut,
                                              TootleVCacheOptimizer eVCacheOptimizer = TOOTLE_VCACHE_AUTO);
 
+//=================================================================================================================================
+/// This function optimizes an index buffer for the vertex cache and returns it as triangle strips separated by a restart index,
+///  for drawing with primitive restart.  The faces are ordered by the TOOTLE_VCACHE_LSTRIPS algorithm, except that each new
+///  strip starts next to the vertices that are still in a cache of nCacheSize vertices.  Consecutive faces that continue a
+///  strip are joined, so a strip needs one index per face plus a few to start it, instead of three per face.  Each face keeps
+///  its winding: the odd triangles of a strip are reversed as the graphics APIs expect.  The same faces are also returned as a
+///  triangle list.  Use TootleMeasureCacheEfficiencyStrips to measure the strips.
+///
+/// \param pnIB              The index buffer to optimize.  Must be a triangle list.
+/// \param nFaces            The number of faces in the index buffer.  This must non-zero and less than TOOTLE_MAX_FACES.
+/// \param nVertices         The number of vertices in the model.  This must non-zero and less than TOOTLE_MAX_VERTICES.
+///                           All indices must be less than nVertices.
+/// \param nCacheSize        The number of vertices that will fit in cache.  If the application does not know or care about
+///                           the vertex cache size, then it should pass TOOTLE_DEFAULT_VCACHE_SIZE.  This value must be non-zero.
+/// \param pnStripIBOut      An array that will be filled with the strips.  Must have room for 4*nFaces-1 indices.
+/// \param pnStripIndicesOut A pointer to receive the number of indices in pnStripIBOut, including the restart indices.
+/// \param pnIBOut           A pointer that will be filled with the faces as a triangle list, in the same order.  May be NULL.
+///                           May equal pnIB.
+/// \param pnFaceRemapOut    A pointer to an array that will be filled with a face re-mapping.  May be NULL.  This is an array
+///                           of nFaces elements.  Element i in the array will contain the position of input face i in the
+///                           output face ordering.
+/// \param nRestartIndex     The index that separates two strips.  Must not be less than nVertices.
+///
+/// \return                  Possible return codes:  TOOTLE_OK, TOOTLE_OUT_OF_MEMORY, TOOTLE_INVALID_ARGS
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeVCacheStrips(const unsigned int* pnIB,
+                                                   unsigned int        nFaces,
+                                                   unsigned int        nVertices,
+                                                   unsigned int        nCacheSize,
+                                                   unsigned int*       pnStripIBOut,
+                                                   unsigned int*       pnStripIndicesOut,
+                                                   unsigned int*       pnIBOut = NULL,
+                                                   unsigned int*       pnFaceRemapOut = NULL,
+                                                   unsigned int        nRestartIndex = TOOTLE_DEFAULT_RESTART_INDEX);
+
+//=================================================================================================================================
+/// This function optimizes the index buffer of a mesh too large to optimize in memory for the vertex cache.  The mesh is split
+///  into spatial chunks that fit in the memory budget, along a grid of cells numbered in Morton order, so that consecutive
+///  chunks are close together.  Each chunk is optimized on its own with the chosen algorithm, as if it were passed to
+///  TootleOptimizeVCache, and the results are written one after the other to the output.  The vertex buffer and the index
+///  buffers are only read and written through the pointers, so they can be memory-mapped files: the index buffer is read
+///  sequentially twice, once to count the faces of each cell and once to write each face to its cell's place in the output.
+///  Each chunk is then read from the output and optimized in place, so the output is written once in cell order and once
+///  sequentially.  Only the positions of the vertices of each face are read from the vertex buffer, once per pass over the
+///  index buffer.  The memory allocated by the function stays within the budget, whatever the size of the mesh.
+///  The faces keep their vertices and winding.  Only the faces at the border of a chunk miss the cache more often than with
+///  TootleOptimizeVCache.
+///
+/// \param pVB              A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
+///                           position must be a 3-component floating point value (X,Y,Z).
+/// \param pnIB             The index buffer.  Must be a triangle list.
+/// \param nVertices        The number of vertices.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+///                           All indices must be less than nVertices.
+/// \param nFaces           The number of faces.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param nVBStride        The distance between successive vertices in the vertex buffer, in bytes.  This must be at least
+///                           3*sizeof(float).
+/// \param nCacheSize       The number of vertices that will fit in cache.  If the application does not know or care about the
+///                           vertex cache size, then it should pass TOOTLE_DEFAULT_VCACHE_SIZE.  This value must be non-zero.
+/// \param nMemoryBudgetMB  The largest amount of memory the function may allocate, in megabytes.  The larger it is, the fewer
+///                           chunks the mesh is split into.  Must be non-zero.
+/// \param pnIBOut          The optimized index buffer.  Must have room for 3*nFaces indices.  May not equal pnIB.
+/// \param eVCacheOptimizer The algorithm that optimizes each chunk: TOOTLE_VCACHE_TIPSY or TOOTLE_VCACHE_TIPSY_COMPRESS, as in
+///                           TootleOptimizeVCache.  The memory of the other algorithms has no bound per face, so they can not
+///                           be held to the budget.
+/// \param pnChunksOut      A pointer to receive the number of chunks.  May be NULL.
+///
+/// \return  Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeVCacheStreaming(const void*           pVB,
+                                                      const unsigned int*   pnIB,
+                                                      unsigned int          nVertices,
+                                                      unsigned int          nFaces,
+                                                      unsigned int          nVBStride,
+                                                      unsigned int          nCacheSize,
+                                                      unsigned int          nMemoryBudgetMB,
+                                                      unsigned int*         pnIBOut,
+                                                      TootleVCacheOptimizer eVCacheOptimizer = TOOTLE_VCACHE_TIPSY,
+                                                      unsigned int*         pnChunksOut = NULL);
+
+//=================================================================================================================================
+/// This function updates an optimized mesh after a small edit, instead of optimizing the whole mesh again.  The previous result
+///  is an index buffer whose faces are grouped in clusters, as produced by TootleClusterMesh, TootleVCacheClusters and
+///  TootleOptimizeOverdraw, together with the cluster of each face.  The edit removes some of its faces and adds new ones.
+///  Each added face joins the cluster of the face it shares the most vertices with, among the kept faces and the other added
+///  faces, so the clusters grow into the edited region.  The added faces that touch no cluster form a new cluster, drawn
+///  last.  The clusters keep their draw order.  Only the clusters that lost or gained faces are optimized again for the
+///  vertex cache, and the others are copied, so the cost of the expensive steps is proportional to the size of the edit.
+///  The overdraw order of the clusters is not changed: after large edits, optimize the whole mesh again.
+///
+/// \param pnIB                  The previous optimized index buffer.  Must be a triangle list.
+/// \param pnFaceClusters        The cluster of each face of pnIB.  The faces of a cluster must be contiguous, and the IDs must
+///                                be less than nFaces.  The pnFaceClustersOut of a previous call qualifies.  The output of
+///                                TootleClusterMesh only matches the index buffer until TootleOptimizeOverdraw reorders the
+///                                clusters.  After that, permute it with pnClusterRemapOut: the faces of pnIB are those of cluster
+///                                pnClusterRemapOut[0], then those of cluster pnClusterRemapOut[1], and so on.  An array that
+///                                does not match pnIB is not detected, and gives wrong clusters.
+/// \param nVertices             The number of vertices after the edit.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+///                                All indices must be less than nVertices.
+/// \param nFaces                The number of faces in pnIB.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param nCacheSize            The number of vertices that will fit in cache.  If the application does not know or care about
+///                                the vertex cache size, then it should pass TOOTLE_DEFAULT_VCACHE_SIZE.  Must be non-zero.
+/// \param pnRemovedFaces        The positions in pnIB of the faces to remove, each at most once.  May be NULL if nRemovedFaces
+///                                is 0.
+/// \param nRemovedFaces         The number of faces to remove.
+/// \param pnAddedIB             The faces to add, as a triangle list.  May be NULL if nAddedFaces is 0.
+/// \param nAddedFaces           The number of faces to add.
+/// \param pnIBOut               The updated index buffer.  Must have room for 3*(nFaces-nRemovedFaces+nAddedFaces) indices.
+///                                May not equal pnIB.
+/// \param pnFaceClustersOut     An array of nFaces-nRemovedFaces+nAddedFaces+1 elements that will receive the cluster of each
+///                                face of pnIBOut, numbered in draw order, followed by the number of clusters.  May not equal
+///                                pnFaceClusters.
+/// \param eVCacheOptimizer      The algorithm that optimizes the updated clusters, as in TootleOptimizeVCache.
+/// \param pnUpdatedClustersOut  A pointer to receive the number of clusters that were optimized again.  May be NULL.
+///
+/// \return  Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleUpdateOptimizedMesh(const unsigned int*   pnIB,
+                                                  const unsigned int*   pnFaceClusters,
+                                                  unsigned int          nVertices,
+                                                  unsigned int          nFaces,
+                                                  unsigned int          nCacheSize,
+                                                  const unsigned int*   pnRemovedFaces,
+                                                  unsigned int          nRemovedFaces,
+                                                  const unsigned int*   pnAddedIB,
+                                                  unsigned int          nAddedFaces,
+                                                  unsigned int*         pnIBOut,
+                                                  unsigned int*         pnFaceClustersOut,
+                                                  TootleVCacheOptimizer eVCacheOptimizer = TOOTLE_VCACHE_TIPSY,
+                                                  unsigned int*         pnUpdatedClustersOut = NULL);
+
 //=================================================================================================================================
 ///  This function partitions a mesh into a set of connected, roughly planar clusters.  It generates a new mesh that is re-arranged
 ///  in cluster order.  This clustering is required as a pre-cursor to overdraw optimization. This function returns a mesh that
@@ -123,7 +430,11 @@ TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
 ///                            but not more than nFaces.  This value is only a hint.  More clusters may be created if Tootle
 ///                           considers it necessary. (for example, if there are numerous connected components in the mesh).
 ///                           Passing 0 for this value causes Tootle to use an automatic method to determine when to stop creating
-///                            clusters.
+///                            clusters.  A non-zero target places all the cluster seeds at once by farthest point sampling,
+///                            then refines them until the clusters stop changing.  Earlier versions of Tootle added one seed
+///                            per iteration instead, so the clusters of a given target differ from theirs, with similar
+///                            overdraw and vertex cache results in a fraction of the time.  The automatic method still adds
+///                            one seed at a time.
 /// \param pnClusteredIBOut  An array that will receive a copy of the index buffer, sorted by cluster ID.
 ///                           May not be NULL.  May equal pIB.
 /// \param pnFaceClustersOut An array of nFaces+1 unsigned ints, that will be filled with the cluster ID that was assigned to
@@ -132,8 +443,25 @@ TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
 /// \param pnFaceRemapOut    An array that will receive a face re-mapping.  May be NULL.  If not NULL, must be an array of size
 ///                           nFaces. The i'th element of the output array contains the position of input face i in the new face
 ///                           ordering.
+/// \param nMemoryBudgetMB   The largest amount of memory the function may allocate, in megabytes, or 0 for no limit.  If the
+///                           clustering would not fit, the function fails before allocating.  See TootleEstimateMemory.
 /// \return  Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, TOOTLE_OK
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleClusterMeshEx(const void*         pVB,
+                                            const unsigned int* pnIB,
+                                            unsigned int        nVertices,
+                                            unsigned int        nFaces,
+                                            unsigned int        nVBStride,
+                                            unsigned int        nTargetClusters,
+                                            unsigned int*       pnClusteredIBOut,
+                                            unsigned int*       pnFaceClustersOut,
+                                            unsigned int*       pnFaceRemapOut,
+                                            unsigned int        nMemoryBudgetMB = 0);
+
+//=================================================================================================================================
+/// Calls TootleClusterMeshEx with nMemoryBudgetMB = 0.  This is the signature exported by earlier versions of Tootle, and is
+///  kept so that applications built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleClusterMesh(const void*         pVB,
                                           const unsigned int* pnIB,
                                           unsigned int        nVertices,
@@ -171,6 +499,36 @@ TootleResult TOOTLE_DLL TootleFastOptimizeVCacheAndClusterMesh(const unsigned in
                                                                unsigned int*       pnNumClustersOut,
                                                                float               fAlpha = TOOTLE_DEFAULT_ALPHA);
 
+//=================================================================================================================================
+/// This function generates a set of viewpoints for TootleOptimizeOverdraw, TootleOptimize and TootleMeasureOverdraw.  The
+///  viewpoints sample the unit sphere at a chosen density, optionally restricted to the cone of directions from which the mesh
+///  is actually seen: a hemisphere for terrain, or a narrow cone for an object only seen from above.  The time spent measuring
+///  overdraw grows with the number of viewpoints, so sampling only the relevant directions is faster, and the ordering is no
+///  longer traded off against views that never occur.
+///
+/// \param eSampling          The sampling: TOOTLE_VIEWPOINT_GEODESIC or TOOTLE_VIEWPOINT_FIBONACCI.
+/// \param nSphereViewpoints  The density of the sampling, as the number of viewpoints it would place on the whole sphere.
+///                            The geodesic sampling rounds it up to the next possible count.  Must be non-zero and at most
+///                            TOOTLE_MAX_VIEWPOINTS.  The default viewpoint set has 642.
+/// \param pfConeAxis         The direction at the center of the cone, as X,Y,Z.  Need not be normalized.  Viewpoints are
+///                            camera positions, so (0,1,0) selects the views from above when Y is up.  If NULL, the viewpoints
+///                            cover the whole sphere.
+/// \param fConeAngle         The angle between the axis and the boundary of the cone, in degrees, in (0, 180].  Pass 90 for a
+///                            hemisphere.  Ignored if pfConeAxis is NULL.
+/// \param pfViewpointsOut    An array receiving 3 floats per viewpoint.  May be NULL, to get the number of viewpoints first.
+///                            The viewpoints are unit vectors.  If the cone is too narrow to contain a viewpoint of the
+///                            geodesic sampling, the axis itself is returned.
+/// \param pnViewpointsOut    A pointer to receive the number of viewpoints.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleGenerateViewpoints(TootleViewpointSampling eSampling,
+                                                 unsigned int            nSphereViewpoints,
+                                                 const float*            pfConeAxis,
+                                                 float                   fConeAngle,
+                                                 float*                  pfViewpointsOut,
+                                                 unsigned int*           pnViewpointsOut);
+
 //=================================================================================================================================
 /// Given a clustered mesh, this function computes a cluster ordering that minimizes expected overdraw, and sorts the clusters
 ///  according to this ordering.  The input is a mesh whose faces are seperated into clusters.  The clustering can be obtained by
@@ -203,9 +561,36 @@ TootleResult TOOTLE_DLL TootleFastOptimizeVCacheAndClusterMesh(const unsigned in
 ///                            of the cluster that should come i'th in the draw order.
 /// \param eOverdrawOptimizer The algorithm selection for optimizing overdraw.  Pass either TOOTLE_OVERDRAW_FAST (default),
 ///                            TOOTLE_OVERDRAW_AUTO, TOOTLE_OVERDRAW_DIRECT3D, or TOOTLE_OVERDRAW_RAYTRACE.
+/// \param nMemoryBudgetMB    The largest amount of memory the function may allocate, in megabytes, or 0 for no limit.  The
+///                            ray tracer and its overdraw table grow with the number of faces and the square of the number of
+///                            clusters.  If they would not fit, TOOTLE_OVERDRAW_FAST is used instead.  If nothing fits, the
+///                            function fails before allocating.  See TootleEstimateMemory.
+/// \param eCostModel         The cost of the fragments that the cluster order minimizes.  TOOTLE_OVERDRAW_COST_PLAIN (default),
+///                            TOOTLE_OVERDRAW_COST_HIZ or TOOTLE_OVERDRAW_COST_PREPASS.  The other models replace
+///                            TOOTLE_OVERDRAW_AUTO and TOOTLE_OVERDRAW_DIRECT3D by TOOTLE_OVERDRAW_RAYTRACE.
+///                            TOOTLE_OVERDRAW_FAST does not measure overdraw, and ignores it.
 /// \return Possible return codes:  TOOTLE_OK, TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, TOOTLE_3D_API_ERROR, or
 ///                                  TOOTLE_NOT_INITIALIZED
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeOverdrawEx(const void*             pVB,
+                                                 const unsigned int*     pnIB,
+                                                 unsigned int            nVertices,
+                                                 unsigned int            nFaces,
+                                                 unsigned int            nVBStride,
+                                                 const float*            pfViewpoint,
+                                                 unsigned int            nViewpoints,
+                                                 TootleFaceWinding       eFrontWinding,
+                                                 const unsigned int*     pnFaceClusters,
+                                                 unsigned int*           pnIBOut,
+                                                 unsigned int*           pnClusterRemapOut,
+                                                 TootleOverdrawOptimizer eOverdrawOptimizer = TOOTLE_OVERDRAW_FAST,
+                                                 unsigned int            nMemoryBudgetMB    = 0,
+                                                 TootleOverdrawCostModel eCostModel         = TOOTLE_OVERDRAW_COST_PLAIN);
+
+//=================================================================================================================================
+/// Calls TootleOptimizeOverdrawEx with nMemoryBudgetMB = 0 and eCostModel = TOOTLE_OVERDRAW_COST_PLAIN.  This is the signature
+///  exported by earlier versions of Tootle, and is kept so that applications built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleOptimizeOverdraw(const void*             pVB,
                                                const unsigned int*     pnIB,
                                                unsigned int            nVertices,
@@ -234,6 +619,8 @@ void TOOTLE_DLL TootleCleanup();
 ///  (2) TOOTLE_VCACHE_DIRECT3D : use D3DXOptimizeFaces to optimize indices.
 ///  (3) TOOTLE_VCACHE_LSTRIPS  : use LSTRIPS (triangle strips) to optimize indices.
 ///  (4) TOOTLE_VCACHE_TIPSY    : use TIPSY (a new algorithm from SIGGRAPH 2007) to optimize indices.
+///  (5) TOOTLE_VCACHE_TIPSY_COMPRESS : use TIPSY, emitting the triangles around each vertex in adjacency order so that
+///                               TootleEncodeIndexBuffer compresses the result better.
 ///
 /// \param pVB                A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
 ///                            position must be a 3-component floating point value (X,Y,Z).
@@ -251,15 +638,40 @@ void TOOTLE_DLL TootleCleanup();
 ///                            set will be used.
 /// \param nViewpoints        The number of viewpoints in the viewpoint array.
 /// \param eFrontWinding      The winding order of front-faces in the model.
-/// \param eVCacheOptimizer   The selection for choosing the algorithm to optimize vertex cache.  There are four choices:
-///                            TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_DIRECT3D, TOOTLE_VCACHE_LSTRIPS or TOOTLE_VCACHE_TIPSY.
+/// \param eVCacheOptimizer   The selection for choosing the algorithm to optimize vertex cache.  There are five choices:
+///                            TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_DIRECT3D, TOOTLE_VCACHE_LSTRIPS, TOOTLE_VCACHE_TIPSY or
+///                            TOOTLE_VCACHE_TIPSY_COMPRESS.
 /// \param pnIBOut            A pointer that will be filled with an optimized index buffer.  May not be NULL.  May equal pIB.
 /// \param pnNumClustersOut   The number of clusters generated by the algorithm.  May be NULL if the output is not requested.
 /// \param eOverdrawOptimizer The algorithm selection for optimizing overdraw.  Pass either TOOTLE_OVERDRAW_FAST (default),
 ///                            TOOTLE_OVERDRAW_AUTO, TOOTLE_OVERDRAW_DIRECT3D, or TOOTLE_OVERDRAW_RAYTRACE.
+/// \param nMemoryBudgetMB    The largest amount of memory the function may allocate, in megabytes, or 0 for no limit.  It is
+///                            passed on to each step, which picks a smaller algorithm when it can.  If the clustering would not
+///                            fit, the function fails before allocating.  See TootleEstimateMemory.
+/// \param eCostModel         The cost of the fragments that the cluster order minimizes, as for TootleOptimizeOverdraw.
 ///
 /// \return  Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, TOOTLE_OK
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeEx(const void*             pVB,
+                                         const unsigned int*     pnIB,
+                                         unsigned int            nVertices,
+                                         unsigned int            nFaces,
+                                         unsigned int            nVBStride,
+                                         unsigned int            nCacheSize,
+                                         const float*            pViewpoints,
+                                         unsigned int            nViewpoints,
+                                         TootleFaceWinding       eFrontWinding,
+                                         unsigned int*           pnIBOut,
+                                         unsigned int*           pnNumClustersOut,
+                                         TootleVCacheOptimizer   eVCacheOptimizer   = TOOTLE_VCACHE_AUTO,
+                                         TootleOverdrawOptimizer eOverdrawOptimizer = TOOTLE_OVERDRAW_FAST,
+                                         unsigned int            nMemoryBudgetMB    = 0,
+                                         TootleOverdrawCostModel eCostModel         = TOOTLE_OVERDRAW_COST_PLAIN);
+
+//=================================================================================================================================
+/// Calls TootleOptimizeEx with nMemoryBudgetMB = 0 and eCostModel = TOOTLE_OVERDRAW_COST_PLAIN.  This is the signature exported
+///  by earlier versions of Tootle, and is kept so that applications built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleOptimize(const void*             pVB,
                                        const unsigned int*     pnIB,
                                        unsigned int            nVertices,
@@ -291,9 +703,30 @@ TootleResult TOOTLE_DLL TootleOptimize(const void*             pVB,
 /// \param pnIBOut          The updated index buffer (the output).  May not be NULL.
 /// \param pnNumClustersOut The number of output clusters.  May be NULL if not requested.
 /// \param fAlpha           a linear parameter to compute lambda term from the algorithm.  Pass TOOTLE_DEFAULT_ALPHA as a default.
+/// \param nMemoryBudgetMB  The largest amount of memory the function may allocate, in megabytes, or 0 for no limit.  If the
+///                          optimization would not fit, the function fails before allocating.  See TootleEstimateMemory.
+/// \param fMaxACMRIncrease If positive, the faces of each cluster are ordered front to back, as by TootleVCacheClusters,
+///                          within this increase of the ACMR of the cluster.  0 (default) keeps the vertex cache order.
 ///
 /// \return  Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY or TOOTLE_OK
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleFastOptimizeEx(const void*         pVB,
+                                             const unsigned int* pnIB,
+                                             unsigned int        nVertices,
+                                             unsigned int        nFaces,
+                                             unsigned int        nVBStride,
+                                             unsigned int        nCacheSize,
+                                             TootleFaceWinding   eFrontWinding,
+                                             unsigned int*       pnIBOut,
+                                             unsigned int*       pnNumClustersOut,
+                                             float               fAlpha           = TOOTLE_DEFAULT_ALPHA,
+                                             unsigned int        nMemoryBudgetMB  = 0,
+                                             float               fMaxACMRIncrease = 0.0f);
+
+//=================================================================================================================================
+/// Calls TootleFastOptimizeEx with nMemoryBudgetMB = 0 and fMaxACMRIncrease = 0.0f.  This is the signature exported by earlier
+///  versions of Tootle, and is kept so that applications built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleFastOptimize(const void*         pVB,
                                            const unsigned int* pnIB,
                                            unsigned int        nVertices,
@@ -305,6 +738,99 @@ TootleResult TOOTLE_DLL TootleFastOptimize(const void*         pVB,
                                            unsigned int*       pnNumClustersOut,
                                            float               fAlpha = TOOTLE_DEFAULT_ALPHA);
 
+//=================================================================================================================================
+/// This function performs the same optimization as TootleFastOptimize, but chooses fAlpha for the mesh.  The vertex cache
+///  optimization does not depend on fAlpha, so it runs once.  The clustering and the overdraw ordering then run for a fixed set
+///  of candidate values of fAlpha, in parallel on nThreads threads.  The overdraw of each result is estimated by rendering the
+///  mesh once into a few small images, and drawing their fragments in the order of each result.
+///  Each result is scored by its ACMR and by its fraction of overdrawn pixels, both relative to the best of all the results:
+///  ACMR / best ACMR + fOverdrawWeight * overdrawn pixels / fewest overdrawn pixels.  The result with the lowest score is
+///  returned.  It does not depend on the number of threads.
+///  The total work is about ten times that of TootleFastOptimize, most of which is shared out among the threads.
+///
+/// \param pVB              A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
+///                          position must be a 3-component floating point value (X,Y,Z).
+/// \param pnIB             The input index buffer: 3 unsigned int per triangle.
+/// \param nVertices        The number of vertices in the vertex buffer.
+/// \param nFaces           The number of faces in the index buffer.
+/// \param nVBStride        The distance between successive vertices in the vertex buffer, in bytes.  This must be at least
+///                          3*sizeof(float).
+/// \param nCacheSize       Hardware cache size (12 to 24 are good options).
+/// \param eFrontWinding    The winding order of front-faces in the model.
+/// \param pnIBOut          The updated index buffer (the output).  May not be NULL.  May equal pnIB.
+/// \param pnNumClustersOut The number of output clusters.  May be NULL if not requested.
+/// \param fOverdrawWeight  The weight of the overdraw against the ACMR.  With a weight of 1, 1% more overdrawn pixels cost
+///                          as much as 1% more vertex cache misses.  Must not be negative.  0 optimizes the vertex cache only,
+///                          and skips the overdraw estimate.
+/// \param pfAlphaOut       A pointer to receive the chosen value of fAlpha.  May be NULL if not requested.
+/// \param nThreads         The number of threads.  0 uses one thread per core.
+///
+/// \return  Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleFastOptimizeAutoAlpha(const void*         pVB,
+                                                    const unsigned int* pnIB,
+                                                    unsigned int        nVertices,
+                                                    unsigned int        nFaces,
+                                                    unsigned int        nVBStride,
+                                                    unsigned int        nCacheSize,
+                                                    TootleFaceWinding   eFrontWinding,
+                                                    unsigned int*       pnIBOut,
+                                                    unsigned int*       pnNumClustersOut,
+                                                    float               fOverdrawWeight = TOOTLE_DEFAULT_OVERDRAW_WEIGHT,
+                                                    float*              pfAlphaOut      = NULL,
+                                                    unsigned int        nThreads        = 0);
+
+//=================================================================================================================================
+/// This function performs the same optimization as TootleOptimize on a mesh made of several submeshes, one per material,
+///  which are drawn with separate draw calls.  Each material's faces are clustered and optimized for the vertex cache on their
+///  own, so no cluster spans two materials.  The materials are processed in parallel on nThreads threads.
+///  The overdraw is then measured once for the whole mesh, and the result is used both to order the clusters within each
+///  material and to order the materials themselves.  In the output index buffer, the faces of each material are contiguous
+///  and the materials appear in the order given by pnMaterialRemapOut, which is the order their draw calls should be issued in.
+///
+/// \param pVB                A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
+///                            position must be a 3-component floating point value (X,Y,Z).
+/// \param pnIB               An index buffer.  Must be a triangle list.
+/// \param nVertices          Number of vertices.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+/// \param nFaces             Number of faces.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param nVBStride          The distance between successive vertices in the vertex buffer, in bytes.  This must be at least
+///                            3*sizeof(float).
+/// \param nCacheSize         The number of vertices that will fit in cache.  This value must be non-zero.
+/// \param pViewpoints        An array of viewpoints to use to measure overdraw, as for TootleOptimize.  May be NULL.
+/// \param nViewpoints        The number of viewpoints in the viewpoint array.
+/// \param eFrontWinding      The winding order of front-faces in the model.
+/// \param pnFaceMaterials    The material ID of each face.  Every ID must be less than nMaterials.  The faces do not need to
+///                            be sorted by material.
+/// \param nMaterials         The number of materials.  This must be non-zero.  Materials without faces are placed last.
+/// \param pnIBOut            A pointer that will be filled with an optimized index buffer.  May not be NULL.  May equal pnIB.
+/// \param pnMaterialRemapOut An array of size nMaterials that will receive the draw order of the materials.  Element 0 contains
+///                            the ID of the material whose faces come first in pnIBOut, element 1 the second, and so on.
+///                            May be NULL if the output is not requested.
+/// \param pnNumClustersOut   The total number of clusters generated in all materials.  May be NULL.
+/// \param eVCacheOptimizer   The algorithm used to optimize each cluster for the vertex cache, as for TootleOptimize.
+/// \param eOverdrawOptimizer The algorithm used to order the clusters and the materials, as for TootleOptimize.
+/// \param nThreads           The number of threads optimizing the materials.  0 uses one thread per core.
+///
+/// \return  Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeSubmeshes(const void*             pVB,
+                                                const unsigned int*     pnIB,
+                                                unsigned int            nVertices,
+                                                unsigned int            nFaces,
+                                                unsigned int            nVBStride,
+                                                unsigned int            nCacheSize,
+                                                const float*            pViewpoints,
+                                                unsigned int            nViewpoints,
+                                                TootleFaceWinding       eFrontWinding,
+                                                const unsigned int*     pnFaceMaterials,
+                                                unsigned int            nMaterials,
+                                                unsigned int*           pnIBOut,
+                                                unsigned int*           pnMaterialRemapOut,
+                                                unsigned int*           pnNumClustersOut,
+                                                TootleVCacheOptimizer   eVCacheOptimizer   = TOOTLE_VCACHE_AUTO,
+                                                TootleOverdrawOptimizer eOverdrawOptimizer = TOOTLE_OVERDRAW_FAST,
+                                                unsigned int            nThreads           = 0);
+
 //=================================================================================================================================
 /// This is a utility function to optimize vertex cache on a clustered index buffer.  This function simply calls
 ///  TootleOptimizeVCache repeatedly.  The faces within each cluster will be re-ordered, but the clustering will be maintained
@@ -313,6 +839,8 @@ TootleResult TOOTLE_DLL TootleFastOptimize(const void*         pVB,
 ///  (2) TOOTLE_VCACHE_DIRECT3D : use D3DXOptimizeFaces to optimize indices.
 ///  (3) TOOTLE_VCACHE_TSTRIPS  : use TSTRIPS (triangle strips) to optimize indices.
 ///  (4) TOOTLE_VCACHE_TIPSY    : use TIPSY (a new algorithm from SIGGRAPH 2007) to optimize indices.
+///  (5) TOOTLE_VCACHE_TIPSY_COMPRESS : use TIPSY, emitting the triangles around each vertex in adjacency order so that
+///                               TootleEncodeIndexBuffer compresses the result better.
 ///
 /// \param pnIB             The index buffer to optimize.  Must be a triangle list.
 /// \param nFaces           The number of faces in the index buffer.  This must be non-zero and less than TOOTLE_MAX_FACES.
@@ -325,10 +853,45 @@ TootleResult TOOTLE_DLL TootleFastOptimize(const void*         pVB,
 /// \param pnFaceRemapOut   A pointer to an array that will be filled with a face re-mapping.  May be NULL.  This is an array of
 ///                          nFaces elements.
 ///                          Element i in the array will contain the position of input face i in the output face ordering.
-/// \param eVCacheOptimizer The selection for choosing the algorithm to optimize vertex cache.  There are four choices:
-///                          TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_DIRECT3D, TOOTLE_VCACHE_LSTRIPS or TOOTLE_VCACHE_TIPSY.
+/// \param eVCacheOptimizer The selection for choosing the algorithm to optimize vertex cache.  There are five choices:
+///                          TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_DIRECT3D, TOOTLE_VCACHE_LSTRIPS, TOOTLE_VCACHE_TIPSY or
+///                          TOOTLE_VCACHE_TIPSY_COMPRESS.
+/// \param nMemoryBudgetMB  The largest amount of memory the function may allocate, in megabytes, or 0 for no limit.  Each
+///                          cluster is optimized as by TootleOptimizeVCache with this budget.
+/// \param pVB              A pointer to the vertex buffer, or NULL.  The pointer pVB must point to the vertex position.  The
+///                          vertex position must be a 3-component floating point value (X,Y,Z).  If it is not NULL and
+///                          fMaxACMRIncrease is positive, the faces of each cluster are then ordered front to back, to reduce
+///                          the overdraw of a cluster on itself.  The depth of a face is the distance of its centroid from the
+///                          centroid of the mesh, along the average normal of the cluster, as TOOTLE_OVERDRAW_FAST measures
+///                          the clusters.  The vertex cache order is kept in runs of consecutive faces, which are sorted by
+///                          depth.  The runs are as short as the ACMR budget allows.
+/// \param nVBStride        The distance between successive vertices in the vertex buffer, in bytes.  This must be at least
+///                          3*sizeof(float) if pVB is not NULL.
+/// \param eFrontWinding    The winding order of front-faces in the model.
+/// \param fMaxACMRIncrease The largest increase of the ACMR of a cluster that the front to back order may cost, measured with
+///                          a FIFO cache of nCacheSize vertices.  0.01 to 0.05 keeps most of the vertex cache efficiency.
+///                          0 (default) keeps the vertex cache order.
 /// \return                 Possible return codes:  TOOTLE_OK, TOOTLE_OUT_OF_MEMORY, TOOTLE_INVALID_ARGS
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleVCacheClustersEx(const unsigned int*   pnIB,
+                                               unsigned int          nFaces,
+                                               unsigned int          nVertices,
+                                               unsigned int          nCacheSize,
+                                               const unsigned int*   pnFaceClusters,
+                                               unsigned int*         pnIBOut,
+                                               unsigned int*         pnFaceRemapOut,
+                                               TootleVCacheOptimizer eVCacheOptimizer = TOOTLE_VCACHE_AUTO,
+                                               unsigned int          nMemoryBudgetMB  = 0,
+                                               const void*           pVB              = NULL,
+                                               unsigned int          nVBStride        = 0,
+                                               TootleFaceWinding     eFrontWinding    = TOOTLE_CW,
+                                               float                 fMaxACMRIncrease = 0.0f);
+
+//=================================================================================================================================
+/// Calls TootleVCacheClustersEx with nMemoryBudgetMB = 0, pVB = NULL, nVBStride = 0, eFrontWinding = TOOTLE_CW and
+///  fMaxACMRIncrease = 0.0f.  This is the signature exported by earlier versions of Tootle, and is kept so that applications
+///  built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleVCacheClusters(const unsigned int*   pnIB,
                                              unsigned int          nFaces,
                                              unsigned int          nVertices,
@@ -356,6 +919,60 @@ TootleResult TOOTLE_DLL TootleMeasureCacheEfficiency(const unsigned int* pnIB,
                                                      unsigned int        nCacheSize,
                                                      float*              pfEfficiencyOut);
 
+//=================================================================================================================================
+/// A utility function to measure the cache efficiency of triangle strips, such as those made by TootleOptimizeVCacheStrips.
+///  The vertex cache is simulated as in TootleMeasureCacheEfficiency.  Restart indices do not reach the cache, and degenerate
+///  triangles are not counted as faces, so the result can be compared to the ACMR of a triangle list.
+///
+/// \param pnStripIB       The strip index buffer whose efficiency should be measured.
+/// \param nIndices        The number of indices in pnStripIB, including the restart indices.  Must be non-zero.
+/// \param nCacheSize      The number of vertices that will fit in cache. If the application doesn't know or care, it should use
+///                         TOOTLE_DEFAULT_VCACHE_SIZE.
+/// \param nRestartIndex   The index that separates two strips.
+/// \param pfEfficiencyOut A pointer to receive the vertex cache efficiency.  This is defined as the number of cache misses per
+///                         triangle.
+/// \return  Possible return codes:  TOOTLE_OK, TOOTLE_INVALID_ARGS (also returned if the strips hold no triangle)
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleMeasureCacheEfficiencyStrips(const unsigned int* pnStripIB,
+                                                           unsigned int        nIndices,
+                                                           unsigned int        nCacheSize,
+                                                           unsigned int        nRestartIndex,
+                                                           float*              pfEfficiencyOut);
+
+//=================================================================================================================================
+/// A utility function to simulate vertex fetching and measure the memory traffic caused by an index buffer.
+///  Every index that misses the post-transform cache (simulated the same way as in TootleMeasureCacheEfficiency) fetches the
+///  cache lines covering its vertex through a set-associative, LRU replaced vertex fetch cache.  Lines that miss that cache
+///  are read from memory.  Use this to compare vertex orderings, for example before and after TootleOptimizeVertexMemory.
+///
+/// \param pnIB                   The index buffer whose fetch behavior should be measured.  Must be a triangle list.
+/// \param nVertices              The number of vertices in the vertex buffer.  This must be non-zero and less than
+///                                 TOOTLE_MAX_VERTICES.  All indices must be less than nVertices.
+/// \param nFaces                 The number of faces in the index buffer.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param nVBStride              The distance between successive vertices in the vertex buffer, in bytes.  Must be non-zero
+///                                 and at most TOOTLE_MAX_FETCH_VERTEX_STRIDE.
+/// \param nCacheSize             The number of vertices that will fit in the post-transform cache.  If the application doesn't
+///                                 know or care, it should use TOOTLE_DEFAULT_VCACHE_SIZE.  Pass 0 to fetch every index.
+/// \param pfBytesPerTriangleOut  A pointer to receive the number of bytes read from memory per triangle.  May be NULL.
+/// \param pfOverfetchOut         A pointer to receive the overfetch: the number of bytes read from memory divided by the size
+///                                 of the vertices referenced by the index buffer.  1 is optimal.  May be NULL.
+/// \param nFetchLineSize         The size of a cache line in bytes.  Must be non-zero.
+/// \param nFetchCacheSize        The size of the vertex fetch cache in bytes.  Must hold at least nFetchCacheWays lines.
+/// \param nFetchCacheWays        The associativity of the vertex fetch cache.  Must be non-zero.
+///
+/// \return  Possible return codes:  TOOTLE_OK, TOOTLE_OUT_OF_MEMORY, TOOTLE_INVALID_ARGS
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleMeasureVertexFetch(const unsigned int* pnIB,
+                                                 unsigned int        nVertices,
+                                                 unsigned int        nFaces,
+                                                 unsigned int        nVBStride,
+                                                 unsigned int        nCacheSize,
+                                                 float*              pfBytesPerTriangleOut,
+                                                 float*              pfOverfetchOut,
+                                                 unsigned int        nFetchLineSize  = TOOTLE_DEFAULT_FETCH_LINE_SIZE,
+                                                 unsigned int        nFetchCacheSize = TOOTLE_DEFAULT_FETCH_CACHE_SIZE,
+                                                 unsigned int        nFetchCacheWays = TOOTLE_DEFAULT_FETCH_CACHE_WAYS);
+
 //=================================================================================================================================
 /// A utility function to measure the amount of overdraw that occurs over a set of views.  Overdraw is defined as the number of
 /// pixels rendered divided by the number of pixels covered by an object, minus one.
@@ -380,9 +997,34 @@ TootleResult TOOTLE_DLL TootleMeasureCacheEfficiency(const unsigned int* pnIB,
 ///                            TOOTLE_OVERDRAW_RAYTRACE.  If you pass any other tokens, it will default to
 ///                            TOOTLE_OVERDRAW_DIRECT3D.  For software only build, it will automatically choose
 ///                            TOOTLE_OVERDRAW_RAYTRACE.
+/// \param nMemoryBudgetMB    The largest amount of memory the function may allocate, in megabytes, or 0 for no limit.  If the
+///                            ray tracer would not fit, the function fails before allocating.  See TootleEstimateMemory.
+/// \param eCostModel         The cost of the fragments to measure.  TOOTLE_OVERDRAW_COST_PLAIN (default) counts the fragments
+///                            that pass the per-pixel depth test.  TOOTLE_OVERDRAW_COST_HIZ counts the fragments that pass the
+///                            8x8 tile depth test.  TOOTLE_OVERDRAW_COST_PREPASS counts one shaded fragment per pixel plus a
+///                            quarter of the depth fragments that pass the tile test, so it is at least 0.  The other models
+///                            are always measured with TOOTLE_OVERDRAW_RAYTRACE.
 ///
 /// \return Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, TOOTLE_NOT_INITIALIZED, or TOOTLE_OK.
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleMeasureOverdrawEx(const void*             pVB,
+                                                const unsigned int*     pnIB,
+                                                unsigned int            nVertices,
+                                                unsigned int            nFaces,
+                                                unsigned int            nVBStride,
+                                                const float*            pfViewpoint,
+                                                unsigned int            nViewpoints,
+                                                TootleFaceWinding       eFrontWinding,
+                                                float*                  pfAvgODOut,
+                                                float*                  pfMaxODOut,
+                                                TootleOverdrawOptimizer eOverdrawOptimizer = TOOTLE_OVERDRAW_DIRECT3D,
+                                                unsigned int            nMemoryBudgetMB    = 0,
+                                                TootleOverdrawCostModel eCostModel         = TOOTLE_OVERDRAW_COST_PLAIN);
+
+//=================================================================================================================================
+/// Calls TootleMeasureOverdrawEx with nMemoryBudgetMB = 0 and eCostModel = TOOTLE_OVERDRAW_COST_PLAIN.  This is the signature
+///  exported by earlier versions of Tootle, and is kept so that applications built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleMeasureOverdraw(const void*             pVB,
                                               const unsigned int*     pnIB,
                                               unsigned int            nVertices,
@@ -402,6 +1044,13 @@ TootleResult TOOTLE_DLL TootleMeasureOverdraw(const void*             pVB,
 ///  Typically vertices are fetched in a cacheline (more than one vertex at a time).  Thus, the vertex in the next memory location
 ///  will come for free if they are processed next in line.  This is what we want to exploit.
 ///  It will compute a new Vertex Buffer and Index Buffer (since the vertices have been reordered).
+///  There are two choices for the new vertex order:
+///  (1) TOOTLE_VMEMORY_FIRST_USE   : number the vertices in the order they are first referenced by the index buffer.
+///  (2) TOOTLE_VMEMORY_FETCH_AWARE : group the vertices into cache lines of nFetchLineSize bytes.  Each line is filled with
+///                                    vertices that are fetched close together (within a window of post-transform cache
+///                                    misses) in the index buffer, and again later.  This lowers the number of cache lines
+///                                    fetched when vertices are wide or are fetched several times.  Use
+///                                    TootleMeasureVertexFetch to compare the results.
 ///
 /// \param pVB                  A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
 ///                              position must be a 3-component floating point value (X,Y,Z).
@@ -415,9 +1064,35 @@ TootleResult TOOTLE_DLL TootleMeasureOverdraw(const void*             pVB,
 /// \param pnVertexRemapOut     An array that will receive a vertex re-mapping.  May be NULL if the output is not requested.
 ///                              If not NULL, must be an array of size nVertices.  The i'th element of the output array contains
 ///                               the position of the input vertex i in the new vertex re-ordering.
+/// \param eVertexMemoryOptimizer The algorithm used to order the vertices: TOOTLE_VMEMORY_FIRST_USE or
+///                              TOOTLE_VMEMORY_FETCH_AWARE.
+/// \param nCacheSize           The number of vertices that will fit in the post-transform cache.  Only used by
+///                              TOOTLE_VMEMORY_FETCH_AWARE.
+/// \param nFetchLineSize       The size of a vertex fetch cache line in bytes.  Only used by TOOTLE_VMEMORY_FETCH_AWARE.
+/// \param pVBOutLayout         If not NULL, the vertices are quantized to this layout as they are written to pVBOut, which
+///                              must then hold nVertices * pVBOutLayout->nVBOutStride bytes.  TOOTLE_VMEMORY_FETCH_AWARE groups
+///                              the vertices by their output size.  May be NULL to copy the vertices unchanged.
 ///
 /// \return Possible return codes: TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK
 //=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeVertexMemoryEx(const void*                 pVB,
+                                                     const unsigned int*         pnIB,
+                                                     unsigned int                nVertices,
+                                                     unsigned int                nFaces,
+                                                     unsigned int                nVBStride,
+                                                     void*                       pVBOut,
+                                                     unsigned int*               pnIBOut,
+                                                     unsigned int*               pnVertexRemapOut,
+                                                     TootleVertexMemoryOptimizer eVertexMemoryOptimizer = TOOTLE_VMEMORY_FIRST_USE,
+                                                     unsigned int                nCacheSize = TOOTLE_DEFAULT_VCACHE_SIZE,
+                                                     unsigned int                nFetchLineSize = TOOTLE_DEFAULT_FETCH_LINE_SIZE,
+                                                     const TootleVertexLayout*   pVBOutLayout = NULL);
+
+//=================================================================================================================================
+/// Calls TootleOptimizeVertexMemoryEx with eVertexMemoryOptimizer = TOOTLE_VMEMORY_FIRST_USE, nCacheSize =
+///  TOOTLE_DEFAULT_VCACHE_SIZE, nFetchLineSize = TOOTLE_DEFAULT_FETCH_LINE_SIZE and pVBOutLayout = NULL.  This is the signature
+///  exported by earlier versions of Tootle, and is kept so that applications built against them do not need to be rebuilt.
+//=================================================================================================================================
 TootleResult TOOTLE_DLL TootleOptimizeVertexMemory(const void*         pVB,
                                                    const unsigned int* pnIB,
                                                    unsigned int        nVertices,
@@ -427,6 +1102,213 @@ TootleResult TOOTLE_DLL TootleOptimizeVertexMemory(const void*         pVB,
                                                    unsigned int*       pnIBOut,
                                                    unsigned int*       pnVertexRemapOut);
 
+//=================================================================================================================================
+/// This function rearranges several vertex streams (for example positions, normals and texture coordinates stored in separate
+///  vertex buffers) with a single vertex re-ordering, as TootleOptimizeVertexMemory does for one vertex buffer.  With
+///  TOOTLE_VMEMORY_FETCH_AWARE, the number of vertices grouped into a cache line is taken from the stream that fits the fewest
+///  of them in a line, ignoring streams whose vertices are too wide to share a line.  Streams with a pVBOutLayout are
+///  quantized while they are reordered (see TootleVertexLayout), and their output stride is used for the grouping.
+///
+/// \param pnIB                 The mesh index buffer.  This must be a triangle list.
+/// \param nVertices            The number of vertices in each stream.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+/// \param nFaces               The number of faces in the mesh.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param pStreams             The vertex streams.  Streams with a NULL pVBOut only take part in choosing the order.
+/// \param nStreams             The number of vertex streams.  May be 0 if only the re-mapping is requested.
+/// \param pnIBOut              The output index buffer.  May be NULL.  May equal pnIB.
+/// \param pnVertexRemapOut     An array that will receive a vertex re-mapping.  May be NULL if the output is not requested.
+///                              If not NULL, must be an array of size nVertices.  The i'th element of the output array contains
+///                               the position of the input vertex i in the new vertex re-ordering.
+/// \param eVertexMemoryOptimizer The algorithm used to order the vertices: TOOTLE_VMEMORY_FIRST_USE or
+///                              TOOTLE_VMEMORY_FETCH_AWARE.
+/// \param nCacheSize           The number of vertices that will fit in the post-transform cache.
+/// \param nFetchLineSize       The size of a vertex fetch cache line in bytes.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeVertexStreams(const unsigned int*         pnIB,
+                                                    unsigned int                nVertices,
+                                                    unsigned int                nFaces,
+                                                    const TootleVertexStream*   pStreams,
+                                                    unsigned int                nStreams,
+                                                    unsigned int*               pnIBOut,
+                                                    unsigned int*               pnVertexRemapOut,
+                                                    TootleVertexMemoryOptimizer eVertexMemoryOptimizer = TOOTLE_VMEMORY_FETCH_AWARE,
+                                                    unsigned int                nCacheSize = TOOTLE_DEFAULT_VCACHE_SIZE,
+                                                    unsigned int                nFetchLineSize = TOOTLE_DEFAULT_FETCH_LINE_SIZE);
+
+//=================================================================================================================================
+/// This function optimizes the levels of detail of a mesh that share one vertex buffer.  Each level's index buffer is
+///  optimized for the vertex cache and overdraw as TootleOptimize does, then the vertices are re-ordered as
+///  TootleOptimizeVertexMemory does, except that the vertices of the coarsest level come first, followed by the vertices that
+///  the next finer level adds, and so on.  Each level therefore references a dense prefix of the vertex buffer whose size is
+///  returned in its nVerticesOut, so the coarse levels touch a compact region of memory and the vertices only needed by the
+///  finer levels can be streamed in or evicted separately.  Vertices referenced by no level are placed at the end.
+///
+/// \param pVB                  A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
+///                              position must be a 3-component floating point value (X,Y,Z).
+/// \param nVertices            The number of vertices.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+/// \param nVBStride            The distance between successive vertices in the vertex buffer, in bytes.  This must be at least
+///                              3*sizeof(float).
+/// \param pLevels              The levels of detail, from the finest (pLevels[0]) to the coarsest.  All indices must be less
+///                              than nVertices.
+/// \param nLevels              The number of levels.  This must be non-zero.
+/// \param nCacheSize           The number of vertices that will fit in the post-transform cache.
+/// \param pViewpoints          The viewpoints used to measure overdraw, as for TootleOptimize.  May be NULL.
+/// \param nViewpoints          The number of viewpoints in the viewpoint array.
+/// \param eFrontWinding        The winding order of front-faces in the model.
+/// \param pVBOut               The output vertex buffer.  May not be NULL.  May equal pVB.
+/// \param pnVertexRemapOut     An array that will receive a vertex re-mapping.  May be NULL if the output is not requested.
+///                              If not NULL, must be an array of size nVertices.  The i'th element of the output array contains
+///                               the position of the input vertex i in the new vertex re-ordering.
+/// \param eVCacheOptimizer     The algorithm used to optimize each level for the vertex cache, as for TootleOptimize.
+/// \param eOverdrawOptimizer   The algorithm used to optimize each level for overdraw, as for TootleOptimize.
+/// \param eVertexMemoryOptimizer The algorithm used to order the vertices within each level's range: TOOTLE_VMEMORY_FIRST_USE
+///                              or TOOTLE_VMEMORY_FETCH_AWARE.
+/// \param nFetchLineSize       The size of a vertex fetch cache line in bytes.  Only used by TOOTLE_VMEMORY_FETCH_AWARE.
+/// \param pVBOutLayout         If not NULL, the vertices are quantized to this layout as they are written to pVBOut, as for
+///                              TootleOptimizeVertexMemory.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleOptimizeLODChain(const void*                 pVB,
+                                               unsigned int                nVertices,
+                                               unsigned int                nVBStride,
+                                               TootleLODLevel*             pLevels,
+                                               unsigned int                nLevels,
+                                               unsigned int                nCacheSize,
+                                               const float*                pViewpoints,
+                                               unsigned int                nViewpoints,
+                                               TootleFaceWinding           eFrontWinding,
+                                               void*                       pVBOut,
+                                               unsigned int*               pnVertexRemapOut,
+                                               TootleVCacheOptimizer       eVCacheOptimizer = TOOTLE_VCACHE_AUTO,
+                                               TootleOverdrawOptimizer     eOverdrawOptimizer = TOOTLE_OVERDRAW_FAST,
+                                               TootleVertexMemoryOptimizer eVertexMemoryOptimizer = TOOTLE_VMEMORY_FIRST_USE,
+                                               unsigned int                nFetchLineSize = TOOTLE_DEFAULT_FETCH_LINE_SIZE,
+                                               const TootleVertexLayout*   pVBOutLayout = NULL);
+
+//=================================================================================================================================
+/// This function returns the size of the largest buffer TootleEncodeIndexBuffer can produce for nFaces faces.  Use it to
+///  allocate the output buffer of TootleEncodeIndexBuffer.
+///
+/// \param nFaces               The number of faces in the index buffer.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param pnBufferSizeOut      A pointer to receive the buffer size, in bytes.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleEncodeIndexBufferBound(unsigned int  nFaces,
+                                                     unsigned int* pnBufferSizeOut);
+
+//=================================================================================================================================
+/// This function compresses an index buffer for storage or transmission.  The encoding predicts each triangle from an edge of
+///  the last few triangles and each new vertex from the vertices referenced so far, so it works best on index buffers that were
+///  optimized for the vertex cache (TOOTLE_VCACHE_TIPSY_COMPRESS gives the smallest output) and then passed through
+///  TootleOptimizeVertexMemory.  A typical optimized mesh needs 1 to 2 bytes per triangle instead of 12.
+///  Use TootleDecodeIndexBuffer to restore the index buffer.  The decoded triangles are in the same order, but the vertices of a
+///  triangle may be rotated.  The winding order of the triangles is preserved.
+///
+/// \param pnIB                 The index buffer to compress.  Must be a triangle list.
+/// \param nVertices            The number of vertices.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+///                              All indices must be less than nVertices.
+/// \param nFaces               The number of faces in the index buffer.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param pBufferOut           The buffer receiving the compressed index buffer.
+/// \param nBufferSize          The size of pBufferOut in bytes.  A buffer of the size returned by TootleEncodeIndexBufferBound
+///                              is always large enough.
+/// \param pnEncodedSizeOut     A pointer to receive the size of the compressed index buffer in bytes.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS (also returned if pBufferOut is too small) or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleEncodeIndexBuffer(const unsigned int* pnIB,
+                                                unsigned int        nVertices,
+                                                unsigned int        nFaces,
+                                                unsigned char*      pBufferOut,
+                                                unsigned int        nBufferSize,
+                                                unsigned int*       pnEncodedSizeOut);
+
+//=================================================================================================================================
+/// This function restores an index buffer compressed by TootleEncodeIndexBuffer.
+///
+/// \param pBuffer              The compressed index buffer.
+/// \param nBufferSize          The size of the compressed index buffer in bytes, as returned by TootleEncodeIndexBuffer.
+/// \param nVertices            The number of vertices passed to TootleEncodeIndexBuffer.  Used to reject corrupt data.
+/// \param nFaces               The number of faces passed to TootleEncodeIndexBuffer.
+/// \param pnIBOut              The output index buffer.  Must have room for 3*nFaces indices.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS (also returned if the data is corrupt) or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleDecodeIndexBuffer(const unsigned char* pBuffer,
+                                                unsigned int         nBufferSize,
+                                                unsigned int         nVertices,
+                                                unsigned int         nFaces,
+                                                unsigned int*        pnIBOut);
+
+//=================================================================================================================================
+/// This function welds the vertices of a mesh that share a position, so that the optimizations that follow the connectivity of
+///  the mesh see through attribute seams.  Vertices are usually split wherever a texture coordinate or a normal is discontinuous,
+///  and the clustering and the vertex cache optimizations see a boundary at every split.  Each vertex of the index buffer is
+///  replaced by the lowest numbered vertex at the same position, or connected to it by a chain of vertices at most fEpsilon
+///  apart.  Faces that become degenerate and repeats of an earlier face (in any rotation, with the same winding) are dropped.
+///  The welded vertices have the positions of the original ones, so the welded index buffer can be optimized by the other
+///  Tootle functions with the original vertex buffer.  TootleUnweldIndexBuffer then maps the result back to the original
+///  vertices.  The search for close vertices runs on nThreads threads, and its result does not depend on the thread count.
+///
+/// \param pVB              A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
+///                          position must be a 3-component floating point value (X,Y,Z).
+/// \param pnIB             The index buffer.  Must be a triangle list.
+/// \param nVertices        The number of vertices.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+/// \param nFaces           The number of faces.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param nVBStride        The distance between successive vertices in the vertex buffer, in bytes.  This must be at least
+///                          3*sizeof(float).
+/// \param pnIBOut          The welded index buffer, holding the faces that were kept in their input order.  Must have room
+///                          for 3*nFaces indices.  May equal pnIB.
+/// \param pnFacesOut       A pointer to receive the number of faces in pnIBOut.
+/// \param pnVertexWeldOut  An array of size nVertices that will receive the vertex each vertex was welded to.  May be NULL
+///                          if the output is not requested.  It is needed by TootleUnweldIndexBuffer.
+/// \param pnFaceRemapOut   An array of size nFaces that will receive a face re-mapping.  May be NULL if the output is not
+///                          requested.  Element i contains the position of input face i in pnIBOut, or TOOTLE_MAX_FACES if
+///                          the face was dropped.
+/// \param fEpsilon         The largest distance between two positions that are welded.  0 welds equal positions only.
+/// \param nThreads         The number of threads.  0 uses one thread per core.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleWeldMesh(const void*         pVB,
+                                       const unsigned int* pnIB,
+                                       unsigned int        nVertices,
+                                       unsigned int        nFaces,
+                                       unsigned int        nVBStride,
+                                       unsigned int*       pnIBOut,
+                                       unsigned int*       pnFacesOut,
+                                       unsigned int*       pnVertexWeldOut,
+                                       unsigned int*       pnFaceRemapOut,
+                                       float               fEpsilon = 0.0f,
+                                       unsigned int        nThreads = 0);
+
+//=================================================================================================================================
+/// This function maps an index buffer produced from the output of TootleWeldMesh back to the original vertices.  The faces of
+///  pnWeldedIB may have been re-ordered and rotated by the other Tootle functions.  Each one is replaced by the original face
+///  it was welded from, rotated the same way, so the winding and the order of the faces are kept.  Faces dropped by
+///  TootleWeldMesh stay dropped.
+///
+/// \param pnIB             The index buffer that was passed to TootleWeldMesh.
+/// \param nVertices        The number of vertices.  This must be non-zero and less than TOOTLE_MAX_VERTICES.
+/// \param nFaces           The number of faces in pnIB.  This must be non-zero and less than TOOTLE_MAX_FACES.
+/// \param pnVertexWeld     The vertex welding returned by TootleWeldMesh in pnVertexWeldOut.
+/// \param pnWeldedIB       The welded index buffer, after optimization.
+/// \param nWeldedFaces     The number of faces in pnWeldedIB.
+/// \param pnIBOut          The output index buffer, with room for 3*nWeldedFaces indices.  May equal pnWeldedIB.
+///
+/// \return Possible return codes: TOOTLE_INVALID_ARGS (also returned if a face of pnWeldedIB is not a welded face of pnIB),
+///          TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK
+//=================================================================================================================================
+TootleResult TOOTLE_DLL TootleUnweldIndexBuffer(const unsigned int* pnIB,
+                                                unsigned int        nVertices,
+                                                unsigned int        nFaces,
+                                                const unsigned int* pnVertexWeld,
+                                                const unsigned int* pnWeldedIB,
+                                                unsigned int        nWeldedFaces,
+                                                unsigned int*       pnIBOut);
+
 // @}
 
 #endif
@@ -0,0 +1,420 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+/**
+An index buffer codec that exploits the order produced by the vertex cache optimizers.
+
+After vertex cache optimization, most triangles share an edge with one of the last few triangles, and after
+TootleOptimizeVertexMemory, the vertices that are not in the cache are usually referenced in increasing order.
+The encoder keeps the same two FIFOs as the decoder:
+
+    - an edge FIFO holding the last 16 edges that a following triangle may share, stored in the order in which
+      the neighbouring triangle traverses them, and
+    - a vertex FIFO holding the last 16 vertices that were not already in the vertex FIFO.
+
+Every triangle is described by one code byte:
+
+    0xXY, X < 15 : the triangle starts with edge X of the edge FIFO (0 is the most recent edge).  Y describes the
+                   third vertex.
+    0xFY         : the triangle shares no edge with the FIFO.  Y describes the first vertex, and a byte in the
+                   data stream describes the second (high nibble) and the third (low nibble) vertex.
+
+A vertex description is:
+
+    0      : the next new vertex, one more than the largest vertex referenced so far as a new vertex
+    1..14  : entry Y-1 of the vertex FIFO (0 is the most recent vertex)
+    15     : an explicit vertex, stored in the data stream as a LEB128 varint holding the zig-zag encoded difference
+             to the previous explicit vertex
+
+The encoded buffer is the version byte, the code bytes of all triangles and then the data stream.  Keeping the code
+bytes together lets the decoder run through them without branching on the variable length data in most cases.
+Triangles may be rotated by the encoder to put the shared edge first; the winding order is never changed.
+*/
+
+#include "TootlePCH.h"
+#include "indexcodec.h"
+
+/// The number of entries in each FIFO.  Must be a power of two.
+#define INDEXCODEC_FIFO_SIZE  16
+
+/// The code for a triangle that does not share an edge with the edge FIFO
+#define INDEXCODEC_CODE_NO_EDGE  15
+
+/// The vertex description of an explicitly stored vertex
+#define INDEXCODEC_VERTEX_EXPLICIT  15
+
+//=================================================================================================================================
+//
+//          Internal functions
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Finds a vertex in the vertex FIFO.
+/// \return The FIFO position of the vertex (0 is the most recent entry), or -1 if it is not in the usable part of the FIFO.
+//=================================================================================================================================
+static inline int FindVertex(const unsigned int* pnVertexFifo, unsigned int nVertexFifoOffset, unsigned int nVertex)
+{
+    for (int i = 0; i < INDEXCODEC_VERTEX_EXPLICIT - 1; i++)
+    {
+        if (pnVertexFifo[(nVertexFifoOffset - 1 - i) & (INDEXCODEC_FIFO_SIZE - 1)] == nVertex)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+//=================================================================================================================================
+/// Writes a zig-zag encoded difference as a LEB128 varint
+//=================================================================================================================================
+static inline unsigned char* WriteVarint(unsigned char* pData, unsigned int nDelta)
+{
+    unsigned int nValue = (nDelta << 1) ^ (unsigned int)((int) nDelta >> 31);
+
+    while (nValue >= 0x80)
+    {
+        *pData++ = (unsigned char)(nValue | 0x80);
+        nValue >>= 7;
+    }
+
+    *pData++ = (unsigned char) nValue;
+
+    return pData;
+}
+
+//=================================================================================================================================
+/// Reads a varint written by WriteVarint.
+/// \return The position after the varint, or NULL if the varint is malformed or runs past pEnd.
+//=================================================================================================================================
+static inline const unsigned char* ReadVarint(const unsigned char* pData, const unsigned char* pEnd, unsigned int& rnDelta)
+{
+    unsigned int nValue = 0;
+
+    for (unsigned int nShift = 0; nShift < 35; nShift += 7)
+    {
+        if (pData == pEnd)
+        {
+            return NULL;
+        }
+
+        unsigned int nByte = *pData++;
+        nValue |= (nByte & 0x7f) << nShift;
+
+        if (nByte < 0x80)
+        {
+            rnDelta = (nValue >> 1) ^ (0u - (nValue & 1));
+            return pData;
+        }
+    }
+
+    return NULL;
+}
+
+//=================================================================================================================================
+/// Encodes one vertex of a triangle, updating the coder state the same way DecodeVertex does.
+/// \return The vertex description
+//=================================================================================================================================
+static inline unsigned int EncodeVertex(unsigned int   nVertex,
+                                        unsigned int*  pnVertexFifo,
+                                        unsigned int&  rnVertexFifoOffset,
+                                        unsigned int&  rnNext,
+                                        unsigned int&  rnLast,
+                                        unsigned char*& rpData)
+{
+    if (nVertex == rnNext)
+    {
+        rnNext++;
+        pnVertexFifo[rnVertexFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)] = nVertex;
+        return 0;
+    }
+
+    int nFifo = FindVertex(pnVertexFifo, rnVertexFifoOffset, nVertex);
+
+    if (nFifo >= 0)
+    {
+        return 1 + nFifo;
+    }
+
+    rpData = WriteVarint(rpData, nVertex - rnLast);
+    rnLast = nVertex;
+    pnVertexFifo[rnVertexFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)] = nVertex;
+
+    return INDEXCODEC_VERTEX_EXPLICIT;
+}
+
+//=================================================================================================================================
+/// Decodes one vertex description written by EncodeVertex.
+/// \return false if the data is malformed or the vertex is not below nVertices
+//=================================================================================================================================
+static inline bool DecodeVertex(unsigned int          nCode,
+                                unsigned int*         pnVertexFifo,
+                                unsigned int&         rnVertexFifoOffset,
+                                unsigned int&         rnNext,
+                                unsigned int&         rnLast,
+                                const unsigned char*& rpData,
+                                const unsigned char*  pEnd,
+                                unsigned int          nVertices,
+                                unsigned int&         rnVertex)
+{
+    if (nCode == 0)
+    {
+        if (rnNext >= nVertices)
+        {
+            return false;
+        }
+
+        rnVertex = rnNext++;
+        pnVertexFifo[rnVertexFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)] = rnVertex;
+        return true;
+    }
+
+    if (nCode < INDEXCODEC_VERTEX_EXPLICIT)
+    {
+        rnVertex = pnVertexFifo[(rnVertexFifoOffset - nCode) & (INDEXCODEC_FIFO_SIZE - 1)];
+        return true;
+    }
+
+    unsigned int nDelta;
+    rpData = ReadVarint(rpData, pEnd, nDelta);
+
+    if (rpData == NULL)
+    {
+        return false;
+    }
+
+    rnVertex = rnLast + nDelta;
+
+    if (rnVertex >= nVertices)
+    {
+        return false;
+    }
+
+    rnLast = rnVertex;
+    pnVertexFifo[rnVertexFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)] = rnVertex;
+
+    return true;
+}
+
+//=================================================================================================================================
+//
+//          Codec functions
+//
+//=================================================================================================================================
+
+size_t IndexCodecBound(size_t nFaces)
+{
+    return 1 + nFaces * INDEXCODEC_MAX_TRIANGLE_SIZE;
+}
+
+size_t IndexCodecEncode(const unsigned int* pnIB, unsigned int nFaces, unsigned char* pBuffer, size_t nBufferSize)
+{
+    if (nBufferSize < 1 + (size_t) nFaces)
+    {
+        return 0;
+    }
+
+    unsigned int pnEdgeFifo[INDEXCODEC_FIFO_SIZE][2];
+    unsigned int pnVertexFifo[INDEXCODEC_FIFO_SIZE];
+    unsigned int nEdgeFifoOffset = 0;
+    unsigned int nVertexFifoOffset = 0;
+    unsigned int nNext = 0;
+    unsigned int nLast = 0;
+
+    // the decoder starts with the same zero filled FIFOs, so that every FIFO entry is a valid vertex
+    memset(pnEdgeFifo, 0, sizeof(pnEdgeFifo));
+    memset(pnVertexFifo, 0, sizeof(pnVertexFifo));
+
+    pBuffer[0] = INDEXCODEC_VERSION;
+
+    unsigned char* pCodes = pBuffer + 1;
+    unsigned char* pData = pCodes + nFaces;
+    unsigned char* pEnd = pBuffer + nBufferSize;
+
+    for (unsigned int i = 0; i < nFaces; i++)
+    {
+        if ((size_t)(pEnd - pData) < INDEXCODEC_MAX_TRIANGLE_SIZE - 1)
+        {
+            return 0;
+        }
+
+        const unsigned int* pnFace = &pnIB[3 * i];
+
+        // look for the most recent edge shared with this triangle, in any of its three rotations
+        int nEdge = -1;
+        unsigned int nRotation = 0;
+
+        for (int e = 0; e < INDEXCODEC_CODE_NO_EDGE && nEdge < 0; e++)
+        {
+            const unsigned int* pnEdge = pnEdgeFifo[(nEdgeFifoOffset - 1 - e) & (INDEXCODEC_FIFO_SIZE - 1)];
+
+            for (unsigned int r = 0; r < 3; r++)
+            {
+                if (pnFace[r] == pnEdge[0] && pnFace[(r + 1) % 3] == pnEdge[1])
+                {
+                    nEdge = e;
+                    nRotation = r;
+                    break;
+                }
+            }
+        }
+
+        if (nEdge >= 0)
+        {
+            unsigned int a = pnFace[nRotation];
+            unsigned int b = pnFace[(nRotation + 1) % 3];
+            unsigned int c = pnFace[(nRotation + 2) % 3];
+
+            unsigned int nCodeC = EncodeVertex(c, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData);
+            pCodes[i] = (unsigned char)((nEdge << 4) | nCodeC);
+
+            unsigned int* pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = c;
+            pnEdgeOut[1] = b;
+
+            pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = a;
+            pnEdgeOut[1] = c;
+        }
+        else
+        {
+            unsigned int a = pnFace[0];
+            unsigned int b = pnFace[1];
+            unsigned int c = pnFace[2];
+
+            // the data byte has to precede the varints of b and c, so a is encoded before the byte is reserved
+            unsigned int nCodeA = EncodeVertex(a, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData);
+            unsigned char* pDataByte = pData++;
+            unsigned int nCodeB = EncodeVertex(b, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData);
+            unsigned int nCodeC = EncodeVertex(c, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData);
+
+            pCodes[i] = (unsigned char)((INDEXCODEC_CODE_NO_EDGE << 4) | nCodeA);
+            *pDataByte = (unsigned char)((nCodeB << 4) | nCodeC);
+
+            unsigned int* pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = b;
+            pnEdgeOut[1] = a;
+
+            pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = c;
+            pnEdgeOut[1] = b;
+
+            pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = a;
+            pnEdgeOut[1] = c;
+        }
+    }
+
+    return pData - pBuffer;
+}
+
+bool IndexCodecDecode(const unsigned char* pBuffer, size_t nBufferSize, unsigned int nVertices, unsigned int nFaces,
+                      unsigned int* pnIBOut)
+{
+    if (nBufferSize < 1 + (size_t) nFaces || pBuffer[0] != INDEXCODEC_VERSION)
+    {
+        return false;
+    }
+
+    unsigned int pnEdgeFifo[INDEXCODEC_FIFO_SIZE][2];
+    unsigned int pnVertexFifo[INDEXCODEC_FIFO_SIZE];
+    unsigned int nEdgeFifoOffset = 0;
+    unsigned int nVertexFifoOffset = 0;
+    unsigned int nNext = 0;
+    unsigned int nLast = 0;
+
+    memset(pnEdgeFifo, 0, sizeof(pnEdgeFifo));
+    memset(pnVertexFifo, 0, sizeof(pnVertexFifo));
+
+    const unsigned char* pCodes = pBuffer + 1;
+    const unsigned char* pData = pCodes + nFaces;
+    const unsigned char* pEnd = pBuffer + nBufferSize;
+
+    for (unsigned int i = 0; i < nFaces; i++, pnIBOut += 3)
+    {
+        unsigned int nCode = pCodes[i];
+        unsigned int nEdge = nCode >> 4;
+
+        if (nEdge < INDEXCODEC_CODE_NO_EDGE)
+        {
+            const unsigned int* pnEdge = pnEdgeFifo[(nEdgeFifoOffset - 1 - nEdge) & (INDEXCODEC_FIFO_SIZE - 1)];
+            unsigned int a = pnEdge[0];
+            unsigned int b = pnEdge[1];
+            unsigned int c;
+            unsigned int nCodeC = nCode & 15;
+
+            // The common cases of a new or a cached third vertex are handled without branching on which one it is.
+            //  The FIFO entry at nVertexFifoOffset is never referenced by a code, so it can be written unconditionally.
+            if (nCodeC < INDEXCODEC_VERTEX_EXPLICIT)
+            {
+                unsigned int nNew = (nCodeC == 0);
+                c = nNew ? nNext : pnVertexFifo[(nVertexFifoOffset - nCodeC) & (INDEXCODEC_FIFO_SIZE - 1)];
+                pnVertexFifo[nVertexFifoOffset & (INDEXCODEC_FIFO_SIZE - 1)] = c;
+                nVertexFifoOffset += nNew;
+                nNext += nNew;
+
+                if (nNext > nVertices)
+                {
+                    return false;
+                }
+            }
+            else if (!DecodeVertex(nCodeC, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData, pEnd, nVertices, c))
+            {
+                return false;
+            }
+
+            pnIBOut[0] = a;
+            pnIBOut[1] = b;
+            pnIBOut[2] = c;
+
+            unsigned int* pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = c;
+            pnEdgeOut[1] = b;
+
+            pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = a;
+            pnEdgeOut[1] = c;
+        }
+        else
+        {
+            unsigned int a, b, c;
+
+            if (!DecodeVertex(nCode & 15, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData, pEnd, nVertices, a) ||
+                pData == pEnd)
+            {
+                return false;
+            }
+
+            unsigned int nCodesBC = *pData++;
+
+            if (!DecodeVertex(nCodesBC >> 4, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData, pEnd, nVertices, b) ||
+                !DecodeVertex(nCodesBC & 15, pnVertexFifo, nVertexFifoOffset, nNext, nLast, pData, pEnd, nVertices, c))
+            {
+                return false;
+            }
+
+            pnIBOut[0] = a;
+            pnIBOut[1] = b;
+            pnIBOut[2] = c;
+
+            unsigned int* pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = b;
+            pnEdgeOut[1] = a;
+
+            pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = c;
+            pnEdgeOut[1] = b;
+
+            pnEdgeOut = pnEdgeFifo[nEdgeFifoOffset++ & (INDEXCODEC_FIFO_SIZE - 1)];
+            pnEdgeOut[0] = a;
+            pnEdgeOut[1] = c;
+        }
+    }
+
+    // trailing bytes mean the buffer was not produced for nFaces triangles
+    return pData == pEnd;
+}
@@ -0,0 +1,28 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _TOOTLE_INDEXCODEC_H_
+#define _TOOTLE_INDEXCODEC_H_
+
+#include <cstddef>
+
+/// The version byte written at the start of every encoded index buffer
+#define INDEXCODEC_VERSION  1
+
+/// The largest number of bytes IndexCodecEncode writes for one triangle (one code byte, one data byte, three varints)
+#define INDEXCODEC_MAX_TRIANGLE_SIZE  17
+
+/// Returns the size of the largest possible encoding of nFaces triangles
+size_t IndexCodecBound(size_t nFaces);
+
+/// Encodes a triangle list into pBuffer.  Returns the encoded size, or 0 if the encoding does not fit in nBufferSize bytes.
+size_t IndexCodecEncode(const unsigned int* pnIB, unsigned int nFaces, unsigned char* pBuffer, size_t nBufferSize);
+
+/// Decodes nFaces triangles from pBuffer into pnIBOut.  Returns false if the data is malformed or references vertices
+/// beyond nVertices.  The triangles are returned in their encoded order, possibly rotated (the winding is preserved).
+bool IndexCodecDecode(const unsigned char* pBuffer, size_t nBufferSize, unsigned int nVertices, unsigned int nFaces,
+                      unsigned int* pnIBOut);
+
+#endif
@@ -6,6 +6,7 @@
 #include "TootlePCH.h"
 #include "overdraw.h"
 #include "soup.h"
+#include "geometry.h"
 
 #ifndef _SOFTWARE_ONLY_VERSION
     #include "d3doverdrawwindow.h"
@@ -32,9 +33,6 @@ static Soup* s_pSoup = NULL;
     D3DOverdrawWindow* s_pOverdrawWindow;
 #endif
 
-/// If number of clusters is higher than this, use the raytracing algorithm
-const UINT RAYTRACE_CLUSTER_THRESHOLD = 225;
-
 
 
 //=================================================================================================================================
@@ -45,6 +43,7 @@ const UINT RAYTRACE_CLUSTER_THRESHOLD = 225;
 // compute face normals for the mesh.
 static std::vector<float> ComputeFaceNormals(const float*        pfVB,
                                              const unsigned int* pnIB,
+                                             unsigned int        nVertices,
                                              unsigned int        nFaces);
 
 //=================================================================================================================================
@@ -55,6 +54,7 @@ static std::vector<float> ComputeFaceNormals(const float*        pfVB,
 /// \param bCullCCW            Specify true to cull CCW faces, otherwise cull CW faces.
 /// \param rClusters           Array identifying the cluster for each face.  Faces are assumed sorted by cluster
 /// \param nClusters           The number of clusters in rClusters.
+/// \param eCostModel          The model of the cost of the fragments counted in the graph
 /// \param rGraphOut           An array of edges that will contain the overdraw graph
 /// \return TOOTLE_OK, or TOOTLE_OUT_OF_MEMORY
 //=================================================================================================================================
@@ -63,6 +63,7 @@ TootleResult ODComputeGraphRaytrace(const float*            pViewpoints,
                                     bool                    bCullCCW,
                                     const std::vector<int>& rClusters,
                                     UINT                    nClusters,
+                                    TootleOverdrawCostModel eCostModel,
                                     std::vector<t_edge>&    rGraphOut)
 {
     std::vector<Vector3> tn;
@@ -100,7 +101,7 @@ TootleResult ODComputeGraphRaytrace(const float*            pViewpoints,
     }
 
     // generate the per-cluster overdraw table
-    if (!tr.CalculateOverdraw(pViewpoints, nViewpoints, TOOTLE_RAYTRACE_IMAGE_SIZE, bCullCCW, &fullgraph))
+    if (!tr.CalculateOverdraw(pViewpoints, nViewpoints, TOOTLE_RAYTRACE_IMAGE_SIZE, bCullCCW, eCostModel, &fullgraph))
     {
         return TOOTLE_OUT_OF_MEMORY;
     }
@@ -316,24 +317,26 @@ TootleResult ODObjectOverdraw(const float* pViewpoints, unsigned int nViewpoints
 /// \param pViewpoints    The viewpoints to use to measure overdraw
 /// \param nViewpoints    The number of viewpoints in the array
 /// \param bCullCCW       Set to true to cull CCW faces, otherwise cull CW faces.
+/// \param eCostModel     The model of the cost of the fragments to measure
 /// \param fODAvg         (Output) Average overdraw
 /// \param fODMax         (Output) Maximum overdraw
 /// \return TOOTLE_OK, TOOTLE_OUT_OF_MEMORY
 //=================================================================================================================================
-TootleResult ODObjectOverdrawRaytrace(const float*        pfVB,
-                                      const unsigned int* pnIB,
-                                      unsigned int        nVertices,
-                                      unsigned int        nFaces,
-                                      const float*        pViewpoints,
-                                      unsigned int        nViewpoints,
-                                      bool                bCullCCW,
-                                      float&              fAvgOD,
-                                      float&              fMaxOD)
+TootleResult ODObjectOverdrawRaytrace(const float*            pfVB,
+                                      const unsigned int*     pnIB,
+                                      unsigned int            nVertices,
+                                      unsigned int            nFaces,
+                                      const float*            pViewpoints,
+                                      unsigned int            nViewpoints,
+                                      bool                    bCullCCW,
+                                      TootleOverdrawCostModel eCostModel,
+                                      float&                  fAvgOD,
+                                      float&                  fMaxOD)
 {
     assert(pfVB);
     assert(pnIB);
 
-    const std::vector<float> faceNormals = ComputeFaceNormals(pfVB, pnIB, nFaces);
+    const std::vector<float> faceNormals = ComputeFaceNormals(pfVB, pnIB, nVertices, nFaces);
 
     TootleRaytracer tr;
 
@@ -344,7 +347,7 @@ TootleResult ODObjectOverdrawRaytrace(const float*        pfVB,
 
 
     // generate the per-cluster overdraw table
-    if (!tr.MeasureOverdraw(pViewpoints, nViewpoints, TOOTLE_RAYTRACE_IMAGE_SIZE, bCullCCW, fAvgOD, fMaxOD))
+    if (!tr.MeasureOverdraw(pViewpoints, nViewpoints, TOOTLE_RAYTRACE_IMAGE_SIZE, bCullCCW, eCostModel, fAvgOD, fMaxOD))
     {
         return TOOTLE_OUT_OF_MEMORY;
     }
@@ -361,42 +364,23 @@ TootleResult ODObjectOverdrawRaytrace(const float*        pfVB,
 /// \param pfVB            A pointer to the vertex buffer.  The pointer pVB must point to the vertex position.  The vertex
 ///                         position must be a 3-component floating point value (X,Y,Z).
 /// \param pnIB            The index buffer.  Must be a triangle list.
+/// \param nVertices       The number of vertices.
 /// \param nFaces          The number of indices.  This must be non-zero and less than TOOTLE_MAX_FACES.
-/// \param pFaceNormals    The output face normals.  May not be NULL.  Need to be pre-allocated of size 3*nFaces.
-/// \param bFrontCWWinding Specify true if the mesh has CW front face winding, false otherwise.
 ///
-/// \return void
+/// \return The face normals, 3 floats per face.
 //=================================================================================================================================
 std::vector<float> ComputeFaceNormals(const float*        pfVB,
                                       const unsigned int* pnIB,
+                                      unsigned int        nVertices,
                                       unsigned int        nFaces)
 {
     assert(pnIB);
 
-    // triangle index
-    unsigned int nFirst;
-    unsigned int nSecond;
-    unsigned int nThird;
-
     std::vector<float> result (nFaces * 3);
 
-    for (unsigned int i = 0; i < nFaces; i++)
-    {
-        nFirst  = pnIB[ 3 * i     ];
-        nSecond = pnIB[ 3 * i + 1 ];
-        nThird  = pnIB[ 3 * i + 2 ];
-
-        const Vector3 p0(pfVB[ 3 * nFirst  ], pfVB[ 3 * nFirst  + 1 ], pfVB[ 3 * nFirst  + 2 ]);
-        const Vector3 p1(pfVB[ 3 * nSecond ], pfVB[ 3 * nSecond + 1 ], pfVB[ 3 * nSecond + 2 ]);
-        const Vector3 p2(pfVB[ 3 * nThird  ], pfVB[ 3 * nThird  + 1 ], pfVB[ 3 * nThird  + 2 ]);
-
-        const Vector3 a = p0 - p1, b = p1 - p2;
-        const Vector3 vNormal = Normalize(Cross(a, b));
-
-        result [ 3 * i     ] = vNormal[ 0 ];
-        result [ 3 * i + 1 ] = vNormal[ 1 ];
-        result [ 3 * i + 2 ] = vNormal[ 2 ];
-    }
+    SoAPositions positions;
+    positions.Load(pfVB, nVertices, 3 * sizeof(float));
+    ComputeFaceGeometry(positions, pnIB, nFaces, result.data (), NULL);
 
     return result;
 }
@@ -409,6 +393,9 @@ std::vector<float> ComputeFaceNormals(const float*        pfVB,
 /// \param rClusterStart       Array giving the index of the first triangle in each cluster.  The size should be one plus the number
 ///                             of clusters.  The value of the last element of this array is the number of triangles in the mesh
 /// \param rGraphOut           An array of edges that will contain the overdraw graph
+/// \param eOverdrawOptimizer  The algorithm that computes the graph
+/// \param eCostModel          The model of the cost of the fragments counted in the graph.  Only the ray tracer models
+///                             TOOTLE_OVERDRAW_COST_HIZ and TOOTLE_OVERDRAW_COST_PREPASS, and the other algorithms ignore it.
 /// \return TOOTLE_OK, TOOTLE_INTERNAL_ERROR, TOOTLE_3D_API_ERROR, TOOTLE_OUT_OF_MEMORY
 //=================================================================================================================================
 TootleResult ODOverdrawGraph(const float*            pViewpoints,
@@ -417,7 +404,8 @@ TootleResult ODOverdrawGraph(const float*            pViewpoints,
                              const std::vector<int>& rClusters,
                              const std::vector<int>& rClusterStart,
                              std::vector<t_edge>&    rGraphOut,
-                             TootleOverdrawOptimizer eOverdrawOptimizer)
+                             TootleOverdrawOptimizer eOverdrawOptimizer,
+                             TootleOverdrawCostModel eCostModel)
 {
 #ifdef _SOFTWARE_ONLY_VERSION
 
@@ -453,7 +441,7 @@ TootleResult ODOverdrawGraph(const float*            pViewpoints,
             if (rClusterStart.size() > RAYTRACE_CLUSTER_THRESHOLD)
             {
                 return ODComputeGraphRaytrace(pViewpoints, nViewpoints, bCullCCW,
-                                              rClusters, (UINT) rClusterStart.size() - 1, rGraphOut);
+                                              rClusters, (UINT) rClusterStart.size() - 1, eCostModel, rGraphOut);
             }
             else
             {
@@ -470,7 +458,7 @@ TootleResult ODOverdrawGraph(const float*            pViewpoints,
         case TOOTLE_OVERDRAW_RAYTRACE:
 
             return ODComputeGraphRaytrace(pViewpoints, nViewpoints, bCullCCW,
-                                          rClusters, (UINT) rClusterStart.size() - 1, rGraphOut);
+                                          rClusters, (UINT) rClusterStart.size() - 1, eCostModel, rGraphOut);
             break;
 
         default:
@@ -13,6 +13,9 @@
 
 #define TOOTLE_RAYTRACE_IMAGE_SIZE 512    // the image size used to optimize and measure overdraw using ray tracing implementation
 
+/// If number of clusters is higher than this, TOOTLE_OVERDRAW_AUTO uses the raytracing algorithm
+const unsigned int RAYTRACE_CLUSTER_THRESHOLD = 225;
+
 class Soup;
 
 TootleResult ODInit();
@@ -23,15 +26,16 @@ bool ODIsInitialized();
 TootleResult ODSetSoup(Soup* pSoup, TootleFaceWinding eWinding);
 
 TootleResult ODObjectOverdraw(const float* pViewpoints, unsigned int nViewpoints, float& fODAvg, float& fODMax);
-TootleResult ODObjectOverdrawRaytrace(const float*        pfVB,
-                                      const unsigned int* pnIB,
-                                      unsigned int        nVertices,
-                                      unsigned int        nFaces,
-                                      const float*        pViewpoints,
-                                      unsigned int        nViewpoints,
-                                      bool                bCullCCW,
-                                      float&              fAvgOD,
-                                      float&              fMaxOD);
+TootleResult ODObjectOverdrawRaytrace(const float*            pfVB,
+                                      const unsigned int*     pnIB,
+                                      unsigned int            nVertices,
+                                      unsigned int            nFaces,
+                                      const float*            pViewpoints,
+                                      unsigned int            nViewpoints,
+                                      bool                    bCullCCW,
+                                      TootleOverdrawCostModel eCostModel,
+                                      float&                  fAvgOD,
+                                      float&                  fMaxOD);
 
 TootleResult ODOverdrawGraph(const float*            pViewpoints,
                              unsigned int            nViewpoints,
@@ -39,7 +43,8 @@ TootleResult ODOverdrawGraph(const float*            pViewpoints,
                              const std::vector<int>&       rClusters,
                              const std::vector<int>&       rClusterOut,
                              std::vector<t_edge>&          rGraphOut,
-                             TootleOverdrawOptimizer eOverdrawOptimizer);
+                             TootleOverdrawOptimizer eOverdrawOptimizer,
+                             TootleOverdrawCostModel eCostModel);
 
 void ODCleanup();
 
@@ -6,6 +6,7 @@
 #include "TootlePCH.h"
 #include <algorithm>
 #include "soup.h"
+#include "geometry.h"
 #include "error.h"
 
 int
@@ -96,15 +97,11 @@ ComputeTriNormals(std::vector<Vector3>& tn)
 
     tn.resize (t ().size ());
 
-    const int nf = static_cast<int> (t().size());
-
-    for (int i = 0; i < nf; i++)
+    if (!t().empty())
     {
-        const Vector3& p0 = v(t(i)[0]);
-        const Vector3& p1 = v(t(i)[1]);
-        const Vector3& p2 = v(t(i)[2]);
-        Vector3 a = p0 - p1, b = p1 - p2, c = p2 - p0;
-        tn[i] = Normalize(Cross(a, b));
+        SoAPositions positions;
+        positions.Load(v());
+        ComputeFaceGeometry(positions, (const UINT*) &t(0)[0], (UINT) t().size(), &tn[0][0], NULL);
     }
 
     debugf(("Done with tri normals"));
@@ -119,14 +116,11 @@ ComputeTriCenters(std::vector<Vector3>& tc)
 
     tc.resize (t ().size ());
 
-    const int nf = static_cast<int> (t().size());
-
-    for (int i = 0; i < nf; i++)
+    if (!t().empty())
     {
-        const Vector3& p0 = v(t(i)[0]);
-        const Vector3& p1 = v(t(i)[1]);
-        const Vector3& p2 = v(t(i)[2]);
-        tc[i] = (p0 + p1 + p2) / 3.f;
+        SoAPositions positions;
+        positions.Load(v());
+        ComputeFaceGeometry(positions, (const UINT*) &t(0)[0], (UINT) t().size(), NULL, &tc[0][0]);
     }
 
     debugf(("Done with tri centers"));
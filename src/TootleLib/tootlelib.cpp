@@ -4,6 +4,10 @@
 /// \file
 ****************************************************************************************/
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
 #include "TootlePCH.h"
 
 #ifndef _SOFTWARE_ONLY_VERSION
@@ -15,6 +19,9 @@
 #include "clustering.h"
 #include "error.h"
 #include "overdraw.h"
+#include "indexcodec.h"
+#include "vertexquantize.h"
+#include "weld.h"
 
 #include "tootlelib.h"
 #include "triorder.h"
@@ -78,7 +85,22 @@ static TootleResult TootleOptimizeVCacheTipsy(const unsigned int*   pnIB,
                                               unsigned int          nVertices,
                                               unsigned int          nCacheSize,
                                               unsigned int*         pnIBOut,
-                                              unsigned int*         pnFaceRemapOut);
+                                              unsigned int*         pnFaceRemapOut,
+                                              bool                  bCompressTies,
+                                              int*                  piVertexMap);
+
+// order the faces of each cluster front to back, within an ACMR budget
+static void FrontToBackClusters(const void*         pVB,
+                                unsigned int        nVertices,
+                                unsigned int        nVBStride,
+                                unsigned int*       pnIB,
+                                unsigned int        nFaces,
+                                TootleFaceWinding   eFrontWinding,
+                                const unsigned int* pnClusterStart,
+                                unsigned int        nClusters,
+                                unsigned int        nCacheSize,
+                                float               fMaxACMRIncrease,
+                                unsigned int*       pnFaceOrderOut);
 
 // optimize overdraw by reordering clusters based on Direct3D rendering
 static TootleResult TootleOptimizeOverdrawDirect3DAndRaytrace(const void*             pVB,
@@ -90,6 +112,7 @@ static TootleResult TootleOptimizeOverdrawDirect3DAndRaytrace(const void*
                                                               unsigned int            nViewpoints,
                                                               TootleFaceWinding       eFrontWinding,
                                                               TootleOverdrawOptimizer eOverdrawOptimizer,
+                                                              TootleOverdrawCostModel eCostModel,
                                                               const unsigned int*     pnFaceClusters,
                                                               unsigned int*           pnIBOut,
                                                               unsigned int*           pnClusterRemapOut);
@@ -120,16 +143,17 @@ static TootleResult TootleMeasureOverdrawDirect3D(const void*         pVB,
 #endif
 
 // measure overdraw using software rendering via raytracing
-static TootleResult TootleMeasureOverdrawRaytrace(const void*         pVB,
-                                                  const unsigned int* pnIB,
-                                                  unsigned int        nVertices,
-                                                  unsigned int        nFaces,
-                                                  unsigned int        nVBStride,
-                                                  const float*        pfViewpoint,
-                                                  unsigned int        nViewpoints,
-                                                  TootleFaceWinding   eFrontWinding,
-                                                  float*              pfAvgODOut,
-                                                  float*              pfMaxODOut);
+static TootleResult TootleMeasureOverdrawRaytrace(const void*             pVB,
+                                                  const unsigned int*     pnIB,
+                                                  unsigned int            nVertices,
+                                                  unsigned int            nFaces,
+                                                  unsigned int            nVBStride,
+                                                  const float*            pfViewpoint,
+                                                  unsigned int            nViewpoints,
+                                                  TootleFaceWinding       eFrontWinding,
+                                                  float*                  pfAvgODOut,
+                                                  float*                  pfMaxODOut,
+                                                  TootleOverdrawCostModel eCostModel);
 
 
 // converting the cluster array IDs from the full (v1.2 tootle) format to a compact format (v2.0 tootle).
@@ -144,6 +168,223 @@ static bool IsClusterArrayFullFormat(const unsigned int* pnID, unsigned int nFac
 // check whether the cluster array IDs is of type compact format (v2.0 tootle).
 static bool IsClusterArrayCompactFormat(const unsigned int* pnID, unsigned int nFaces);
 
+// the number of bytes allocated by a call.  It may exceed what size_t holds on 32-bit builds.
+typedef unsigned long long MemoryBytes;
+
+// the peak memory that a step of a call allocates, measured on the sample meshes with a 16 vertex cache and rounded up.  It
+//  is linear in the number of faces and vertices of the mesh.
+struct MemoryCost
+{
+    MemoryBytes nBytesPerFace;
+    MemoryBytes nBytesPerVertex;
+};
+
+// Tipsify and the index buffer it renumbers the vertices of, plus the copy of the index buffer made when the output
+//  overwrites the input
+static const MemoryCost MEMORY_TIPSY         = {  48,  20 };
+
+// the stripifier and its adjacency, plus the copy of the index buffer
+static const MemoryCost MEMORY_LSTRIPS       = { 112,  70 };
+
+// the soup, the mesh with its vertex to face and adjacency tables, and the face normals and centers used by Cluster()
+static const MemoryCost MEMORY_CLUSTER       = { 124, 110 };
+
+// the soup and the per-cluster measures of TootleOptimizeOverdrawFastApproximation
+static const MemoryCost MEMORY_FAST_OVERDRAW = {  42,  32 };
+
+// the ray tracer: the soup, the face normals, and the kd-tree, whose leaves duplicate the faces that straddle the splits
+static const MemoryCost MEMORY_RAYTRACE      = { 500, 380 };
+
+// the soup handed to the Direct3D overdraw module
+static const MemoryCost MEMORY_SOUP          = {  28,  24 };
+
+// the scratch and cluster arrays of TootleFastOptimize
+static const MemoryCost MEMORY_FAST_OPTIMIZE = {  64,  53 };
+
+// the bytes per cluster of the seeds and cluster measures of the clustering and of the fast overdraw approximation
+#define MEMORY_BYTES_PER_CLUSTER 96
+
+// the bytes per pair of clusters of the dense overdraw table, and of the overdraw graph and the feedback arc set built from
+//  it, when the overdraw is ordered by rendering every cluster against every other
+#define MEMORY_BYTES_PER_CLUSTER_PAIR 6
+
+// returns the memory of a step for a mesh
+static MemoryBytes MemoryOf(const MemoryCost& rCost, UINT nVertices, UINT nFaces)
+{
+    return rCost.nBytesPerFace * nFaces + rCost.nBytesPerVertex * nVertices;
+}
+
+// returns true if nBytes fits in a budget of nMemoryBudgetMB megabytes.  A budget of 0 has no limit.
+static bool FitsMemoryBudget(MemoryBytes nBytes, UINT nMemoryBudgetMB)
+{
+    return nMemoryBudgetMB == 0 || nBytes <= ((MemoryBytes) nMemoryBudgetMB << 20);
+}
+
+// returns the number of clusters assumed when it is not known.  Automatic clustering stops at about 128 clusters, or at one
+//  cluster per 250 faces for large meshes.
+static UINT TypicalClusterCount(UINT nFaces)
+{
+    return std::min(nFaces, std::max(128u, nFaces / 250));
+}
+
+// estimates the memory of TootleClusterMesh
+static MemoryBytes EstimateClusterMemory(UINT nVertices, UINT nFaces, UINT nClusters)
+{
+    return MemoryOf(MEMORY_CLUSTER, nVertices, nFaces) + (MemoryBytes) MEMORY_BYTES_PER_CLUSTER * nClusters;
+}
+
+// estimates the memory of TootleOptimizeVCache
+static MemoryBytes EstimateVCacheMemory(TootleVCacheOptimizer eVCacheOptimizer, UINT nCacheSize, UINT nVertices, UINT nFaces)
+{
+    if (eVCacheOptimizer == TOOTLE_VCACHE_LSTRIPS ||
+        (eVCacheOptimizer == TOOTLE_VCACHE_AUTO && nCacheSize <= 6))
+    {
+        return MemoryOf(MEMORY_LSTRIPS, nVertices, nFaces);
+    }
+
+    return MemoryOf(MEMORY_TIPSY, nVertices, nFaces);
+}
+
+// returns the vertex cache optimizer that TootleOptimizeVCache runs within a budget: the stripifier needs about four times
+//  the memory of Tipsify, so Tipsify replaces it if it does not fit
+static TootleVCacheOptimizer ChooseVCacheOptimizer(TootleVCacheOptimizer eVCacheOptimizer, UINT nCacheSize, UINT nVertices,
+                                                   UINT nFaces, UINT nMemoryBudgetMB)
+{
+    if (!FitsMemoryBudget(EstimateVCacheMemory(eVCacheOptimizer, nCacheSize, nVertices, nFaces), nMemoryBudgetMB) &&
+        (eVCacheOptimizer == TOOTLE_VCACHE_LSTRIPS || eVCacheOptimizer == TOOTLE_VCACHE_AUTO))
+    {
+        return TOOTLE_VCACHE_TIPSY;
+    }
+
+    return eVCacheOptimizer;
+}
+
+// estimates the memory of TootleOptimizeOverdraw for a mesh with nClusters clusters
+static MemoryBytes EstimateOverdrawMemory(TootleOverdrawOptimizer eOverdrawOptimizer, UINT nVertices, UINT nFaces,
+                                          UINT nClusters)
+{
+    if (eOverdrawOptimizer == TOOTLE_OVERDRAW_AUTO)
+    {
+#ifdef _SOFTWARE_ONLY_VERSION
+        eOverdrawOptimizer = TOOTLE_OVERDRAW_RAYTRACE;
+#else
+        eOverdrawOptimizer = (nClusters + 1 > RAYTRACE_CLUSTER_THRESHOLD) ? TOOTLE_OVERDRAW_RAYTRACE : TOOTLE_OVERDRAW_DIRECT3D;
+#endif
+    }
+
+    const MemoryBytes nClusterPairs = (MemoryBytes) nClusters * nClusters;
+
+    switch (eOverdrawOptimizer)
+    {
+        case TOOTLE_OVERDRAW_RAYTRACE:
+            return MemoryOf(MEMORY_RAYTRACE, nVertices, nFaces) + MEMORY_BYTES_PER_CLUSTER_PAIR * nClusterPairs;
+
+        case TOOTLE_OVERDRAW_DIRECT3D:
+            return MemoryOf(MEMORY_SOUP, nVertices, nFaces) + MEMORY_BYTES_PER_CLUSTER_PAIR * nClusterPairs;
+
+        default:
+            return MemoryOf(MEMORY_FAST_OVERDRAW, nVertices, nFaces) + (MemoryBytes) MEMORY_BYTES_PER_CLUSTER * nClusters;
+    }
+}
+
+// returns the overdraw optimizer that TootleOptimizeOverdraw runs within a budget: the fast approximation replaces the
+//  rendered ones if they do not fit
+static TootleOverdrawOptimizer ChooseOverdrawOptimizer(TootleOverdrawOptimizer eOverdrawOptimizer, UINT nVertices, UINT nFaces,
+                                                       UINT nClusters, UINT nMemoryBudgetMB)
+{
+    if (!FitsMemoryBudget(EstimateOverdrawMemory(eOverdrawOptimizer, nVertices, nFaces, nClusters), nMemoryBudgetMB) &&
+        (eOverdrawOptimizer == TOOTLE_OVERDRAW_AUTO     ||
+         eOverdrawOptimizer == TOOTLE_OVERDRAW_DIRECT3D ||
+         eOverdrawOptimizer == TOOTLE_OVERDRAW_RAYTRACE))
+    {
+        return TOOTLE_OVERDRAW_FAST;
+    }
+
+    return eOverdrawOptimizer;
+}
+
+// estimates the memory of TootleMeasureOverdraw
+static MemoryBytes EstimateMeasureOverdrawMemory(TootleOverdrawOptimizer eOverdrawOptimizer, UINT nVertices, UINT nFaces)
+{
+#ifdef _SOFTWARE_ONLY_VERSION
+    eOverdrawOptimizer = TOOTLE_OVERDRAW_RAYTRACE;
+#endif
+
+    if (eOverdrawOptimizer == TOOTLE_OVERDRAW_RAYTRACE)
+    {
+        return MemoryOf(MEMORY_RAYTRACE, nVertices, nFaces);
+    }
+
+    return MemoryOf(MEMORY_SOUP, nVertices, nFaces);
+}
+
+// estimates the memory of a call with the algorithms it would choose within nMemoryBudgetMB.  Returns TOOTLE_OUT_OF_MEMORY if
+//  the estimate does not fit in the budget.
+static TootleResult EstimateMemory(TootleFunction          eFunction,
+                                   UINT                    nVertices,
+                                   UINT                    nFaces,
+                                   UINT                    nCacheSize,
+                                   UINT                    nClusters,
+                                   TootleVCacheOptimizer   eVCacheOptimizer,
+                                   TootleOverdrawOptimizer eOverdrawOptimizer,
+                                   UINT                    nMemoryBudgetMB,
+                                   MemoryBytes*            pnBytesOut)
+{
+    if (nClusters == 0)
+    {
+        nClusters = TypicalClusterCount(nFaces);
+    }
+
+    eVCacheOptimizer   = ChooseVCacheOptimizer(eVCacheOptimizer, nCacheSize, nVertices, nFaces, nMemoryBudgetMB);
+    eOverdrawOptimizer = ChooseOverdrawOptimizer(eOverdrawOptimizer, nVertices, nFaces, nClusters, nMemoryBudgetMB);
+
+    MemoryBytes nBytes;
+
+    switch (eFunction)
+    {
+        case TOOTLE_FUNCTION_OPTIMIZE_VCACHE:
+        case TOOTLE_FUNCTION_VCACHE_CLUSTERS:
+            // the clusters are optimized one at a time, and the largest one may hold most of the faces
+            nBytes = EstimateVCacheMemory(eVCacheOptimizer, nCacheSize, nVertices, nFaces);
+            break;
+
+        case TOOTLE_FUNCTION_CLUSTER_MESH:
+            nBytes = EstimateClusterMemory(nVertices, nFaces, nClusters);
+            break;
+
+        case TOOTLE_FUNCTION_OPTIMIZE_OVERDRAW:
+            nBytes = EstimateOverdrawMemory(eOverdrawOptimizer, nVertices, nFaces, nClusters);
+            break;
+
+        case TOOTLE_FUNCTION_MEASURE_OVERDRAW:
+            nBytes = EstimateMeasureOverdrawMemory(eOverdrawOptimizer, nVertices, nFaces);
+            break;
+
+        case TOOTLE_FUNCTION_OPTIMIZE:
+            // the steps run one after the other, and the cluster array is kept throughout
+            nBytes = std::max(EstimateClusterMemory(nVertices, nFaces, nClusters),
+                              EstimateVCacheMemory(eVCacheOptimizer, nCacheSize, nVertices, nFaces));
+            nBytes = std::max(nBytes, EstimateOverdrawMemory(eOverdrawOptimizer, nVertices, nFaces, nClusters));
+            nBytes += sizeof(UINT) * ((MemoryBytes) nFaces + 1);
+            break;
+
+        case TOOTLE_FUNCTION_FAST_OPTIMIZE:
+            nBytes = MemoryOf(MEMORY_FAST_OPTIMIZE, nVertices, nFaces);
+            break;
+
+        default:
+            errorf(("TootleEstimateMemory: eFunction is invalid."));
+            return TOOTLE_INVALID_ARGS;
+    }
+
+    if (pnBytesOut)
+    {
+        *pnBytesOut = nBytes;
+    }
+
+    return FitsMemoryBudget(nBytes, nMemoryBudgetMB) ? TOOTLE_OK : TOOTLE_OUT_OF_MEMORY;
+}
+
 TootleResult TOOTLE_DLL TootleInit()
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
@@ -159,6 +400,50 @@ TootleResult TOOTLE_DLL TootleInit()
     AMD_TOOTLE_API_FUNCTION_END
 }
 
+TootleResult TOOTLE_DLL TootleEstimateMemory(TootleFunction          eFunction,
+                                             unsigned int            nVertices,
+                                             unsigned int            nFaces,
+                                             unsigned int            nCacheSize,
+                                             unsigned int            nClusters,
+                                             TootleVCacheOptimizer   eVCacheOptimizer,
+                                             TootleOverdrawOptimizer eOverdrawOptimizer,
+                                             unsigned int            nMemoryBudgetMB,
+                                             unsigned int*           pnKilobytesOut)
+{
+    // sanity checks
+    if (!pnKilobytesOut)
+    {
+        errorf(("TootleEstimateMemory: pnKilobytesOut is NULL"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleEstimateMemory: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleEstimateMemory: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    MemoryBytes nBytes = 0;
+    TootleResult result = EstimateMemory(eFunction, nVertices, nFaces, nCacheSize, nClusters, eVCacheOptimizer,
+                                         eOverdrawOptimizer, nMemoryBudgetMB, &nBytes);
+
+    if (result != TOOTLE_INVALID_ARGS)
+    {
+        *pnKilobytesOut = (unsigned int) std::min((nBytes + 1023) / 1024, (MemoryBytes) 0xffffffff);
+    }
+
+    return result;
+}
+
 static TootleResult FindFaceMappingFromIndex(const unsigned int* pnIB,
                                              const unsigned int* pnIB2,
                                              const unsigned int  nIndex,
@@ -201,13 +486,17 @@ static TootleResult FindFaceMappingFromIndex(const unsigned int* pnIB,
     return TOOTLE_INTERNAL_ERROR;
 }
 
-TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
-                                             unsigned int          nFaces,
-                                             unsigned int          nVertices,
-                                             unsigned int          nCacheSize,
-                                             unsigned int*         pnIBOut,
-                                             unsigned int*         pnFaceRemapOut,
-                                             TootleVCacheOptimizer eVCacheOptimizer)
+// TootleOptimizeVCacheEx, with the vertex map of FanVertOptimizeVCacheOnly.  TootleVCacheClustersEx passes one map to all of
+//  its clusters, so that it is cleared once for the mesh.
+static TootleResult TootleOptimizeVCacheWithMap(const unsigned int*   pnIB,
+                                                unsigned int          nFaces,
+                                                unsigned int          nVertices,
+                                                unsigned int          nCacheSize,
+                                                unsigned int*         pnIBOut,
+                                                unsigned int*         pnFaceRemapOut,
+                                                TootleVCacheOptimizer eVCacheOptimizer,
+                                                unsigned int          nMemoryBudgetMB,
+                                                int*                  piVertexMap)
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
 
@@ -235,6 +524,16 @@ TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
         return TOOTLE_INVALID_ARGS;
     }
 
+    // within a memory budget, fall back to a smaller algorithm, or fail before allocating
+    eVCacheOptimizer = ChooseVCacheOptimizer(eVCacheOptimizer, nCacheSize, nVertices, nFaces, nMemoryBudgetMB);
+
+    if (!FitsMemoryBudget(EstimateVCacheMemory(eVCacheOptimizer, nCacheSize, nVertices, nFaces), nMemoryBudgetMB))
+    {
+        errorf(("TootleOptimizeVCache: The optimization does not fit in nMemoryBudgetMB"));
+
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
     unsigned int* pnIBOutTmp = pnIBOut;
 
     // if source and destination buffer are the same, we need a local copy
@@ -262,7 +561,8 @@ TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
             }
             else
             {
-                result = TootleOptimizeVCacheTipsy(pnIB, nFaces, nVertices, nCacheSize, pnIBOutTmp, pnFaceRemapOut);
+                result = TootleOptimizeVCacheTipsy(pnIB, nFaces, nVertices, nCacheSize, pnIBOutTmp, pnFaceRemapOut, false,
+                                                   piVertexMap);
             }
 
             break;
@@ -281,7 +581,13 @@ TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
             break;
 
         case TOOTLE_VCACHE_TIPSY:
-            result = TootleOptimizeVCacheTipsy(pnIB, nFaces, nVertices, nCacheSize, pnIBOutTmp, pnFaceRemapOut);
+            result = TootleOptimizeVCacheTipsy(pnIB, nFaces, nVertices, nCacheSize, pnIBOutTmp, pnFaceRemapOut, false,
+                                               piVertexMap);
+            break;
+
+        case TOOTLE_VCACHE_TIPSY_COMPRESS:
+            result = TootleOptimizeVCacheTipsy(pnIB, nFaces, nVertices, nCacheSize, pnIBOutTmp, pnFaceRemapOut, true,
+                                               piVertexMap);
             break;
 
         default:
@@ -303,1793 +609,5019 @@ TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
     AMD_TOOTLE_API_FUNCTION_END
 }
 
-#ifndef _SOFTWARE_ONLY_VERSION
-static TootleResult TootleOptimizeVCacheDirect3D(const unsigned int* pnIB,
-                                                 unsigned int        nFaces,
-                                                 unsigned int        nVertices,
-                                                 unsigned int        nCacheSize,
-                                                 unsigned int*       pnIBOut,
-                                                 unsigned int*       pnFaceRemapOut)
+TootleResult TOOTLE_DLL TootleOptimizeVCacheEx(const unsigned int*   pnIB,
+                                               unsigned int          nFaces,
+                                               unsigned int          nVertices,
+                                               unsigned int          nCacheSize,
+                                               unsigned int*         pnIBOut,
+                                               unsigned int*         pnFaceRemapOut,
+                                               TootleVCacheOptimizer eVCacheOptimizer,
+                                               unsigned int          nMemoryBudgetMB)
 {
-    // sanity checks
+    return TootleOptimizeVCacheWithMap(pnIB, nFaces, nVertices, nCacheSize, pnIBOut, pnFaceRemapOut, eVCacheOptimizer,
+                                       nMemoryBudgetMB, NULL);
+}
+
+TootleResult TOOTLE_DLL TootleOptimizeVCache(const unsigned int*   pnIB,
+                                             unsigned int          nFaces,
+                                             unsigned int          nVertices,
+                                             unsigned int          nCacheSize,
+                                             unsigned int*         pnIBOut,
+                                             unsigned int*         pnFaceRemapOut,
+                                             TootleVCacheOptimizer eVCacheOptimizer)
+{
+    return TootleOptimizeVCacheEx(pnIB, nFaces, nVertices, nCacheSize, pnIBOut, pnFaceRemapOut, eVCacheOptimizer);
+}
+
+TootleResult TOOTLE_DLL TootleOptimizeVCacheStrips(const unsigned int* pnIB,
+                                                   unsigned int        nFaces,
+                                                   unsigned int        nVertices,
+                                                   unsigned int        nCacheSize,
+                                                   unsigned int*       pnStripIBOut,
+                                                   unsigned int*       pnStripIndicesOut,
+                                                   unsigned int*       pnIBOut,
+                                                   unsigned int*       pnFaceRemapOut,
+                                                   unsigned int        nRestartIndex)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks on the input parameters
     assert(pnIB);
+    assert(pnStripIBOut);
+    assert(pnStripIndicesOut);
 
     if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
     {
-        errorf(("TootleOptimizeVCacheDirect3D: Invalid value of nFaces"));
+        errorf(("TootleOptimizeVCacheStrips: Invalid value of nFaces"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleOptimizeVCacheDirect3D: Invalid value of nVertices"));
+        errorf(("TootleOptimizeVCacheStrips: Invalid value of nVertices"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nCacheSize == 0)
     {
-        errorf(("TootleOptimizeVCacheDirect3D: nCacheSize = 0"));
+        errorf(("TootleOptimizeVCacheStrips: nCacheSize = 0"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    auto pFaceRemap = 
-#ifdef _DX11_1_
-                    new uint32_t[nFaces];
-#else
-                    new DWORD[ nFaces ];
-#endif
-    HRESULT hres = D3D_OK;
-
-    if (nFaces == 1)
-    {
-        // D3DX doesn't like it if we optimize a single face (we'll get an internal error), so just pass through
-        *pFaceRemap = 0;
-    }
-    else
+    if (nRestartIndex < nVertices)
     {
-#ifdef _DX11_1_
+        errorf(("TootleOptimizeVCacheStrips: nRestartIndex is a valid vertex index"));
 
-        hres = DirectX::OptimizeFaces(pnIB, nFaces, nullptr, pFaceRemap);
-#else
-        // use D3DX for optimization
-        hres = D3DXOptimizeFaces(pnIB, nFaces, nVertices, true, pFaceRemap);
-#endif
+        return TOOTLE_INVALID_ARGS;
     }
 
-    if (hres == D3D_OK)
+    for (UINT i = 0; i < 3 * nFaces; i++)
     {
-        // re-order faces
-        if (pnIBOut)
+        if (pnIB[i] >= nVertices)
         {
-            for (UINT i = 0; i < nFaces; i++)
-            {
-                for (UINT j = 0; j < 3; j++)
-                {
-                    pnIBOut[(3 * i) + j ] = pnIB[(3 * pFaceRemap[i]) + j ];
-                }
-            }
-        }
+            errorf(("TootleOptimizeVCacheStrips: Index buffer references vertices beyond nVertices"));
 
-        // copy face re-mapping if user wants it
-        if (pnFaceRemapOut)
-        {
-            memcpy(pnFaceRemapOut, pFaceRemap, sizeof(UINT)*nFaces);
+            return TOOTLE_INVALID_ARGS;
         }
     }
 
-    delete[] pFaceRemap;
+    // the list output may overwrite the input, which the stripifier reads until it is done
+    std::vector<UINT> ibOut;
 
-    switch (hres)
+    if (pnIBOut == pnIB)
     {
-        case D3D_OK:
-            return TOOTLE_OK;
+        ibOut.resize(3 * nFaces);
+    }
 
-        case E_OUTOFMEMORY:
-            return TOOTLE_OUT_OF_MEMORY;
+    if (!Stripifier::ProcessStrips(pnIB, nFaces, nVertices, nCacheSize, nRestartIndex, pnStripIBOut, pnStripIndicesOut,
+                                   ibOut.empty() ? pnIBOut : &ibOut[0], pnFaceRemapOut))
+    {
+        return TOOTLE_OUT_OF_MEMORY;
+    }
 
-        default:
-            return TOOTLE_INTERNAL_ERROR;
+    if (!ibOut.empty())
+    {
+        memcpy(pnIBOut, &ibOut[0], 3 * nFaces * sizeof(UINT));
     }
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
 }
-#endif
 
-static TootleResult TootleOptimizeVCacheLStrips(const unsigned int* pnIB,
-                                                unsigned int        nFaces,
-                                                unsigned int        nVertices,
-                                                unsigned int        nCacheSize,
-                                                unsigned int*       pnIBOut,
-                                                unsigned int*       pnFaceRemapOut)
-{
-    // sanity checks
-    assert(pnIB);
+// the largest number of grid cells along each axis used by TootleOptimizeVCacheStreaming to partition the mesh
+#define STREAM_MAX_GRID_RESOLUTION 64
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
-    {
-        errorf(("TootleOptimizeVCacheLStrips: Invalid value of nFaces"));
+// a bound on the bytes TootleOptimizeVCacheStreaming allocates per face of a chunk of F faces and V <= 3F vertices, with Tipsify:
+//  the chunk index buffer (12 bytes), the vertices of OptimizeVCacheLocal (up to 24 bytes with the growth of the vector, after
+//  its 24 bytes of sort pairs are freed), the scratch of FanVertOptimizeVCacheOnly (7F + F/32 + 8V + 1 ints, at most 125 bytes)
+//  and the vertex map of FanVertLinSort (V ints, at most 12 bytes).  That is at most 173 bytes, and the rest is left for the
+//  allocator.  The other optimizers have no such bound, so they are not accepted.
+#define STREAM_BYTES_PER_FACE 256
 
-        return TOOTLE_INVALID_ARGS;
-    }
+// the spatial grid TootleOptimizeVCacheStreaming partitions a mesh with.  The cells are numbered in Morton order, so cells
+//  with consecutive numbers are close together
+struct StreamGrid
+{
+    const char* pVB;
+    UINT        nVBStride;
+    UINT        nResolution;
+    float       fMin[3];
+    float       fScale[3];
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    // returns the cell holding the center of a face
+    UINT FaceCell(const unsigned int* pnFace) const
     {
-        errorf(("TootleOptimizeVCacheLStrips: Invalid value of nVertices"));
+        UINT nCell = 0;
 
-        return TOOTLE_INVALID_ARGS;
-    }
+        for (UINT a = 0; a < 3; a++)
+        {
+            float fCenter = 0.0f;
 
-    if (nCacheSize == 0)
-    {
-        errorf(("TootleOptimizeVCacheLStrips: nCacheSize = 0"));
-
-        return TOOTLE_INVALID_ARGS;
-    }
-
-    unsigned int* pnStripResult = new unsigned int[ nFaces * 3 ];
+            for (UINT k = 0; k < 3; k++)
+            {
+                fCenter += ((const float*)(pVB + (size_t) pnFace[k] * nVBStride))[a];
+            }
 
-    Stripifier::Process(pnIB, nFaces, pnStripResult, pnFaceRemapOut);
+            int x = (int)((fCenter / 3.0f - fMin[a]) * fScale[a]);
+            x = std::min(std::max(x, 0), (int) nResolution - 1);
 
-    // re-order faces
-    if (pnIBOut)
-    {
-        for (UINT i = 0; i < nFaces * 3; i++)
-        {
-            pnIBOut[ i ] = pnStripResult[ i ];
+            // interleave the bits of the three coordinates
+            for (UINT b = 0; (1u << b) < nResolution; b++)
+            {
+                nCell |= ((x >> b) & 1u) << (3 * b + a);
+            }
         }
-    }
-
-    TootleResult result = TOOTLE_OK;
-
-    delete[] pnStripResult;
 
-    return result;
-}
+        return nCell;
+    }
+};
 
-static TootleResult TootleOptimizeVCacheTipsy(const unsigned int* pnIB,
-                                              unsigned int        nFaces,
-                                              unsigned int        nVertices,
-                                              unsigned int        nCacheSize,
-                                              unsigned int*       pnIBOut,
-                                              unsigned int*       pnFaceRemapOut)
+// optimizes a part of a mesh for the vertex cache, with memory and time proportional to the size of the part only.
+//  pnChunkIB holds the faces in the original vertex numbering and is overwritten.  The optimized faces are written to pnIBOut.
+static TootleResult OptimizeVCacheLocal(unsigned int* pnChunkIB, UINT nChunkFaces, UINT nCacheSize,
+                                        TootleVCacheOptimizer eVCacheOptimizer, unsigned int* pnIBOut)
 {
-    // sanity checks
-    assert(pnIB);
+    // renumber the vertices of the chunk from 0, so that the optimizer only needs memory for the vertices of the chunk
+    std::vector< std::pair<UINT, UINT> > indices(3 * nChunkFaces);
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    for (UINT i = 0; i < 3 * nChunkFaces; i++)
     {
-        errorf(("TootleOptimizeVCacheTipsy: Invalid value of nFaces"));
-
-        return TOOTLE_INVALID_ARGS;
+        indices[i] = std::make_pair(pnChunkIB[i], i);
     }
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
-    {
-        errorf(("TootleOptimizeVCacheTipsy: Invalid value of nVertices"));
+    std::sort(indices.begin(), indices.end());
 
-        return TOOTLE_INVALID_ARGS;
-    }
+    std::vector<UINT> vertices;
 
-    if (nCacheSize == 0)
+    for (UINT i = 0; i < 3 * nChunkFaces; i++)
     {
-        errorf(("TootleOptimizeVCacheTipsy: nCacheSize = 0"));
+        if (vertices.empty() || vertices.back() != indices[i].first)
+        {
+            vertices.push_back(indices[i].first);
+        }
 
-        return TOOTLE_INVALID_ARGS;
+        pnChunkIB[indices[i].second] = (UINT) vertices.size() - 1;
     }
 
-    FanVertOptimizeVCacheOnly((int*) pnIB, (int*) pnIBOut, nVertices, nFaces, nCacheSize, NULL, NULL, NULL);
-
-    // if the face remapping is requested, compute it for the caller.
-    // Perhaps, this information should be generated as the indices get built in FanVertOptimizeVCache to be
-    //  more efficient.
-    if (pnFaceRemapOut)
-    {
-        UINT nFaceMap;
-        TootleResult result;
+    std::vector< std::pair<UINT, UINT> >().swap(indices);
 
-        for (UINT i = 0; i < nFaces; i++)
-        {
-            result = FindFaceMappingFromIndex(pnIB, pnIBOut, i, nFaces, &nFaceMap);
+    // the optimized faces go straight to the output, and are then numbered back
+    TootleResult result = TootleOptimizeVCache(pnChunkIB, nChunkFaces, (UINT) vertices.size(), nCacheSize, pnIBOut, NULL,
+                                               eVCacheOptimizer);
 
-            if (result != TOOTLE_OK)
-            {
-                return result;
-            }
+    if (result != TOOTLE_OK)
+    {
+        return result;
+    }
 
-            pnFaceRemapOut[i] = nFaceMap;
-        }
+    for (UINT i = 0; i < 3 * nChunkFaces; i++)
+    {
+        pnIBOut[i] = vertices[ pnIBOut[i] ];
     }
 
     return TOOTLE_OK;
 }
 
-TootleResult TOOTLE_DLL TootleClusterMesh(const void*         pVB,
-                                          const unsigned int* pnIB,
-                                          unsigned int        nVertices,
-                                          unsigned int        nFaces,
-                                          unsigned int        nVBStride,
-                                          unsigned int        nTargetClusters,
-                                          unsigned int*       pnClusteredIBOut,
-                                          unsigned int*       pnFaceClustersOut,
-                                          unsigned int*       pnFaceRemapOut)
+TootleResult TOOTLE_DLL TootleOptimizeVCacheStreaming(const void*           pVB,
+                                                      const unsigned int*   pnIB,
+                                                      unsigned int          nVertices,
+                                                      unsigned int          nFaces,
+                                                      unsigned int          nVBStride,
+                                                      unsigned int          nCacheSize,
+                                                      unsigned int          nMemoryBudgetMB,
+                                                      unsigned int*         pnIBOut,
+                                                      TootleVCacheOptimizer eVCacheOptimizer,
+                                                      unsigned int*         pnChunksOut)
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
 
     // sanity checks
     assert(pVB);
     assert(pnIB);
-    assert(pnClusteredIBOut);
-    assert(pnFaceClustersOut);
+    assert(pnIBOut);
 
     if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleClusterMesh: Invalid value of nVertices"));
+        errorf(("TootleOptimizeVCacheStreaming: Invalid value of nVertices"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
     {
-        errorf(("TootleClusterMesh: Invalid value of nFaces"));
+        errorf(("TootleOptimizeVCacheStreaming: Invalid value of nFaces"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nVBStride < 3 * sizeof(float))
     {
-        errorf(("TootleClusterMesh: nVBStride less than 3*sizeof(float)"));
+        errorf(("TootleOptimizeVCacheStreaming: nVBStride less than 3*sizeof(float)"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // because Pedro's clustering implementation is so heavily tied to the Soup/Mesh classes, it's easier just to
-    // construct a soup here eventually we should re-work the code to avoid this redundant copying.
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleOptimizeVCacheStreaming: nCacheSize = 0"));
 
-    Soup soup;
+        return TOOTLE_INVALID_ARGS;
+    }
 
-    if (!MakeSoup(pVB, pnIB, nVertices, nFaces, nVBStride, &soup))
+    if (pnIBOut == pnIB)
     {
-        return TOOTLE_OUT_OF_MEMORY;
-    }
+        errorf(("TootleOptimizeVCacheStreaming: pnIBOut must not equal pnIB"));
 
-    // cluster the mesh
-    UINT nClusters = nTargetClusters;
-    std::vector<int> clusterIDs;
-    ClusterResult result = Cluster(&soup, nClusters, clusterIDs);
+        return TOOTLE_INVALID_ARGS;
+    }
 
-    switch (result)
+    if (eVCacheOptimizer != TOOTLE_VCACHE_TIPSY && eVCacheOptimizer != TOOTLE_VCACHE_TIPSY_COMPRESS)
     {
-        case CLUSTER_OK:              break;
-
-        case CLUSTER_OUT_OF_MEMORY:   return TOOTLE_OUT_OF_MEMORY;
+        errorf(("TootleOptimizeVCacheStreaming: eVCacheOptimizer must be TOOTLE_VCACHE_TIPSY or TOOTLE_VCACHE_TIPSY_COMPRESS"));
 
-        default:                      return TOOTLE_INTERNAL_ERROR;
+        return TOOTLE_INVALID_ARGS;
     }
 
-    // create an array to hold the face re-mapping
-    // use the output array if the user provided one, otherwise, allocate a new one
-    UINT* pnRemap = pnFaceRemapOut;
+    // the grid takes at most an eighth of the budget, and the chunks get the rest
+    const size_t nBudget = (size_t) nMemoryBudgetMB * 1024 * 1024;
 
-    if (!pnRemap)
+    StreamGrid grid;
+    grid.pVB = (const char*) pVB;
+    grid.nVBStride = nVBStride;
+    grid.nResolution = STREAM_MAX_GRID_RESOLUTION;
+
+    while (grid.nResolution > 1 &&
+           2 * sizeof(UINT) * grid.nResolution * grid.nResolution * grid.nResolution > nBudget / 8)
     {
-        pnRemap = new UINT[ nFaces ];
+        grid.nResolution /= 2;
     }
 
-    if (!SortFacesByCluster(soup, clusterIDs, pnRemap))
+    const UINT nCells = grid.nResolution * grid.nResolution * grid.nResolution;
+    const size_t nChunkFaces = (nBudget - std::min(nBudget, 2 * sizeof(UINT) * (size_t) nCells)) / STREAM_BYTES_PER_FACE;
+
+    if (nChunkFaces == 0)
     {
-        return TOOTLE_OUT_OF_MEMORY;
+        errorf(("TootleOptimizeVCacheStreaming: nMemoryBudgetMB is too small"));
+
+        return TOOTLE_INVALID_ARGS;
     }
 
-    if (pnRemap != pnFaceRemapOut)
+    // find the bounding box of the vertices
+    float fMax[3];
+
+    for (UINT a = 0; a < 3; a++)
     {
-        // don't need this temporary array anymore
-        delete[] pnRemap;
+        grid.fMin[a] = ((const float*) pVB)[a];
+        fMax[a] = grid.fMin[a];
     }
 
-    // copy clustered mesh to output array
-
-    // once again, we're memcpying int to unsigned int.
-    // This should be ok because, if clustering worked, all cluster IDs will be positive
-    // We should still fix it eventually though
-    memcpy(pnFaceClustersOut, &clusterIDs[0], sizeof(int)*clusterIDs.size());
-    memcpy(pnClusteredIBOut, &soup.t(0), sizeof(int)*soup.t().size() * 3);
+    for (UINT i = 1; i < nVertices; i++)
+    {
+        const float* pfPosition = (const float*)(grid.pVB + (size_t) i * nVBStride);
 
-    // Append the number of cluster to the last element of the array.
-    // This is to ensure we can mix and match the full (old tootle) and compact (new tootle) format.
-    pnFaceClustersOut[nFaces] = 1 + pnFaceClustersOut[nFaces - 1];
+        for (UINT a = 0; a < 3; a++)
+        {
+            grid.fMin[a] = std::min(grid.fMin[a], pfPosition[a]);
+            fMax[a] = std::max(fMax[a], pfPosition[a]);
+        }
+    }
 
-    return TOOTLE_OK;
+    for (UINT a = 0; a < 3; a++)
+    {
+        grid.fScale[a] = (fMax[a] > grid.fMin[a]) ? grid.nResolution / (fMax[a] - grid.fMin[a]) : 0.0f;
+    }
 
-    AMD_TOOTLE_API_FUNCTION_END
-}
+    // count the faces in each cell, and turn the counts into the position of each cell in the output
+    std::vector<UINT> cellStart(nCells + 1, 0);
 
-TootleResult TOOTLE_DLL TootleFastOptimizeVCacheAndClusterMesh(const unsigned int* pnIB,
-                                                               unsigned int        nFaces,
-                                                               unsigned int        nVertices,
-                                                               unsigned int        nCacheSize,
-                                                               unsigned int*       pnIBOut,
-                                                               unsigned int*       pnClustersOut,
-                                                               unsigned int*       pnNumClustersOut,
-                                                               float               fAlpha)
-{
-    AMD_TOOTLE_API_FUNCTION_BEGIN
+    for (UINT i = 0; i < nFaces; i++)
+    {
+        const unsigned int* pnFace = &pnIB[3 * i];
 
-    // sanity checks
-    assert(pnIB);
-    assert(pnIBOut);
-    assert(pnClustersOut);
+        if (pnFace[0] >= nVertices || pnFace[1] >= nVertices || pnFace[2] >= nVertices)
+        {
+            errorf(("TootleOptimizeVCacheStreaming: Index buffer references vertices beyond nVertices"));
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
-    {
-        errorf(("TootleFastOptimizeVCacheAndClusterMesh: Invalid value of nFaces"));
+            return TOOTLE_INVALID_ARGS;
+        }
 
-        return TOOTLE_INVALID_ARGS;
+        cellStart[ grid.FaceCell(pnFace) + 1 ]++;
     }
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    for (UINT c = 0; c < nCells; c++)
     {
-        errorf(("TootleFastOptimizeVCacheAndClusterMesh: Invalid value of nVertices"));
-
-        return TOOTLE_INVALID_ARGS;
+        cellStart[c + 1] += cellStart[c];
     }
 
-    if (nCacheSize == 0)
+    // write each face to the position of its cell in the output, in input order.  This reads the index buffer a second and
+    //  last time.  The cellStart array is reused to count the faces written to each cell.
+    for (UINT i = 0; i < nFaces; i++)
     {
-        errorf(("TootleOptimizeVCacheAndClusterMesh: nCacheSize = 0"));
+        const unsigned int* pnFace = &pnIB[3 * i];
+        UINT nPosition = cellStart[ grid.FaceCell(pnFace) ]++;
 
-        return TOOTLE_INVALID_ARGS;
+        memcpy(&pnIBOut[3 * (size_t) nPosition], pnFace, 3 * sizeof(UINT));
     }
 
-    unsigned int* pnOutput = pnIBOut;
+    std::vector<UINT>().swap(cellStart);
 
-    // if source and destination buffer are the same, we need a local copy
-    if (pnIBOut)
+    // each chunk is a run of nChunkFaces faces of the output, optimized in place.  The faces of a cell that does not fit in
+    //  a chunk are split between chunks in their input order.
+    std::vector<UINT> chunkIB(3 * std::min(nChunkFaces, (size_t) nFaces));
+    UINT nChunks = 0;
+
+    for (UINT nChunkStart = 0; nChunkStart < nFaces; nChunkStart += (UINT) nChunkFaces)
     {
-        if (pnIB == pnIBOut)
+        const UINT nChunkEnd = (UINT) std::min((size_t) nFaces, nChunkStart + nChunkFaces);
+
+        memcpy(&chunkIB[0], &pnIBOut[3 * (size_t) nChunkStart], 3 * (nChunkEnd - nChunkStart) * sizeof(UINT));
+
+        TootleResult result = OptimizeVCacheLocal(&chunkIB[0], nChunkEnd - nChunkStart, nCacheSize, eVCacheOptimizer,
+                                                  &pnIBOut[3 * (size_t) nChunkStart]);
+
+        if (result != TOOTLE_OK)
         {
-            pnOutput = new unsigned int[ 3 * nFaces ];
+            return result;
         }
+
+        nChunks++;
     }
 
-    float         fACMR;
-    unsigned int* pnClustersOutTmp;
-    unsigned int  pnNumClustersOutTmp;
+    if (pnChunksOut)
+    {
+        *pnChunksOut = nChunks;
+    }
 
-    pnClustersOutTmp = new unsigned int [ nFaces + 1 ];
+    return TOOTLE_OK;
 
-    // OPTIMIZE VERTEX CACHE
-    fACMR = FanVertOptimizeVCacheOnly((int*) pnIB, (int*) pnOutput, nVertices, nFaces, nCacheSize, NULL,
-                                      (int*) pnClustersOutTmp, (int*) &pnNumClustersOutTmp);
+    AMD_TOOTLE_API_FUNCTION_END
+}
 
-    // copy the output back
-    if (pnIBOut &&
-        pnOutput != pnIBOut)
+// chooses the cluster of a face added by TootleUpdateOptimizedMesh: the cluster of the face that shares the most vertices with
+//  it, among the kept faces and the added faces whose cluster is chosen already.  Ties go to the cluster drawn first.
+//  vertexFaces lists (vertex, face) pairs sorted by vertex, where faces from nFaces on are added faces.
+//  Returns TOOTLE_NONE if no face shares a vertex with it.
+static UINT ChooseAddedFaceCluster(const unsigned int* pnFace, const unsigned int* pnIB, const unsigned int* pnAddedIB, UINT nFaces,
+                                   const std::vector< std::pair<UINT, UINT> >& vertexFaces, const std::vector<UINT>& faceRun,
+                                   const std::vector<UINT>& addedRun)
+{
+    UINT nBestRun = TOOTLE_NONE;
+    UINT nBestShared = 0;
+
+    for (UINT k = 0; k < 3; k++)
     {
-        memcpy(pnIBOut, pnOutput, nFaces * 3 * sizeof(unsigned int));
-        delete [] pnOutput;
-    }
+        std::vector< std::pair<UINT, UINT> >::const_iterator it =
+            std::lower_bound(vertexFaces.begin(), vertexFaces.end(), std::make_pair(pnFace[k], 0u));
 
-    float fLambda;
-    fLambda = fAlpha + (1.0f - fAlpha) * fACMR;
+        for (; it != vertexFaces.end() && it->first == pnFace[k]; it++)
+        {
+            const unsigned int* pnOther = (it->second < nFaces) ? &pnIB[3 * it->second] : &pnAddedIB[3 * (it->second - nFaces)];
+            UINT nRun = (it->second < nFaces) ? faceRun[it->second] : addedRun[it->second - nFaces];
 
-    // PERFORM LINEAR CLUSTERING based on the output of Vertex Cache Optimization algorithm (hard boundaries) and
-    //  fLambda (soft boundaries).
-    FanVertOptimizeClusterOnly((int*) pnIBOut, nVertices, nFaces, nCacheSize, fLambda, (int*) pnClustersOutTmp,
-                               pnNumClustersOutTmp, (int*) pnClustersOut, (int*) pnNumClustersOut, NULL);
+            if (pnOther == pnFace || nRun == TOOTLE_NONE)
+            {
+                continue;
+            }
 
-    delete[] pnClustersOutTmp;
+            UINT nShared = 0;
 
-    return TOOTLE_OK;
+            for (UINT a = 0; a < 3; a++)
+            {
+                for (UINT b = 0; b < 3; b++)
+                {
+                    nShared += (pnFace[a] == pnOther[b]) ? 1 : 0;
+                }
+            }
 
-    AMD_TOOTLE_API_FUNCTION_END
+            if (nShared > nBestShared || (nShared == nBestShared && nRun < nBestRun))
+            {
+                nBestShared = nShared;
+                nBestRun = nRun;
+            }
+        }
+    }
+
+    return nBestRun;
 }
 
-TootleResult TOOTLE_DLL TootleOptimizeOverdraw(const void*             pVB,
-                                               const unsigned int*     pnIB,
-                                               unsigned int            nVertices,
-                                               unsigned int            nFaces,
-                                               unsigned int            nVBStride,
-                                               const float*            pfViewpoint,
-                                               unsigned int            nViewpoints,
-                                               TootleFaceWinding       eFrontWinding,
-                                               const unsigned int*     pnFaceClusters,
-                                               unsigned int*           pnIBOut,
-                                               unsigned int*           pnClusterRemapOut,
-                                               TootleOverdrawOptimizer eOverdrawOptimizer)
+// appends to worklist the added faces that share a vertex with pnFace and are not queued yet, and marks them as queued
+static void QueueAddedFaceNeighbors(const unsigned int* pnFace, UINT nFaces,
+                                    const std::vector< std::pair<UINT, UINT> >& vertexFaces, std::vector<char>& addedQueued,
+                                    std::vector<UINT>& worklist)
+{
+    for (UINT k = 0; k < 3; k++)
+    {
+        std::vector< std::pair<UINT, UINT> >::const_iterator it =
+            std::lower_bound(vertexFaces.begin(), vertexFaces.end(), std::make_pair(pnFace[k], 0u));
+
+        for (; it != vertexFaces.end() && it->first == pnFace[k]; it++)
+        {
+            if (it->second >= nFaces && !addedQueued[it->second - nFaces])
+            {
+                addedQueued[it->second - nFaces] = 1;
+                worklist.push_back(it->second - nFaces);
+            }
+        }
+    }
+}
+
+TootleResult TOOTLE_DLL TootleUpdateOptimizedMesh(const unsigned int*   pnIB,
+                                                  const unsigned int*   pnFaceClusters,
+                                                  unsigned int          nVertices,
+                                                  unsigned int          nFaces,
+                                                  unsigned int          nCacheSize,
+                                                  const unsigned int*   pnRemovedFaces,
+                                                  unsigned int          nRemovedFaces,
+                                                  const unsigned int*   pnAddedIB,
+                                                  unsigned int          nAddedFaces,
+                                                  unsigned int*         pnIBOut,
+                                                  unsigned int*         pnFaceClustersOut,
+                                                  TootleVCacheOptimizer eVCacheOptimizer,
+                                                  unsigned int*         pnUpdatedClustersOut)
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
 
     // sanity checks
-    assert(pVB);
     assert(pnIB);
     assert(pnFaceClusters);
+    assert(pnIBOut);
+    assert(pnFaceClustersOut);
 
     if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleOptimizeOverdraw: Invalid value of nVertices"));
+        errorf(("TootleUpdateOptimizedMesh: Invalid value of nVertices"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES || nAddedFaces > TOOTLE_MAX_FACES - nFaces)
     {
-        errorf(("TootleOptimizeOverdraw: Invalid value of nFaces"));
+        errorf(("TootleUpdateOptimizedMesh: Invalid value of nFaces or nAddedFaces"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nVBStride < 3 * sizeof(float))
+    if (nRemovedFaces >= nFaces + nAddedFaces)
     {
-        errorf(("TootleOptimizeOverdraw: nVBStride less than 3*sizeof(float)"));
+        errorf(("TootleUpdateOptimizedMesh: No face is left"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // make sure that they're not being stupid and passing us bad enum values
-    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    if ((nRemovedFaces > 0 && pnRemovedFaces == NULL) || (nAddedFaces > 0 && pnAddedIB == NULL))
     {
-        errorf(("TootleOptimizeOverdraw: Invalid face winding."));
+        errorf(("TootleUpdateOptimizedMesh: pnRemovedFaces or pnAddedIB is NULL"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // Select the overdraw optimization algorithm based on the input parameter.
-    switch (eOverdrawOptimizer)
+    if (nCacheSize == 0)
     {
-        case TOOTLE_OVERDRAW_DIRECT3D:
-#ifdef _SOFTWARE_ONLY_VERSION
-            fprintf(stderr, "TootleOptimizeOverdraw: No Direct3D support for this version.\n");
-            return TOOTLE_INTERNAL_ERROR;
-#endif
-
-        case TOOTLE_OVERDRAW_AUTO:
-        case TOOTLE_OVERDRAW_RAYTRACE:
-            return TootleOptimizeOverdrawDirect3DAndRaytrace(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
-                                                             eFrontWinding, eOverdrawOptimizer, pnFaceClusters, pnIBOut,
-                                                             pnClusterRemapOut);
-            break;
-
-        case TOOTLE_OVERDRAW_FAST:
-            return TootleOptimizeOverdrawFastApproximation(pVB, pnIB, nVertices, nFaces, nVBStride,
-                                                           eFrontWinding, pnFaceClusters, pnIBOut, pnClusterRemapOut);
-            break;
-
-        default:
-            errorf(("TootleOptimizeOverdraw: eOverdrawOptimizer is invalid."));
+        errorf(("TootleUpdateOptimizedMesh: nCacheSize = 0"));
 
-            return TOOTLE_INVALID_ARGS;
+        return TOOTLE_INVALID_ARGS;
     }
 
-    AMD_TOOTLE_API_FUNCTION_END
-}
-
-static TootleResult TootleOptimizeOverdrawDirect3DAndRaytrace(const void*             pVB,
-                                                              const unsigned int*     pnIB,
-                                                              unsigned int            nVertices,
-                                                              unsigned int            nFaces,
-                                                              unsigned int            nVBStride,
-                                                              const float*            pfViewpoint,
-                                                              unsigned int            nViewpoints,
-                                                              TootleFaceWinding       eFrontWinding,
-                                                              TootleOverdrawOptimizer eOverdrawOptimizer,
-                                                              const unsigned int*     pnFaceClusters,
-                                                              unsigned int*           pnIBOut,
-                                                              unsigned int*           pnClusterRemapOut)
-{
-    // sanity checks
-    assert(pVB);
-    assert(pnIB);
-    assert(pnFaceClusters);
-
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    if (pnIBOut == pnIB || pnFaceClustersOut == pnFaceClusters)
     {
-        errorf(("TootleOptimizeOverdrawDirect3D: Invalid value of nVertices"));
+        errorf(("TootleUpdateOptimizedMesh: The outputs must not equal the inputs"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    for (UINT i = 0; i < 3 * nAddedFaces; i++)
     {
-        errorf(("TootleOptimizeOverdrawDirect3D: Invalid value of nFaces"));
+        if (pnAddedIB[i] >= nVertices)
+        {
+            errorf(("TootleUpdateOptimizedMesh: pnAddedIB references vertices beyond nVertices"));
 
-        return TOOTLE_INVALID_ARGS;
+            return TOOTLE_INVALID_ARGS;
+        }
     }
 
-    if (nVBStride < 3 * sizeof(float))
+    // find the runs of faces of each cluster.  The cluster IDs only need to be different between neighboring runs, but
+    //  a cluster must not be split into several runs.
+    std::vector<UINT> runStart;
+    std::vector<UINT> faceRun(nFaces);
+    std::vector<char> clusterSeen(nFaces, 0);
+
+    for (UINT i = 0; i < nFaces; i++)
     {
-        errorf(("TootleOptimizeOverdraw: nVBStride less than 3*sizeof(float)"));
+        if (i == 0 || pnFaceClusters[i] != pnFaceClusters[i - 1])
+        {
+            if (pnFaceClusters[i] >= nFaces || clusterSeen[ pnFaceClusters[i] ])
+            {
+                errorf(("TootleUpdateOptimizedMesh: Invalid cluster ID, or the faces of a cluster are not contiguous"));
 
-        return TOOTLE_INVALID_ARGS;
-    }
+                return TOOTLE_INVALID_ARGS;
+            }
 
-    // make sure that they're not being stupid and passing us bad enum values
-    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
-    {
-        errorf(("TootleOptimizeOverdrawDirect3D: Invalid face winding."));
-        return TOOTLE_INVALID_ARGS;
+            clusterSeen[ pnFaceClusters[i] ] = 1;
+            runStart.push_back(i);
+        }
+
+        faceRun[i] = (UINT) runStart.size() - 1;
     }
 
-#ifndef _SOFTWARE_ONLY_VERSION
+    const UINT nRuns = (UINT) runStart.size();
+    runStart.push_back(nFaces);
 
-    if (!ODIsInitialized())
+    // mark the removed faces and their clusters
+    std::vector<char> faceRemoved(nFaces, 0);
+    std::vector<char> runUpdated(nRuns + 1, 0);
+
+    for (UINT i = 0; i < nRemovedFaces; i++)
     {
-        return TOOTLE_NOT_INITIALIZED;
-    }
+        if (pnRemovedFaces[i] >= nFaces || faceRemoved[ pnRemovedFaces[i] ])
+        {
+            errorf(("TootleUpdateOptimizedMesh: Invalid or repeated face in pnRemovedFaces"));
 
-#endif
+            return TOOTLE_INVALID_ARGS;
+        }
 
-    // perform check whether pnFaceCluster is in the full format.
-    if (!IsClusterArrayFullFormat(pnFaceClusters, nFaces))
-    {
-        ConvertClusterArrayFromCompactToFull((unsigned int*) pnFaceClusters, nFaces);
+        faceRemoved[ pnRemovedFaces[i] ] = 1;
+        runUpdated[ faceRun[ pnRemovedFaces[i] ] ] = 1;
+        faceRun[ pnRemovedFaces[i] ] = TOOTLE_NONE;
     }
 
-    // make sure that cluster array is sorted, as required
-    bool bOrdered = true;
+    // list the kept faces that share a vertex with an added face, and the added faces, by vertex.  Only this
+    //  neighborhood of the edit is searched for the clusters of the added faces.
+    std::vector<char> vertexAdded(nVertices, 0);
 
-    if (pnFaceClusters[0] != 0)
+    for (UINT i = 0; i < 3 * nAddedFaces; i++)
     {
-        bOrdered = false;
+        vertexAdded[ pnAddedIB[i] ] = 1;
     }
 
-    for (UINT i = 1;  i < nFaces; i++)
+    std::vector< std::pair<UINT, UINT> > vertexFaces;
+
+    for (UINT i = 0; nAddedFaces > 0 && i < 3 * nFaces; i++)
     {
-        int x = pnFaceClusters[i] - pnFaceClusters[i - 1];
+        if (pnIB[i] >= nVertices)
+        {
+            errorf(("TootleUpdateOptimizedMesh: pnIB references vertices beyond nVertices"));
 
-        if (x < 0 || x > 1)
+            return TOOTLE_INVALID_ARGS;
+        }
+
+        if (vertexAdded[ pnIB[i] ] && !faceRemoved[i / 3])
         {
-            bOrdered = false;
-            break;
+            vertexFaces.push_back(std::make_pair(pnIB[i], i / 3));
         }
     }
 
-    if (!bOrdered)
+    for (UINT i = 0; i < 3 * nAddedFaces; i++)
     {
-        errorf(("TootleOptimizeOverdrawDirect3D: Cluster array is not ordered."));
-
-        return TOOTLE_INVALID_ARGS;
+        vertexFaces.push_back(std::make_pair(pnAddedIB[i], nFaces + i / 3));
     }
 
-    // if there is only one cluster, do nothing, just pass through
-    // if we don't do this, various pieces of code will break
-    UINT nClusters = 1 + pnFaceClusters[nFaces - 1];
+    std::sort(vertexFaces.begin(), vertexFaces.end());
 
-    if (nClusters == 1)
+    // grow the clusters around the edit into the added faces, breadth first from the added faces that touch a kept face.
+    //  Each added face is given a cluster once, when it leaves the worklist, and queues its added neighbors.  The added
+    //  faces that are never reached touch no cluster, and form a new cluster drawn last.
+    std::vector<UINT> addedRun(nAddedFaces, TOOTLE_NONE);
+    std::vector<char> addedQueued(nAddedFaces, 0);
+    std::vector<UINT> worklist;
+
+    for (UINT i = 0; i < vertexFaces.size();)
     {
-        if (pnClusterRemapOut)
+        UINT j = i;
+        bool bKeptVertex = false;
+
+        for (; j < vertexFaces.size() && vertexFaces[j].first == vertexFaces[i].first; j++)
         {
-            *pnClusterRemapOut = 0;
+            bKeptVertex |= (vertexFaces[j].second < nFaces);
         }
 
-        if (pnIBOut)
+        for (; bKeptVertex && i < j; i++)
         {
-            memcpy(pnIBOut, pnIB, sizeof(unsigned int)*nFaces * 3);
+            if (vertexFaces[i].second >= nFaces)
+            {
+                addedQueued[ vertexFaces[i].second - nFaces ] = 1;
+            }
         }
 
-        return TOOTLE_OK;
+        i = j;
     }
 
-    // use default viewpoints if they were omitted
-    if (!pfViewpoint)
+    for (UINT i = 0; i < nAddedFaces; i++)
     {
-        pfViewpoint = pDefaultViewpoint;
-        nViewpoints = nDefaultViewpoints;
+        if (addedQueued[i])
+        {
+            worklist.push_back(i);
+        }
     }
 
-    // make some soup
-    Soup soup;
-
-    if (!MakeSoup(pVB, pnIB, nVertices, nFaces, nVBStride, &soup))
+    for (UINT w = 0; w < worklist.size(); w++)
     {
-        return TOOTLE_OUT_OF_MEMORY;
-    }
+        const unsigned int* pnFace = &pnAddedIB[3 * worklist[w]];
 
-    // give soup to overdraw module
-    TootleResult result;
-
-    result = ODSetSoup(&soup, eFrontWinding);
+        addedRun[ worklist[w] ] = ChooseAddedFaceCluster(pnFace, pnIB, pnAddedIB, nFaces, vertexFaces, faceRun, addedRun);
+        assert(addedRun[ worklist[w] ] != TOOTLE_NONE);
 
-    if (result != TOOTLE_OK)
-    {
-        return result;
+        QueueAddedFaceNeighbors(pnFace, nFaces, vertexFaces, addedQueued, worklist);
     }
 
-    // build one of std::vector<> things for the cluster array
-    std::vector<int> cluster;
+    std::vector< std::vector<UINT> > runAdded(nRuns + 1);
 
-    for (UINT i = 0; i < nFaces; i++)
+    for (UINT i = 0; i < nAddedFaces; i++)
     {
-        cluster.push_back (pnFaceClusters [i]);
+        UINT nRun = (addedRun[i] == TOOTLE_NONE) ? nRuns : addedRun[i];
+        runAdded[nRun].push_back(i);
+        runUpdated[nRun] = 1;
     }
 
-    //build array containing the index of the first face in each cluster
-    std::vector<int> ClusterStart;
-    UINT iLast = nClusters;
+    // write the clusters in their previous order.  Only the updated clusters are optimized again.
+    std::vector<UINT> chunkIB;
+    UINT nFacesOut = 0;
+    UINT nClustersOut = 0;
+    UINT nUpdatedClusters = 0;
 
-    for (UINT i = 0; i < nFaces; i++)
+    for (UINT r = 0; r <= nRuns; r++)
     {
-        if (pnFaceClusters[i] != iLast)
-        {
-            iLast = pnFaceClusters[i];
+        UINT nRunFaces = 0;
 
-            ClusterStart.push_back (i);
+        if (r == nRuns && !runUpdated[r])
+        {
+            // no new cluster
+            break;
         }
-    }
 
-    // last element needs to contain the number of faces in the mesh. Various pieces of code depend on this
-    ClusterStart.push_back (nFaces);
+        if (!runUpdated[r])
+        {
+            nRunFaces = runStart[r + 1] - runStart[r];
+            memcpy(&pnIBOut[3 * nFacesOut], &pnIB[3 * runStart[r]], 3 * nRunFaces * sizeof(UINT));
+        }
+        else
+        {
+            chunkIB.clear();
 
-    //compute the overdraw graph
-    std::vector<t_edge> graph;
-    result = ODOverdrawGraph(pfViewpoint, nViewpoints,
-                             (eFrontWinding != TOOTLE_CCW),    // cull CCW faces if they aren't front facing
-                             cluster, ClusterStart, graph, eOverdrawOptimizer);
+            if (r < nRuns)
+            {
+                for (UINT i = runStart[r]; i < runStart[r + 1]; i++)
+                {
+                    if (!faceRemoved[i])
+                    {
+                        chunkIB.insert(chunkIB.end(), &pnIB[3 * i], &pnIB[3 * i + 3]);
+                    }
+                }
+            }
 
-    if (result != TOOTLE_OK)
-    {
-        return result;
-    }
+            for (UINT i = 0; i < runAdded[r].size(); i++)
+            {
+                chunkIB.insert(chunkIB.end(), &pnAddedIB[3 * runAdded[r][i]], &pnAddedIB[3 * runAdded[r][i] + 3]);
+            }
 
-    //reorder clusters
-    std::vector<int> order (nClusters);
+            nRunFaces = (UINT) chunkIB.size() / 3;
 
-    if (graph.size() != 0)
-    {
-        if (!feedback(nClusters, static_cast<int> (graph.size()), &graph[0], &order[0]))
-        {
-            return TOOTLE_OUT_OF_MEMORY;
-        }
-    }
-    else
-    {
-        // this means that there is no overdraw anywhere on the model, so just keep the current cluster order
-        for (UINT i = 0; i < nClusters; i++)
-        {
-            order[i] = i;
-        }
+            if (nRunFaces == 0)
+            {
+                continue;
+            }
 
-    }
+            TootleResult result = OptimizeVCacheLocal(&chunkIB[0], nRunFaces, nCacheSize, eVCacheOptimizer, &pnIBOut[3 * nFacesOut]);
 
-    //reorder triangles in soup based on cluster reordering
-    std::vector<Soup::Triangle> tt = soup.t();
+            if (result != TOOTLE_OK)
+            {
+                return result;
+            }
 
-    int j = 0;
+            nUpdatedClusters++;
+        }
 
-    for (int i = 0; i < static_cast<int>(order.size()); i++)
-    {
-        for (int k = ClusterStart[order[i]]; k < ClusterStart[order[i] + 1]; k++)
+        for (UINT i = 0; i < nRunFaces; i++)
         {
-            soup.t(j) = tt[k];
-            cluster[j] = i; //number clusters sequentially in the file
-            j++;
+            pnFaceClustersOut[nFacesOut + i] = nClustersOut;
         }
-    }
 
-    // copy to output arrays
-    if (pnIBOut)
-    {
-        // TODO:  Someday we should fix this memcpy of int to unsigned int
-        memcpy(pnIBOut, (unsigned int*)&soup.t(0), sizeof(int)*nFaces * 3);
+        nFacesOut += nRunFaces;
+        nClustersOut++;
     }
 
-    if (pnClusterRemapOut)
+    assert(nFacesOut == nFaces - nRemovedFaces + nAddedFaces);
+    pnFaceClustersOut[nFacesOut] = nClustersOut;
+
+    if (pnUpdatedClustersOut)
     {
-        memcpy(pnClusterRemapOut, &(order[0]), sizeof(UINT) * nClusters);
+        *pnUpdatedClustersOut = nUpdatedClusters;
     }
 
     return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
 }
 
-static TootleResult TootleOptimizeOverdrawFastApproximation(const void*         pVB,
-                                                            const unsigned int* pnIB,
-                                                            unsigned int        nVertices,
-                                                            unsigned int        nFaces,
-                                                            unsigned int        nVBStride,
-                                                            TootleFaceWinding   eFrontWinding,
-                                                            const unsigned int* pnFaceClusters,
-                                                            unsigned int*       pnIBOut,
-                                                            unsigned int*       pnClusterRemapOut)
+#ifndef _SOFTWARE_ONLY_VERSION
+static TootleResult TootleOptimizeVCacheDirect3D(const unsigned int* pnIB,
+                                                 unsigned int        nFaces,
+                                                 unsigned int        nVertices,
+                                                 unsigned int        nCacheSize,
+                                                 unsigned int*       pnIBOut,
+                                                 unsigned int*       pnFaceRemapOut)
 {
     // sanity checks
-    assert(pVB);
     assert(pnIB);
-    assert(pnFaceClusters);
-    assert(pnIBOut);
-
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
-    {
-        errorf(("TootleOptimizeOverdrawFastApproximation: nVertices is invalid."));
-
-        return TOOTLE_INVALID_ARGS;
-    }
 
     if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
     {
-        errorf(("TootleOptimizeOverdrawFastApproximation: nFaces is invalid."));
+        errorf(("TootleOptimizeVCacheDirect3D: Invalid value of nFaces"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nVBStride < 3 * sizeof(float))
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleOptimizeOverdrawFastApproximation: nVBStride less than 3*sizeof(float)"));
+        errorf(("TootleOptimizeVCacheDirect3D: Invalid value of nVertices"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // make sure that they're not being stupid and passing us bad enum values
-    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    if (nCacheSize == 0)
     {
-        errorf(("TootleOptimizeOverdrawFastApproximation: Invalid face winding."));
+        errorf(("TootleOptimizeVCacheDirect3D: nCacheSize = 0"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // perform check whether pnFaceCluster is in the compact format.
-    if (!IsClusterArrayCompactFormat(pnFaceClusters, nFaces))
-    {
-        ConvertClusterArrayFromFullToCompact((unsigned int*) pnFaceClusters, nFaces);
-    }
-
-    unsigned int* pnOutput = pnIBOut;
-
-    // if source and destination buffer are the same, we need a local copy
+    auto pFaceRemap = 
+#ifdef _DX11_1_
+                    new uint32_t[nFaces];
+#else
+                    new DWORD[ nFaces ];
+#endif
+    HRESULT hres = D3D_OK;
+
+    if (nFaces == 1)
+    {
+        // D3DX doesn't like it if we optimize a single face (we'll get an internal error), so just pass through
+        *pFaceRemap = 0;
+    }
+    else
+    {
+#ifdef _DX11_1_
+
+        hres = DirectX::OptimizeFaces(pnIB, nFaces, nullptr, pFaceRemap);
+#else
+        // use D3DX for optimization
+        hres = D3DXOptimizeFaces(pnIB, nFaces, nVertices, true, pFaceRemap);
+#endif
+    }
+
+    if (hres == D3D_OK)
+    {
+        // re-order faces
+        if (pnIBOut)
+        {
+            for (UINT i = 0; i < nFaces; i++)
+            {
+                for (UINT j = 0; j < 3; j++)
+                {
+                    pnIBOut[(3 * i) + j ] = pnIB[(3 * pFaceRemap[i]) + j ];
+                }
+            }
+        }
+
+        // copy face re-mapping if user wants it
+        if (pnFaceRemapOut)
+        {
+            memcpy(pnFaceRemapOut, pFaceRemap, sizeof(UINT)*nFaces);
+        }
+    }
+
+    delete[] pFaceRemap;
+
+    switch (hres)
+    {
+        case D3D_OK:
+            return TOOTLE_OK;
+
+        case E_OUTOFMEMORY:
+            return TOOTLE_OUT_OF_MEMORY;
+
+        default:
+            return TOOTLE_INTERNAL_ERROR;
+    }
+}
+#endif
+
+static TootleResult TootleOptimizeVCacheLStrips(const unsigned int* pnIB,
+                                                unsigned int        nFaces,
+                                                unsigned int        nVertices,
+                                                unsigned int        nCacheSize,
+                                                unsigned int*       pnIBOut,
+                                                unsigned int*       pnFaceRemapOut)
+{
+    // sanity checks
+    assert(pnIB);
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleOptimizeVCacheLStrips: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleOptimizeVCacheLStrips: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleOptimizeVCacheLStrips: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    unsigned int* pnStripResult = new unsigned int[ nFaces * 3 ];
+
+    Stripifier::Process(pnIB, nFaces, nCacheSize, pnStripResult, pnFaceRemapOut);
+
+    // re-order faces
     if (pnIBOut)
     {
-        if (pnIB == pnIBOut)
+        for (UINT i = 0; i < nFaces * 3; i++)
+        {
+            pnIBOut[ i ] = pnStripResult[ i ];
+        }
+    }
+
+    TootleResult result = TOOTLE_OK;
+
+    delete[] pnStripResult;
+
+    return result;
+}
+
+static TootleResult TootleOptimizeVCacheTipsy(const unsigned int* pnIB,
+                                              unsigned int        nFaces,
+                                              unsigned int        nVertices,
+                                              unsigned int        nCacheSize,
+                                              unsigned int*       pnIBOut,
+                                              unsigned int*       pnFaceRemapOut,
+                                              bool                bCompressTies,
+                                              int*                piVertexMap)
+{
+    // sanity checks
+    assert(pnIB);
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleOptimizeVCacheTipsy: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleOptimizeVCacheTipsy: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleOptimizeVCacheTipsy: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    FanVertOptimizeVCacheOnly((int*) pnIB, (int*) pnIBOut, nVertices, nFaces, nCacheSize, NULL, NULL, NULL, bCompressTies,
+                              piVertexMap);
+
+    // if the face remapping is requested, compute it for the caller.
+    // Perhaps, this information should be generated as the indices get built in FanVertOptimizeVCache to be
+    //  more efficient.
+    if (pnFaceRemapOut)
+    {
+        UINT nFaceMap;
+        TootleResult result;
+
+        for (UINT i = 0; i < nFaces; i++)
+        {
+            result = FindFaceMappingFromIndex(pnIB, pnIBOut, i, nFaces, &nFaceMap);
+
+            if (result != TOOTLE_OK)
+            {
+                return result;
+            }
+
+            pnFaceRemapOut[i] = nFaceMap;
+        }
+    }
+
+    return TOOTLE_OK;
+}
+
+TootleResult TOOTLE_DLL TootleClusterMeshEx(const void*         pVB,
+                                            const unsigned int* pnIB,
+                                            unsigned int        nVertices,
+                                            unsigned int        nFaces,
+                                            unsigned int        nVBStride,
+                                            unsigned int        nTargetClusters,
+                                            unsigned int*       pnClusteredIBOut,
+                                            unsigned int*       pnFaceClustersOut,
+                                            unsigned int*       pnFaceRemapOut,
+                                            unsigned int        nMemoryBudgetMB)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+    assert(pnClusteredIBOut);
+    assert(pnFaceClustersOut);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleClusterMesh: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleClusterMesh: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleClusterMesh: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    const UINT nEstimatedClusters = (nTargetClusters != 0) ? std::min(nTargetClusters, nFaces) : TypicalClusterCount(nFaces);
+
+    if (!FitsMemoryBudget(EstimateClusterMemory(nVertices, nFaces, nEstimatedClusters), nMemoryBudgetMB))
+    {
+        errorf(("TootleClusterMesh: The clustering does not fit in nMemoryBudgetMB"));
+
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+    // because Pedro's clustering implementation is so heavily tied to the Soup/Mesh classes, it's easier just to
+    // construct a soup here eventually we should re-work the code to avoid this redundant copying.
+
+    Soup soup;
+
+    if (!MakeSoup(pVB, pnIB, nVertices, nFaces, nVBStride, &soup))
+    {
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+    // cluster the mesh
+    UINT nClusters = nTargetClusters;
+    std::vector<int> clusterIDs;
+    ClusterResult result = Cluster(&soup, nClusters, clusterIDs);
+
+    switch (result)
+    {
+        case CLUSTER_OK:              break;
+
+        case CLUSTER_OUT_OF_MEMORY:   return TOOTLE_OUT_OF_MEMORY;
+
+        default:                      return TOOTLE_INTERNAL_ERROR;
+    }
+
+    // create an array to hold the face re-mapping
+    // use the output array if the user provided one, otherwise, allocate a new one
+    UINT* pnRemap = pnFaceRemapOut;
+
+    if (!pnRemap)
+    {
+        pnRemap = new UINT[ nFaces ];
+    }
+
+    if (!SortFacesByCluster(soup, clusterIDs, pnRemap))
+    {
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+    if (pnRemap != pnFaceRemapOut)
+    {
+        // don't need this temporary array anymore
+        delete[] pnRemap;
+    }
+
+    // copy clustered mesh to output array
+
+    // once again, we're memcpying int to unsigned int.
+    // This should be ok because, if clustering worked, all cluster IDs will be positive
+    // We should still fix it eventually though
+    memcpy(pnFaceClustersOut, &clusterIDs[0], sizeof(int)*clusterIDs.size());
+    memcpy(pnClusteredIBOut, &soup.t(0), sizeof(int)*soup.t().size() * 3);
+
+    // Append the number of cluster to the last element of the array.
+    // This is to ensure we can mix and match the full (old tootle) and compact (new tootle) format.
+    pnFaceClustersOut[nFaces] = 1 + pnFaceClustersOut[nFaces - 1];
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleClusterMesh(const void*         pVB,
+                                          const unsigned int* pnIB,
+                                          unsigned int        nVertices,
+                                          unsigned int        nFaces,
+                                          unsigned int        nVBStride,
+                                          unsigned int        nTargetClusters,
+                                          unsigned int*       pnClusteredIBOut,
+                                          unsigned int*       pnFaceClustersOut,
+                                          unsigned int*       pnFaceRemapOut)
+{
+    return TootleClusterMeshEx(pVB, pnIB, nVertices, nFaces, nVBStride, nTargetClusters, pnClusteredIBOut, pnFaceClustersOut,
+                               pnFaceRemapOut);
+}
+
+TootleResult TOOTLE_DLL TootleFastOptimizeVCacheAndClusterMesh(const unsigned int* pnIB,
+                                                               unsigned int        nFaces,
+                                                               unsigned int        nVertices,
+                                                               unsigned int        nCacheSize,
+                                                               unsigned int*       pnIBOut,
+                                                               unsigned int*       pnClustersOut,
+                                                               unsigned int*       pnNumClustersOut,
+                                                               float               fAlpha)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pnIB);
+    assert(pnIBOut);
+    assert(pnClustersOut);
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleFastOptimizeVCacheAndClusterMesh: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleFastOptimizeVCacheAndClusterMesh: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleOptimizeVCacheAndClusterMesh: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    unsigned int* pnOutput = pnIBOut;
+
+    // if source and destination buffer are the same, we need a local copy
+    if (pnIBOut)
+    {
+        if (pnIB == pnIBOut)
+        {
+            pnOutput = new unsigned int[ 3 * nFaces ];
+        }
+    }
+
+    float         fACMR;
+    unsigned int* pnClustersOutTmp;
+    unsigned int  pnNumClustersOutTmp;
+
+    pnClustersOutTmp = new unsigned int [ nFaces + 1 ];
+
+    // OPTIMIZE VERTEX CACHE
+    fACMR = FanVertOptimizeVCacheOnly((int*) pnIB, (int*) pnOutput, nVertices, nFaces, nCacheSize, NULL,
+                                      (int*) pnClustersOutTmp, (int*) &pnNumClustersOutTmp);
+
+    // copy the output back
+    if (pnIBOut &&
+        pnOutput != pnIBOut)
+    {
+        memcpy(pnIBOut, pnOutput, nFaces * 3 * sizeof(unsigned int));
+        delete [] pnOutput;
+    }
+
+    float fLambda;
+    fLambda = fAlpha + (1.0f - fAlpha) * fACMR;
+
+    // PERFORM LINEAR CLUSTERING based on the output of Vertex Cache Optimization algorithm (hard boundaries) and
+    //  fLambda (soft boundaries).
+    FanVertOptimizeClusterOnly((int*) pnIBOut, nVertices, nFaces, nCacheSize, fLambda, (int*) pnClustersOutTmp,
+                               pnNumClustersOutTmp, (int*) pnClustersOut, (int*) pnNumClustersOut, NULL);
+
+    delete[] pnClustersOutTmp;
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleGenerateViewpoints(TootleViewpointSampling eSampling,
+                                                 unsigned int            nSphereViewpoints,
+                                                 const float*            pfConeAxis,
+                                                 float                   fConeAngle,
+                                                 float*                  pfViewpointsOut,
+                                                 unsigned int*           pnViewpointsOut)
+{
+    // sanity checks
+    assert(pnViewpointsOut);
+
+    if (nSphereViewpoints == 0 || nSphereViewpoints > TOOTLE_MAX_VIEWPOINTS)
+    {
+        errorf(("TootleGenerateViewpoints: nSphereViewpoints is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (eSampling != TOOTLE_VIEWPOINT_GEODESIC && eSampling != TOOTLE_VIEWPOINT_FIBONACCI)
+    {
+        errorf(("TootleGenerateViewpoints: eSampling is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // without a cone, the whole sphere is a cone around any axis
+    float pfAxis[3] = { 0, 0, 1 };
+    float fCosAngle = -1;
+
+    if (pfConeAxis)
+    {
+        const float fLength = sqrtf(pfConeAxis[0] * pfConeAxis[0] + pfConeAxis[1] * pfConeAxis[1] +
+                                    pfConeAxis[2] * pfConeAxis[2]);
+
+        if (!(fLength > 0 && std::isfinite(fLength)))
+        {
+            errorf(("TootleGenerateViewpoints: pfConeAxis must be a non-zero vector"));
+
+            return TOOTLE_INVALID_ARGS;
+        }
+
+        if (!(fConeAngle > 0 && fConeAngle <= 180))
+        {
+            errorf(("TootleGenerateViewpoints: fConeAngle must be in (0, 180]"));
+
+            return TOOTLE_INVALID_ARGS;
+        }
+
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            pfAxis[c] = pfConeAxis[c] / fLength;
+        }
+
+        fCosAngle = (fConeAngle < 180) ? (float) cos(fConeAngle * SCALAR_TORADIAN) : -1.0f;
+    }
+
+    unsigned int nViewpoints;
+
+    if (eSampling == TOOTLE_VIEWPOINT_GEODESIC)
+    {
+        nViewpoints = GenerateGeodesicViewpoints(GeodesicFrequency(nSphereViewpoints), pfAxis, fCosAngle, pfViewpointsOut);
+
+        // a cone between the viewpoints still gets one
+        if (nViewpoints == 0)
+        {
+            if (pfViewpointsOut)
+            {
+                memcpy(pfViewpointsOut, pfAxis, sizeof(pfAxis));
+            }
+
+            nViewpoints = 1;
+        }
+    }
+    else
+    {
+        nViewpoints = FibonacciViewpointCount(nSphereViewpoints, fCosAngle);
+
+        if (pfViewpointsOut)
+        {
+            GenerateFibonacciViewpoints(nViewpoints, pfAxis, fCosAngle, pfViewpointsOut);
+        }
+    }
+
+    *pnViewpointsOut = nViewpoints;
+
+    return TOOTLE_OK;
+}
+
+TootleResult TOOTLE_DLL TootleOptimizeOverdrawEx(const void*             pVB,
+                                                 const unsigned int*     pnIB,
+                                                 unsigned int            nVertices,
+                                                 unsigned int            nFaces,
+                                                 unsigned int            nVBStride,
+                                                 const float*            pfViewpoint,
+                                                 unsigned int            nViewpoints,
+                                                 TootleFaceWinding       eFrontWinding,
+                                                 const unsigned int*     pnFaceClusters,
+                                                 unsigned int*           pnIBOut,
+                                                 unsigned int*           pnClusterRemapOut,
+                                                 TootleOverdrawOptimizer eOverdrawOptimizer,
+                                                 unsigned int            nMemoryBudgetMB,
+                                                 TootleOverdrawCostModel eCostModel)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+    assert(pnFaceClusters);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleOptimizeOverdraw: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleOptimizeOverdraw: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleOptimizeOverdraw: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // make sure that they're not being stupid and passing us bad enum values
+    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("TootleOptimizeOverdraw: Invalid face winding."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (eCostModel != TOOTLE_OVERDRAW_COST_PLAIN && eCostModel != TOOTLE_OVERDRAW_COST_HIZ &&
+        eCostModel != TOOTLE_OVERDRAW_COST_PREPASS)
+    {
+        errorf(("TootleOptimizeOverdraw: Invalid overdraw cost model."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // the hierarchical Z buffer is only modelled by the ray tracer
+    if (eCostModel != TOOTLE_OVERDRAW_COST_PLAIN &&
+        (eOverdrawOptimizer == TOOTLE_OVERDRAW_AUTO || eOverdrawOptimizer == TOOTLE_OVERDRAW_DIRECT3D))
+    {
+        eOverdrawOptimizer = TOOTLE_OVERDRAW_RAYTRACE;
+    }
+
+    // within a memory budget, fall back to the fast approximation, or fail before allocating.  The last element of the cluster
+    //  array holds the number of clusters in both formats.
+    const UINT nClusters = pnFaceClusters[nFaces];
+    eOverdrawOptimizer = ChooseOverdrawOptimizer(eOverdrawOptimizer, nVertices, nFaces, nClusters, nMemoryBudgetMB);
+
+    if (!FitsMemoryBudget(EstimateOverdrawMemory(eOverdrawOptimizer, nVertices, nFaces, nClusters), nMemoryBudgetMB))
+    {
+        errorf(("TootleOptimizeOverdraw: The optimization does not fit in nMemoryBudgetMB"));
+
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+    // Select the overdraw optimization algorithm based on the input parameter.
+    switch (eOverdrawOptimizer)
+    {
+        case TOOTLE_OVERDRAW_DIRECT3D:
+#ifdef _SOFTWARE_ONLY_VERSION
+            fprintf(stderr, "TootleOptimizeOverdraw: No Direct3D support for this version.\n");
+            return TOOTLE_INTERNAL_ERROR;
+#endif
+
+        case TOOTLE_OVERDRAW_AUTO:
+        case TOOTLE_OVERDRAW_RAYTRACE:
+            return TootleOptimizeOverdrawDirect3DAndRaytrace(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
+                                                               eFrontWinding, eOverdrawOptimizer, eCostModel, pnFaceClusters,
+                                                               pnIBOut, pnClusterRemapOut);
+            break;
+
+        case TOOTLE_OVERDRAW_FAST:
+            return TootleOptimizeOverdrawFastApproximation(pVB, pnIB, nVertices, nFaces, nVBStride,
+                                                             eFrontWinding, pnFaceClusters, pnIBOut, pnClusterRemapOut);
+            break;
+
+        default:
+            errorf(("TootleOptimizeOverdraw: eOverdrawOptimizer is invalid."));
+
+            return TOOTLE_INVALID_ARGS;
+    }
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleOptimizeOverdraw(const void*             pVB,
+                                               const unsigned int*     pnIB,
+                                               unsigned int            nVertices,
+                                               unsigned int            nFaces,
+                                               unsigned int            nVBStride,
+                                               const float*            pfViewpoint,
+                                               unsigned int            nViewpoints,
+                                               TootleFaceWinding       eFrontWinding,
+                                               const unsigned int*     pnFaceClusters,
+                                               unsigned int*           pnIBOut,
+                                               unsigned int*           pnClusterRemapOut,
+                                               TootleOverdrawOptimizer eOverdrawOptimizer)
+{
+    return TootleOptimizeOverdrawEx(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints, eFrontWinding,
+                                    pnFaceClusters, pnIBOut, pnClusterRemapOut, eOverdrawOptimizer);
+}
+
+static TootleResult TootleOptimizeOverdrawDirect3DAndRaytrace(const void*             pVB,
+                                                              const unsigned int*     pnIB,
+                                                              unsigned int            nVertices,
+                                                              unsigned int            nFaces,
+                                                              unsigned int            nVBStride,
+                                                              const float*            pfViewpoint,
+                                                              unsigned int            nViewpoints,
+                                                              TootleFaceWinding       eFrontWinding,
+                                                              TootleOverdrawOptimizer eOverdrawOptimizer,
+                                                              TootleOverdrawCostModel eCostModel,
+                                                              const unsigned int*     pnFaceClusters,
+                                                              unsigned int*           pnIBOut,
+                                                              unsigned int*           pnClusterRemapOut)
+{
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+    assert(pnFaceClusters);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleOptimizeOverdrawDirect3D: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleOptimizeOverdrawDirect3D: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleOptimizeOverdraw: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // make sure that they're not being stupid and passing us bad enum values
+    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("TootleOptimizeOverdrawDirect3D: Invalid face winding."));
+        return TOOTLE_INVALID_ARGS;
+    }
+
+#ifndef _SOFTWARE_ONLY_VERSION
+
+    if (!ODIsInitialized())
+    {
+        return TOOTLE_NOT_INITIALIZED;
+    }
+
+#endif
+
+    // perform check whether pnFaceCluster is in the full format.
+    if (!IsClusterArrayFullFormat(pnFaceClusters, nFaces))
+    {
+        ConvertClusterArrayFromCompactToFull((unsigned int*) pnFaceClusters, nFaces);
+    }
+
+    // make sure that cluster array is sorted, as required
+    bool bOrdered = true;
+
+    if (pnFaceClusters[0] != 0)
+    {
+        bOrdered = false;
+    }
+
+    for (UINT i = 1;  i < nFaces; i++)
+    {
+        int x = pnFaceClusters[i] - pnFaceClusters[i - 1];
+
+        if (x < 0 || x > 1)
+        {
+            bOrdered = false;
+            break;
+        }
+    }
+
+    if (!bOrdered)
+    {
+        errorf(("TootleOptimizeOverdrawDirect3D: Cluster array is not ordered."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // if there is only one cluster, do nothing, just pass through
+    // if we don't do this, various pieces of code will break
+    UINT nClusters = 1 + pnFaceClusters[nFaces - 1];
+
+    if (nClusters == 1)
+    {
+        if (pnClusterRemapOut)
+        {
+            *pnClusterRemapOut = 0;
+        }
+
+        if (pnIBOut)
+        {
+            memcpy(pnIBOut, pnIB, sizeof(unsigned int)*nFaces * 3);
+        }
+
+        return TOOTLE_OK;
+    }
+
+    // use default viewpoints if they were omitted
+    if (!pfViewpoint)
+    {
+        pfViewpoint = pDefaultViewpoint;
+        nViewpoints = nDefaultViewpoints;
+    }
+
+    // make some soup
+    Soup soup;
+
+    if (!MakeSoup(pVB, pnIB, nVertices, nFaces, nVBStride, &soup))
+    {
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+    // give soup to overdraw module
+    TootleResult result;
+
+    result = ODSetSoup(&soup, eFrontWinding);
+
+    if (result != TOOTLE_OK)
+    {
+        return result;
+    }
+
+    // build one of std::vector<> things for the cluster array
+    std::vector<int> cluster;
+
+    for (UINT i = 0; i < nFaces; i++)
+    {
+        cluster.push_back (pnFaceClusters [i]);
+    }
+
+    //build array containing the index of the first face in each cluster
+    std::vector<int> ClusterStart;
+    UINT iLast = nClusters;
+
+    for (UINT i = 0; i < nFaces; i++)
+    {
+        if (pnFaceClusters[i] != iLast)
+        {
+            iLast = pnFaceClusters[i];
+
+            ClusterStart.push_back (i);
+        }
+    }
+
+    // last element needs to contain the number of faces in the mesh. Various pieces of code depend on this
+    ClusterStart.push_back (nFaces);
+
+    //compute the overdraw graph
+    std::vector<t_edge> graph;
+    result = ODOverdrawGraph(pfViewpoint, nViewpoints,
+                             (eFrontWinding != TOOTLE_CCW),    // cull CCW faces if they aren't front facing
+                             cluster, ClusterStart, graph, eOverdrawOptimizer, eCostModel);
+
+    if (result != TOOTLE_OK)
+    {
+        return result;
+    }
+
+    //reorder clusters
+    std::vector<int> order (nClusters);
+
+    if (graph.size() != 0)
+    {
+        if (!feedback(nClusters, static_cast<int> (graph.size()), &graph[0], &order[0]))
+        {
+            return TOOTLE_OUT_OF_MEMORY;
+        }
+    }
+    else
+    {
+        // this means that there is no overdraw anywhere on the model, so just keep the current cluster order
+        for (UINT i = 0; i < nClusters; i++)
+        {
+            order[i] = i;
+        }
+
+    }
+
+    //reorder triangles in soup based on cluster reordering
+    std::vector<Soup::Triangle> tt = soup.t();
+
+    int j = 0;
+
+    for (int i = 0; i < static_cast<int>(order.size()); i++)
+    {
+        for (int k = ClusterStart[order[i]]; k < ClusterStart[order[i] + 1]; k++)
+        {
+            soup.t(j) = tt[k];
+            cluster[j] = i; //number clusters sequentially in the file
+            j++;
+        }
+    }
+
+    // copy to output arrays
+    if (pnIBOut)
+    {
+        // TODO:  Someday we should fix this memcpy of int to unsigned int
+        memcpy(pnIBOut, (unsigned int*)&soup.t(0), sizeof(int)*nFaces * 3);
+    }
+
+    if (pnClusterRemapOut)
+    {
+        memcpy(pnClusterRemapOut, &(order[0]), sizeof(UINT) * nClusters);
+    }
+
+    return TOOTLE_OK;
+}
+
+static TootleResult TootleOptimizeOverdrawFastApproximation(const void*         pVB,
+                                                            const unsigned int* pnIB,
+                                                            unsigned int        nVertices,
+                                                            unsigned int        nFaces,
+                                                            unsigned int        nVBStride,
+                                                            TootleFaceWinding   eFrontWinding,
+                                                            const unsigned int* pnFaceClusters,
+                                                            unsigned int*       pnIBOut,
+                                                            unsigned int*       pnClusterRemapOut)
+{
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+    assert(pnFaceClusters);
+    assert(pnIBOut);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleOptimizeOverdrawFastApproximation: nVertices is invalid."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleOptimizeOverdrawFastApproximation: nFaces is invalid."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleOptimizeOverdrawFastApproximation: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // make sure that they're not being stupid and passing us bad enum values
+    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("TootleOptimizeOverdrawFastApproximation: Invalid face winding."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // perform check whether pnFaceCluster is in the compact format.
+    if (!IsClusterArrayCompactFormat(pnFaceClusters, nFaces))
+    {
+        ConvertClusterArrayFromFullToCompact((unsigned int*) pnFaceClusters, nFaces);
+    }
+
+    unsigned int* pnOutput = pnIBOut;
+
+    // if source and destination buffer are the same, we need a local copy
+    if (pnIBOut)
+    {
+        if (pnIB == pnIBOut)
+        {
+            pnOutput = new unsigned int[ 3 * nFaces ];
+        }
+    }
+
+    float* pfVB = new float[ nVertices * 3 ];
+
+    // make a packed version of the vertex buffer.
+    unsigned int nVertexPositionSize = 3 * sizeof(float);
+    const char*  pVBuffer            = (const char*) pVB;
+
+    for (unsigned int i = 0; i < nVertices; i++)
+    {
+        memcpy(&pfVB[ 3 * i ], pVBuffer, nVertexPositionSize);
+
+        pVBuffer += nVBStride;
+    }
+
+    FanVertOptimizeOverdrawOnly(pfVB, (int*) pnIB, (int*) pnOutput, nVertices, nFaces,
+                                eFrontWinding, (int*) pnFaceClusters, pnFaceClusters[ nFaces ],
+                                NULL, (int*) pnClusterRemapOut);
+
+    // copy the output back
+    if (pnIBOut &&
+        pnOutput != pnIBOut)
+    {
+        memcpy(pnIBOut, pnOutput, nFaces * 3 * sizeof(unsigned int));
+        delete[] pnOutput;
+    }
+
+    delete[] pfVB;
+
+    return TOOTLE_OK;
+}
+
+//=================================================================================================================================
+/// This method should be called when the application is finished Tootling.
+/// Failure to call this function when the application is finished Tootling will result in resource leaks
+//=================================================================================================================================
+void TOOTLE_DLL TootleCleanup()
+{
+    try 
+    {
+        // clean up overdraw module
+        if (ODIsInitialized ()) {
+            ODCleanup ();
+        }
+    }
+    catch (...)         
+    {
+    }
+}
+
+TootleResult TOOTLE_DLL TootleOptimizeEx(const void*             pVB,
+                                         const unsigned int*     pnIB,
+                                         unsigned int            nVertices,
+                                         unsigned int            nFaces,
+                                         unsigned int            nVBStride,
+                                         unsigned int            nCacheSize,
+                                         const float*            pViewpoints,
+                                         unsigned int            nViewpoints,
+                                         TootleFaceWinding       eFrontWinding,
+                                         unsigned int*           pnIBOut,
+                                         unsigned int*           pnNumClustersOut,
+                                         TootleVCacheOptimizer   eVCacheOptimizer,
+                                         TootleOverdrawOptimizer eOverdrawOptimizer,
+                                         unsigned int            nMemoryBudgetMB,
+                                         TootleOverdrawCostModel eCostModel)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+    assert(pnIBOut);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleOptimize: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleOptimize: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleOptimize: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleOptimize: nVBStride is less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // make sure that they're not being stupid and passing us bad enum values
+    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("Invalid face winding."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    TootleResult result;
+
+    // each step checks the budget again, once the number of clusters is known
+    result = EstimateMemory(TOOTLE_FUNCTION_OPTIMIZE, nVertices, nFaces, nCacheSize, 0, eVCacheOptimizer, eOverdrawOptimizer,
+                            nMemoryBudgetMB, NULL);
+
+    if (result != TOOTLE_OK)
+    {
+        errorf(("TootleOptimize: The optimization does not fit in nMemoryBudgetMB"));
+
+        return result;
+    }
+
+    // allocate an array to hold the cluster ID for each face
+    unsigned int* pnFaceClusters = new unsigned int[ nFaces + 1 ];
+
+    // cluster the mesh, and sort faces by cluster
+    result = TootleClusterMeshEx(pVB, pnIB, nVertices, nFaces, nVBStride, 0, pnIBOut, pnFaceClusters, NULL, nMemoryBudgetMB);
+
+    if (result != TOOTLE_OK)
+    {
+        return result;
+    }
+
+    // perform vertex cache optimization on the clustered mesh
+    result = TootleVCacheClustersEx(pnIBOut, nFaces, nVertices, nCacheSize, pnFaceClusters, pnIBOut, NULL, eVCacheOptimizer,
+                                    nMemoryBudgetMB);
+
+    if (result != TOOTLE_OK)
+    {
+        return result;
+    }
+
+    // optimize the draw order
+    result = TootleOptimizeOverdrawEx(pVB, pnIBOut, nVertices, nFaces, nVBStride, pViewpoints, nViewpoints, eFrontWinding,
+                                      pnFaceClusters, pnIBOut, NULL, eOverdrawOptimizer, nMemoryBudgetMB, eCostModel);
+
+    if (result != TOOTLE_OK)
+    {
+        return result;
+    }
+
+    // if the resulting number of clusters is requested, return it to the caller
+    if (pnNumClustersOut)
+    {
+        *pnNumClustersOut = pnFaceClusters[ nFaces ];
+    }
+
+    delete [] pnFaceClusters;
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleOptimize(const void*             pVB,
+                                       const unsigned int*     pnIB,
+                                       unsigned int            nVertices,
+                                       unsigned int            nFaces,
+                                       unsigned int            nVBStride,
+                                       unsigned int            nCacheSize,
+                                       const float*            pViewpoints,
+                                       unsigned int            nViewpoints,
+                                       TootleFaceWinding       eFrontWinding,
+                                       unsigned int*           pnIBOut,
+                                       unsigned int*           pnNumClustersOut,
+                                       TootleVCacheOptimizer   eVCacheOptimizer,
+                                       TootleOverdrawOptimizer eOverdrawOptimizer)
+{
+    return TootleOptimizeEx(pVB, pnIB, nVertices, nFaces, nVBStride, nCacheSize, pViewpoints, nViewpoints, eFrontWinding,
+                            pnIBOut, pnNumClustersOut, eVCacheOptimizer, eOverdrawOptimizer);
+}
+
+TootleResult TOOTLE_DLL TootleFastOptimizeEx(const void*         pVB,
+                                             const unsigned int* pnIB,
+                                             unsigned int        nVertices,
+                                             unsigned int        nFaces,
+                                             unsigned int        nVBStride,
+                                             unsigned int        nCacheSize,
+                                             TootleFaceWinding   eFrontWinding,
+                                             unsigned int*       pnIBOut,
+                                             unsigned int*       pnNumClustersOut,
+                                             float               fAlpha,
+                                             unsigned int        nMemoryBudgetMB,
+                                             float               fMaxACMRIncrease)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+    assert(pnIBOut);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleFastOptimize: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleFastOptimize: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleFastOptimize: nVBStride is less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleFastOptimize: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (!(fMaxACMRIncrease >= 0.0f))
+    {
+        errorf(("TootleFastOptimize: fMaxACMRIncrease is negative"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (!FitsMemoryBudget(MemoryOf(MEMORY_FAST_OPTIMIZE, nVertices, nFaces), nMemoryBudgetMB))
+    {
+        errorf(("TootleFastOptimize: The optimization does not fit in nMemoryBudgetMB"));
+
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+    unsigned int* pnClustersTmp;
+    unsigned int  pnNumClustersTmp;
+
+    pnClustersTmp = new unsigned int[ nFaces + 1 ];
+
+    TootleResult result;
+
+    // OPTIMIVE VERTEX CACHE AND CLUSTERS
+    result = TootleFastOptimizeVCacheAndClusterMesh(pnIB, nFaces, nVertices, nCacheSize, pnIBOut,
+                                                      pnClustersTmp, &pnNumClustersTmp, fAlpha);
+
+    if (result != TOOTLE_OK)
+    {
+        // an error detected
+        delete[] pnClustersTmp;
+        return result;
+    }
+
+    // ORDER THE FACES OF EACH CLUSTER FRONT TO BACK
+    if (fMaxACMRIncrease > 0.0f)
+    {
+        FrontToBackClusters(pVB, nVertices, nVBStride, pnIBOut, nFaces, eFrontWinding, pnClustersTmp, pnNumClustersTmp,
+                            nCacheSize, fMaxACMRIncrease, NULL);
+    }
+
+    // OPTIMIZE OVERDRAW
+    result = TootleOptimizeOverdraw(pVB, pnIBOut, nVertices, nFaces, nVBStride, NULL, 0,
+                                    eFrontWinding, pnClustersTmp, pnIBOut, NULL, TOOTLE_OVERDRAW_FAST);
+
+    delete[] pnClustersTmp;
+
+    if (pnNumClustersOut)
+    {
+        *pnNumClustersOut = pnNumClustersTmp;
+    }
+
+    return result;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleFastOptimize(const void*         pVB,
+                                           const unsigned int* pnIB,
+                                           unsigned int        nVertices,
+                                           unsigned int        nFaces,
+                                           unsigned int        nVBStride,
+                                           unsigned int        nCacheSize,
+                                           TootleFaceWinding   eFrontWinding,
+                                           unsigned int*       pnIBOut,
+                                           unsigned int*       pnNumClustersOut,
+                                           float               fAlpha)
+{
+    return TootleFastOptimizeEx(pVB, pnIB, nVertices, nFaces, nVBStride, nCacheSize, eFrontWinding, pnIBOut, pnNumClustersOut,
+                                fAlpha);
+}
+
+/// The candidate values of fAlpha tried by TootleFastOptimizeAutoAlpha.  TOOTLE_DEFAULT_ALPHA is one of them.
+static const float s_fCandidateAlphas[] = { 0.25f, 0.5f, 0.625f, TOOTLE_DEFAULT_ALPHA, 0.875f, 1.0f, 1.5f, 2.0f };
+static const UINT  s_nCandidateAlphas   = sizeof(s_fCandidateAlphas) / sizeof(s_fCandidateAlphas[0]);
+
+/// The fraction of overdrawn pixels below which TootleFastOptimizeAutoAlpha considers the overdraw of two candidates equal
+#define AUTO_ALPHA_MIN_OVERDRAW 0.001f
+
+/// The work shared by the threads of TootleFastOptimizeAutoAlpha
+struct AlphaSearch
+{
+    const float*               pfVB;              ///< The packed vertex positions
+    const int*                 piIB;              ///< The index buffer optimized for the vertex cache
+    const int*                 piHardClusters;    ///< The clusters found by the vertex cache optimization
+    int                        nHardClusters;
+    unsigned int               nVertices;
+    unsigned int               nFaces;
+    unsigned int               nCacheSize;
+    TootleFaceWinding          eFrontWinding;
+    float                      fACMR;             ///< The ACMR returned by the vertex cache optimization
+    bool                       bEstimateOverdraw; ///< False if only the ACMR of the candidates is needed
+    std::vector<OverdrawImage> images;            ///< The images of piIB used to estimate the overdraw
+    std::vector<float>         candidateACMR;     ///< The ACMR of each candidate
+    std::vector<float>         candidateOverdraw; ///< The estimated overdraw of each candidate
+    std::vector<TootleResult>  results;           ///< The result of each image, then of each candidate.  NA_TOOTLE_RESULT
+                                                  ///<  until the image is rendered or the candidate evaluated.
+    std::atomic<UINT>          nNextTask;         ///< The next image or candidate to be taken by a thread
+};
+
+//=================================================================================================================================
+/// Clusters the index buffer of an AlphaSearch for one candidate value of fAlpha, and orders the clusters for overdraw
+///  as TootleFastOptimize does.
+///
+/// \param rSearch       The search
+/// \param nCandidate    The candidate
+/// \param pnIBOut       Receives the index buffer
+/// \param rScratch      Scratch array of 3*nFaces elements, and at least nCacheSize
+/// \param piFaceOrderOut Receives the faces of rSearch.piIB in the order they appear in pnIBOut.  May be NULL.
+///
+/// \return The number of clusters
+//=================================================================================================================================
+static unsigned int ClusterForAlpha(const AlphaSearch& rSearch, UINT nCandidate, unsigned int* pnIBOut,
+                                    std::vector<int>& rScratch, int* piFaceOrderOut)
+{
+    float fAlpha  = s_fCandidateAlphas[ nCandidate ];
+    float fLambda = fAlpha + (1.0f - fAlpha) * rSearch.fACMR;
+    int   nClusters;
+
+    // the partition only needs a cache, and the ordering a measure and a sort key per cluster
+    std::vector<int> clusters(rSearch.nFaces + 1);
+    std::vector<int> clusterRemap(rSearch.nFaces);
+
+    FanVertOptimizeClusterOnly((int*) rSearch.piIB, rSearch.nVertices, rSearch.nFaces, rSearch.nCacheSize, fLambda,
+                               (int*) rSearch.piHardClusters, rSearch.nHardClusters, &clusters[0], &nClusters, &rScratch[0]);
+
+    FanVertOptimizeOverdrawOnly((float*) rSearch.pfVB, (int*) rSearch.piIB, (int*) pnIBOut, rSearch.nVertices,
+                                rSearch.nFaces, rSearch.eFrontWinding, &clusters[0], nClusters, &rScratch[0],
+                                &clusterRemap[0]);
+
+    if (piFaceOrderOut)
+    {
+        for (int c = 0; c < nClusters; c++)
+        {
+            int nCluster = clusterRemap[ c ];
+
+            for (int f = clusters[ nCluster ]; f < clusters[ nCluster + 1 ]; f++)
+            {
+                *piFaceOrderOut++ = f;
+            }
+        }
+    }
+
+    return (unsigned int) nClusters;
+}
+
+//=================================================================================================================================
+/// Measures the ACMR and estimates the overdraw of one candidate of an AlphaSearch.
+///
+/// \param rSearch     The search
+/// \param nCandidate  The candidate to evaluate
+/// \param rIB         Scratch array of 3*nFaces elements
+/// \param rScratch    Scratch array of 3*nFaces elements, and at least nCacheSize
+/// \param rFaceOrder  Scratch array of nFaces elements
+/// \param rMissStamps Scratch array of nVertices elements
+//=================================================================================================================================
+static void EvaluateAlpha(AlphaSearch& rSearch, UINT nCandidate, std::vector<UINT>& rIB, std::vector<int>& rScratch,
+                          std::vector<int>& rFaceOrder, std::vector<UINT>& rMissStamps)
+{
+    ClusterForAlpha(rSearch, nCandidate, &rIB[0], rScratch, &rFaceOrder[0]);
+
+    // measure the ACMR as TootleMeasureCacheEfficiency does.  the FIFO cache holds the vertices of the last nCacheSize misses,
+    //  so each vertex only needs the number of the miss that loaded it
+    UINT nMisses = 0;
+
+    std::fill(rMissStamps.begin(), rMissStamps.end(), 0);
+
+    for (UINT i = 0; i < 3 * rSearch.nFaces; i++)
+    {
+        UINT& rStamp = rMissStamps[ rIB[ i ] ];
+
+        if (rStamp == 0 || nMisses - rStamp >= rSearch.nCacheSize)
+        {
+            rStamp = ++nMisses;
+        }
+    }
+
+    rSearch.candidateACMR[ nCandidate ] = (float) nMisses / (float) rSearch.nFaces;
+
+    if (rSearch.bEstimateOverdraw)
+    {
+        rSearch.candidateOverdraw[ nCandidate ] = OverdrawReplayImages(&rSearch.images[0], OVERDRAW_SAMPLE_VIEWS,
+                                                                       &rFaceOrder[0], rSearch.nFaces);
+    }
+}
+
+//=================================================================================================================================
+/// The thread function of TootleFastOptimizeAutoAlpha.  Takes images to render, or candidates to evaluate, from the search
+///  until none are left.
+//=================================================================================================================================
+static void AlphaSearchWorker(AlphaSearch* pSearch, bool bImages)
+{
+    try
+    {
+        if (bImages)
+        {
+            for (;;)
+            {
+                UINT nView = pSearch->nNextTask++;
+
+                if (nView >= OVERDRAW_SAMPLE_VIEWS)
+                {
+                    break;
+                }
+
+                OverdrawSampleImage(pSearch->piIB, pSearch->nFaces, pSearch->pfVB, pSearch->nVertices,
+                                    pSearch->eFrontWinding, nView, pSearch->images[ nView ]);
+
+                pSearch->results[ nView ] = TOOTLE_OK;
+            }
+
+            return;
+        }
+
+        std::vector<UINT> ib(3 * pSearch->nFaces);
+        std::vector<int>  scratch(std::max(pSearch->nCacheSize, 3 * pSearch->nFaces));
+        std::vector<int>  faceOrder(pSearch->nFaces);
+        std::vector<UINT> missStamps(pSearch->nVertices);
+
+        for (;;)
+        {
+            UINT nCandidate = pSearch->nNextTask++;
+
+            if (nCandidate >= s_nCandidateAlphas)
+            {
+                break;
+            }
+
+            EvaluateAlpha(*pSearch, nCandidate, ib, scratch, faceOrder, missStamps);
+
+            pSearch->results[ OVERDRAW_SAMPLE_VIEWS + nCandidate ] = TOOTLE_OK;
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        // the task being done keeps NA_TOOTLE_RESULT, the other threads carry on with the rest
+    }
+}
+
+//=================================================================================================================================
+/// Renders the images of an AlphaSearch, or evaluates its candidates, on nThreads threads.
+//=================================================================================================================================
+static void RunAlphaSearch(AlphaSearch& rSearch, UINT nThreads, bool bImages)
+{
+    std::vector<std::thread> workers;
+    UINT i;
+
+    rSearch.nNextTask = 0;
+
+    for (i = 1; i < nThreads; i++)
+    {
+        try
+        {
+            workers.push_back(std::thread(AlphaSearchWorker, &rSearch, bImages));
+        }
+        catch (const std::system_error&)
+        {
+            // carry on with the threads we have
+            break;
+        }
+    }
+
+    // the calling thread works too
+    AlphaSearchWorker(&rSearch, bImages);
+
+    for (i = 0; i < workers.size(); i++)
+    {
+        workers[ i ].join();
+    }
+}
+
+TootleResult TOOTLE_DLL TootleFastOptimizeAutoAlpha(const void*         pVB,
+                                                    const unsigned int* pnIB,
+                                                    unsigned int        nVertices,
+                                                    unsigned int        nFaces,
+                                                    unsigned int        nVBStride,
+                                                    unsigned int        nCacheSize,
+                                                    TootleFaceWinding   eFrontWinding,
+                                                    unsigned int*       pnIBOut,
+                                                    unsigned int*       pnNumClustersOut,
+                                                    float               fOverdrawWeight,
+                                                    float*              pfAlphaOut,
+                                                    unsigned int        nThreads)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+    assert(pnIBOut);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleFastOptimizeAutoAlpha: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleFastOptimizeAutoAlpha: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleFastOptimizeAutoAlpha: nVBStride is less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleFastOptimizeAutoAlpha: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("TootleFastOptimizeAutoAlpha: Invalid face winding."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (!(fOverdrawWeight >= 0.0f))
+    {
+        errorf(("TootleFastOptimizeAutoAlpha: fOverdrawWeight is negative"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    UINT i;
+
+    // make a packed version of the vertex buffer.
+    std::vector<float> vb(3 * nVertices);
+    const char*        pVBuffer = (const char*) pVB;
+
+    for (i = 0; i < nVertices; i++)
+    {
+        memcpy(&vb[ 3 * i ], pVBuffer, 3 * sizeof(float));
+
+        pVBuffer += nVBStride;
+    }
+
+    // OPTIMIZE VERTEX CACHE, once for all the candidates
+    std::vector<int> ib(3 * nFaces);
+    std::vector<int> hardClusters(nFaces + 1);
+    int              nHardClusters;
+
+    AlphaSearch search;
+    search.fACMR = FanVertOptimizeVCacheOnly((int*) pnIB, &ib[0], nVertices, nFaces, nCacheSize, NULL, &hardClusters[0],
+                                             &nHardClusters);
+
+    search.pfVB              = &vb[0];
+    search.piIB              = &ib[0];
+    search.piHardClusters    = &hardClusters[0];
+    search.nHardClusters     = nHardClusters;
+    search.nVertices         = nVertices;
+    search.nFaces            = nFaces;
+    search.nCacheSize        = nCacheSize;
+    search.eFrontWinding     = eFrontWinding;
+    search.bEstimateOverdraw = (fOverdrawWeight > 0.0f);
+    search.candidateACMR.resize(s_nCandidateAlphas, 0.0f);
+    search.candidateOverdraw.resize(s_nCandidateAlphas, 0.0f);
+    search.results.resize(OVERDRAW_SAMPLE_VIEWS + s_nCandidateAlphas, NA_TOOTLE_RESULT);
+
+    if (nThreads == 0)
+    {
+        nThreads = std::thread::hardware_concurrency();
+    }
+
+    nThreads = std::max(nThreads, 1u);
+
+    // render the mesh once, to estimate the overdraw of the face order of every candidate
+    if (search.bEstimateOverdraw)
+    {
+        search.images.resize(OVERDRAW_SAMPLE_VIEWS);
+
+        RunAlphaSearch(search, std::min(nThreads, (UINT) OVERDRAW_SAMPLE_VIEWS), true);
+    }
+    else
+    {
+        std::fill(search.results.begin(), search.results.begin() + OVERDRAW_SAMPLE_VIEWS, TOOTLE_OK);
+    }
+
+    // CLUSTER AND OPTIMIZE OVERDRAW for each candidate, and score the results
+    RunAlphaSearch(search, std::min(nThreads, s_nCandidateAlphas), false);
+
+    for (i = 0; i < search.results.size(); i++)
+    {
+        if (search.results[ i ] != TOOTLE_OK)
+        {
+            // an image or a candidate is left undone if its thread ran out of memory
+            return TOOTLE_OUT_OF_MEMORY;
+        }
+    }
+
+    // the ACMR and the fraction of overdrawn pixels of each candidate are scored relative to the best ones
+    float fMinACMR     = search.candidateACMR[ 0 ];
+    float fMinOverdraw = search.candidateOverdraw[ 0 ];
+
+    for (i = 1; i < s_nCandidateAlphas; i++)
+    {
+        fMinACMR     = std::min(fMinACMR, search.candidateACMR[ i ]);
+        fMinOverdraw = std::min(fMinOverdraw, search.candidateOverdraw[ i ]);
+    }
+
+    float fMinExcess = std::max(fMinOverdraw - 1.0f, 0.0f) + AUTO_ALPHA_MIN_OVERDRAW;
+    UINT  nBest      = 0;
+    float fBestScore = 0.0f;
+
+    for (i = 0; i < s_nCandidateAlphas; i++)
+    {
+        float fExcess = std::max(search.candidateOverdraw[ i ] - 1.0f, 0.0f) + AUTO_ALPHA_MIN_OVERDRAW;
+        float fScore  = search.candidateACMR[ i ] / fMinACMR;
+
+        if (search.bEstimateOverdraw)
+        {
+            fScore += fOverdrawWeight * fExcess / fMinExcess;
+        }
+
+        if (i == 0 || fScore < fBestScore)
+        {
+            nBest      = i;
+            fBestScore = fScore;
+        }
+    }
+
+    // the candidates' index buffers are not kept, so the best one is built again
+    std::vector<int> scratch(std::max(nCacheSize, 3 * nFaces));
+    unsigned int nClusters = ClusterForAlpha(search, nBest, pnIBOut, scratch, NULL);
+
+    if (pnNumClustersOut)
+    {
+        *pnNumClustersOut = nClusters;
+    }
+
+    if (pfAlphaOut)
+    {
+        *pfAlphaOut = s_fCandidateAlphas[ nBest ];
+    }
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleVCacheClustersEx(const unsigned int*   pnIB,
+                                               unsigned int          nFaces,
+                                               unsigned int          nVertices,
+                                               unsigned int          nCacheSize,
+                                               const unsigned int*   pnFaceClusters,
+                                               unsigned int*         pnIBOut,
+                                               unsigned int*         pnFaceRemapOut,
+                                               TootleVCacheOptimizer eVCacheOptimizer,
+                                               unsigned int          nMemoryBudgetMB,
+                                               const void*           pVB,
+                                               unsigned int          nVBStride,
+                                               TootleFaceWinding     eFrontWinding,
+                                               float                 fMaxACMRIncrease)
+{
+
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pnIB);
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleVCacheClusters: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleVCacheClusters: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleVCacheClusters: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (eVCacheOptimizer != TOOTLE_VCACHE_AUTO     &&
+        eVCacheOptimizer != TOOTLE_VCACHE_DIRECT3D &&
+        eVCacheOptimizer != TOOTLE_VCACHE_LSTRIPS  &&
+        eVCacheOptimizer != TOOTLE_VCACHE_TIPSY    &&
+        eVCacheOptimizer != TOOTLE_VCACHE_TIPSY_COMPRESS)
+    {
+        errorf(("TootleVCacheClusters: Invalid selection for vertex cache optimization algorithm"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (!(fMaxACMRIncrease >= 0.0f))
+    {
+        errorf(("TootleVCacheClusters: fMaxACMRIncrease is negative"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // the faces are only ordered front to back with the vertex positions and a budget
+    const bool bFrontToBack = (pVB != NULL && fMaxACMRIncrease > 0.0f);
+
+    if (bFrontToBack && nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleVCacheClusters: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (bFrontToBack && eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("TootleVCacheClusters: Invalid face winding."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // the clusters are optimized one at a time, so the largest one must fit in the budget.  Check it before writing any output.
+    if (nMemoryBudgetMB != 0)
+    {
+        UINT nLargestCluster = 0;
+        UINT nStart = 0;
+
+        for (UINT i = 0; i < nFaces; i++)
+        {
+            if (i == nFaces - 1 || (pnFaceClusters[i + 1] != pnFaceClusters[i]))
+            {
+                nLargestCluster = std::max(nLargestCluster, 1 + (i - nStart));
+                nStart = i + 1;
+            }
+        }
+
+        TootleVCacheOptimizer eLargest = ChooseVCacheOptimizer(eVCacheOptimizer, nCacheSize, nVertices, nLargestCluster,
+                                                                 nMemoryBudgetMB);
+
+        if (!FitsMemoryBudget(EstimateVCacheMemory(eLargest, nCacheSize, nVertices, nLargestCluster), nMemoryBudgetMB))
+        {
+            errorf(("TootleVCacheClusters: The largest cluster does not fit in nMemoryBudgetMB"));
+
+            return TOOTLE_OUT_OF_MEMORY;
+        }
+    }
+
+    // the front to back order needs the optimized index buffer, even if the application does not
+    std::vector<UINT> ibTmp;
+    UINT* pnOptimizedIB = pnIBOut;
+
+    if (bFrontToBack && !pnOptimizedIB)
+    {
+        ibTmp.resize(3 * nFaces);
+        pnOptimizedIB = &ibTmp[0];
+    }
+
+    // VCache within clusters.  Tipsify's vertex map is cleared once here, and each cluster leaves it cleared.
+    std::vector<int> vertexMap(nVertices, 0);
+    std::vector<UINT> clusterStart;
+    UINT nClusterStart = 0;
+    TootleResult result;
+
+    for (UINT i = 0; i < nFaces; i++)
+    {
+        if (i == nFaces - 1 || (pnFaceClusters[i + 1] != pnFaceClusters[i]))
+        {
+            UINT nClusterFaces = 1 + (i - nClusterStart);
+
+            const UINT* pnClusterIB = &pnIB[ 3 * nClusterStart ];
+            UINT* pnClusterIBOut = (pnOptimizedIB) ? &pnOptimizedIB[ 3 * nClusterStart ] : 0;
+            UINT* pnClusterRemapOut = (pnFaceRemapOut) ? &pnFaceRemapOut[ nClusterStart ] : 0;
+
+            result = TootleOptimizeVCacheWithMap(pnClusterIB, nClusterFaces, nVertices, nCacheSize, pnClusterIBOut,
+                                                 pnClusterRemapOut, eVCacheOptimizer, nMemoryBudgetMB, &vertexMap[0]);
+
+            if (result != TOOTLE_OK)
+            {
+                return result;
+            }
+
+            // the remapping of the cluster is relative to its first face
+            for (UINT j = 0; pnClusterRemapOut && j < nClusterFaces; j++)
+            {
+                pnClusterRemapOut[j] += nClusterStart;
+            }
+
+            clusterStart.push_back(nClusterStart);
+            nClusterStart = i + 1;
+        }
+    }
+
+    if (bFrontToBack)
+    {
+        clusterStart.push_back(nFaces);
+
+        std::vector<UINT> faceOrder(pnFaceRemapOut ? nFaces : 0);
+
+        FrontToBackClusters(pVB, nVertices, nVBStride, pnOptimizedIB, nFaces, eFrontWinding, &clusterStart[0],
+                            (UINT) clusterStart.size() - 1, nCacheSize, fMaxACMRIncrease,
+                            pnFaceRemapOut ? &faceOrder[0] : NULL);
+
+        // compose the remapping with the front to back order
+        if (pnFaceRemapOut)
+        {
+            std::vector<UINT> newPosition(nFaces);
+
+            for (UINT i = 0; i < nFaces; i++)
+            {
+                newPosition[faceOrder[i]] = i;
+            }
+
+            for (UINT i = 0; i < nFaces; i++)
+            {
+                pnFaceRemapOut[i] = newPosition[pnFaceRemapOut[i]];
+            }
+        }
+    }
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleVCacheClusters(const unsigned int*   pnIB,
+                                             unsigned int          nFaces,
+                                             unsigned int          nVertices,
+                                             unsigned int          nCacheSize,
+                                             const unsigned int*   pnFaceClusters,
+                                             unsigned int*         pnIBOut,
+                                             unsigned int*         pnFaceRemapOut,
+                                             TootleVCacheOptimizer eVCacheOptimizer)
+{
+    return TootleVCacheClustersEx(pnIB, nFaces, nVertices, nCacheSize, pnFaceClusters, pnIBOut, pnFaceRemapOut,
+                                  eVCacheOptimizer);
+}
+
+//=================================================================================================================================
+/// Orders the faces of each cluster front to back, keeping the vertex cache order in runs of faces.  See FrontToBackClusterFaces.
+/// \param pVB              The vertex buffer.  It must point to the vertex positions, 3 floats each.
+/// \param nVertices        The number of vertices.
+/// \param nVBStride        The distance between successive vertices in the vertex buffer, in bytes.
+/// \param pnIB             The index buffer, whose clusters are reordered in place.
+/// \param nFaces           The number of faces.
+/// \param eFrontWinding    The winding order of front-faces in the model.
+/// \param pnClusterStart   The first face of each cluster, followed by nFaces.
+/// \param nClusters        The number of clusters.
+/// \param nCacheSize       The vertex cache size the ACMR is measured with.
+/// \param fMaxACMRIncrease The largest increase of the ACMR of a cluster.
+/// \param pnFaceOrderOut   May be NULL, or receives for each face the position it had in pnIB.
+//=================================================================================================================================
+static void FrontToBackClusters(const void*         pVB,
+                                unsigned int        nVertices,
+                                unsigned int        nVBStride,
+                                unsigned int*       pnIB,
+                                unsigned int        nFaces,
+                                TootleFaceWinding   eFrontWinding,
+                                const unsigned int* pnClusterStart,
+                                unsigned int        nClusters,
+                                unsigned int        nCacheSize,
+                                float               fMaxACMRIncrease,
+                                unsigned int*       pnFaceOrderOut)
+{
+    // make a packed version of the vertex buffer.
+    std::vector<float> vertices(3 * nVertices);
+    const char* pVBuffer = (const char*) pVB;
+
+    for (UINT i = 0; i < nVertices; i++)
+    {
+        memcpy(&vertices[3 * i], pVBuffer, 3 * sizeof(float));
+        pVBuffer += nVBStride;
+    }
+
+    FrontToBackClusterFaces((int*) pnIB, nFaces, &vertices[0], nVertices, eFrontWinding, (const int*) pnClusterStart,
+                            nClusters, nCacheSize, fMaxACMRIncrease, (int*) pnFaceOrderOut);
+}
+
+TootleResult TOOTLE_DLL TootleMeasureCacheEfficiency(const unsigned int* pnIB,
+                                                     unsigned int        nFaces,
+                                                     unsigned int        nCacheSize,
+                                                     float*              pfEfficiencyOut)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pnIB);
+    assert(pfEfficiencyOut);
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleMeasureCacheEfficiency: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleMeasureCacheEfficiency: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // allocate ourselves a vertex cache
+    unsigned int* pnCache = new unsigned int[nCacheSize];
+
+    // initialize cache to EMPTY
+    UINT nEmpty = 0xffffffff;
+
+    for (UINT i = 0; i < nCacheSize; i++)
+    {
+        pnCache[i] = nEmpty;
+    }
+
+    // simulate vertex processing
+    UINT nFetches = 0;
+    UINT nCacheIndex = 0;
+    UINT nIndices = 3 * nFaces;
+
+    for (UINT i = 0; i < nIndices; i++)
+    {
+        UINT nVert = pnIB[i];
+
+        // search for this vertex in the cache
+        bool bFound = false;
+
+        for (UINT j = 0; j < nCacheSize; j++)
+        {
+            if (nVert == pnCache[j])
+            {
+                bFound = true;
+                break;
+            }
+        }
+
+        // it's not there, so put it there
+        if (!bFound)
+        {
+            nFetches++;
+            pnCache[nCacheIndex] = pnIB[i];
+            nCacheIndex = (nCacheIndex + 1);
+
+            if (nCacheIndex == nCacheSize)
+            {
+                nCacheIndex = 0;
+            }
+        }
+    }
+
+    delete [] pnCache;
+
+    // I don't know why anyone would pass NULL for this, but just in case...
+    if (pfEfficiencyOut)
+    {
+        *pfEfficiencyOut = (float) nFetches / (float) nFaces;
+    }
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleMeasureCacheEfficiencyStrips(const unsigned int* pnStripIB,
+                                                           unsigned int        nIndices,
+                                                           unsigned int        nCacheSize,
+                                                           unsigned int        nRestartIndex,
+                                                           float*              pfEfficiencyOut)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pnStripIB);
+    assert(pfEfficiencyOut);
+
+    if (nIndices == 0)
+    {
+        errorf(("TootleMeasureCacheEfficiencyStrips: nIndices = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nCacheSize == 0)
+    {
+        errorf(("TootleMeasureCacheEfficiencyStrips: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // the same FIFO cache as TootleMeasureCacheEfficiency.  The restart index is not a vertex and does not touch the cache.
+    std::vector<UINT> cache(nCacheSize, 0xffffffff);
+
+    UINT nFetches = 0;
+    UINT nCacheIndex = 0;
+    UINT nFaces = 0;
+    UINT nStripLength = 0;
+
+    for (UINT i = 0; i < nIndices; i++)
+    {
+        UINT nVert = pnStripIB[i];
+
+        if (nVert == nRestartIndex)
+        {
+            nStripLength = 0;
+            continue;
+        }
+
+        // every index after the second one of a strip completes a triangle, unless it is degenerate
+        nStripLength++;
+
+        if (nStripLength >= 3 &&
+            nVert != pnStripIB[i - 1] && nVert != pnStripIB[i - 2] && pnStripIB[i - 1] != pnStripIB[i - 2])
+        {
+            nFaces++;
+        }
+
+        if (std::find(cache.begin(), cache.end(), nVert) == cache.end())
+        {
+            nFetches++;
+            cache[nCacheIndex] = nVert;
+            nCacheIndex = (nCacheIndex + 1) % nCacheSize;
+        }
+    }
+
+    if (nFaces == 0)
+    {
+        errorf(("TootleMeasureCacheEfficiencyStrips: The strips contain no triangles"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (pfEfficiencyOut)
+    {
+        *pfEfficiencyOut = (float) nFetches / (float) nFaces;
+    }
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleMeasureVertexFetch(const unsigned int* pnIB,
+                                                 unsigned int        nVertices,
+                                                 unsigned int        nFaces,
+                                                 unsigned int        nVBStride,
+                                                 unsigned int        nCacheSize,
+                                                 float*              pfBytesPerTriangleOut,
+                                                 float*              pfOverfetchOut,
+                                                 unsigned int        nFetchLineSize,
+                                                 unsigned int        nFetchCacheSize,
+                                                 unsigned int        nFetchCacheWays)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pnIB);
+
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleMeasureVertexFetch: Invalid value of nVertices"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleMeasureVertexFetch: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride == 0 || nVBStride > TOOTLE_MAX_FETCH_VERTEX_STRIDE)
+    {
+        errorf(("TootleMeasureVertexFetch: Invalid value of nVBStride"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFetchLineSize == 0 || nFetchCacheWays == 0 || nFetchCacheSize / nFetchLineSize < nFetchCacheWays)
+    {
+        errorf(("TootleMeasureVertexFetch: The fetch cache must hold at least nFetchCacheWays lines"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    UINT nIndices = 3 * nFaces;
+    UINT i;
+
+    for (i = 0; i < nIndices; i++)
+    {
+        if (pnIB[i] >= nVertices)
+        {
+            errorf(("TootleMeasureVertexFetch: Index buffer references vertices beyond nVertices"));
+
+            return TOOTLE_INVALID_ARGS;
+        }
+    }
+
+    // The post-transform cache is a FIFO, so a vertex is still cached as long as fewer than nCacheSize vertices were
+    //  inserted after it.  Remembering when each vertex was inserted avoids searching the cache.  0 means never inserted.
+    std::vector<UINT> vertexInsertion(nVertices, 0);
+    UINT nInserted = 0;
+
+    // The fetch cache holds the line indices of each set in most recently used first order
+    typedef unsigned long long LineIndex;
+    const LineIndex nEmpty = ~(LineIndex) 0;
+
+    UINT nSets = (nFetchCacheSize / nFetchLineSize) / nFetchCacheWays;
+    std::vector<LineIndex> lines(nSets * nFetchCacheWays, nEmpty);
+
+    LineIndex nLineFetches = 0;
+    UINT nReferenced = 0;
+
+    // simulate vertex processing
+    for (i = 0; i < nIndices; i++)
+    {
+        UINT nVert = pnIB[i];
+
+        if (vertexInsertion[nVert] == 0)
+        {
+            nReferenced++;
+        }
+        else if (nInserted - vertexInsertion[nVert] < nCacheSize)
+        {
+            // post-transform cache hit, the vertex is not fetched
+            continue;
+        }
+
+        vertexInsertion[nVert] = ++nInserted;
+
+        // fetch every line the vertex touches
+        LineIndex nStart = (LineIndex) nVert * nVBStride;
+        LineIndex nFirstLine = nStart / nFetchLineSize;
+        LineIndex nLastLine = (nStart + nVBStride - 1) / nFetchLineSize;
+
+        for (LineIndex nLine = nFirstLine; nLine <= nLastLine; nLine++)
+        {
+            LineIndex* pSet = &lines[(size_t)(nLine % nSets) * nFetchCacheWays];
+
+            UINT nWay = 0;
+
+            while (nWay < nFetchCacheWays && pSet[nWay] != nLine)
+            {
+                nWay++;
+            }
+
+            if (nWay == nFetchCacheWays)
+            {
+                // miss, replace the least recently used line
+                nLineFetches++;
+                nWay = nFetchCacheWays - 1;
+            }
+
+            for (; nWay > 0; nWay--)
+            {
+                pSet[nWay] = pSet[nWay - 1];
+            }
+
+            pSet[0] = nLine;
+        }
+    }
+
+    double fBytes = (double) nLineFetches * nFetchLineSize;
+
+    if (pfBytesPerTriangleOut)
+    {
+        *pfBytesPerTriangleOut = (float)(fBytes / nFaces);
+    }
+
+    if (pfOverfetchOut)
+    {
+        *pfOverfetchOut = (float)(fBytes / ((double) nReferenced * nVBStride));
+    }
+
+    return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleMeasureOverdrawEx(const void*             pVB,
+                                                const unsigned int*     pnIB,
+                                                unsigned int            nVertices,
+                                                unsigned int            nFaces,
+                                                unsigned int            nVBStride,
+                                                const float*            pfViewpoint,
+                                                unsigned int            nViewpoints,
+                                                TootleFaceWinding       eFrontWinding,
+                                                float*                  pfAvgODOut,
+                                                float*                  pfMaxODOut,
+                                                TootleOverdrawOptimizer eOverdrawOptimizer,
+                                                unsigned int            nMemoryBudgetMB,
+                                                TootleOverdrawCostModel eCostModel)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleMeasureOverdraw: nCacheSize = 0"));
+
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleMeasureOverdraw: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleMeasureOverdraw: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (eCostModel != TOOTLE_OVERDRAW_COST_PLAIN && eCostModel != TOOTLE_OVERDRAW_COST_HIZ &&
+        eCostModel != TOOTLE_OVERDRAW_COST_PREPASS)
+    {
+        errorf(("TootleMeasureOverdraw: Invalid overdraw cost model."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // the hierarchical Z buffer is only modelled by the ray tracer
+    if (eCostModel != TOOTLE_OVERDRAW_COST_PLAIN)
+    {
+        eOverdrawOptimizer = TOOTLE_OVERDRAW_RAYTRACE;
+    }
+
+    if (!FitsMemoryBudget(EstimateMeasureOverdrawMemory(eOverdrawOptimizer, nVertices, nFaces), nMemoryBudgetMB))
+    {
+        errorf(("TootleMeasureOverdraw: The measurement does not fit in nMemoryBudgetMB"));
+
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+#ifdef _SOFTWARE_ONLY_VERSION
+    eOverdrawOptimizer;  // satisfy unused parameter warning message
+    return TootleMeasureOverdrawRaytrace(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
+                                         eFrontWinding, pfAvgODOut, pfMaxODOut, eCostModel);
+#else
+
+    switch (eOverdrawOptimizer)
+    {
+        case TOOTLE_OVERDRAW_RAYTRACE:
+            return TootleMeasureOverdrawRaytrace(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
+                                                   eFrontWinding, pfAvgODOut, pfMaxODOut, eCostModel);
+
+        case TOOTLE_OVERDRAW_AUTO:
+        case TOOTLE_OVERDRAW_FAST:
+        case TOOTLE_OVERDRAW_DIRECT3D:
+        default:
+            return TootleMeasureOverdrawDirect3D(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
+                                                   eFrontWinding, pfAvgODOut, pfMaxODOut);
+    }
+
+#endif
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleMeasureOverdraw(const void*             pVB,
+                                              const unsigned int*     pnIB,
+                                              unsigned int            nVertices,
+                                              unsigned int            nFaces,
+                                              unsigned int            nVBStride,
+                                              const float*            pfViewpoint,
+                                              unsigned int            nViewpoints,
+                                              TootleFaceWinding       eFrontWinding,
+                                              float*                  pfAvgODOut,
+                                              float*                  pfMaxODOut,
+                                              TootleOverdrawOptimizer eOverdrawOptimizer)
+{
+    return TootleMeasureOverdrawEx(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints, eFrontWinding,
+                                   pfAvgODOut, pfMaxODOut, eOverdrawOptimizer);
+}
+
+#ifndef _SOFTWARE_ONLY_VERSION
+TootleResult TootleMeasureOverdrawDirect3D(const void*         pVB,
+                                           const unsigned int* pnIB,
+                                           unsigned int        nVertices,
+                                           unsigned int        nFaces,
+                                           unsigned int        nVBStride,
+                                           const float*        pfViewpoint,
+                                           unsigned int        nViewpoints,
+                                           TootleFaceWinding   eFrontWinding,
+                                           float*              pfAvgODOut,
+                                           float*              pfMaxODOut)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleMeasureOverdraw: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleMeasureOverdraw: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleMeasureOverdraw: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (!ODIsInitialized())
+    {
+        return TOOTLE_NOT_INITIALIZED;
+    }
+
+    // make sure that they're not being stupid and passing us bad enum values
+    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("Invalid face winding."));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // use default viewpoints if they were omitted
+    if (!pfViewpoint)
+    {
+        pfViewpoint = pDefaultViewpoint;
+        nViewpoints = nDefaultViewpoints;
+    }
+
+    // cook us up some soup
+    Soup soup;
+
+    if (!MakeSoup(pVB, pnIB, nVertices, nFaces, nVBStride, &soup))
+    {
+        return TOOTLE_OUT_OF_MEMORY;
+    }
+
+    // send soup to overdraw module
+    TootleResult result = ODSetSoup(&soup, eFrontWinding);
+
+    if (result == TOOTLE_OK)
+    {
+        // measure overdraw
+        float fAvgOD, fMaxOD;
+        result = ODObjectOverdraw(pfViewpoint, nViewpoints, fAvgOD, fMaxOD);
+
+        if (result != TOOTLE_OK)
+        {
+            return result;
+        }
+
+        // set output variables
+        if (pfAvgODOut)
+        {
+            *pfAvgODOut = fAvgOD - 1.0f;
+        }
+
+        if (pfMaxODOut)
+        {
+            *pfMaxODOut = fMaxOD - 1.0f;
+        }
+    }
+
+    return result;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+#endif
+
+TootleResult TootleMeasureOverdrawRaytrace(const void*             pVB,
+                                           const unsigned int*     pnIB,
+                                           unsigned int            nVertices,
+                                           unsigned int            nFaces,
+                                           unsigned int            nVBStride,
+                                           const float*            pfViewpoint,
+                                           unsigned int            nViewpoints,
+                                           TootleFaceWinding       eFrontWinding,
+                                           float*                  pfAvgODOut,
+                                           float*                  pfMaxODOut,
+                                           TootleOverdrawCostModel eCostModel)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pVB);
+    assert(pnIB);
+
+    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    {
+        errorf(("TootleMeasureOverdraw: nCacheSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleMeasureOverdraw: Invalid value of nFaces"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nVBStride < 3 * sizeof(float))
+    {
+        errorf(("TootleMeasureOverdraw: nVBStride less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // make sure that they're not being stupid and passing us bad enum values
+    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    {
+        errorf(("Invalid face winding."));
+     
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // use default viewpoints if they were omitted
+    if (!pfViewpoint)
+    {
+        pfViewpoint = pDefaultViewpoint;
+        nViewpoints = nDefaultViewpoints;
+    }
+
+    // create a non-interleaved vertex buffer
+    float* pfVB = new float[ 3 * nVertices ];
+
+    const char* pVBuffer = (const char*) pVB;
+
+    for (unsigned int i = 0; i < nVertices; i++)
+    {
+        memcpy(&pfVB[3 * i], pVBuffer, sizeof(float) * 3);
+        pVBuffer += nVBStride;
+    }
+
+    TootleResult result;
+    float fAvgOD;
+    float fMaxOD;
+
+    result = ODObjectOverdrawRaytrace(pfVB, pnIB, nVertices, nFaces, pfViewpoint, nViewpoints,
+                                      (eFrontWinding != TOOTLE_CCW),    // cull CCW faces if they aren't front facing
+                                      eCostModel, fAvgOD, fMaxOD);
+
+    if (pfAvgODOut)
+    {
+        *pfAvgODOut = fAvgOD - 1.0f;
+    }
+
+    if (pfMaxODOut)
+    {
+        *pfMaxODOut = fMaxOD - 1.0f;
+    }
+
+    // clean up
+    delete[] pfVB;
+
+    return result;
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+//=================================================================================================================================
+/// A helper function to convert the cluster array ID from the full format to the compact format.
+///  The compact format is used by old tootle (i3D version) while the full format is used by the new tootle (SIGGRAPH version).
+///
+/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
+/// \param nFaces  The total number of faces of the mesh.
+///
+/// \return Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_INTERNAL_ERROR, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK.
+//=================================================================================================================================
+static TootleResult ConvertClusterArrayFromFullToCompact(unsigned int* pnID, unsigned int nFaces)
+{
+    // sanity checks
+    assert(pnID);
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("ConvertClusterArrayFromFullToCompact: nFaces is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // if less then two triangles, then just return from the function.
+    if (nFaces < 2)
+    {
+        return TOOTLE_OK;
+    }
+
+    // check whether the cluster array is of a full format.
+    if (!IsClusterArrayFullFormat(pnID, nFaces))
+    {
+        errorf(("ConvertClusterIDFromFullToCompact: pnID is not a full format"));
+        
+        return TOOTLE_INTERNAL_ERROR;
+    }
+
+    unsigned int nNumCluster;
+
+    nNumCluster = 1 + pnID[ nFaces - 1 ];
+
+    // sanity check on the number of cluster
+    if (nNumCluster > nFaces)
+    {
+        errorf(("ConvertClusterArrayFromFullToCompact: nNumCluster > nFaces"));
+        
+        return TOOTLE_INTERNAL_ERROR;
+    }
+
+    if (nNumCluster >= TOOTLE_NONE)
+    {
+        errorf(("ConvertClusterIDFromFullToCompact: nNumCluster >= TOOTLE_NONE (max int)"));
+        
+        return TOOTLE_INTERNAL_ERROR;
+    }
+
+    unsigned int nStart;
+    unsigned int nCount;
+
+    // The starting cluster has to be zero.
+    if (pnID[ 0 ] != 0)
+    {
+        errorf(("ConvertClusterIDFromFullToCompact: pnID[0] != 0"));
+        
+        return TOOTLE_INTERNAL_ERROR;
+    }
+
+    // Compacting the cluster array
+    unsigned int i;
+
+    nCount = 0;
+    nStart = 0;
+
+    for (i = 1; i < nFaces; i++)
+    {
+        if (pnID[ i ] != nCount)
+        {
+            nStart = i;
+            nCount++;
+            pnID[ nCount ] = nStart;
+        }
+    }
+
+    // Append the cluster array with the total size
+    nCount++;
+    pnID[ nCount ] = i;
+
+    // Fill the rest of the array with NONE
+    nCount++;
+
+    for (; nCount < nFaces; nCount++)
+    {
+        pnID[ nCount ] = TOOTLE_NONE;
+    }
+
+    // The last element of the array should be the total number of clusters.
+    pnID[ nFaces ] = nNumCluster;
+
+    return TOOTLE_OK;
+}
+
+//=================================================================================================================================
+/// A helper function to convert the cluster array ID from the compact format to the full format.
+///  The compact format is used by old tootle (i3D version) while the full format is used by the new tootle (SIGGRAPH version).
+/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
+/// \param nFaces  The total number of faces of the mesh.
+///
+/// \return Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_INTERNAL_ERROR, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK.
+//=================================================================================================================================
+static TootleResult ConvertClusterArrayFromCompactToFull(unsigned int* pnID, unsigned int nFaces)
+{
+    // sanity checks
+    assert(pnID);
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("ConvertClusterArrayFromCompactToFull: nFaces is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    // if less then two triangles, then just return from the function.
+    if (nFaces < 2)
+    {
+        return TOOTLE_OK;
+    }
+
+    // check if the cluster array is of compact format.
+    if (!IsClusterArrayCompactFormat(pnID, nFaces))
+    {
+        errorf(("ConvertClusterArrayFromCompactToFull: pnID is not a compact format"));
+        
+        return TOOTLE_INTERNAL_ERROR;
+    }
+
+    unsigned int nNumCluster;
+
+    nNumCluster = pnID[ nFaces ];
+
+    // sanity check on the number of cluster
+    if (nNumCluster > nFaces)
+    {
+        errorf(("ConvertClusterArrayFromCompactToFull: nNumCluster > nLength"));
+        
+        return TOOTLE_INTERNAL_ERROR;
+    }
+
+    // Make a local copy of the compact form array
+    unsigned int* pnTmp = new unsigned int[ nNumCluster + 1 ];
+
+    memcpy(pnTmp, pnID, (nNumCluster + 1) * sizeof(unsigned int));
+
+    unsigned int i;
+    unsigned int j;
+    unsigned int nStart;
+
+    // Compute the full format.
+    nStart = 0;
+
+    for (i = 1; i <= nNumCluster; i++)
+    {
+        if (pnTmp[i] > nFaces)
+        {
+            errorf(("ConvertClusterArrayFromCompactToFull: pnTmp[i] > nLength"));
+            
+            return TOOTLE_INTERNAL_ERROR;
+        }
+
+        for (j = nStart; j < pnTmp[i]; j++)
+        {
+            pnID[j] = i - 1;
+        }
+
+        nStart = pnTmp[i];
+    }
+
+    // Append the last entry of the array by the number of total clusters
+    pnID[ nFaces ] = nNumCluster;
+
+    delete[] pnTmp;
+
+    return TOOTLE_OK;
+}
+
+//=================================================================================================================================
+/// A helper function to check whether the cluster array is of a full format type.
+///  The full format is used by the old tootle (i3D version).
+///  This function does not check whether the array is valid.
+///
+/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
+/// \param nFaces  The total number of faces of the mesh.
+///
+/// \return Possible return codes:  true if the cluster array is of a full format type, false otherwise
+//=================================================================================================================================
+static bool IsClusterArrayFullFormat(const unsigned int* pnID, unsigned int nFaces)
+{
+    assert(pnID);
+    assert(nFaces > 0);
+
+    if (pnID[ nFaces ] == (1 + pnID[ nFaces - 1 ]))
+    {
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+//=================================================================================================================================
+/// A helper function to check whether the cluster array is of a compact format type.
+///  The compact format is used by the new tootle (SIGGRAPH version).
+///  This function does not check whether the array is valid.
+///
+/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
+/// \param nFaces  The total number of faces of the mesh.
+///
+/// \return Possible return codes:  true if the cluster array is of a full format type, false otherwise
+//=================================================================================================================================
+static bool IsClusterArrayCompactFormat(const unsigned int* pnID, unsigned int nFaces)
+{
+    assert(pnID);
+    assert(nFaces > 0);
+
+    unsigned int nNumCluster;
+
+    nNumCluster = pnID[ nFaces ];
+
+    // a special case of all the faces are in a separate cluster (it is both a compact and full form)
+    if (nNumCluster == nFaces)
+    {
+        return true;
+    }
+    else
+    {
+        if (nNumCluster == (1 + pnID[ nFaces - 1 ]))
+        {
+            return false;  // a full format
+        }
+        else
+        {
+            return true;
+        }
+    }
+}
+
+//=================================================================================================================================
+/// Counts how often a candidate vertex is fetched close to the fetches of the vertices already placed in a block
+///
+/// \param rBlock          The vertices in the block
+/// \param nCandidate      The candidate vertex
+/// \param rFetchStart     Element v is the start of the fetches of vertex v in rFetchPositions
+/// \param rFetchPositions The positions of the fetches of each vertex in the fetch stream
+/// \param nWindow         The largest distance between two fetches that are considered close
+//=================================================================================================================================
+static UINT CountCloseFetches(const std::vector<UINT>& rBlock,
+                              UINT                     nCandidate,
+                              const std::vector<UINT>& rFetchStart,
+                              const std::vector<UINT>& rFetchPositions,
+                              UINT                     nWindow)
+{
+    UINT nCount = 0;
+
+    for (UINT i = 0; i < rBlock.size(); i++)
+    {
+        for (UINT j = rFetchStart[ rBlock[i] ]; j < rFetchStart[ rBlock[i] + 1 ]; j++)
+        {
+            for (UINT k = rFetchStart[ nCandidate ]; k < rFetchStart[ nCandidate + 1 ]; k++)
+            {
+                UINT nDistance = (rFetchPositions[j] > rFetchPositions[k]) ? rFetchPositions[j] - rFetchPositions[k] :
+                                 rFetchPositions[k] - rFetchPositions[j];
+
+                if (nDistance <= nWindow)
+                {
+                    nCount++;
+                }
+            }
+        }
+    }
+
+    return nCount;
+}
+
+//=================================================================================================================================
+/// Assigns new locations to the referenced vertices, such that vertices that are fetched close together share cache lines.
+///  The fetch stream (the indices that miss the post-transform cache) is walked in order.  Each vertex that has no location
+///  yet opens a block of nBlockSize consecutive locations.  The rest of the block is filled with the vertices, fetched shortly
+///  after it, whose fetches are most often close to the fetches of the vertices already in the block.  Ties go
+///  to the vertex fetched first, so without any repeated co-occurrence this reduces to first-use order.
+///
+/// \param pnIB        The index buffer.  Out-of-bounds indices are ignored.
+/// \param nVertices   The number of vertices
+/// \param nFaces      The number of faces
+/// \param nCacheSize  The post-transform cache size used to find the fetch stream
+/// \param nBlockSize  The number of vertices that share a cache line
+/// \param pnVIDRemap  Receives the new location of each referenced vertex.  Vertices that already have a location (not
+///                     TOOTLE_MAX_VERTICES) keep it.
+/// \param rnVIDCount  The number of locations assigned so far.  New locations are assigned from here.
+//=================================================================================================================================
+static void OrderVerticesForFetch(const unsigned int* pnIB,
+                                  unsigned int        nVertices,
+                                  unsigned int        nFaces,
+                                  unsigned int        nCacheSize,
+                                  unsigned int        nBlockSize,
+                                  unsigned int*       pnVIDRemap,
+                                  unsigned int&       rnVIDCount)
+{
+    UINT nIndices = 3 * nFaces;
+    UINT i;
+
+    // find the fetch stream, simulating the post-transform cache as in TootleMeasureVertexFetch
+    std::vector<UINT> fetches;
+    fetches.reserve(nIndices);
+
+    std::vector<UINT> vertexInsertion(nVertices, 0);
+    UINT nInserted = 0;
+
+    for (i = 0; i < nIndices; i++)
+    {
+        UINT nVert = pnIB[i];
+
+        if (nVert >= nVertices ||
+            (vertexInsertion[nVert] != 0 && nInserted - vertexInsertion[nVert] < nCacheSize))
+        {
+            continue;
+        }
+
+        vertexInsertion[nVert] = ++nInserted;
+        fetches.push_back(nVert);
+    }
+
+    UINT nFetches = (UINT) fetches.size();
+
+    // list the positions of the fetches of each vertex
+    std::vector<UINT> fetchStart(nVertices + 1, 0);
+
+    for (i = 0; i < nFetches; i++)
+    {
+        fetchStart[ fetches[i] + 1 ]++;
+    }
+
+    for (i = 0; i < nVertices; i++)
+    {
+        fetchStart[i + 1] += fetchStart[i];
+    }
+
+    std::vector<UINT> fetchPositions(nFetches);
+    std::vector<UINT> fetchCursor(fetchStart.begin(), fetchStart.end() - 1);
+
+    for (i = 0; i < nFetches; i++)
+    {
+        fetchPositions[ fetchCursor[ fetches[i] ]++ ] = i;
+    }
+
+    // Fetches less than two cache sizes apart count as close.  Candidates are searched over twice that distance, which
+    //  measured slightly better than searching only among the close fetches.
+    UINT nWindow = 2 * ((nCacheSize > 2 * nBlockSize) ? nCacheSize : 2 * nBlockSize);
+    UINT nSearchWindow = 2 * nWindow;
+
+    std::vector<UINT> block;
+    block.reserve(nBlockSize);
+
+    for (i = 0; i < nFetches; i++)
+    {
+        if (pnVIDRemap[ fetches[i] ] != TOOTLE_MAX_VERTICES)
+        {
+            continue;
+        }
+
+        // open a new block
+        block.clear();
+        block.push_back(fetches[i]);
+        pnVIDRemap[ fetches[i] ] = rnVIDCount++;
+
+        UINT nEnd = (nFetches - i - 1 > nSearchWindow) ? i + 1 + nSearchWindow : nFetches;
+
+        while (block.size() < nBlockSize)
+        {
+            UINT nBest      = TOOTLE_MAX_VERTICES;
+            UINT nBestCount = 0;
+
+            for (UINT j = i + 1; j < nEnd; j++)
+            {
+                if (pnVIDRemap[ fetches[j] ] != TOOTLE_MAX_VERTICES)
+                {
+                    continue;
+                }
+
+                UINT nCount = CountCloseFetches(block, fetches[j], fetchStart, fetchPositions, nWindow);
+
+                if (nCount > nBestCount)
+                {
+                    nBest      = fetches[j];
+                    nBestCount = nCount;
+                }
+            }
+
+            if (nBest == TOOTLE_MAX_VERTICES)
+            {
+                break;
+            }
+
+            block.push_back(nBest);
+            pnVIDRemap[ nBest ] = rnVIDCount++;
+        }
+    }
+}
+
+//=================================================================================================================================
+/// Checks that every attribute of a vertex layout has a valid format and fits in both the input and the output vertex.
+//=================================================================================================================================
+static bool IsVertexLayoutValid(const TootleVertexLayout& rLayout, unsigned int nVBStride)
+{
+    if (rLayout.nVBOutStride == 0 || (rLayout.pAttributes == NULL && rLayout.nAttributes > 0))
+    {
+        return false;
+    }
+
+    for (UINT i = 0; i < rLayout.nAttributes; i++)
+    {
+        const TootleVertexAttribute& rAttribute = rLayout.pAttributes[i];
+        UINT nInSize;
+        UINT nOutSize;
+
+        if (!GetVertexAttributeSize(rAttribute, nInSize, nOutSize) ||
+            nInSize > nVBStride || rAttribute.nOffset > nVBStride - nInSize ||
+            nOutSize > rLayout.nVBOutStride || rAttribute.nOutOffset > rLayout.nVBOutStride - nOutSize)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//=================================================================================================================================
+/// Returns the number of vertices to group into a cache line for TOOTLE_VMEMORY_FETCH_AWARE: as many as the stream that fits
+///  the fewest of them in a line holds, counting the output size of quantized streams.  Streams with vertices as wide as a
+///  cache line gain nothing from grouping, so they are not considered.  Returns 0 if no stream benefits from grouping.
+//=================================================================================================================================
+static UINT GetFetchBlockSize(const TootleVertexStream* pStreams, unsigned int nStreams, unsigned int nFetchLineSize)
+{
+    UINT nBlockSize = 0;
+
+    for (UINT i = 0; i < nStreams; i++)
+    {
+        UINT nStride = (pStreams[i].pVBOutLayout != NULL) ? pStreams[i].pVBOutLayout->nVBOutStride : pStreams[i].nVBStride;
+        UINT nPerLine = nFetchLineSize / nStride;
+
+        if (nPerLine >= 2 && (nBlockSize == 0 || nPerLine < nBlockSize))
         {
-            pnOutput = new unsigned int[ 3 * nFaces ];
+            nBlockSize = nPerLine;
         }
     }
 
-    float* pfVB = new float[ nVertices * 3 ];
-
-    // make a packed version of the vertex buffer.
-    unsigned int nVertexPositionSize = 3 * sizeof(float);
-    const char*  pVBuffer            = (const char*) pVB;
+    return nBlockSize;
+}
 
-    for (unsigned int i = 0; i < nVertices; i++)
+//=================================================================================================================================
+/// Assigns the next free locations to the vertices referenced by an index buffer that have no location yet.
+///
+/// \param pnIB        The index buffer.  Out-of-bounds indices are ignored.
+/// \param nVertices   The number of vertices
+/// \param nFaces      The number of faces
+/// \param eVertexMemoryOptimizer  The algorithm used to order the vertices
+/// \param nCacheSize  The post-transform cache size, for TOOTLE_VMEMORY_FETCH_AWARE
+/// \param nBlockSize  The number of vertices that share a cache line, for TOOTLE_VMEMORY_FETCH_AWARE.  0 to number the
+///                     vertices in the order they are first referenced.
+/// \param pnVIDRemap  The location of each vertex, TOOTLE_MAX_VERTICES for the vertices without one
+/// \param rnVIDCount  The number of locations assigned so far
+//=================================================================================================================================
+static void AssignVertexLocations(const unsigned int*         pnIB,
+                                  unsigned int                nVertices,
+                                  unsigned int                nFaces,
+                                  TootleVertexMemoryOptimizer eVertexMemoryOptimizer,
+                                  unsigned int                nCacheSize,
+                                  unsigned int                nBlockSize,
+                                  unsigned int*               pnVIDRemap,
+                                  unsigned int&               rnVIDCount)
+{
+    if (eVertexMemoryOptimizer == TOOTLE_VMEMORY_FETCH_AWARE && nBlockSize > 0)
     {
-        memcpy(&pfVB[ 3 * i ], pVBuffer, nVertexPositionSize);
-
-        pVBuffer += nVBStride;
+        OrderVerticesForFetch(pnIB, nVertices, nFaces, nCacheSize, nBlockSize, pnVIDRemap, rnVIDCount);
     }
 
-    FanVertOptimizeOverdrawOnly(pfVB, (int*) pnIB, (int*) pnOutput, nVertices, nFaces,
-                                eFrontWinding, (int*) pnFaceClusters, pnFaceClusters[ nFaces ],
-                                NULL, (int*) pnClusterRemapOut);
+    // vertices that have not been assigned a location yet are numbered in the order they are first referenced
+    unsigned int nFaces3 = nFaces * 3;
 
-    // copy the output back
-    if (pnIBOut &&
-        pnOutput != pnIBOut)
+    for (unsigned int i = 0; i < nFaces3; i++)
     {
-        memcpy(pnIBOut, pnOutput, nFaces * 3 * sizeof(unsigned int));
-        delete[] pnOutput;
+        unsigned int nVID = pnIB[ i ];
+
+        if (nVID < nVertices && pnVIDRemap[ nVID ] == TOOTLE_MAX_VERTICES)
+        {
+            pnVIDRemap[ nVID ] = rnVIDCount++;
+        }
     }
+}
 
-    delete[] pfVB;
+//=================================================================================================================================
+/// Writes the requested output streams with their vertices moved to the locations given by pnVIDRemap, converting the
+///  vertices of streams with an output layout.
+//=================================================================================================================================
+static void RemapVertexStreams(const TootleVertexStream* pStreams,
+                               unsigned int              nStreams,
+                               unsigned int              nVertices,
+                               const unsigned int*       pnVIDRemap)
+{
+    for (unsigned int nStream = 0; nStream < nStreams; nStream++)
+    {
+        const TootleVertexStream& rStream = pStreams[ nStream ];
 
-    return TOOTLE_OK;
+        if (rStream.pVBOut == NULL)
+        {
+            continue;
+        }
+
+        // make a local copy if the stream is reordered in place
+        unsigned int nVBStride = rStream.nVBStride;
+        unsigned int nVBOutStride = (rStream.pVBOutLayout != NULL) ? rStream.pVBOutLayout->nVBOutStride : nVBStride;
+        char* pVBOutTmp = (char*) rStream.pVBOut;
+
+        if (rStream.pVB == rStream.pVBOut)
+        {
+            pVBOutTmp = new char[ (size_t) nVertices * nVBOutStride ];
+        }
+
+        if (rStream.pVBOutLayout != NULL)
+        {
+            // quantize the vertices as they are rearranged
+            QuantizeVertices(rStream.pVB, nVBStride, nVertices, *rStream.pVBOutLayout, pnVIDRemap, pVBOutTmp);
+        }
+        else
+        {
+            // rearrange the vertex buffer based on the remapping
+            const char* pVBuffer = (const char*) rStream.pVB;
+
+            for (unsigned int i = 0; i < nVertices; i++)
+            {
+                memcpy(&pVBOutTmp[ (size_t) pnVIDRemap[ i ] * nVBStride ], pVBuffer, nVBStride);
+
+                pVBuffer += nVBStride;
+            }
+        }
+
+        // copy the result if the user is supplying the same pointer for pVB and pVBOut
+        if (rStream.pVBOut != pVBOutTmp)
+        {
+            memcpy(rStream.pVBOut, pVBOutTmp, (size_t) nVertices * nVBOutStride);
+            delete[] pVBOutTmp;
+        }
+    }
 }
 
 //=================================================================================================================================
-/// This method should be called when the application is finished Tootling.
-/// Failure to call this function when the application is finished Tootling will result in resource leaks
+/// Computes a vertex re-ordering and applies it to the index buffer and to every vertex stream.  The arguments have been
+///  validated by the caller.
 //=================================================================================================================================
-void TOOTLE_DLL TootleCleanup()
+static TootleResult OptimizeVertexStreams(const unsigned int*         pnIB,
+                                          unsigned int                nVertices,
+                                          unsigned int                nFaces,
+                                          const TootleVertexStream*   pStreams,
+                                          unsigned int                nStreams,
+                                          unsigned int*               pnIBOut,
+                                          unsigned int*               pnVertexRemapOut,
+                                          TootleVertexMemoryOptimizer eVertexMemoryOptimizer,
+                                          unsigned int                nCacheSize,
+                                          unsigned int                nFetchLineSize)
 {
-    try 
+    // create an array of vertex id map.
+    unsigned int* pnVIDRemap = new unsigned int[ nVertices ];
+
+    unsigned int i;
+
+    // mark all vertices map as hasn't been touched/remapped.
+    for (i = 0; i < nVertices; i++)
     {
-        // clean up overdraw module
-        if (ODIsInitialized ()) {
-            ODCleanup ();
+        pnVIDRemap[ i ] = TOOTLE_MAX_VERTICES;
+    }
+
+    unsigned int nVIDCount = 0;
+
+    AssignVertexLocations(pnIB, nVertices, nFaces, eVertexMemoryOptimizer, nCacheSize,
+                          GetFetchBlockSize(pStreams, nStreams, nFetchLineSize), pnVIDRemap, nVIDCount);
+
+    // Make sure we map all the vertices.
+    // It is possible for some of the vertices not to be referenced by the triangle indices.
+    // In this case, we just assign them to the end of the vertex buffer.
+    for (i = 0; i < nVertices; i++)
+    {
+        if (pnVIDRemap[ i ] == TOOTLE_MAX_VERTICES)
+        {
+            pnVIDRemap[ i ] = nVIDCount++;
         }
     }
-    catch (...)         
+
+    // check the result (make sure we have mapped all the vertices)
+    assert(nVIDCount == nVertices);
+
+    // REMAP THE VERTICES in the index buffer.  pnIBOut may equal pnIB, each index is read before it is written.
+    unsigned int nFaces3 = nFaces * 3;
+    bool bWarning        = true;
+
+    for (i = 0; i < nFaces3; i++)
+    {
+        unsigned int nVID = pnIB[ i ];
+
+        if (nVID >= nVertices && bWarning)
+        {
+            fprintf(stderr, "TootleOptimizeVertexMemory's warning: triangle indices are referencing out-of-bounds vertex buffer.\n");
+            bWarning = false;
+        }
+
+        if (pnIBOut != NULL)
+        {
+            pnIBOut[ i ] = (nVID < nVertices) ? pnVIDRemap[ nVID ] : nVID;
+        }
+    }
+
+    RemapVertexStreams(pStreams, nStreams, nVertices, pnVIDRemap);
+
+    // if the vertex id remap is asked by the caller
+    if (pnVertexRemapOut)
     {
+        memcpy(pnVertexRemapOut, pnVIDRemap, nVertices * sizeof(unsigned int));
     }
+
+    delete [] pnVIDRemap;
+
+    return TOOTLE_OK;
 }
 
-TootleResult TOOTLE_DLL TootleOptimize(const void*             pVB,
-                                       const unsigned int*     pnIB,
-                                       unsigned int            nVertices,
-                                       unsigned int            nFaces,
-                                       unsigned int            nVBStride,
-                                       unsigned int            nCacheSize,
-                                       const float*            pViewpoints,
-                                       unsigned int            nViewpoints,
-                                       TootleFaceWinding       eFrontWinding,
-                                       unsigned int*           pnIBOut,
-                                       unsigned int*           pnNumClustersOut,
-                                       TootleVCacheOptimizer   eVCacheOptimizer,
-                                       TootleOverdrawOptimizer eOverdrawOptimizer)
+TootleResult TOOTLE_DLL TootleOptimizeVertexMemoryEx(const void*                 pVB,
+                                                     const unsigned int*         pnIB,
+                                                     unsigned int                nVertices,
+                                                     unsigned int                nFaces,
+                                                     unsigned int                nVBStride,
+                                                     void*                       pVBOut,
+                                                     unsigned int*               pnIBOut,
+                                                     unsigned int*               pnVertexRemapOut,
+                                                     TootleVertexMemoryOptimizer eVertexMemoryOptimizer,
+                                                     unsigned int                nCacheSize,
+                                                     unsigned int                nFetchLineSize,
+                                                     const TootleVertexLayout*   pVBOutLayout)
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
 
     // sanity checks
     assert(pVB);
     assert(pnIB);
-    assert(pnIBOut);
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    // We also check whether nVertices is not equal to TOOTLE_MAX_VERTICES since
+    //  we will use TOOTLE_MAX_VERTICES as a flag to denote that the vertex has not been mapped.
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleOptimize: Invalid value of nVertices"));
+        errorf(("TootleOptimizeVertexMemory: nVertices is invalid")) ;
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
     {
-        errorf(("TootleOptimize: Invalid value of nFaces"));
+        errorf(("TootleOptimizeVertexMemory: nFaces is invalid")) ;
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nCacheSize == 0)
+    if (nVBStride < 3 * sizeof(float))
     {
-        errorf(("TootleOptimize: nCacheSize = 0"));
+        errorf(("TootleOptimizeVertexMemory: nVBStride is less than 3*sizeof(float)"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nVBStride < 3 * sizeof(float))
+    if (eVertexMemoryOptimizer != TOOTLE_VMEMORY_FIRST_USE && eVertexMemoryOptimizer != TOOTLE_VMEMORY_FETCH_AWARE)
     {
-        errorf(("TootleOptimize: nVBStride is less than 3*sizeof(float)"));
+        errorf(("TootleOptimizeVertexMemory: eVertexMemoryOptimizer is invalid"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // make sure that they're not being stupid and passing us bad enum values
-    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    if (nFetchLineSize == 0)
     {
-        errorf(("Invalid face winding."));
+        errorf(("TootleOptimizeVertexMemory: nFetchLineSize = 0"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // allocate an array to hold the cluster ID for each face
-    unsigned int* pnFaceClusters = new unsigned int[ nFaces + 1 ];
-
-    TootleResult result;
-    // cluster the mesh, and sort faces by cluster
-    result = TootleClusterMesh(pVB, pnIB, nVertices, nFaces, nVBStride, 0, pnIBOut, pnFaceClusters, NULL);
-
-    if (result != TOOTLE_OK)
+    if (pVBOutLayout != NULL && !IsVertexLayoutValid(*pVBOutLayout, nVBStride))
     {
-        return result;
+        errorf(("TootleOptimizeVertexMemory: pVBOutLayout is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
     }
 
-    // perform vertex cache optimization on the clustered mesh
-    result = TootleVCacheClusters(pnIBOut, nFaces, nVertices, nCacheSize, pnFaceClusters, pnIBOut, NULL, eVCacheOptimizer);
+    TootleVertexStream stream;
+    stream.pVB          = pVB;
+    stream.pVBOut       = pVBOut;
+    stream.nVBStride    = nVBStride;
+    stream.pVBOutLayout = pVBOutLayout;
 
-    if (result != TOOTLE_OK)
+    return OptimizeVertexStreams(pnIB, nVertices, nFaces, &stream, 1, pnIBOut, pnVertexRemapOut, eVertexMemoryOptimizer,
+                                 nCacheSize, nFetchLineSize);
+
+    AMD_TOOTLE_API_FUNCTION_END
+}
+
+TootleResult TOOTLE_DLL TootleOptimizeVertexMemory(const void*         pVB,
+                                                   const unsigned int* pnIB,
+                                                   unsigned int        nVertices,
+                                                   unsigned int        nFaces,
+                                                   unsigned int        nVBStride,
+                                                   void*               pVBOut,
+                                                   unsigned int*       pnIBOut,
+                                                   unsigned int*       pnVertexRemapOut)
+{
+    return TootleOptimizeVertexMemoryEx(pVB, pnIB, nVertices, nFaces, nVBStride, pVBOut, pnIBOut, pnVertexRemapOut);
+}
+
+TootleResult TOOTLE_DLL TootleOptimizeVertexStreams(const unsigned int*         pnIB,
+                                                    unsigned int                nVertices,
+                                                    unsigned int                nFaces,
+                                                    const TootleVertexStream*   pStreams,
+                                                    unsigned int                nStreams,
+                                                    unsigned int*               pnIBOut,
+                                                    unsigned int*               pnVertexRemapOut,
+                                                    TootleVertexMemoryOptimizer eVertexMemoryOptimizer,
+                                                    unsigned int                nCacheSize,
+                                                    unsigned int                nFetchLineSize)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
+
+    // sanity checks
+    assert(pnIB);
+    assert(pStreams || nStreams == 0);
+
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        return result;
+        errorf(("TootleOptimizeVertexStreams: nVertices is invalid")) ;
+
+        return TOOTLE_INVALID_ARGS;
     }
 
-    // optimize the draw order
-    result = TootleOptimizeOverdraw(pVB, pnIBOut, nVertices, nFaces, nVBStride, pViewpoints, nViewpoints, eFrontWinding,
-                                    pnFaceClusters, pnIBOut, NULL, eOverdrawOptimizer);
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleOptimizeVertexStreams: nFaces is invalid")) ;
 
-    if (result != TOOTLE_OK)
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    for (unsigned int i = 0; i < nStreams; i++)
     {
-        return result;
+        if (pStreams[i].pVB == NULL || pStreams[i].nVBStride == 0)
+        {
+            errorf(("TootleOptimizeVertexStreams: a stream has no data or a zero stride"));
+
+            return TOOTLE_INVALID_ARGS;
+        }
+
+        if (pStreams[i].pVBOutLayout != NULL && !IsVertexLayoutValid(*pStreams[i].pVBOutLayout, pStreams[i].nVBStride))
+        {
+            errorf(("TootleOptimizeVertexStreams: a stream has an invalid pVBOutLayout"));
+
+            return TOOTLE_INVALID_ARGS;
+        }
     }
 
-    // if the resulting number of clusters is requested, return it to the caller
-    if (pnNumClustersOut)
+    if (eVertexMemoryOptimizer != TOOTLE_VMEMORY_FIRST_USE && eVertexMemoryOptimizer != TOOTLE_VMEMORY_FETCH_AWARE)
     {
-        *pnNumClustersOut = pnFaceClusters[ nFaces ];
+        errorf(("TootleOptimizeVertexStreams: eVertexMemoryOptimizer is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
     }
 
-    delete [] pnFaceClusters;
+    if (nFetchLineSize == 0)
+    {
+        errorf(("TootleOptimizeVertexStreams: nFetchLineSize = 0"));
 
-    return TOOTLE_OK;
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    return OptimizeVertexStreams(pnIB, nVertices, nFaces, pStreams, nStreams, pnIBOut, pnVertexRemapOut,
+                                 eVertexMemoryOptimizer, nCacheSize, nFetchLineSize);
 
     AMD_TOOTLE_API_FUNCTION_END
 }
 
-TootleResult TOOTLE_DLL TootleFastOptimize(const void*         pVB,
-                                           const unsigned int* pnIB,
-                                           unsigned int        nVertices,
-                                           unsigned int        nFaces,
-                                           unsigned int        nVBStride,
-                                           unsigned int        nCacheSize,
-                                           TootleFaceWinding   eFrontWinding,
-                                           unsigned int*       pnIBOut,
-                                           unsigned int*       pnNumClustersOut,
-                                           float               fAlpha)
+TootleResult TOOTLE_DLL TootleOptimizeLODChain(const void*                 pVB,
+                                               unsigned int                nVertices,
+                                               unsigned int                nVBStride,
+                                               TootleLODLevel*             pLevels,
+                                               unsigned int                nLevels,
+                                               unsigned int                nCacheSize,
+                                               const float*                pViewpoints,
+                                               unsigned int                nViewpoints,
+                                               TootleFaceWinding           eFrontWinding,
+                                               void*                       pVBOut,
+                                               unsigned int*               pnVertexRemapOut,
+                                               TootleVCacheOptimizer       eVCacheOptimizer,
+                                               TootleOverdrawOptimizer     eOverdrawOptimizer,
+                                               TootleVertexMemoryOptimizer eVertexMemoryOptimizer,
+                                               unsigned int                nFetchLineSize,
+                                               const TootleVertexLayout*   pVBOutLayout)
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
 
     // sanity checks
     assert(pVB);
-    assert(pnIB);
-    assert(pnIBOut);
+    assert(pLevels);
+    assert(pVBOut);
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleFastOptimize: Invalid value of nVertices"));
+        errorf(("TootleOptimizeLODChain: nVertices is invalid"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    if (nLevels == 0)
     {
-        errorf(("TootleFastOptimize: Invalid value of nFaces"));
+        errorf(("TootleOptimizeLODChain: nLevels = 0"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nVBStride < 3 * sizeof(float))
     {
-        errorf(("TootleFastOptimize: nVBStride is less than 3*sizeof(float)"));
+        errorf(("TootleOptimizeLODChain: nVBStride is less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (eVertexMemoryOptimizer != TOOTLE_VMEMORY_FIRST_USE && eVertexMemoryOptimizer != TOOTLE_VMEMORY_FETCH_AWARE)
+    {
+        errorf(("TootleOptimizeLODChain: eVertexMemoryOptimizer is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (nFetchLineSize == 0)
+    {
+        errorf(("TootleOptimizeLODChain: nFetchLineSize = 0"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    if (pVBOutLayout != NULL && !IsVertexLayoutValid(*pVBOutLayout, nVBStride))
+    {
+        errorf(("TootleOptimizeLODChain: pVBOutLayout is invalid"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nCacheSize == 0)
+    UINT nLevel;
+    UINT i;
+
+    for (nLevel = 0; nLevel < nLevels; nLevel++)
+    {
+        const TootleLODLevel& rLevel = pLevels[ nLevel ];
+
+        if (rLevel.pnIB == NULL || rLevel.pnIBOut == NULL || rLevel.nFaces == 0 || rLevel.nFaces > TOOTLE_MAX_FACES)
+        {
+            errorf(("TootleOptimizeLODChain: level %u is invalid", nLevel));
+
+            return TOOTLE_INVALID_ARGS;
+        }
+
+        for (i = 0; i < 3 * rLevel.nFaces; i++)
+        {
+            if (rLevel.pnIB[ i ] >= nVertices)
+            {
+                errorf(("TootleOptimizeLODChain: level %u references an out-of-bounds vertex", nLevel));
+
+                return TOOTLE_INVALID_ARGS;
+            }
+        }
+    }
+
+    // optimize each level for the vertex cache and overdraw on its own
+    TootleResult result;
+
+    for (nLevel = 0; nLevel < nLevels; nLevel++)
     {
-        errorf(("TootleFastOptimize: nCacheSize = 0"));
+        TootleLODLevel& rLevel = pLevels[ nLevel ];
 
-        return TOOTLE_INVALID_ARGS;
+        result = TootleOptimize(pVB, rLevel.pnIB, nVertices, rLevel.nFaces, nVBStride, nCacheSize, pViewpoints, nViewpoints,
+                                eFrontWinding, rLevel.pnIBOut, NULL, eVCacheOptimizer, eOverdrawOptimizer);
+
+        if (result != TOOTLE_OK)
+        {
+            return result;
+        }
     }
 
-    unsigned int* pnClustersTmp;
-    unsigned int  pnNumClustersTmp;
+    // Assign the vertex locations from the coarsest level to the finest, so that each level adds its new vertices after the
+    //  ones of the coarser levels.
+    TootleVertexStream stream;
+    stream.pVB          = pVB;
+    stream.pVBOut       = pVBOut;
+    stream.nVBStride    = nVBStride;
+    stream.pVBOutLayout = pVBOutLayout;
 
-    pnClustersTmp = new unsigned int[ nFaces + 1 ];
+    UINT nBlockSize = GetFetchBlockSize(&stream, 1, nFetchLineSize);
 
-    TootleResult result;
+    std::vector<UINT> vidRemap(nVertices, TOOTLE_MAX_VERTICES);
+    UINT nVIDCount = 0;
 
-    // OPTIMIVE VERTEX CACHE AND CLUSTERS
-    result = TootleFastOptimizeVCacheAndClusterMesh(pnIB, nFaces, nVertices, nCacheSize, pnIBOut,
-                                                    pnClustersTmp, &pnNumClustersTmp, fAlpha);
+    for (nLevel = nLevels; nLevel-- > 0;)
+    {
+        TootleLODLevel& rLevel = pLevels[ nLevel ];
 
-    if (result != TOOTLE_OK)
+        AssignVertexLocations(rLevel.pnIBOut, nVertices, rLevel.nFaces, eVertexMemoryOptimizer, nCacheSize, nBlockSize,
+                              &vidRemap[0], nVIDCount);
+
+        rLevel.nVerticesOut = nVIDCount;
+    }
+
+    // vertices that no level references go to the end of the vertex buffer
+    for (i = 0; i < nVertices; i++)
     {
-        // an error detected
-        delete[] pnClustersTmp;
-        return result;
+        if (vidRemap[ i ] == TOOTLE_MAX_VERTICES)
+        {
+            vidRemap[ i ] = nVIDCount++;
+        }
     }
 
-    // OPTIMIZE OVERDRAW
-    result = TootleOptimizeOverdraw(pVB, pnIBOut, nVertices, nFaces, nVBStride, NULL, 0,
-                                    eFrontWinding, pnClustersTmp, pnIBOut, NULL, TOOTLE_OVERDRAW_FAST);
+    assert(nVIDCount == nVertices);
 
-    delete[] pnClustersTmp;
+    for (nLevel = 0; nLevel < nLevels; nLevel++)
+    {
+        TootleLODLevel& rLevel = pLevels[ nLevel ];
 
-    if (pnNumClustersOut)
+        for (i = 0; i < 3 * rLevel.nFaces; i++)
+        {
+            rLevel.pnIBOut[ i ] = vidRemap[ rLevel.pnIBOut[ i ] ];
+        }
+    }
+
+    RemapVertexStreams(&stream, 1, nVertices, &vidRemap[0]);
+
+    if (pnVertexRemapOut)
     {
-        *pnNumClustersOut = pnNumClustersTmp;
+        memcpy(pnVertexRemapOut, &vidRemap[0], nVertices * sizeof(unsigned int));
     }
 
-    return result;
+    return TOOTLE_OK;
 
     AMD_TOOTLE_API_FUNCTION_END
 }
 
-TootleResult TOOTLE_DLL TootleVCacheClusters(const unsigned int*   pnIB,
-                                             unsigned int          nFaces,
-                                             unsigned int          nVertices,
-                                             unsigned int          nCacheSize,
-                                             const unsigned int*   pnFaceClusters,
-                                             unsigned int*         pnIBOut,
-                                             unsigned int*         pnFaceRemapOut,
-                                             TootleVCacheOptimizer eVCacheOptimizer)
+/// The work shared by the threads of TootleOptimizeSubmeshes
+struct SubmeshBatch
 {
+    const void*               pVB;
+    unsigned int              nVertices;
+    unsigned int              nVBStride;
+    unsigned int              nCacheSize;
+    TootleVCacheOptimizer     eVCacheOptimizer;
+    const UINT*               pnMaterialStart;  ///< The first face of each material, followed by the number of faces
+    unsigned int              nMaterials;
+    UINT*                     pnIB;             ///< The index buffer, sorted by material.  Optimized in place.
+    UINT*                     pnFaceClusters;   ///< Receives the cluster of each face, numbered from 0 within each material
+    std::vector<TootleResult> results;          ///< The result of each material, NA_TOOTLE_RESULT until it is optimized
+    std::atomic<UINT>         nNextMaterial;    ///< The next material to be taken by a thread
+};
 
-    AMD_TOOTLE_API_FUNCTION_BEGIN
+//=================================================================================================================================
+/// Clusters the faces of one material of a SubmeshBatch and optimizes each cluster for the vertex cache.  The vertices of the
+///  material are packed into a local vertex buffer first, so that the cost does not depend on the size of the whole mesh.
+///
+/// \param rBatch     The batch
+/// \param nMaterial  The material to optimize.  Must have at least one face.
+/// \param rLocalIDs  Scratch array of nVertices elements, all TOOTLE_MAX_VERTICES.  They are reset before returning.
+//=================================================================================================================================
+static TootleResult OptimizeSubmesh(SubmeshBatch& rBatch, UINT nMaterial, std::vector<UINT>& rLocalIDs)
+{
+    UINT  nFirstFace = rBatch.pnMaterialStart[ nMaterial ];
+    UINT  nFaces     = rBatch.pnMaterialStart[ nMaterial + 1 ] - nFirstFace;
+    UINT* pnIB       = &rBatch.pnIB[ 3 * nFirstFace ];
+    UINT  i;
 
-    // sanity checks
-    assert(pnIB);
+    // pack the vertices referenced by the material
+    std::vector<UINT>  globalIDs;
+    std::vector<float> positions;
+    std::vector<UINT>  localIB(3 * nFaces);
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    for (i = 0; i < 3 * nFaces; i++)
     {
-        errorf(("TootleVCacheClusters: Invalid value of nFaces"));
+        UINT nVID = pnIB[ i ];
 
-        return TOOTLE_INVALID_ARGS;
-    }
+        if (rLocalIDs[ nVID ] == TOOTLE_MAX_VERTICES)
+        {
+            const float* pfPosition = (const float*)((const char*) rBatch.pVB + (size_t) nVID * rBatch.nVBStride);
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
-    {
-        errorf(("TootleVCacheClusters: Invalid value of nVertices"));
+            rLocalIDs[ nVID ] = (UINT) globalIDs.size();
+            globalIDs.push_back(nVID);
+            positions.insert(positions.end(), pfPosition, pfPosition + 3);
+        }
 
-        return TOOTLE_INVALID_ARGS;
+        localIB[ i ] = rLocalIDs[ nVID ];
     }
 
-    if (nCacheSize == 0)
+    for (i = 0; i < globalIDs.size(); i++)
     {
-        errorf(("TootleVCacheClusters: nCacheSize = 0"));
+        rLocalIDs[ globalIDs[ i ] ] = TOOTLE_MAX_VERTICES;
+    }
 
-        return TOOTLE_INVALID_ARGS;
+    // cluster the material, and optimize the clusters for the vertex cache, as TootleOptimize does
+    UINT nLocalVertices = (UINT) globalIDs.size();
+    std::vector<UINT> clusters(nFaces + 1);
+    TootleResult result;
+
+    result = TootleClusterMesh(&positions[0], &localIB[0], nLocalVertices, nFaces, 3 * sizeof(float), 0, &localIB[0],
+                               &clusters[0], NULL);
+
+    if (result != TOOTLE_OK)
+    {
+        return result;
     }
 
-    if (eVCacheOptimizer != TOOTLE_VCACHE_AUTO     &&
-        eVCacheOptimizer != TOOTLE_VCACHE_DIRECT3D &&
-        eVCacheOptimizer != TOOTLE_VCACHE_LSTRIPS  &&
-        eVCacheOptimizer != TOOTLE_VCACHE_TIPSY)
+    result = TootleVCacheClusters(&localIB[0], nFaces, nLocalVertices, rBatch.nCacheSize, &clusters[0], &localIB[0], NULL,
+                                  rBatch.eVCacheOptimizer);
+
+    if (result != TOOTLE_OK)
     {
-        errorf(("TootleVCacheClusters: Invalid selection for vertex cache optimization algorithm"));
+        return result;
+    }
 
-        return TOOTLE_INVALID_ARGS;
+    for (i = 0; i < 3 * nFaces; i++)
+    {
+        pnIB[ i ] = globalIDs[ localIB[ i ] ];
     }
 
-    // VCache within clusters
-    UINT nClusterStart = 0;
-    TootleResult result;
+    memcpy(&rBatch.pnFaceClusters[ nFirstFace ], &clusters[0], nFaces * sizeof(UINT));
 
-    for (UINT i = 0; i < nFaces; i++)
+    return TOOTLE_OK;
+}
+
+//=================================================================================================================================
+/// The thread function of TootleOptimizeSubmeshes.  Takes materials from the batch until none are left.
+//=================================================================================================================================
+static void OptimizeSubmeshesWorker(SubmeshBatch* pBatch)
+{
+    try
     {
-        if (i == nFaces - 1 || (pnFaceClusters[i + 1] != pnFaceClusters[i]))
-        {
-            UINT nClusterFaces = 1 + (i - nClusterStart);
+        std::vector<UINT> localIDs(pBatch->nVertices, TOOTLE_MAX_VERTICES);
 
-            const UINT* pnClusterIB = &pnIB[ 3 * nClusterStart ];
-            UINT* pnClusterIBOut = (pnIBOut) ? &pnIBOut[ 3 * nClusterStart ] : 0;
-            UINT* pnClusterRemapOut = (pnFaceRemapOut) ? &pnFaceRemapOut[ 3 * nClusterStart ] : 0;
+        for (;;)
+        {
+            UINT nMaterial = pBatch->nNextMaterial++;
 
-            result = TootleOptimizeVCache(pnClusterIB, nClusterFaces, nVertices, nCacheSize,
-                                          pnClusterIBOut, pnClusterRemapOut, eVCacheOptimizer);
+            if (nMaterial >= pBatch->nMaterials)
+            {
+                break;
+            }
 
-            if (result != TOOTLE_OK)
+            if (pBatch->pnMaterialStart[ nMaterial ] == pBatch->pnMaterialStart[ nMaterial + 1 ])
             {
-                return result;
+                pBatch->results[ nMaterial ] = TOOTLE_OK;
+                continue;
             }
 
-            nClusterStart = i + 1;
+            pBatch->results[ nMaterial ] = OptimizeSubmesh(*pBatch, nMaterial, localIDs);
         }
     }
+    catch (const std::bad_alloc&)
+    {
+        // the material being optimized keeps NA_TOOTLE_RESULT, the other threads carry on with the rest
+    }
+}
 
-    return TOOTLE_OK;
+/// Orders indices by an array of measures, in ascending order.  Equal measures keep the order of their indices.
+class MeasureLess
+{
+public:
+    MeasureLess(const std::vector<float>& rMeasures) : m_rMeasures(rMeasures) {}
 
-    AMD_TOOTLE_API_FUNCTION_END
-}
+    bool operator()(UINT a, UINT b) const
+    {
+        return (m_rMeasures[a] != m_rMeasures[b]) ? (m_rMeasures[a] < m_rMeasures[b]) : (a < b);
+    }
 
-TootleResult TOOTLE_DLL TootleMeasureCacheEfficiency(const unsigned int* pnIB,
-                                                     unsigned int        nFaces,
-                                                     unsigned int        nCacheSize,
-                                                     float*              pfEfficiencyOut)
+private:
+    const std::vector<float>& m_rMeasures;
+};
+
+//=================================================================================================================================
+/// Orders the clusters within each material, and the materials, by the view-independent measure of
+///  TOOTLE_OVERDRAW_FAST.  The measures of all the clusters and materials are taken relative to the centroid of the whole mesh.
+///
+/// \param pfVB           The vertex positions, 3 floats per vertex
+/// \param pnIB           The index buffer, sorted by material and by cluster within each material
+/// \param nFaces         The number of faces
+/// \param eFrontWinding  The winding order of front faces
+/// \param rClusterStart  The first face of each cluster, followed by nFaces
+/// \param rMaterialStart The first face of each (non-empty) material, followed by nFaces
+/// \param rFirstCluster  The first cluster of each material, followed by the number of clusters
+/// \param rClusterOrder  Receives, for each material's range of clusters, the clusters of that material in draw order
+/// \param rMaterialOrder Receives the materials in draw order
+//=================================================================================================================================
+static void OrderSubmeshesFast(const float*             pfVB,
+                               const UINT*              pnIB,
+                               UINT                     nFaces,
+                               TootleFaceWinding        eFrontWinding,
+                               const std::vector<int>&  rClusterStart,
+                               const std::vector<int>&  rMaterialStart,
+                               const std::vector<UINT>& rFirstCluster,
+                               std::vector<UINT>&       rClusterOrder,
+                               std::vector<UINT>&       rMaterialOrder)
 {
-    AMD_TOOTLE_API_FUNCTION_BEGIN
+    UINT nClusters  = (UINT) rClusterStart.size() - 1;
+    UINT nMaterials = (UINT) rMaterialStart.size() - 1;
+    UINT i;
 
-    // sanity checks
-    assert(pnIB);
-    assert(pfEfficiencyOut);
+    std::vector<float> clusterMeasures(nClusters);
+    std::vector<float> materialMeasures(nMaterials);
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
-    {
-        errorf(("TootleMeasureCacheEfficiency: Invalid value of nFaces"));
+    OverdrawClusterMeasures((const int*) pnIB, nFaces, pfVB, eFrontWinding, &rClusterStart[0], nClusters, &clusterMeasures[0]);
+    OverdrawClusterMeasures((const int*) pnIB, nFaces, pfVB, eFrontWinding, &rMaterialStart[0], nMaterials,
+                            &materialMeasures[0]);
 
-        return TOOTLE_INVALID_ARGS;
+    for (i = 0; i < nClusters; i++)
+    {
+        rClusterOrder[ i ] = i;
     }
 
-    if (nCacheSize == 0)
+    for (i = 0; i < nMaterials; i++)
     {
-        errorf(("TootleMeasureCacheEfficiency: nCacheSize = 0"));
+        std::stable_sort(&rClusterOrder[0] + rFirstCluster[ i ], &rClusterOrder[0] + rFirstCluster[ i + 1 ],
+                         MeasureLess(clusterMeasures));
 
-        return TOOTLE_INVALID_ARGS;
+        rMaterialOrder[ i ] = i;
     }
 
-    // allocate ourselves a vertex cache
-    unsigned int* pnCache = new unsigned int[nCacheSize];
+    std::stable_sort(rMaterialOrder.begin(), rMaterialOrder.end(), MeasureLess(materialMeasures));
+}
 
-    // initialize cache to EMPTY
-    UINT nEmpty = 0xffffffff;
+//=================================================================================================================================
+/// Orders the clusters within each material, and the materials, with one overdraw graph of all the clusters.  The edges
+///  between clusters of the same material order that material's clusters, and the edges between clusters of different materials
+///  are summed to order the materials.
+///
+/// \param rSoup          The mesh, sorted by material and by cluster within each material
+/// \param pfViewpoint    The viewpoints.  May be NULL to use the default ones.
+/// \param nViewpoints    The number of viewpoints
+/// \param eFrontWinding  The winding order of front faces
+/// \param eOverdrawOptimizer The algorithm used to compute the overdraw graph
+/// \param rFaceClusters  The cluster of each face
+/// \param rClusterStart  The first face of each cluster, followed by the number of faces
+/// \param rFirstCluster  The first cluster of each (non-empty) material, followed by the number of clusters
+/// \param rClusterOrder  Receives, for each material's range of clusters, the clusters of that material in draw order
+/// \param rMaterialOrder Receives the materials in draw order
+//=================================================================================================================================
+static TootleResult OrderSubmeshesByGraph(Soup&                    rSoup,
+                                          const float*             pfViewpoint,
+                                          unsigned int             nViewpoints,
+                                          TootleFaceWinding        eFrontWinding,
+                                          TootleOverdrawOptimizer  eOverdrawOptimizer,
+                                          const std::vector<int>&  rFaceClusters,
+                                          const std::vector<int>&  rClusterStart,
+                                          const std::vector<UINT>& rFirstCluster,
+                                          std::vector<UINT>&       rClusterOrder,
+                                          std::vector<UINT>&       rMaterialOrder)
+{
+    UINT nClusters  = (UINT) rClusterStart.size() - 1;
+    UINT nMaterials = (UINT) rFirstCluster.size() - 1;
+    UINT i;
 
-    for (UINT i = 0; i < nCacheSize; i++)
+    // use default viewpoints if they were omitted
+    if (!pfViewpoint)
     {
-        pnCache[i] = nEmpty;
+        pfViewpoint = pDefaultViewpoint;
+        nViewpoints = nDefaultViewpoints;
     }
 
-    // simulate vertex processing
-    UINT nFetches = 0;
-    UINT nCacheIndex = 0;
-    UINT nIndices = 3 * nFaces;
+    // compute the overdraw graph of all the clusters once
+    std::vector<t_edge> graph;
 
-    for (UINT i = 0; i < nIndices; i++)
+    if (nClusters > 1)
     {
-        UINT nVert = pnIB[i];
-
-        // search for this vertex in the cache
-        bool bFound = false;
+        TootleResult result = ODSetSoup(&rSoup, eFrontWinding);
 
-        for (UINT j = 0; j < nCacheSize; j++)
+        if (result != TOOTLE_OK)
         {
-            if (nVert == pnCache[j])
-            {
-                bFound = true;
-                break;
-            }
+            return result;
         }
 
-        // it's not there, so put it there
-        if (!bFound)
-        {
-            nFetches++;
-            pnCache[nCacheIndex] = pnIB[i];
-            nCacheIndex = (nCacheIndex + 1);
+        result = ODOverdrawGraph(pfViewpoint, nViewpoints,
+                                 (eFrontWinding != TOOTLE_CCW),    // cull CCW faces if they aren't front facing
+                                 rFaceClusters, rClusterStart, graph, eOverdrawOptimizer, TOOTLE_OVERDRAW_COST_PLAIN);
 
-            if (nCacheIndex == nCacheSize)
-            {
-                nCacheIndex = 0;
-            }
+        if (result != TOOTLE_OK)
+        {
+            return result;
         }
     }
 
-    delete [] pnCache;
+    std::vector<UINT> clusterMaterial(nClusters);
 
-    // I don't know why anyone would pass NULL for this, but just in case...
-    if (pfEfficiencyOut)
+    for (i = 0; i < nMaterials; i++)
     {
-        *pfEfficiencyOut = (float) nFetches / (float) nFaces;
+        for (UINT j = rFirstCluster[ i ]; j < rFirstCluster[ i + 1 ]; j++)
+        {
+            clusterMaterial[ j ] = i;
+        }
     }
 
-    return TOOTLE_OK;
-
-    AMD_TOOTLE_API_FUNCTION_END
-}
-
-TootleResult TOOTLE_DLL TootleMeasureOverdraw(const void*             pVB,
-                                              const unsigned int*     pnIB,
-                                              unsigned int            nVertices,
-                                              unsigned int            nFaces,
-                                              unsigned int            nVBStride,
-                                              const float*            pfViewpoint,
-                                              unsigned int            nViewpoints,
-                                              TootleFaceWinding       eFrontWinding,
-                                              float*                  pfAvgODOut,
-                                              float*                  pfMaxODOut,
-                                              TootleOverdrawOptimizer eOverdrawOptimizer)
-{
-    AMD_TOOTLE_API_FUNCTION_BEGIN
-
-    // sanity checks
-    assert(pVB);
-    assert(pnIB);
+    // split the graph into the edges within each material, and the net cost between each pair of materials
+    std::vector< std::vector<t_edge> > materialGraphs(nMaterials);
+    std::map< std::pair<UINT, UINT>, int > materialCosts;
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    for (i = 0; i < graph.size(); i++)
     {
-        errorf(("TootleMeasureOverdraw: nCacheSize = 0"));
+        UINT nFrom = clusterMaterial[ graph[ i ].from ];
+        UINT nTo   = clusterMaterial[ graph[ i ].to ];
 
+        if (nFrom == nTo)
+        {
+            t_edge edge = graph[ i ];
+            edge.from -= rFirstCluster[ nFrom ];
+            edge.to   -= rFirstCluster[ nFrom ];
 
-        return TOOTLE_INVALID_ARGS;
+            materialGraphs[ nFrom ].push_back(edge);
+        }
+        else if (nFrom < nTo)
+        {
+            materialCosts[ std::make_pair(nFrom, nTo) ] += graph[ i ].cost;
+        }
+        else
+        {
+            materialCosts[ std::make_pair(nTo, nFrom) ] -= graph[ i ].cost;
+        }
     }
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    // order the clusters of each material
+    std::vector<int> order;
+
+    for (i = 0; i < nMaterials; i++)
     {
-        errorf(("TootleMeasureOverdraw: Invalid value of nFaces"));
+        UINT nMaterialClusters = rFirstCluster[ i + 1 ] - rFirstCluster[ i ];
+        order.resize(nMaterialClusters);
 
-        return TOOTLE_INVALID_ARGS;
+        if (materialGraphs[ i ].size() != 0)
+        {
+            if (!feedback(nMaterialClusters, (int) materialGraphs[ i ].size(), &materialGraphs[ i ][0], &order[0]))
+            {
+                return TOOTLE_OUT_OF_MEMORY;
+            }
+        }
+        else
+        {
+            for (UINT j = 0; j < nMaterialClusters; j++)
+            {
+                order[ j ] = j;
+            }
+        }
+
+        for (UINT j = 0; j < nMaterialClusters; j++)
+        {
+            rClusterOrder[ rFirstCluster[ i ] + j ] = rFirstCluster[ i ] + order[ j ];
+        }
     }
 
-    if (nVBStride < 3 * sizeof(float))
+    // order the materials
+    std::vector<t_edge> materialGraph;
+
+    for (std::map< std::pair<UINT, UINT>, int >::const_iterator it = materialCosts.begin(); it != materialCosts.end(); ++it)
     {
-        errorf(("TootleMeasureOverdraw: nVBStride less than 3*sizeof(float)"));
+        if (it->second != 0)
+        {
+            t_edge edge;
+            edge.from = (it->second > 0) ? it->first.first : it->first.second;
+            edge.to   = (it->second > 0) ? it->first.second : it->first.first;
+            edge.cost = (it->second > 0) ? it->second : -it->second;
 
-        return TOOTLE_INVALID_ARGS;
+            materialGraph.push_back(edge);
+        }
     }
 
-#ifdef _SOFTWARE_ONLY_VERSION
-    eOverdrawOptimizer;  // satisfy unused parameter warning message
-    return TootleMeasureOverdrawRaytrace(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
-                                         eFrontWinding, pfAvgODOut, pfMaxODOut);
-#else
+    order.resize(nMaterials);
 
-    switch (eOverdrawOptimizer)
+    if (materialGraph.size() != 0)
     {
-        case TOOTLE_OVERDRAW_RAYTRACE:
-            return TootleMeasureOverdrawRaytrace(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
-                                                 eFrontWinding, pfAvgODOut, pfMaxODOut);
-
-        case TOOTLE_OVERDRAW_AUTO:
-        case TOOTLE_OVERDRAW_FAST:
-        case TOOTLE_OVERDRAW_DIRECT3D:
-        default:
-            return TootleMeasureOverdrawDirect3D(pVB, pnIB, nVertices, nFaces, nVBStride, pfViewpoint, nViewpoints,
-                                                 eFrontWinding, pfAvgODOut, pfMaxODOut);
+        if (!feedback(nMaterials, (int) materialGraph.size(), &materialGraph[0], &order[0]))
+        {
+            return TOOTLE_OUT_OF_MEMORY;
+        }
+    }
+    else
+    {
+        for (i = 0; i < nMaterials; i++)
+        {
+            order[ i ] = i;
+        }
     }
 
-#endif
+    for (i = 0; i < nMaterials; i++)
+    {
+        rMaterialOrder[ i ] = order[ i ];
+    }
 
-    AMD_TOOTLE_API_FUNCTION_END
+    return TOOTLE_OK;
 }
 
-#ifndef _SOFTWARE_ONLY_VERSION
-TootleResult TootleMeasureOverdrawDirect3D(const void*         pVB,
-                                           const unsigned int* pnIB,
-                                           unsigned int        nVertices,
-                                           unsigned int        nFaces,
-                                           unsigned int        nVBStride,
-                                           const float*        pfViewpoint,
-                                           unsigned int        nViewpoints,
-                                           TootleFaceWinding   eFrontWinding,
-                                           float*              pfAvgODOut,
-                                           float*              pfMaxODOut)
+TootleResult TOOTLE_DLL TootleOptimizeSubmeshes(const void*             pVB,
+                                                const unsigned int*     pnIB,
+                                                unsigned int            nVertices,
+                                                unsigned int            nFaces,
+                                                unsigned int            nVBStride,
+                                                unsigned int            nCacheSize,
+                                                const float*            pViewpoints,
+                                                unsigned int            nViewpoints,
+                                                TootleFaceWinding       eFrontWinding,
+                                                const unsigned int*     pnFaceMaterials,
+                                                unsigned int            nMaterials,
+                                                unsigned int*           pnIBOut,
+                                                unsigned int*           pnMaterialRemapOut,
+                                                unsigned int*           pnNumClustersOut,
+                                                TootleVCacheOptimizer   eVCacheOptimizer,
+                                                TootleOverdrawOptimizer eOverdrawOptimizer,
+                                                unsigned int            nThreads)
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
 
     // sanity checks
     assert(pVB);
     assert(pnIB);
+    assert(pnFaceMaterials);
+    assert(pnIBOut);
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleMeasureOverdraw: nCacheSize = 0"));
+        errorf(("TootleOptimizeSubmeshes: Invalid value of nVertices"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
     {
-        errorf(("TootleMeasureOverdraw: Invalid value of nFaces"));
+        errorf(("TootleOptimizeSubmeshes: Invalid value of nFaces"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (nVBStride < 3 * sizeof(float))
+    if (nCacheSize == 0)
     {
-        errorf(("TootleMeasureOverdraw: nVBStride less than 3*sizeof(float)"));
+        errorf(("TootleOptimizeSubmeshes: nCacheSize = 0"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    if (!ODIsInitialized())
+    if (nVBStride < 3 * sizeof(float))
     {
-        return TOOTLE_NOT_INITIALIZED;
+        errorf(("TootleOptimizeSubmeshes: nVBStride is less than 3*sizeof(float)"));
+
+        return TOOTLE_INVALID_ARGS;
     }
 
-    // make sure that they're not being stupid and passing us bad enum values
     if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
     {
-        errorf(("Invalid face winding."));
+        errorf(("TootleOptimizeSubmeshes: Invalid face winding."));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // use default viewpoints if they were omitted
-    if (!pfViewpoint)
+    if (nMaterials == 0)
     {
-        pfViewpoint = pDefaultViewpoint;
-        nViewpoints = nDefaultViewpoints;
-    }
+        errorf(("TootleOptimizeSubmeshes: nMaterials = 0"));
 
-    // cook us up some soup
-    Soup soup;
+        return TOOTLE_INVALID_ARGS;
+    }
 
-    if (!MakeSoup(pVB, pnIB, nVertices, nFaces, nVBStride, &soup))
+    switch (eOverdrawOptimizer)
     {
-        return TOOTLE_OUT_OF_MEMORY;
-    }
+        case TOOTLE_OVERDRAW_DIRECT3D:
+#ifdef _SOFTWARE_ONLY_VERSION
+            fprintf(stderr, "TootleOptimizeSubmeshes: No Direct3D support for this version.\n");
+            return TOOTLE_INTERNAL_ERROR;
+#endif
 
-    // send soup to overdraw module
-    TootleResult result = ODSetSoup(&soup, eFrontWinding);
+        case TOOTLE_OVERDRAW_AUTO:
+        case TOOTLE_OVERDRAW_RAYTRACE:
+#ifndef _SOFTWARE_ONLY_VERSION
+            if (!ODIsInitialized())
+            {
+                return TOOTLE_NOT_INITIALIZED;
+            }
 
-    if (result == TOOTLE_OK)
-    {
-        // measure overdraw
-        float fAvgOD, fMaxOD;
-        result = ODObjectOverdraw(pfViewpoint, nViewpoints, fAvgOD, fMaxOD);
+#endif
+            break;
 
-        if (result != TOOTLE_OK)
-        {
-            return result;
-        }
+        case TOOTLE_OVERDRAW_FAST:
+            break;
 
-        // set output variables
-        if (pfAvgODOut)
-        {
-            *pfAvgODOut = fAvgOD - 1.0f;
-        }
+        default:
+            errorf(("TootleOptimizeSubmeshes: eOverdrawOptimizer is invalid."));
 
-        if (pfMaxODOut)
-        {
-            *pfMaxODOut = fMaxOD - 1.0f;
-        }
+            return TOOTLE_INVALID_ARGS;
     }
 
-    return result;
+    UINT i;
 
-    AMD_TOOTLE_API_FUNCTION_END
-}
-#endif
+    for (i = 0; i < 3 * nFaces; i++)
+    {
+        if (pnIB[ i ] >= nVertices)
+        {
+            errorf(("TootleOptimizeSubmeshes: pnIB references an out-of-bounds vertex"));
 
-TootleResult TootleMeasureOverdrawRaytrace(const void*         pVB,
-                                           const unsigned int* pnIB,
-                                           unsigned int        nVertices,
-                                           unsigned int        nFaces,
-                                           unsigned int        nVBStride,
-                                           const float*        pfViewpoint,
-                                           unsigned int        nViewpoints,
-                                           TootleFaceWinding   eFrontWinding,
-                                           float*              pfAvgODOut,
-                                           float*              pfMaxODOut)
-{
-    AMD_TOOTLE_API_FUNCTION_BEGIN
+            return TOOTLE_INVALID_ARGS;
+        }
+    }
 
-    // sanity checks
-    assert(pVB);
-    assert(pnIB);
+    // sort the faces by material, keeping their order within each material
+    std::vector<UINT> materialStart(nMaterials + 1, 0);
 
-    if (nVertices == 0 || nVertices > TOOTLE_MAX_VERTICES)
+    for (i = 0; i < nFaces; i++)
     {
-        errorf(("TootleMeasureOverdraw: nCacheSize = 0"));
+        if (pnFaceMaterials[ i ] >= nMaterials)
+        {
+            errorf(("TootleOptimizeSubmeshes: a material ID is not less than nMaterials"));
 
-        return TOOTLE_INVALID_ARGS;
+            return TOOTLE_INVALID_ARGS;
+        }
+
+        materialStart[ pnFaceMaterials[ i ] + 1 ]++;
     }
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    for (i = 0; i < nMaterials; i++)
     {
-        errorf(("TootleMeasureOverdraw: Invalid value of nFaces"));
-
-        return TOOTLE_INVALID_ARGS;
+        materialStart[ i + 1 ] += materialStart[ i ];
     }
 
-    if (nVBStride < 3 * sizeof(float))
+    std::vector<UINT> ib(3 * nFaces);
+    std::vector<UINT> nextFace(materialStart.begin(), materialStart.end() - 1);
+
+    for (i = 0; i < nFaces; i++)
     {
-        errorf(("TootleMeasureOverdraw: nVBStride less than 3*sizeof(float)"));
+        UINT nFace = nextFace[ pnFaceMaterials[ i ] ]++;
 
-        return TOOTLE_INVALID_ARGS;
+        ib[ 3 * nFace + 0 ] = pnIB[ 3 * i + 0 ];
+        ib[ 3 * nFace + 1 ] = pnIB[ 3 * i + 1 ];
+        ib[ 3 * nFace + 2 ] = pnIB[ 3 * i + 2 ];
     }
 
-    // make sure that they're not being stupid and passing us bad enum values
-    if (eFrontWinding != TOOTLE_CCW && eFrontWinding != TOOTLE_CW)
+    // cluster each material and optimize its clusters for the vertex cache, on several threads
+    std::vector<UINT> faceClusters(nFaces);
+
+    SubmeshBatch batch;
+    batch.pVB              = pVB;
+    batch.nVertices        = nVertices;
+    batch.nVBStride        = nVBStride;
+    batch.nCacheSize       = nCacheSize;
+    batch.eVCacheOptimizer = eVCacheOptimizer;
+    batch.pnMaterialStart  = &materialStart[0];
+    batch.nMaterials       = nMaterials;
+    batch.pnIB             = &ib[0];
+    batch.pnFaceClusters   = &faceClusters[0];
+    batch.results.resize(nMaterials, NA_TOOTLE_RESULT);
+    batch.nNextMaterial    = 0;
+
+    if (nThreads == 0)
     {
-        errorf(("Invalid face winding."));
-     
-        return TOOTLE_INVALID_ARGS;
+        nThreads = std::thread::hardware_concurrency();
     }
 
-    // use default viewpoints if they were omitted
-    if (!pfViewpoint)
+    if (nThreads > nMaterials)
     {
-        pfViewpoint = pDefaultViewpoint;
-        nViewpoints = nDefaultViewpoints;
+        nThreads = nMaterials;
     }
 
-    // create a non-interleaved vertex buffer
-    float* pfVB = new float[ 3 * nVertices ];
-
-    const char* pVBuffer = (const char*) pVB;
+    std::vector<std::thread> workers;
 
-    for (unsigned int i = 0; i < nVertices; i++)
+    for (i = 1; i < nThreads; i++)
     {
-        memcpy(&pfVB[3 * i], pVBuffer, sizeof(float) * 3);
-        pVBuffer += nVBStride;
+        try
+        {
+            workers.push_back(std::thread(OptimizeSubmeshesWorker, &batch));
+        }
+        catch (const std::system_error&)
+        {
+            // carry on with the threads we have
+            break;
+        }
     }
 
-    TootleResult result;
-    float fAvgOD;
-    float fMaxOD;
-
-    result = ODObjectOverdrawRaytrace(pfVB, pnIB, nVertices, nFaces, pfViewpoint, nViewpoints,
-                                      (eFrontWinding != TOOTLE_CCW),    // cull CCW faces if they aren't front facing
-                                      fAvgOD, fMaxOD);
+    // the calling thread works too
+    OptimizeSubmeshesWorker(&batch);
 
-    if (pfAvgODOut)
+    for (i = 0; i < workers.size(); i++)
     {
-        *pfAvgODOut = fAvgOD - 1.0f;
+        workers[ i ].join();
     }
 
-    if (pfMaxODOut)
+    for (i = 0; i < nMaterials; i++)
     {
-        *pfMaxODOut = fMaxOD - 1.0f;
+        if (batch.results[ i ] != TOOTLE_OK)
+        {
+            // a material is left unoptimized if its thread ran out of memory
+            return (batch.results[ i ] == NA_TOOTLE_RESULT) ? TOOTLE_OUT_OF_MEMORY : batch.results[ i ];
+        }
     }
 
-    // clean up
-    delete[] pfVB;
+    // number the clusters across all the materials, skipping the materials without faces
+    std::vector<UINT> usedMaterials;
+    std::vector<int>  usedMaterialStart;
+    std::vector<UINT> firstCluster;
+    std::vector<int>  clusterStart;
+    std::vector<int>  clusters(nFaces);
 
-    return result;
+    for (i = 0; i < nMaterials; i++)
+    {
+        if (materialStart[ i ] == materialStart[ i + 1 ])
+        {
+            continue;
+        }
 
-    AMD_TOOTLE_API_FUNCTION_END
-}
+        UINT nFirstCluster = (UINT) clusterStart.size();
 
-//=================================================================================================================================
-/// A helper function to convert the cluster array ID from the full format to the compact format.
-///  The compact format is used by old tootle (i3D version) while the full format is used by the new tootle (SIGGRAPH version).
-///
-/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
-/// \param nFaces  The total number of faces of the mesh.
-///
-/// \return Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_INTERNAL_ERROR, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK.
-//=================================================================================================================================
-static TootleResult ConvertClusterArrayFromFullToCompact(unsigned int* pnID, unsigned int nFaces)
-{
-    // sanity checks
-    assert(pnID);
+        usedMaterials.push_back(i);
+        usedMaterialStart.push_back(materialStart[ i ]);
+        firstCluster.push_back(nFirstCluster);
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
-    {
-        errorf(("ConvertClusterArrayFromFullToCompact: nFaces is invalid"));
+        for (UINT j = materialStart[ i ]; j < materialStart[ i + 1 ]; j++)
+        {
+            if (j == materialStart[ i ] || faceClusters[ j ] != faceClusters[ j - 1 ])
+            {
+                clusterStart.push_back(j);
+            }
 
-        return TOOTLE_INVALID_ARGS;
+            clusters[ j ] = nFirstCluster + faceClusters[ j ];
+        }
     }
 
-    // if less then two triangles, then just return from the function.
-    if (nFaces < 2)
-    {
-        return TOOTLE_OK;
-    }
+    UINT nUsedMaterials = (UINT) usedMaterials.size();
+    UINT nClusters      = (UINT) clusterStart.size();
 
-    // check whether the cluster array is of a full format.
-    if (!IsClusterArrayFullFormat(pnID, nFaces))
+    usedMaterialStart.push_back(nFaces);
+    firstCluster.push_back(nClusters);
+    clusterStart.push_back(nFaces);
+
+    // order the clusters within each material, and the materials
+    std::vector<UINT> clusterOrder(nClusters);
+    std::vector<UINT> materialOrder(nUsedMaterials);
+
+    if (eOverdrawOptimizer == TOOTLE_OVERDRAW_FAST)
     {
-        errorf(("ConvertClusterIDFromFullToCompact: pnID is not a full format"));
-        
-        return TOOTLE_INTERNAL_ERROR;
-    }
+        // make a packed version of the vertex buffer
+        std::vector<float> positions(3 * nVertices);
+        const char* pVBuffer = (const char*) pVB;
 
-    unsigned int nNumCluster;
+        for (i = 0; i < nVertices; i++)
+        {
+            memcpy(&positions[ 3 * i ], pVBuffer, 3 * sizeof(float));
 
-    nNumCluster = 1 + pnID[ nFaces - 1 ];
+            pVBuffer += nVBStride;
+        }
 
-    // sanity check on the number of cluster
-    if (nNumCluster > nFaces)
-    {
-        errorf(("ConvertClusterArrayFromFullToCompact: nNumCluster > nFaces"));
-        
-        return TOOTLE_INTERNAL_ERROR;
+        OrderSubmeshesFast(&positions[0], &ib[0], nFaces, eFrontWinding, clusterStart, usedMaterialStart, firstCluster,
+                           clusterOrder, materialOrder);
     }
-
-    if (nNumCluster >= TOOTLE_NONE)
+    else
     {
-        errorf(("ConvertClusterIDFromFullToCompact: nNumCluster >= TOOTLE_NONE (max int)"));
-        
-        return TOOTLE_INTERNAL_ERROR;
-    }
+        Soup soup;
 
-    unsigned int nStart;
-    unsigned int nCount;
+        if (!MakeSoup(pVB, &ib[0], nVertices, nFaces, nVBStride, &soup))
+        {
+            return TOOTLE_OUT_OF_MEMORY;
+        }
 
-    // The starting cluster has to be zero.
-    if (pnID[ 0 ] != 0)
-    {
-        errorf(("ConvertClusterIDFromFullToCompact: pnID[0] != 0"));
-        
-        return TOOTLE_INTERNAL_ERROR;
-    }
+        TootleResult result = OrderSubmeshesByGraph(soup, pViewpoints, nViewpoints, eFrontWinding, eOverdrawOptimizer,
+                                                    clusters, clusterStart, firstCluster, clusterOrder, materialOrder);
 
-    // Compacting the cluster array
-    unsigned int i;
+        if (result != TOOTLE_OK)
+        {
+            return result;
+        }
+    }
 
-    nCount = 0;
-    nStart = 0;
+    // write the faces of each material, cluster by cluster, in draw order
+    UINT* pnOut = pnIBOut;
 
-    for (i = 1; i < nFaces; i++)
+    for (i = 0; i < nUsedMaterials; i++)
     {
-        if (pnID[ i ] != nCount)
+        UINT nMaterial = materialOrder[ i ];
+
+        for (UINT j = firstCluster[ nMaterial ]; j < firstCluster[ nMaterial + 1 ]; j++)
         {
-            nStart = i;
-            nCount++;
-            pnID[ nCount ] = nStart;
+            UINT nCluster = clusterOrder[ j ];
+            UINT nClusterFaces = clusterStart[ nCluster + 1 ] - clusterStart[ nCluster ];
+
+            memcpy(pnOut, &ib[ 3 * clusterStart[ nCluster ] ], 3 * nClusterFaces * sizeof(UINT));
+            pnOut += 3 * nClusterFaces;
         }
     }
 
-    // Append the cluster array with the total size
-    nCount++;
-    pnID[ nCount ] = i;
+    if (pnMaterialRemapOut)
+    {
+        for (i = 0; i < nUsedMaterials; i++)
+        {
+            pnMaterialRemapOut[ i ] = usedMaterials[ materialOrder[ i ] ];
+        }
 
-    // Fill the rest of the array with NONE
-    nCount++;
+        // the materials without faces go last
+        for (UINT j = 0; j < nMaterials; j++)
+        {
+            if (materialStart[ j ] == materialStart[ j + 1 ])
+            {
+                pnMaterialRemapOut[ i++ ] = j;
+            }
+        }
+    }
 
-    for (; nCount < nFaces; nCount++)
+    if (pnNumClustersOut)
     {
-        pnID[ nCount ] = TOOTLE_NONE;
+        *pnNumClustersOut = nClusters;
     }
 
-    // The last element of the array should be the total number of clusters.
-    pnID[ nFaces ] = nNumCluster;
-
     return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
 }
 
-//=================================================================================================================================
-/// A helper function to convert the cluster array ID from the compact format to the full format.
-///  The compact format is used by old tootle (i3D version) while the full format is used by the new tootle (SIGGRAPH version).
-/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
-/// \param nFaces  The total number of faces of the mesh.
-///
-/// \return Possible return codes:  TOOTLE_INVALID_ARGS, TOOTLE_INTERNAL_ERROR, TOOTLE_OUT_OF_MEMORY, or TOOTLE_OK.
-//=================================================================================================================================
-static TootleResult ConvertClusterArrayFromCompactToFull(unsigned int* pnID, unsigned int nFaces)
+TootleResult TOOTLE_DLL TootleEncodeIndexBufferBound(unsigned int  nFaces,
+                                                     unsigned int* pnBufferSizeOut)
 {
     // sanity checks
-    assert(pnID);
+    assert(pnBufferSizeOut);
 
-    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES || IndexCodecBound(nFaces) > 0xffffffffu)
     {
-        errorf(("ConvertClusterArrayFromCompactToFull: nFaces is invalid"));
+        errorf(("TootleEncodeIndexBufferBound: nFaces is invalid"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // if less then two triangles, then just return from the function.
-    if (nFaces < 2)
-    {
-        return TOOTLE_OK;
-    }
+    *pnBufferSizeOut = (unsigned int) IndexCodecBound(nFaces);
 
-    // check if the cluster array is of compact format.
-    if (!IsClusterArrayCompactFormat(pnID, nFaces))
-    {
-        errorf(("ConvertClusterArrayFromCompactToFull: pnID is not a compact format"));
-        
-        return TOOTLE_INTERNAL_ERROR;
-    }
+    return TOOTLE_OK;
+}
 
-    unsigned int nNumCluster;
+TootleResult TOOTLE_DLL TootleEncodeIndexBuffer(const unsigned int* pnIB,
+                                                unsigned int        nVertices,
+                                                unsigned int        nFaces,
+                                                unsigned char*      pBufferOut,
+                                                unsigned int        nBufferSize,
+                                                unsigned int*       pnEncodedSizeOut)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
 
-    nNumCluster = pnID[ nFaces ];
+    // sanity checks
+    assert(pnIB);
+    assert(pBufferOut);
+    assert(pnEncodedSizeOut);
 
-    // sanity check on the number of cluster
-    if (nNumCluster > nFaces)
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        errorf(("ConvertClusterArrayFromCompactToFull: nNumCluster > nLength"));
-        
-        return TOOTLE_INTERNAL_ERROR;
-    }
+        errorf(("TootleEncodeIndexBuffer: nVertices is invalid"));
 
-    // Make a local copy of the compact form array
-    unsigned int* pnTmp = new unsigned int[ nNumCluster + 1 ];
+        return TOOTLE_INVALID_ARGS;
+    }
 
-    memcpy(pnTmp, pnID, (nNumCluster + 1) * sizeof(unsigned int));
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
+    {
+        errorf(("TootleEncodeIndexBuffer: nFaces is invalid"));
 
-    unsigned int i;
-    unsigned int j;
-    unsigned int nStart;
+        return TOOTLE_INVALID_ARGS;
+    }
 
-    // Compute the full format.
-    nStart = 0;
+    UINT nIndices = 3 * nFaces;
 
-    for (i = 1; i <= nNumCluster; i++)
+    for (UINT i = 0; i < nIndices; i++)
     {
-        if (pnTmp[i] > nFaces)
+        if (pnIB[i] >= nVertices)
         {
-            errorf(("ConvertClusterArrayFromCompactToFull: pnTmp[i] > nLength"));
-            
-            return TOOTLE_INTERNAL_ERROR;
-        }
+            errorf(("TootleEncodeIndexBuffer: Index buffer references vertices beyond nVertices"));
 
-        for (j = nStart; j < pnTmp[i]; j++)
-        {
-            pnID[j] = i - 1;
+            return TOOTLE_INVALID_ARGS;
         }
-
-        nStart = pnTmp[i];
     }
 
-    // Append the last entry of the array by the number of total clusters
-    pnID[ nFaces ] = nNumCluster;
+    size_t nEncodedSize = IndexCodecEncode(pnIB, nFaces, pBufferOut, nBufferSize);
 
-    delete[] pnTmp;
+    if (nEncodedSize == 0)
+    {
+        errorf(("TootleEncodeIndexBuffer: nBufferSize is too small"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
+
+    *pnEncodedSizeOut = (unsigned int) nEncodedSize;
 
     return TOOTLE_OK;
+
+    AMD_TOOTLE_API_FUNCTION_END
 }
 
-//=================================================================================================================================
-/// A helper function to check whether the cluster array is of a full format type.
-///  The full format is used by the old tootle (i3D version).
-///  This function does not check whether the array is valid.
-///
-/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
-/// \param nFaces  The total number of faces of the mesh.
-///
-/// \return Possible return codes:  true if the cluster array is of a full format type, false otherwise
-//=================================================================================================================================
-static bool IsClusterArrayFullFormat(const unsigned int* pnID, unsigned int nFaces)
+TootleResult TOOTLE_DLL TootleDecodeIndexBuffer(const unsigned char* pBuffer,
+                                                unsigned int         nBufferSize,
+                                                unsigned int         nVertices,
+                                                unsigned int         nFaces,
+                                                unsigned int*        pnIBOut)
 {
-    assert(pnID);
-    assert(nFaces > 0);
+    AMD_TOOTLE_API_FUNCTION_BEGIN
 
-    if (pnID[ nFaces ] == (1 + pnID[ nFaces - 1 ]))
+    // sanity checks
+    assert(pBuffer);
+    assert(pnIBOut);
+
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        return true;
+        errorf(("TootleDecodeIndexBuffer: nVertices is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
     }
-    else
+
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
     {
-        return false;
+        errorf(("TootleDecodeIndexBuffer: nFaces is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
     }
-}
 
-//=================================================================================================================================
-/// A helper function to check whether the cluster array is of a compact format type.
-///  The compact format is used by the new tootle (SIGGRAPH version).
-///  This function does not check whether the array is valid.
-///
-/// \param pnID    The cluster array of size nFaces+1.  Must be of type compact.
-/// \param nFaces  The total number of faces of the mesh.
-///
-/// \return Possible return codes:  true if the cluster array is of a full format type, false otherwise
-//=================================================================================================================================
-static bool IsClusterArrayCompactFormat(const unsigned int* pnID, unsigned int nFaces)
-{
-    assert(pnID);
-    assert(nFaces > 0);
+    if (!IndexCodecDecode(pBuffer, nBufferSize, nVertices, nFaces, pnIBOut))
+    {
+        errorf(("TootleDecodeIndexBuffer: The encoded index buffer is corrupt or does not match nVertices and nFaces"));
 
-    unsigned int nNumCluster;
+        return TOOTLE_INVALID_ARGS;
+    }
 
-    nNumCluster = pnID[ nFaces ];
+    return TOOTLE_OK;
 
-    // a special case of all the faces are in a separate cluster (it is both a compact and full form)
-    if (nNumCluster == nFaces)
-    {
-        return true;
-    }
-    else
-    {
-        if (nNumCluster == (1 + pnID[ nFaces - 1 ]))
-        {
-            return false;  // a full format
-        }
-        else
-        {
-            return true;
-        }
-    }
+    AMD_TOOTLE_API_FUNCTION_END
 }
 
-TootleResult TOOTLE_DLL TootleOptimizeVertexMemory(const void*         pVB,
-                                                   const unsigned int* pnIB,
-                                                   unsigned int        nVertices,
-                                                   unsigned int        nFaces,
-                                                   unsigned int        nVBStride,
-                                                   void*               pVBOut,
-                                                   unsigned int*       pnIBOut,
-                                                   unsigned int*       pnVertexRemapOut)
+TootleResult TOOTLE_DLL TootleWeldMesh(const void*         pVB,
+                                       const unsigned int* pnIB,
+                                       unsigned int        nVertices,
+                                       unsigned int        nFaces,
+                                       unsigned int        nVBStride,
+                                       unsigned int*       pnIBOut,
+                                       unsigned int*       pnFacesOut,
+                                       unsigned int*       pnVertexWeldOut,
+                                       unsigned int*       pnFaceRemapOut,
+                                       float               fEpsilon,
+                                       unsigned int        nThreads)
 {
     AMD_TOOTLE_API_FUNCTION_BEGIN
- 
+
     // sanity checks
     assert(pVB);
     assert(pnIB);
+    assert(pnIBOut);
+    assert(pnFacesOut);
 
-    // We also check whether nVertices is not equal to TOOTLE_MAX_VERTICES since
-    //  we will use TOOTLE_MAX_VERTICES as a flag to denote that the vertex has not been mapped.
     if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        errorf(("TootleOptimizeVertexMemory: nVertices is invalid")) ;
+        errorf(("TootleWeldMesh: nVertices is invalid"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES)
     {
-        errorf(("TootleOptimizeVertexMemory: nFaces is invalid")) ;
+        errorf(("TootleWeldMesh: nFaces is invalid"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
     if (nVBStride < 3 * sizeof(float))
     {
-        errorf(("TootleOptimizeVertexMemory: nVBStride is less than 3*sizeof(float)"));
+        errorf(("TootleWeldMesh: nVBStride is invalid"));
 
         return TOOTLE_INVALID_ARGS;
     }
 
-    // make a local copy for pVBOut and pnIBOut if they are the same as pVB and pnIB.
-    char*         pVBOutTmp = (char*) pVBOut;
-    unsigned int* pnIBOutTmp = pnIBOut;
+    if (!(fEpsilon >= 0.0f && fEpsilon <= FLT_MAX))
+    {
+        errorf(("TootleWeldMesh: fEpsilon must be a non-negative number"));
+
+        return TOOTLE_INVALID_ARGS;
+    }
 
+    UINT nIndices = 3 * nFaces;
 
-    if (pVBOut == NULL || pVB == pVBOut)
+    for (UINT i = 0; i < nIndices; i++)
     {
-        pVBOutTmp = new char[ nVertices * nVBStride ];
+        if (pnIB[i] >= nVertices)
+        {
+            errorf(("TootleWeldMesh: Index buffer references vertices beyond nVertices"));
+
+            return TOOTLE_INVALID_ARGS;
+        }
     }
 
-    if (pnIBOut == NULL || pnIB == pnIBOut)
+    if (nThreads == 0)
     {
-        pnIBOutTmp = new unsigned int[ 3 * nFaces ];
+        nThreads = std::max(std::thread::hardware_concurrency(), 1u);
     }
 
-    // create an array of vertex id map.
-    unsigned int* pnVIDRemap = new unsigned int[ nVertices ];
-
-    unsigned int i;
+    std::vector<UINT> weld;
 
-    // mark all vertices map as hasn't been touched/remapped.
-    for (i = 0; i < nVertices; i++)
+    if (pnVertexWeldOut == NULL)
     {
-        pnVIDRemap[ i ] = TOOTLE_MAX_VERTICES;
+        weld.resize(nVertices);
+        pnVertexWeldOut = &weld[0];
     }
 
-    memcpy(pnIBOutTmp, pnIB, 3 * nFaces * sizeof(unsigned int));
+    WeldVertices(pVB, nVertices, nVBStride, fEpsilon, nThreads, pnVertexWeldOut);
 
-    // REMAP THE VERTICES based on the vertex ids in indices array
-    unsigned int nVID;
-    unsigned int nVIDCount = 0;
-    unsigned int nFaces3  = nFaces * 3;
-    bool bWarning         = true;
+    *pnFacesOut = WeldFaces(pnIB, nFaces, pnVertexWeldOut, pnIBOut, pnFaceRemapOut);
 
-    for (i = 0; i < nFaces3; i++)
-    {
-        nVID = pnIBOutTmp[ i ];
+    return TOOTLE_OK;
 
-        // check whether the vertex has been mapped
-        if (nVID < nVertices)
-        {
-            if (pnVIDRemap[ nVID ] == TOOTLE_MAX_VERTICES)
-            {
-                pnVIDRemap[ nVID ] = nVIDCount++;
-            }
+    AMD_TOOTLE_API_FUNCTION_END
+}
 
-            pnIBOutTmp[ i ] = pnVIDRemap[ nVID ];
-        }
-        else
-        {
-            if (bWarning)
-            {
-                fprintf(stderr, "TootleOptimizeVertexMemory's warning: triangle indices are referencing out-of-bounds vertex buffer.\n");
-                bWarning = false;
-            }
-        }
-    }
+TootleResult TOOTLE_DLL TootleUnweldIndexBuffer(const unsigned int* pnIB,
+                                                unsigned int        nVertices,
+                                                unsigned int        nFaces,
+                                                const unsigned int* pnVertexWeld,
+                                                const unsigned int* pnWeldedIB,
+                                                unsigned int        nWeldedFaces,
+                                                unsigned int*       pnIBOut)
+{
+    AMD_TOOTLE_API_FUNCTION_BEGIN
 
-    // Make sure we map all the vertices.
-    // It is possible for some of the vertices not to be referenced by the triangle indices.
-    // In this case, we just assign them to the end of the vertex buffer.
-    for (i = 0; i < nVertices; i++)
+    // sanity checks
+    assert(pnIB);
+    assert(pnVertexWeld);
+    assert(pnWeldedIB || nWeldedFaces == 0);
+    assert(pnIBOut || nWeldedFaces == 0);
+
+    if (nVertices == 0 || nVertices >= TOOTLE_MAX_VERTICES)
     {
-        if (pnVIDRemap[ i ] == TOOTLE_MAX_VERTICES)
-        {
-            pnVIDRemap[ i ] = nVIDCount++;
-        }
-    }
+        errorf(("TootleUnweldIndexBuffer: nVertices is invalid"));
 
-    // check the result (make sure we have mapped all the vertices)
-    assert(nVIDCount == nVertices);
+        return TOOTLE_INVALID_ARGS;
+    }
 
-    for (i = 0; i < nVertices; i++)
+    if (nFaces == 0 || nFaces > TOOTLE_MAX_FACES || nWeldedFaces > nFaces)
     {
-        assert(pnVIDRemap[ i ] != TOOTLE_MAX_VERTICES);
+        errorf(("TootleUnweldIndexBuffer: nFaces or nWeldedFaces is invalid"));
+
+        return TOOTLE_INVALID_ARGS;
     }
 
-    // if pVBOut is requested by the user, fill it with the right data
-    if (pVBOut != NULL)
-    {
-        // rearrange the vertex buffer based on the remapping
-        const char* pVBuffer = (char*) pVB;
+    UINT i;
 
-        for (i = 0; i < nVertices; i++)
+    for (i = 0; i < 3 * nFaces; i++)
+    {
+        if (pnIB[i] >= nVertices)
         {
-            nVID = pnVIDRemap[ i ];
+            errorf(("TootleUnweldIndexBuffer: Index buffer references vertices beyond nVertices"));
 
-            memcpy(&pVBOutTmp[ nVID * nVBStride ], pVBuffer, nVBStride);
-
-            pVBuffer += nVBStride;
+            return TOOTLE_INVALID_ARGS;
         }
+    }
 
-        // copy the result if the user is supplying the same pointer for pVB and pVBOut
-        if (pVBOut != pVBOutTmp)
+    for (i = 0; i < 3 * nWeldedFaces; i++)
+    {
+        if (pnWeldedIB[i] >= nVertices)
         {
-            memcpy(pVBOut, pVBOutTmp, nVertices * nVBStride);
+            errorf(("TootleUnweldIndexBuffer: Welded index buffer references vertices beyond nVertices"));
+
+            return TOOTLE_INVALID_ARGS;
         }
     }
 
-    // delete pVBOutTmp if it is created locally
-    if (pVBOut != pVBOutTmp)
+    // every vertex must be welded to a vertex that is welded to itself
+    for (i = 0; i < nVertices; i++)
     {
-        delete[] pVBOutTmp;
-    }
+        if (pnVertexWeld[i] >= nVertices || pnVertexWeld[ pnVertexWeld[i] ] != pnVertexWeld[i])
+        {
+            errorf(("TootleUnweldIndexBuffer: pnVertexWeld is not a vertex welding returned by TootleWeldMesh"));
 
-    if (pnIBOut != pnIBOutTmp && pnIBOut != NULL)
-    {
-        memcpy(pnIBOut, pnIBOutTmp, 3 * nFaces * sizeof(unsigned int));
+            return TOOTLE_INVALID_ARGS;
+        }
     }
 
-    if (pnIBOut != pnIBOutTmp)
+    if (!UnweldFaces(pnIB, nFaces, pnVertexWeld, pnWeldedIB, nWeldedFaces, pnIBOut))
     {
-        delete[] pnIBOutTmp;
-    }
+        errorf(("TootleUnweldIndexBuffer: pnWeldedIB holds a face that was not welded from pnIB"));
 
-    // if the vertex id remap is asked by the caller
-    if (pnVertexRemapOut)
-    {
-        memcpy(pnVertexRemapOut, pnVIDRemap, nVertices * sizeof(unsigned int));
+        return TOOTLE_INVALID_ARGS;
     }
 
-    delete [] pnVIDRemap;
-
     return TOOTLE_OK;
 
     AMD_TOOTLE_API_FUNCTION_END
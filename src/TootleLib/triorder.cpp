@@ -21,7 +21,7 @@ void FanVertOptimize(   float *pfVertexPositionsIn,   //vertex buffer positions,
                                                       //(usually alpha=0.75f and beta=0.0f are good options)
 
                         int *piScratch = NULL,        //optional temp buffer for computations; its size in bytes should be:
-                                                      //FanVertScratchSize(iNumVertices, iNumFaces)
+                                                      //FanVertScratchSize(iNumVertices, iNumFaces, iCacheSize)
                                                       //if NULL is passed, function will allocate and free this data
 
                         int *piClustersOut = NULL,    //optional buffer for the output cluster position (in faces) of each cluster
@@ -76,11 +76,13 @@ void FanVertOptimizeOverdrawOnly(float *pfVertexPositionsIn,
 #include <cstdio>
 #include <cstring>
 #include <cmath>
+#include <cfloat>
 #include <climits>
 #include <functional>
 #include <algorithm>
 #include <memory>
 #include <limits>
+#include <vector>
 #include "tootlelib.h"  // TootleFaceWinding enum
 #include "triorder.h"   // TOOTLE_NONE
 
@@ -140,10 +142,93 @@ inline int min(const int a, const int b)
     return a < b ? a : b;
 }
 
+//returns true if the triangles share an edge, in either direction
+static bool ShareEdge(const int* pA, const int* pB)
+{
+    int n = 0;
+
+    for (int a = 0; a < 3; a++)
+    {
+        n += (pA[a] == pB[0] || pA[a] == pB[1] || pA[a] == pB[2]);
+    }
+
+    return n >= 2;
+}
+
+//the emitted flags of the triangles are packed 32 to an int
+static inline bool IsEmitted(const unsigned int* puEmitted, int tri)
+{
+    return (puEmitted[tri >> 5] & (1u << (tri & 31))) != 0;
+}
+
+//size of the scratch memory used by FanVertLinSortT, in ints
+static size_t FanVertLinSortTScratchSize(int iNumVertices, int iNumFaces)
+{
+    return (size_t)iNumFaces * 3 + (size_t)(iNumFaces + 31) / 32 + (size_t)iNumVertices * 7;
+}
+
+//size of the scratch memory used by FanVertLinSort, in ints: FanVertLinSortT's, followed by the renumbered index buffer and
+// the map from new to old vertex ids of FanVertRenumber
+static size_t FanVertLinSortScratchSize(int iNumVertices, int iNumFaces)
+{
+    return FanVertLinSortTScratchSize(iNumVertices, iNumFaces) + (size_t)iNumFaces * 3 + (size_t)iNumVertices;
+}
+
+//the number of vertices above which FanVertLinSort renumbers scattered vertex ids, and the distance between two ids that
+// FanVertIdsScattered counts as far.  Tipsify's per vertex arrays then outgrow the CPU caches, and scattered ids make most of
+// their accesses miss.
+#define FAN_VERT_RENUMBER_MIN_VERTICES 16384
+
+//reorders the fan of vertex id, which starts at piTriList[i], so that each triangle shares an edge with the one emitted
+// before it where possible.  The fan is otherwise emitted in input order, which the vertex cache does not care much about,
+// but triangles that share an edge with the previous one are much cheaper to encode (see indexcodec.cpp)
+static void FanSortByAdjacency(const int* piIndexBufferIn, int* piTriList, const unsigned int* puEmitted, int i, int iNumFaces3,
+                               int id, const int* piLast)
+{
+    int iEnd = i;
+
+    while (iEnd < iNumFaces3 && piIndexBufferIn[piTriList[iEnd]] == id)
+    {
+        iEnd++;
+    }
+
+    for (; i < iEnd; i++)
+    {
+        if (IsEmitted(puEmitted, piTriList[i] / 3))
+        {
+            continue;
+        }
+
+        if (piLast != NULL)
+        {
+            for (int k = i; k < iEnd; k++)
+            {
+                int tri = piTriList[k] / 3;
+
+                if (!IsEmitted(puEmitted, tri) && ShareEdge(&piIndexBufferIn[tri * 3], piLast))
+                {
+                    int t = piTriList[i];
+                    piTriList[i] = piTriList[k];
+                    piTriList[k] = t;
+                    break;
+                }
+            }
+        }
+
+        piLast = &piIndexBufferIn[(piTriList[i] / 3) * 3];
+    }
+}
+
 //function that implements the vcache optimization
-float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces, int* piScratch, int iCacheSize,
-                     int* piClustersOut, int& iNumClusters)
+//bCompressTies emits the triangles of each fan in adjacency order (see FanSortByAdjacency)
+//piScratch must hold FanVertLinSortTScratchSize(iNumVertices, iNumFaces) ints.  It does not need to be initialized.
+//CACHE_SIZE is the cache size as a compile time constant, so that the cache tests in the inner loop fold it; 0 uses
+//iCacheSizeIn instead.  FanVertLinSort picks the instantiation.
+template <int CACHE_SIZE>
+static float FanVertLinSortT(int* piIndexBufferIn, int* piIndexBufferOut, int iNumVertices, int iNumFaces, int* piScratch,
+                             int iCacheSizeIn, int* piClustersOut, int& iNumClusters, bool bCompressTies)
 {
+    const int iCacheSize = CACHE_SIZE ? CACHE_SIZE : iCacheSizeIn;
     int i = 0;
     int iNumFaces3 = iNumFaces * 3;
     int sum = 0;
@@ -159,20 +244,33 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
         piClustersOut[0] = 0;
     }
 
-    //set array pointers from scratch buffer
-    int* piEmitted = piScratch;
-    int* piFanList = piEmitted + iNumFaces;
-    int* piTriList = piFanList + iNumFaces3;
+    //set array pointers from scratch buffer.  only piTriList is sized by the number of indices, the rest is per vertex
+    // (indexed by vertex id) or a bit per triangle
+    int* piTriList = piScratch;
 
-    int* piStartList = piTriList + iNumFaces3;
-    int* piStartListTail = piStartList;
+    unsigned int* puEmitted = (unsigned int*)(piTriList + iNumFaces3);
 
-    int* piRemValence = piStartList + iNumFaces3;
+    int* piFanPos = (int*)(puEmitted + (iNumFaces + 31) / 32);
+    int* piRemValence = piFanPos + iNumVertices;
+    int* piCachePos = piRemValence + iNumVertices;
+    int* piFanList = piCachePos + iNumVertices;
 
-    int* piCachePos = piRemValence + iNumFaces3;
+    //the stack of vertices that entered the cache with triangles left, to restart from at a dead end.  when a vertex is
+    // pushed again, its older entry can never be used: by the time it is popped, the vertex's fan has been emitted.  the
+    // stack position of the newest entry of each vertex is kept, so that the older ones can be dropped when the stack is
+    // full, which bounds it by twice the number of vertices.
+    int* piStackPos = piFanList + iNumVertices;
+    int* piStartList = piStackPos + iNumVertices;
+    int* piStartListTail = piStartList;
+    int* piStartListEnd = piStartList + 2 * iNumVertices;
 
-    int* piFanPos = piCachePos + iNumFaces3;
+    memset(puEmitted, 0, ((iNumFaces + 31) / 32) * sizeof(unsigned int));
 
+    for (i = 0; i < iNumFaces3; i++)
+    {
+        piFanPos[piIndexBufferIn[i]] = 0;
+        piCachePos[piIndexBufferIn[i]] = 0;
+    }
 
     int iCurCachePos = 1 + iCacheSize; //so that cache position of 0 is out of cache
     int iCurCachePosFan;
@@ -198,7 +296,7 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
     for (i = 0; i < nv; i++)
     {
         int x = piFanPos[piFanList[i]];
-        piRemValence[sum] = x;
+        piRemValence[piFanList[i]] = x;
         sum = (piFanPos[piFanList[i]] += sum);
     }
 
@@ -229,6 +327,11 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
 
         iCurCachePosFan = iCurCachePos;
 
+        if (bCompressTies)
+        {
+            FanSortByAdjacency(piIndexBufferIn, piTriList, puEmitted, i, iNumFaces3, id, j > 0 ? &piIndexBufferOut[j - 3] : NULL);
+        }
+
         //loop through extracting all faces from a vertex fan that were not previously written
         while (i < iNumFaces3 && piIndexBufferIn[piTriList[i]] == id)
         {
@@ -236,15 +339,17 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
             int tri = piTriList[i] / 3;
             int tri3 = tri * 3;
 
-            if (++piEmitted[tri] == 1)
+            if (!IsEmitted(puEmitted, tri))
             {
+                puEmitted[tri >> 5] |= 1u << (tri & 31);
+
                 int* pin = &piIndexBufferIn[tri3];
 
                 for (int ii = 0; ii < 3; ii++, pin++)
                 {
                     piIndexBufferOut[j++] = *pin;
 
-                    int x = piFanPos[*pin];
+                    int x = *pin;
 
                     int t = iCurCachePos - piCachePos[x] > iCacheSize;
 
@@ -259,6 +364,24 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
                     {
                         if (t)
                         {
+                            if (piStartListTail == piStartListEnd)
+                            {
+                                //drop the entries that have a newer one
+                                int* piKeep = piStartList;
+
+                                for (int* p = piStartList; p < piStartListEnd; p++)
+                                {
+                                    if (piStackPos[*p] == p - piStartList)
+                                    {
+                                        piStackPos[*p] = (int)(piKeep - piStartList);
+                                        *(piKeep++) = *p;
+                                    }
+                                }
+
+                                piStartListTail = piKeep;
+                            }
+
+                            piStackPos[*pin] = (int)(piStartListTail - piStartList);
                             *(piStartListTail++) = *pin;
                         }
 
@@ -310,8 +433,10 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
                 i = lowi;
             }
 
-            //overdraw output
-            if (piClustersOut && piClustersOut[iNumClusters - 1] != j / 3 && iCurCachePos - piCachePos[i] > iCacheSize * 2)
+            //overdraw output.  once every fan has been emitted (i == iNumFaces3), a cluster would start at iNumFaces, which
+            // is removed below, so there is nothing to check.
+            if (piClustersOut && piClustersOut[iNumClusters - 1] != j / 3 && i < iNumFaces3 &&
+                iCurCachePos - piCachePos[piIndexBufferIn[piTriList[i]]] > iCacheSize * 2)
             {
                 piClustersOut[iNumClusters++] = j / 3;
             }
@@ -323,14 +448,6 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
         }
     }
 
-    //clear temp array (only the elements used)
-    for (i = 0; i < nv; i++)
-    {
-        piFanPos[piFanList[i]] = 0;
-    }
-
-    memset(piScratch, 0, (iNumFaces * 16) * sizeof(int));
-
     if (piClustersOut && piClustersOut[iNumClusters - 1] == iNumFaces)
     {
         iNumClusters--;
@@ -345,42 +462,150 @@ float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces,
     return (iCurCachePos - iCacheSize - 1) / (float)iNumFaces;
 }
 
-//function that implements the overdraw ordering
-void OverdrawOrder(int*              piIndexBufferIn,
-                   int*              piIndexBufferOut,
-                   int               iNumFaces,
-                   float*            pfVertexPositionsIn,
-                   int               /*iNumVertices*/,
-                   TootleFaceWinding eFrontWinding,
-                   int*              piClustersIn, //should have piClustersIn[iNumClusters] == iNumFaces
-                   int               iNumClusters,
-                   int*              piScratch,
-                   int*              piRemap = NULL)
+//returns true if the vertex ids of piIndexBufferIn are scattered: if more than an eighth of the indices are far from the one
+// before them.  Meshes made of strips or grids of vertices, or already ordered for the vertex cache, are not.
+static bool FanVertIdsScattered(const int* piIndexBufferIn, int iNumFaces)
 {
-    int i, j;
-    int c = 0, cstart = 0;
-    int cnext = piClustersIn[1];
-    int* p = piIndexBufferIn;
-    Vector* pvVertexPositionsIn = (Vector*)pfVertexPositionsIn;
-    Vector vMeshPositions = Vector(0, 0, 0);
-    float fMArea = 0.f;
+    int iNumFaces3 = iNumFaces * 3;
+    int iFar = 0;
 
-    int* piScratchBase = piScratch;
-    Vector* pvClusterPositions = (Vector*)piScratch;
-    piScratch += iNumClusters * 3;
+    for (int i = 1; i < iNumFaces3; i++)
+    {
+        if (abs(piIndexBufferIn[i] - piIndexBufferIn[i - 1]) >= FAN_VERT_RENUMBER_MIN_VERTICES)
+        {
+            iFar++;
+        }
+    }
 
-    Vector* pvClusterNormals = (Vector*)piScratch;
-    piScratch += iNumClusters * 3;
+    return iFar > iNumFaces3 / 8;
+}
 
-    ClusterSort* cs = (ClusterSort*)piScratch;
-    piScratch += iNumClusters * 2;
+//numbers the vertices of piIndexBufferIn in the order they are first used, into piIndexBufferOut.  piVertexMap must be 0 for
+// every vertex, and receives one more than the new id of each vertex used.  piOldId receives the vertex of each new id.
+// Returns the number of vertices used.
+static int FanVertRenumber(const int* piIndexBufferIn, int* piIndexBufferOut, int iNumFaces, int* piVertexMap, int* piOldId)
+{
+    int nv = 0;
 
-    for (i = 0; i < iNumClusters; i++)
+    for (int i = 0; i < iNumFaces * 3; i++)
     {
-        pvClusterPositions[i] = Vector(0, 0, 0);
-        pvClusterNormals[i] = Vector(0, 0, 0);
+        int ind = piIndexBufferIn[i];
+
+        if (piVertexMap[ind] == 0)
+        {
+            piOldId[nv++] = ind;
+            piVertexMap[ind] = nv;
+        }
+
+        piIndexBufferOut[i] = piVertexMap[ind] - 1;
+    }
+
+    return nv;
+}
+
+//calls the instantiation of FanVertLinSortT for iCacheSize
+static float FanVertLinSortCacheSize(int* piIndexBufferIn, int* piIndexBufferOut, int iNumVertices, int iNumFaces, int* piScratch,
+                                     int iCacheSize, int* piClustersOut, int& iNumClusters, bool bCompressTies)
+{
+    switch (iCacheSize)
+    {
+        case 12:
+            return FanVertLinSortT<12>(piIndexBufferIn, piIndexBufferOut, iNumVertices, iNumFaces, piScratch, iCacheSize,
+                                       piClustersOut, iNumClusters, bCompressTies);
+
+        case 16:
+            return FanVertLinSortT<16>(piIndexBufferIn, piIndexBufferOut, iNumVertices, iNumFaces, piScratch, iCacheSize,
+                                       piClustersOut, iNumClusters, bCompressTies);
+
+        case 24:
+            return FanVertLinSortT<24>(piIndexBufferIn, piIndexBufferOut, iNumVertices, iNumFaces, piScratch, iCacheSize,
+                                       piClustersOut, iNumClusters, bCompressTies);
+
+        case 32:
+            return FanVertLinSortT<32>(piIndexBufferIn, piIndexBufferOut, iNumVertices, iNumFaces, piScratch, iCacheSize,
+                                       piClustersOut, iNumClusters, bCompressTies);
+
+        default:
+            return FanVertLinSortT<0>(piIndexBufferIn, piIndexBufferOut, iNumVertices, iNumFaces, piScratch, iCacheSize,
+                                      piClustersOut, iNumClusters, bCompressTies);
+    }
+}
+
+//function that implements the vcache optimization.  piScratch must hold FanVertLinSortScratchSize(iNumVertices, iNumFaces) ints.
+//Tipsify only compares vertex ids for equality, and visits the fans in the order their vertices are first used, so it makes
+// the same choices whatever the numbering of the vertices.  Large meshes with scattered vertex ids are numbered by first use
+// before, which keeps its accesses to the per vertex arrays close together, and the output is mapped back afterwards.
+//piVertexMap is NULL, or iNumVertices ints that are all 0.  It is all 0 again on return, so a caller that sorts many pieces of
+// one mesh clears it once instead of once per piece.  If it is NULL and the vertices are renumbered, a map is allocated.
+float FanVertLinSort(int* piIndexBufferIn, int* piIndexBufferOut, int iNumVertices, int iNumFaces, int* piScratch, int iCacheSize,
+                     int* piClustersOut, int& iNumClusters, bool bCompressTies, int* piVertexMap)
+{
+    if (iNumVertices < FAN_VERT_RENUMBER_MIN_VERTICES || !FanVertIdsScattered(piIndexBufferIn, iNumFaces))
+    {
+        return FanVertLinSortCacheSize(piIndexBufferIn, piIndexBufferOut, iNumVertices, iNumFaces, piScratch, iCacheSize,
+                                       piClustersOut, iNumClusters, bCompressTies);
     }
 
+    int* piRenumberedIB = piScratch + FanVertLinSortTScratchSize(iNumVertices, iNumFaces);
+    int* piOldId = piRenumberedIB + iNumFaces * 3;
+
+    bool bMalloc = false;
+
+    if (piVertexMap == NULL)
+    {
+        piVertexMap = (int*)calloc(iNumVertices, sizeof(int));
+        bMalloc = true;
+    }
+
+    int nv = FanVertRenumber(piIndexBufferIn, piRenumberedIB, iNumFaces, piVertexMap, piOldId);
+
+    float fACMR = FanVertLinSortCacheSize(piRenumberedIB, piIndexBufferOut, nv, iNumFaces, piScratch, iCacheSize,
+                                          piClustersOut, iNumClusters, bCompressTies);
+
+    for (int i = 0; i < iNumFaces * 3; i++)
+    {
+        piIndexBufferOut[i] = piOldId[piIndexBufferOut[i]];
+    }
+
+    if (bMalloc)
+    {
+        free(piVertexMap);
+    }
+    else
+    {
+        // clear only the entries that were set, so the map is ready for the caller's next piece
+        for (int i = 0; i < nv; i++)
+        {
+            piVertexMap[piOldId[i]] = 0;
+        }
+    }
+
+    return fACMR;
+}
+
+//computes the area weighted centroid of the mesh, and the area weighted centroid and the average normal of each cluster.
+//the normals point into the front faces, so clusters that face away from the rest of the mesh point back at its centroid.
+static void OverdrawClusterGeometry(const int*           piIndexBufferIn,
+                                    int                  iNumFaces,
+                                    const float*         pfVertexPositionsIn,
+                                    TootleFaceWinding    eFrontWinding,
+                                    const int*           piClustersIn, //should have piClustersIn[iNumClusters] == iNumFaces
+                                    int                  iNumClusters,
+                                    Vector&              vMeshPositionsOut,
+                                    std::vector<Vector>& vClusterPositions,
+                                    std::vector<Vector>& vClusterNormals)
+{
+    int i, j;
+    int c = 0;
+    int cnext = piClustersIn[1];
+    const int* p = piIndexBufferIn;
+    Vector* pvVertexPositionsIn = (Vector*)pfVertexPositionsIn;
+    Vector vMeshPositions = Vector(0, 0, 0);
+    float fMArea = 0.f;
+
+    vClusterPositions.assign(iNumClusters, Vector(0, 0, 0));
+    vClusterNormals.assign(iNumClusters, Vector(0, 0, 0));
+
     float fCArea = 0.f;
 
     unsigned int nVertexCrossOrder[2];  // a variable for crossing vertices that takes into account winding order
@@ -402,8 +627,8 @@ void OverdrawOrder(int*              piIndexBufferIn,
     {
         if (i == cnext)
         {
-            pvClusterPositions[c] /= fCArea * 3.f;
-            pvClusterNormals[c].normalize();
+            vClusterPositions[c] /= fCArea * 3.f;
+            vClusterNormals[c].normalize();
             c++;
 
             if (c == iNumClusters)
@@ -411,7 +636,6 @@ void OverdrawOrder(int*              piIndexBufferIn,
                 break;
             }
 
-            cstart = i;
             cnext = piClustersIn[c + 1];
             fCArea = 0.f;
         }
@@ -433,29 +657,76 @@ void OverdrawOrder(int*              piIndexBufferIn,
 
         for (j = 0; j < 3; j++)
         {
-            Vector* vp = (Vector*)&pfVertexPositionsIn[(*p) * 3];
-            vMeshPositions += *vp * fArea;
-            pvClusterPositions[c] += *vp * fArea;
+            Vector vp = pvVertexPositionsIn[*p];
+            vMeshPositions += vp * fArea;
+            vClusterPositions[c] += vp * fArea;
             p++;
         }
 
-        pvClusterNormals[c] += vNormal;
+        vClusterNormals[c] += vNormal;
 
         fMArea += fArea;
         fCArea += fArea;
     }
 
     vMeshPositions /= fMArea * 3.f;
+    vMeshPositionsOut = vMeshPositions;
+}
 
-    for (i = 0; i < iNumClusters; i++)
+//function that implements the overdraw ordering
+//computes the measure OverdrawOrder sorts the clusters by: the distance of each cluster's centroid in front of the mesh
+//centroid, along the cluster's average normal.  clusters that face away from the rest of the mesh get high values.
+void OverdrawClusterMeasures(const int*        piIndexBufferIn,
+                             int               iNumFaces,
+                             const float*      pfVertexPositionsIn,
+                             TootleFaceWinding eFrontWinding,
+                             const int*        piClustersIn, //should have piClustersIn[iNumClusters] == iNumFaces
+                             int               iNumClusters,
+                             float*            pfMeasuresOut)
+{
+    Vector vMeshPositions;
+    std::vector<Vector> vClusterPositions;
+    std::vector<Vector> vClusterNormals;
+
+    OverdrawClusterGeometry(piIndexBufferIn, iNumFaces, pfVertexPositionsIn, eFrontWinding, piClustersIn, iNumClusters,
+                            vMeshPositions, vClusterPositions, vClusterNormals);
+
+    for (int i = 0; i < iNumClusters; i++)
     {
-        cs[i].dp = dot(pvClusterPositions[i] - vMeshPositions, pvClusterNormals[i]);
+        pfMeasuresOut[i] = dot(vClusterPositions[i] - vMeshPositions, vClusterNormals[i]);
 
-        if (cs[i].dp < -2e20 || cs[i].dp > 2e20)
+        if (pfMeasuresOut[i] < -2e20 || pfMeasuresOut[i] > 2e20)
         {
-            cs[i].dp = 0.f;
+            pfMeasuresOut[i] = 0.f;
         }
+    }
+}
+
+void OverdrawOrder(int*              piIndexBufferIn,
+                   int*              piIndexBufferOut,
+                   int               iNumFaces,
+                   float*            pfVertexPositionsIn,
+                   int               /*iNumVertices*/,
+                   TootleFaceWinding eFrontWinding,
+                   int*              piClustersIn, //should have piClustersIn[iNumClusters] == iNumFaces
+                   int               iNumClusters,
+                   int*              piScratch,
+                   int*              piRemap = NULL)
+{
+    int i, j;
+
+    float* pfMeasures = (float*)piScratch;
+    piScratch += iNumClusters;
+
+    ClusterSort* cs = (ClusterSort*)piScratch;
+    piScratch += iNumClusters * 2;
+
+    OverdrawClusterMeasures(piIndexBufferIn, iNumFaces, pfVertexPositionsIn, eFrontWinding, piClustersIn, iNumClusters,
+                            pfMeasures);
 
+    for (i = 0; i < iNumClusters; i++)
+    {
+        cs[i].dp = pfMeasures[i];
         cs[i].i = i;
     }
 
@@ -479,7 +750,151 @@ void OverdrawOrder(int*              piIndexBufferIn,
         }
     }
 
-    memset(piScratchBase, 0, (piScratch - piScratchBase) * sizeof(int));
+}
+
+//counts the vertex cache misses of a face order with a FIFO cache, which starts empty.  piCacheTime holds, for each vertex,
+//the miss that loaded it or -1, and must be all -1 on entry.  it is all -1 again on return.
+static int FifoCacheMisses(const int* piIndexBufferIn, int iNumFaces, int iCacheSize, int* piCacheTime)
+{
+    int iMisses = 0;
+
+    for (int i = 0; i < 3 * iNumFaces; i++)
+    {
+        int v = piIndexBufferIn[i];
+
+        if (piCacheTime[v] < 0 || iMisses - piCacheTime[v] >= iCacheSize)
+        {
+            piCacheTime[v] = iMisses++;
+        }
+    }
+
+    for (int i = 0; i < 3 * iNumFaces; i++)
+    {
+        piCacheTime[piIndexBufferIn[i]] = -1;
+    }
+
+    return iMisses;
+}
+
+//function that orders the faces of each cluster front to back
+//the depth of a face is the distance of its centroid from the mesh centroid along the normal of its cluster, as in
+//OverdrawClusterMeasures, so the faces that stick out the most in the direction the cluster faces are drawn first.  the
+//vertex cache order is kept in runs of consecutive faces, which are sorted by their average depth: the shortest runs, from
+//single faces upwards by powers of two, whose order does not add more than fMaxACMRIncrease to the ACMR of the cluster.
+void FrontToBackClusterFaces(int*              piIndexBuffer,
+                             int               iNumFaces,
+                             const float*      pfVertexPositionsIn,
+                             int               iNumVertices,
+                             TootleFaceWinding eFrontWinding,
+                             const int*        piClustersIn, //should have piClustersIn[iNumClusters] == iNumFaces
+                             int               iNumClusters,
+                             int               iCacheSize,
+                             float             fMaxACMRIncrease,
+                             int*              piFaceOrderOut)
+{
+    Vector vMeshPositions;
+    std::vector<Vector> vClusterPositions;
+    std::vector<Vector> vClusterNormals;
+
+    OverdrawClusterGeometry(piIndexBuffer, iNumFaces, pfVertexPositionsIn, eFrontWinding, piClustersIn, iNumClusters,
+                            vMeshPositions, vClusterPositions, vClusterNormals);
+
+    Vector* pvVertexPositionsIn = (Vector*)pfVertexPositionsIn;
+    int iLargestCluster = 0;
+
+    for (int c = 0; c < iNumClusters; c++)
+    {
+        iLargestCluster = max(iLargestCluster, piClustersIn[c + 1] - piClustersIn[c]);
+    }
+
+    std::vector<int>         cacheTime(iNumVertices, -1);
+    std::vector<float>       depths(iLargestCluster);
+    std::vector<ClusterSort> runs(iLargestCluster);
+    std::vector<int>         runIB(3 * iLargestCluster);
+    std::vector<int>         runOrder(iLargestCluster);
+
+    if (piFaceOrderOut != NULL)
+    {
+        for (int i = 0; i < iNumFaces; i++)
+        {
+            piFaceOrderOut[i] = i;
+        }
+    }
+
+    for (int c = 0; c < iNumClusters; c++)
+    {
+        int  iStart    = piClustersIn[c];
+        int  iNumInC   = piClustersIn[c + 1] - iStart;
+        int* piCluster = &piIndexBuffer[3 * iStart];
+
+        if (iNumInC < 2)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < iNumInC; i++)
+        {
+            const int* p = &piCluster[3 * i];
+            Vector vCentroid = (pvVertexPositionsIn[p[0]] + pvVertexPositionsIn[p[1]] + pvVertexPositionsIn[p[2]]) / 3.f;
+
+            depths[i] = dot(vCentroid - vMeshPositions, vClusterNormals[c]);
+        }
+
+        int iMaxMisses = FifoCacheMisses(piCluster, iNumInC, iCacheSize, &cacheTime[0]) +
+                         (int)(fMaxACMRIncrease * iNumInC);
+
+        for (int iRun = 1; iRun < iNumInC; iRun *= 2)
+        {
+            int iNumRuns = (iNumInC + iRun - 1) / iRun;
+
+            for (int r = 0; r < iNumRuns; r++)
+            {
+                int iEnd = min(iNumInC, (r + 1) * iRun);
+                float fDepth = 0.f;
+
+                for (int i = r * iRun; i < iEnd; i++)
+                {
+                    fDepth += depths[i];
+                }
+
+                runs[r].dp = fDepth / (iEnd - r * iRun);
+                runs[r].i = r;
+            }
+
+            std::stable_sort(runs.begin(), runs.begin() + iNumRuns, sortfunc);
+
+            int j = 0;
+
+            for (int r = 0; r < iNumRuns; r++)
+            {
+                int iEnd = min(iNumInC, (runs[r].i + 1) * iRun);
+
+                for (int i = runs[r].i * iRun; i < iEnd; i++)
+                {
+                    runOrder[j] = i;
+                    runIB[3 * j + 0] = piCluster[3 * i + 0];
+                    runIB[3 * j + 1] = piCluster[3 * i + 1];
+                    runIB[3 * j + 2] = piCluster[3 * i + 2];
+                    j++;
+                }
+            }
+
+            if (FifoCacheMisses(&runIB[0], iNumInC, iCacheSize, &cacheTime[0]) <= iMaxMisses)
+            {
+                memcpy(piCluster, &runIB[0], 3 * iNumInC * sizeof(int));
+
+                if (piFaceOrderOut != NULL)
+                {
+                    for (int i = 0; i < iNumInC; i++)
+                    {
+                        piFaceOrderOut[iStart + i] = iStart + runOrder[i];
+                    }
+                }
+
+                break;
+            }
+        }
+    }
 }
 
 //overdraw order based on integral
@@ -502,7 +917,6 @@ void OverdrawOrderIntegral(int*              piIndexBufferIn,
     Vector vMeshPositions = Vector(0, 0, 0);
     float fMArea = 0.f;
 
-    int* piScratchBase = piScratch;
     Vector* pvClusterPositions = (Vector*)piScratch;
     piScratch += iNumClusters * 3;
 
@@ -632,7 +1046,206 @@ void OverdrawOrderIntegral(int*              piIndexBufferIn,
         }
     }
 
-    memset(piScratchBase, 0, (piScratch - piScratchBase) * sizeof(int));
+}
+
+//the size of the images, in pixels on a side, rendered by OverdrawSampleImage
+#define OVERDRAW_SAMPLE_IMAGE_SIZE  128
+
+//the directions OverdrawSampleImage renders the mesh along: the axes and the diagonals, both ways
+static const float s_fSampleDirections[OVERDRAW_SAMPLE_VIEWS][3] =
+{
+    { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+    { 1, 1, 1 }, { -1, -1, -1 }, { 1, 1, -1 }, { -1, -1, 1 }, { 1, -1, 1 }, { -1, 1, -1 }, { -1, 1, 1 }, { 1, -1, -1 }
+};
+
+//returns true if the pixel centres on an edge of a counter-clockwise triangle belong to it: those of top and left edges
+static inline bool IsTopLeftEdge(float dx, float dy)
+{
+    return dy < 0.f || (dy == 0.f && dx > 0.f);
+}
+
+//renders the mesh with an orthographic projection along one of the OVERDRAW_SAMPLE_VIEWS directions, culling back faces as
+//TootleMeasureOverdraw does, and stores the fragments of each face.  the image is fitted to the bounding box of the mesh.
+void OverdrawSampleImage(const int*        piIndexBufferIn,
+                         int               iNumFaces,
+                         const float*      pfVertexPositionsIn,
+                         int               iNumVertices,
+                         TootleFaceWinding eFrontWinding,
+                         int               iView,
+                         OverdrawImage&    rImageOut)
+{
+    const int iImageSize = OVERDRAW_SAMPLE_IMAGE_SIZE;
+    const Vector* pvVertexPositionsIn = (const Vector*)pfVertexPositionsIn;
+    int i;
+
+    Vector vMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vector vMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for (i = 0; i < iNumVertices; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            vMin.v[k] = std::min(vMin.v[k], pvVertexPositionsIn[i].v[k]);
+            vMax.v[k] = max(vMax.v[k], pvVertexPositionsIn[i].v[k]);
+        }
+    }
+
+    Vector vCenter = (vMin + vMax) * 0.5f;
+    float fRadius = (vMax - vMin).length() * 0.5f;
+    float fScale = (fRadius > 0.f) ? iImageSize / (2.f * fRadius) : 0.f;
+
+    //the camera looks along d, with x and y spanning the image
+    Vector d(s_fSampleDirections[iView][0], s_fSampleDirections[iView][1], s_fSampleDirections[iView][2]);
+    d.normalize();
+
+    Vector up = (fabsf(d.v[1]) < 0.9f) ? Vector(0, 1, 0) : Vector(1, 0, 0);
+    Vector x = cross(up, d);
+    x.normalize();
+    Vector y = cross(d, x);
+
+    //image x, image y and depth of each vertex
+    std::vector<float> projected((size_t)iNumVertices * 3);
+
+    for (i = 0; i < iNumVertices; i++)
+    {
+        Vector p = pvVertexPositionsIn[i];
+        p -= vCenter;
+
+        projected[ 3 * i ] = (dot(p, x) + fRadius) * fScale;
+        projected[ 3 * i + 1 ] = (dot(p, y) + fRadius) * fScale;
+        projected[ 3 * i + 2 ] = dot(p, d);
+    }
+
+    //the outward normal, as in OverdrawOrderIntegral
+    int iCross0 = (eFrontWinding == TOOTLE_CW) ? 2 : 1;
+    int iCross1 = (eFrontWinding == TOOTLE_CW) ? 1 : 2;
+
+    std::vector<bool> covered(iImageSize * iImageSize, false);
+
+    rImageOut.faceStart.resize(iNumFaces + 1);
+    rImageOut.pixels.clear();
+    rImageOut.depths.clear();
+    rImageOut.iNumCovered = 0;
+
+    for (i = 0; i < iNumFaces; i++)
+    {
+        const int* p = &piIndexBufferIn[ 3 * i ];
+
+        rImageOut.faceStart[i] = (int)rImageOut.pixels.size();
+
+        //front faces point against the camera
+        Vector vCorners[3] = { pvVertexPositionsIn[ p[0] ], pvVertexPositionsIn[ p[1] ], pvVertexPositionsIn[ p[2] ] };
+
+        if (dot(cross(vCorners[iCross0] - vCorners[0], vCorners[iCross1] - vCorners[0]), d) >= 0.f)
+        {
+            continue;
+        }
+
+        const float* a = &projected[ 3 * p[0] ];
+        const float* b = &projected[ 3 * p[1] ];
+        const float* c = &projected[ 3 * p[2] ];
+
+        int x0 = max((int)ceilf(std::min(a[0], std::min(b[0], c[0])) - 0.5f), 0);
+        int x1 = min((int)floorf(max(a[0], max(b[0], c[0])) - 0.5f), iImageSize - 1);
+        int y0 = max((int)ceilf(std::min(a[1], std::min(b[1], c[1])) - 0.5f), 0);
+        int y1 = min((int)floorf(max(a[1], max(b[1], c[1])) - 0.5f), iImageSize - 1);
+
+        //most faces of a dense mesh cover no pixel centre
+        if (x0 > x1 || y0 > y1)
+        {
+            continue;
+        }
+
+        float fArea = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+
+        if (fArea == 0.f)
+        {
+            continue;
+        }
+
+        //make the triangle counter-clockwise in the image
+        if (fArea < 0.f)
+        {
+            std::swap(b, c);
+            fArea = -fArea;
+        }
+
+        bool bTopLeftA = IsTopLeftEdge(c[0] - b[0], c[1] - b[1]);
+        bool bTopLeftB = IsTopLeftEdge(a[0] - c[0], a[1] - c[1]);
+        bool bTopLeftC = IsTopLeftEdge(b[0] - a[0], b[1] - a[1]);
+
+        for (int py = y0; py <= y1; py++)
+        {
+            float fy = py + 0.5f;
+
+            for (int px = x0; px <= x1; px++)
+            {
+                float fx = px + 0.5f;
+
+                //the weight of each corner is the area opposite to it
+                float wa = (c[0] - b[0]) * (fy - b[1]) - (c[1] - b[1]) * (fx - b[0]);
+                float wb = (a[0] - c[0]) * (fy - c[1]) - (a[1] - c[1]) * (fx - c[0]);
+                float wc = (b[0] - a[0]) * (fy - a[1]) - (b[1] - a[1]) * (fx - a[0]);
+
+                if (wa < 0.f || wb < 0.f || wc < 0.f ||
+                    (wa == 0.f && !bTopLeftA) || (wb == 0.f && !bTopLeftB) || (wc == 0.f && !bTopLeftC))
+                {
+                    continue;
+                }
+
+                int iPixel = py * iImageSize + px;
+
+                rImageOut.pixels.push_back(iPixel);
+                rImageOut.depths.push_back((wa * a[2] + wb * b[2] + wc * c[2]) / fArea);
+
+                if (!covered[iPixel])
+                {
+                    covered[iPixel] = true;
+                    rImageOut.iNumCovered++;
+                }
+            }
+        }
+    }
+
+    rImageOut.faceStart[iNumFaces] = (int)rImageOut.pixels.size();
+}
+
+//draws the fragments of the faces in the given order with a depth test, and returns the number of fragments that pass it
+//per covered pixel, over all the images
+float OverdrawReplayImages(const OverdrawImage* pImages,
+                           int                  iNumImages,
+                           const int*           piFaceOrder,
+                           int                  iNumFaces)
+{
+    std::vector<float> depthBuffer(OVERDRAW_SAMPLE_IMAGE_SIZE * OVERDRAW_SAMPLE_IMAGE_SIZE);
+    int iNumCovered = 0;
+    int iNumDrawn = 0;
+
+    for (int v = 0; v < iNumImages; v++)
+    {
+        const OverdrawImage& rImage = pImages[v];
+
+        std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+        iNumCovered += rImage.iNumCovered;
+
+        for (int i = 0; i < iNumFaces; i++)
+        {
+            int f = piFaceOrder[i];
+
+            for (int j = rImage.faceStart[f]; j < rImage.faceStart[f + 1]; j++)
+            {
+                float& fDepth = depthBuffer[ rImage.pixels[j] ];
+
+                if (rImage.depths[j] < fDepth)
+                {
+                    fDepth = rImage.depths[j];
+                    iNumDrawn++;
+                }
+            }
+        }
+    }
+
+    return (iNumCovered > 0) ? iNumDrawn / (float)iNumCovered : 0.f;
 }
 
 //function implements linear clustering
@@ -646,7 +1259,6 @@ int OverdrawOrderPartition(int* piIndexBufferIn,
                            int* piScratch)
 {
 
-    int* piScratchBase = piScratch;
     int* piCache = piScratch;
     piScratch += iCacheSize;
 
@@ -725,15 +1337,20 @@ int OverdrawOrderPartition(int* piIndexBufferIn,
 
     piClustersOut[ iNumFaces ] = j;
 
-    memset(piScratchBase, 0, (piScratch - piScratchBase) * sizeof(int));
 
     return j;
 }
 
-//function that computes size of scratch memory
-size_t FanVertScratchSize(int iNumVertices, int iNumFaces)
+//function that computes size of scratch memory, in bytes.  it covers FanVertOptimize, whose index and cluster buffers
+// are followed by the scratch of whichever step is running (FanVertLinSort, OverdrawOrderPartition or OverdrawOrder)
+size_t FanVertScratchSize(int iNumVertices, int iNumFaces, int iCacheSize)
 {
-    return (size_t)(iNumFaces * 22 + iNumVertices + 3) * (size_t)sizeof(int);
+    size_t nStep = FanVertLinSortScratchSize(iNumVertices, iNumFaces);
+
+    nStep = max(nStep, (size_t)iNumFaces * 3 + 3);
+    nStep = max(nStep, (size_t)iCacheSize);
+
+    return ((size_t)iNumFaces * 6 + 3 + nStep) * sizeof(int);
 }
 
 //main optimization function
@@ -749,7 +1366,7 @@ void FanVertOptimize(float* pfVertexPositionsIn,    //vertex buffer positions, 3
                      //lambda = alpha + beta * ACMR_OF_TIPSY
 
                      int* piScratch = NULL,        //optional temp buffer for computations; its size in bytes should be:
-                     //FanVertScratchSize(iNumVertices, iNumFaces)
+                     //FanVertScratchSize(iNumVertices, iNumFaces, iCacheSize)
                      //if NULL is passed, function will allocate and free this data
 
                      int* piClustersOut = NULL,    //optional buffer for the output cluster position (in faces) of each cluster
@@ -759,9 +1376,8 @@ void FanVertOptimize(float* pfVertexPositionsIn,    //vertex buffer positions, 3
 
     if (piScratch == NULL)
     {
-        size_t iScratchSize = FanVertScratchSize(iNumVertices, iNumFaces);
+        size_t iScratchSize = FanVertScratchSize(iNumVertices, iNumFaces, iCacheSize);
         piScratch = (int*)malloc(iScratchSize);
-        memset(piScratch, 0, iScratchSize);
         bMalloc = true;
     }
 
@@ -781,8 +1397,8 @@ void FanVertOptimize(float* pfVertexPositionsIn,    //vertex buffer positions, 3
 
 
     int iNumClusters;
-    float lambda = FanVertLinSort(piIndexBufferIn, piIndexBufferTmp, iNumFaces,
-                                  piScratch, iCacheSize, piClustersIn, iNumClusters);
+    float lambda = FanVertLinSort(piIndexBufferIn, piIndexBufferTmp, iNumVertices, iNumFaces,
+                                  piScratch, iCacheSize, piClustersIn, iNumClusters, false, NULL);
 
     lambda = alpha + beta * lambda;
 
@@ -834,11 +1450,6 @@ void FanVertOptimize(float* pfVertexPositionsIn,    //vertex buffer positions, 3
         }
     }
 
-    if (piScratch - piScratchBase > 0)
-    {
-        memset(piScratchBase, 0, (piScratch - piScratchBase) * sizeof(int));    //clear memory from tmp
-    }
-
     if (bMalloc)
     {
         free(piScratchBase);
@@ -854,15 +1465,16 @@ float FanVertOptimizeVCacheOnly(int* piIndexBufferIn,
                                 int iCacheSize,
                                 int* piScratch,
                                 int* piClustersOut,
-                                int* iNumClusters)
+                                int* iNumClusters,
+                                bool bCompressTies,
+                                int* piVertexMap)
 {
     bool bMalloc = false;
 
     if (piScratch == NULL)
     {
-        size_t iScratchSize = FanVertScratchSize(iNumVertices, iNumFaces);
+        size_t iScratchSize = ((size_t)iNumFaces + 1 + FanVertLinSortScratchSize(iNumVertices, iNumFaces)) * sizeof(int);
         piScratch = (int*)malloc(iScratchSize);
-        memset(piScratch, 0, iScratchSize);
         bMalloc = true;
     }
 
@@ -877,19 +1489,14 @@ float FanVertOptimizeVCacheOnly(int* piIndexBufferIn,
     }
 
     int nc;
-    float lambda = FanVertLinSort(piIndexBufferIn, piIndexBufferOut, iNumFaces,
-                                  piScratch, iCacheSize, piClustersOut, nc);
+    float lambda = FanVertLinSort(piIndexBufferIn, piIndexBufferOut, iNumVertices, iNumFaces,
+                                  piScratch, iCacheSize, piClustersOut, nc, bCompressTies, piVertexMap);
 
     if (iNumClusters)
     {
         *iNumClusters = nc;
     }
 
-    if (piScratch - piScratchBase > 0)
-    {
-        memset(piScratchBase, 0, (piScratch - piScratchBase) * sizeof(int));    //clear memory from tmp
-    }
-
     if (bMalloc)
     {
         free(piScratchBase);
@@ -914,9 +1521,8 @@ void FanVertOptimizeClusterOnly(int* piIndexBufferIn,
 
     if (piScratch == NULL)
     {
-        size_t iScratchSize = FanVertScratchSize(iNumVertices, iNumFaces);
+        size_t iScratchSize = FanVertScratchSize(iNumVertices, iNumFaces, iCacheSize);
         piScratch = (int*)malloc(iScratchSize);
-        memset(piScratch, 0, iScratchSize);
         bMalloc = true;
     }
 
@@ -945,9 +1551,8 @@ void FanVertOptimizeOverdrawOnly(float*            pfVertexPositionsIn,
 
     if (piScratch == NULL)
     {
-        size_t iScratchSize = FanVertScratchSize(iNumVertices, iNumFaces);
+        size_t iScratchSize = FanVertScratchSize(iNumVertices, iNumFaces, 0);
         piScratch        = (int*) malloc(iScratchSize);
-        memset(piScratch, 0, iScratchSize);
         bMalloc = true;
     }
 
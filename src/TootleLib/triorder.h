@@ -6,10 +6,14 @@
 #ifndef _TRIORDER_H
 #define _TRIORDER_H
 
+#include <vector>
+
 #define TOOTLE_NONE (2147483647)            // 2^31 -1 (ideally should be 2^32-1 for max unsigned int).  However, int and
 // unsigned int are used interchangebly in the library.
 
-/// Perform vertex optimization only
+/// Perform vertex optimization only.  bCompressTies breaks ties in favour of a more compressible index buffer.
+/// piVertexMap may be NULL, or iNumVertices ints that are all 0 and are left that way.  Passing one lets a caller that
+/// optimizes many pieces of a mesh clear it once.
 float FanVertOptimizeVCacheOnly(int*              piIndexBufferIn,
                                 int*              piIndexBufferOut,
                                 int               iNumVertices,
@@ -17,7 +21,9 @@ float FanVertOptimizeVCacheOnly(int*              piIndexBufferIn,
                                 int               iCacheSize,
                                 int*              piScratch = NULL,
                                 int*              piClustersOut = NULL,
-                                int*              iNumClusters = NULL);
+                                int*              iNumClusters = NULL,
+                                bool              bCompressTies = false,
+                                int*              piVertexMap = NULL);
 
 /// The function below just clusters the mesh. It assumes it is already sorted and pre-clustered
 /// with "hard boundaries" during vertex cache optimization using the above function.
@@ -47,5 +53,58 @@ void FanVertOptimizeOverdrawOnly(float*            pfVertexPositionsIn,
                                  int*              piScratch = NULL,
                                  int*              piRemap = NULL);
 
+/// Computes the measure FanVertOptimizeOverdrawOnly sorts the clusters by, in ascending draw order.  piClustersIn holds the
+/// first face of each cluster, followed by iNumFaces.
+void OverdrawClusterMeasures(const int*        piIndexBufferIn,
+                             int               iNumFaces,
+                             const float*      pfVertexPositionsIn,
+                             TootleFaceWinding eFrontWinding,
+                             const int*        piClustersIn,
+                             int               iNumClusters,
+                             float*            pfMeasuresOut);
+
+/// Orders the faces of each cluster front to back, by the distance of their centroids from the mesh centroid along the normal
+/// of the cluster.  The vertex cache order is kept in runs of faces, the shortest whose order adds at most fMaxACMRIncrease
+/// to the ACMR of the cluster, measured with a FIFO cache of iCacheSize vertices.  The index buffer is reordered in place.
+/// piFaceOrderOut may be NULL, or receives for each face the position it had in the index buffer.
+void FrontToBackClusterFaces(int*              piIndexBuffer,
+                             int               iNumFaces,
+                             const float*      pfVertexPositionsIn,
+                             int               iNumVertices,
+                             TootleFaceWinding eFrontWinding,
+                             const int*        piClustersIn,
+                             int               iNumClusters,
+                             int               iCacheSize,
+                             float             fMaxACMRIncrease,
+                             int*              piFaceOrderOut = NULL);
+
+/// The number of directions OverdrawSampleImage can render a mesh along
+#define OVERDRAW_SAMPLE_VIEWS 14
+
+/// The fragments of a mesh rendered at a low resolution along one direction, used to estimate the overdraw of face orders
+struct OverdrawImage
+{
+    std::vector<int>   faceStart;   ///< The first fragment of each face, followed by the number of fragments
+    std::vector<int>   pixels;      ///< The pixel of each fragment
+    std::vector<float> depths;      ///< The depth of each fragment
+    int                iNumCovered; ///< The number of pixels with at least one fragment
+};
+
+/// Renders the front faces of a mesh into a small orthographic image along direction iView, from 0 to OVERDRAW_SAMPLE_VIEWS-1,
+/// and stores the fragments.
+void OverdrawSampleImage(const int*        piIndexBufferIn,
+                         int               iNumFaces,
+                         const float*      pfVertexPositionsIn,
+                         int               iNumVertices,
+                         TootleFaceWinding eFrontWinding,
+                         int               iView,
+                         OverdrawImage&    rImageOut);
+
+/// Estimates the overdraw of a face order, in the same units as TootleMeasureOverdraw, by drawing the fragments of the faces
+/// in that order with a depth test.  piFaceOrder lists the faces of the index buffer passed to OverdrawSampleImage.
+float OverdrawReplayImages(const OverdrawImage* pImages,
+                           int                  iNumImages,
+                           const int*           piFaceOrder,
+                           int                  iNumFaces);
 
 #endif
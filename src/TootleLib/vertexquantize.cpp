@@ -0,0 +1,296 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+/**
+The vertex conversions applied by TootleOptimizeVertexMemory and TootleOptimizeVertexStreams when an output layout is given.
+
+Positions are quantized to 16 bits per component over the bounding box of the attribute, which keeps the error near
+1/131070 of the box size on each axis.  Normals use the octahedral mapping: the unit vector is projected onto the
+octahedron |x| + |y| + |z| = 1, and the lower half of the octahedron is folded over the upper half, giving two values in
+[-1, 1] that are stored as signed normalized integers.  Texture coordinates are rounded to the nearest half float.
+
+The input attributes are read with memcpy, so they need not be aligned.
+*/
+
+#include "TootlePCH.h"
+#include "vertexquantize.h"
+
+//=================================================================================================================================
+//
+//          Internal functions
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Converts a float to the nearest half float, rounding ties to even.  Values too large for a half float become infinite.
+//=================================================================================================================================
+static unsigned short FloatToHalf(float fValue)
+{
+    unsigned int nBits;
+    memcpy(&nBits, &fValue, sizeof(nBits));
+
+    unsigned int nSign     = (nBits >> 16) & 0x8000;
+    unsigned int nExponent = (nBits >> 23) & 0xff;
+    unsigned int nMantissa = nBits & 0x7fffff;
+
+    // infinity and NaN, keeping NaN a NaN
+    if (nExponent == 0xff)
+    {
+        return (unsigned short)(nSign | 0x7c00 | (nMantissa ? 0x200 : 0));
+    }
+
+    int nHalfExponent = (int) nExponent - 127 + 15;
+
+    if (nHalfExponent >= 0x1f)
+    {
+        return (unsigned short)(nSign | 0x7c00);
+    }
+
+    if (nHalfExponent <= 0)
+    {
+        // the value is a half float denormal, or too small for a half float
+        if (nHalfExponent < -10)
+        {
+            return (unsigned short) nSign;
+        }
+
+        nMantissa |= 0x800000;
+
+        unsigned int nShift     = 14 - nHalfExponent;
+        unsigned int nHalf      = nMantissa >> nShift;
+        unsigned int nRemainder = nMantissa & ((1u << nShift) - 1);
+        unsigned int nTie       = 1u << (nShift - 1);
+
+        if (nRemainder > nTie || (nRemainder == nTie && (nHalf & 1)))
+        {
+            nHalf++;
+        }
+
+        return (unsigned short)(nSign | nHalf);
+    }
+
+    // a carry out of the mantissa correctly increments the exponent, up to infinity
+    unsigned int nHalf      = ((unsigned int) nHalfExponent << 10) | (nMantissa >> 13);
+    unsigned int nRemainder = nMantissa & 0x1fff;
+
+    if (nRemainder > 0x1000 || (nRemainder == 0x1000 && (nHalf & 1)))
+    {
+        nHalf++;
+    }
+
+    return (unsigned short)(nSign | nHalf);
+}
+
+//=================================================================================================================================
+/// Rounds a value in [-1, 1] to a signed normalized integer with the given maximum
+//=================================================================================================================================
+static int ToSNorm(float fValue, int nMax)
+{
+    float fScaled = fValue * (float) nMax;
+    int nValue = (int)(fScaled >= 0.0f ? fScaled + 0.5f : fScaled - 0.5f);
+
+    return (nValue > nMax) ? nMax : ((nValue < -nMax) ? -nMax : nValue);
+}
+
+//=================================================================================================================================
+/// Maps a vector to the octahedral encoding, both values in [-1, 1].  A zero vector maps to (0, 0).
+//=================================================================================================================================
+static void EncodeOctahedral(const float* pfNormal, float& rfU, float& rfV)
+{
+    float fLength = fabsf(pfNormal[0]) + fabsf(pfNormal[1]) + fabsf(pfNormal[2]);
+
+    if (!(fLength > 0.0f))
+    {
+        rfU = 0.0f;
+        rfV = 0.0f;
+        return;
+    }
+
+    rfU = pfNormal[0] / fLength;
+    rfV = pfNormal[1] / fLength;
+
+    // fold the lower half of the octahedron over the upper half
+    if (pfNormal[2] < 0.0f)
+    {
+        float fU = rfU;
+        rfU = (1.0f - fabsf(rfV)) * (fU >= 0.0f ? 1.0f : -1.0f);
+        rfV = (1.0f - fabsf(fU)) * (rfV >= 0.0f ? 1.0f : -1.0f);
+    }
+}
+
+//=================================================================================================================================
+//
+//          Quantization functions
+//
+//=================================================================================================================================
+
+bool GetVertexAttributeSize(const TootleVertexAttribute& rAttribute, unsigned int& rnInSize, unsigned int& rnOutSize)
+{
+    switch (rAttribute.eFormat)
+    {
+        case TOOTLE_VERTEX_COPY:
+            rnInSize  = rAttribute.nSize;
+            rnOutSize = rAttribute.nSize;
+            return true;
+
+        case TOOTLE_VERTEX_POSITION_UNORM16:
+            rnInSize  = 3 * sizeof(float);
+            rnOutSize = 3 * sizeof(unsigned short);
+            return true;
+
+        case TOOTLE_VERTEX_NORMAL_OCT8:
+            rnInSize  = 3 * sizeof(float);
+            rnOutSize = 2 * sizeof(signed char);
+            return true;
+
+        case TOOTLE_VERTEX_NORMAL_OCT16:
+            rnInSize  = 3 * sizeof(float);
+            rnOutSize = 2 * sizeof(short);
+            return true;
+
+        case TOOTLE_VERTEX_TEXCOORD_HALF2:
+            rnInSize  = 2 * sizeof(float);
+            rnOutSize = 2 * sizeof(unsigned short);
+            return true;
+
+        case NA_TOOTLE_VERTEX_FORMAT:
+        default:
+            return false;
+    }
+}
+
+void QuantizeVertices(const void*               pVB,
+                      unsigned int              nVBStride,
+                      unsigned int              nVertices,
+                      const TootleVertexLayout& rLayout,
+                      const unsigned int*       pnVIDRemap,
+                      void*                     pVBOut)
+{
+    const char* pVBuffer = (const char*) pVB;
+    unsigned int nAttribute;
+    unsigned int i;
+
+    // Find the bounds of the positions.  Only the position attributes are read, the rest of the vertex is left for the
+    //  single conversion pass below.
+    std::vector<float> bounds;
+
+    for (nAttribute = 0; nAttribute < rLayout.nAttributes; nAttribute++)
+    {
+        const TootleVertexAttribute& rAttribute = rLayout.pAttributes[ nAttribute ];
+
+        if (rAttribute.eFormat != TOOTLE_VERTEX_POSITION_UNORM16)
+        {
+            continue;
+        }
+
+        float pfMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float pfMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        for (i = 0; i < nVertices; i++)
+        {
+            float pfPosition[3];
+            memcpy(pfPosition, &pVBuffer[ (size_t) i * nVBStride + rAttribute.nOffset ], sizeof(pfPosition));
+
+            for (unsigned int c = 0; c < 3; c++)
+            {
+                pfMin[c] = (pfPosition[c] < pfMin[c]) ? pfPosition[c] : pfMin[c];
+                pfMax[c] = (pfPosition[c] > pfMax[c]) ? pfPosition[c] : pfMax[c];
+            }
+        }
+
+        bounds.insert(bounds.end(), pfMin, pfMin + 3);
+        bounds.insert(bounds.end(), pfMax, pfMax + 3);
+    }
+
+    if (rLayout.pfBoundsOut != NULL && !bounds.empty())
+    {
+        memcpy(rLayout.pfBoundsOut, &bounds[0], bounds.size() * sizeof(float));
+    }
+
+    // the scale from a position to its quantized value, for each position attribute
+    std::vector<float> scales(bounds.size() / 2);
+
+    for (i = 0; i < scales.size(); i++)
+    {
+        float fExtent = bounds[ (i / 3) * 6 + 3 + (i % 3) ] - bounds[ (i / 3) * 6 + (i % 3) ];
+        scales[i] = (fExtent > 0.0f) ? 65535.0f / fExtent : 0.0f;
+    }
+
+    // convert and reorder the vertices in one pass
+    char* pVBufferOut = (char*) pVBOut;
+
+    for (i = 0; i < nVertices; i++, pVBuffer += nVBStride)
+    {
+        char* pVertexOut = &pVBufferOut[ (size_t) pnVIDRemap[i] * rLayout.nVBOutStride ];
+        unsigned int nPosition = 0;
+
+        memset(pVertexOut, 0, rLayout.nVBOutStride);
+
+        for (nAttribute = 0; nAttribute < rLayout.nAttributes; nAttribute++)
+        {
+            const TootleVertexAttribute& rAttribute = rLayout.pAttributes[ nAttribute ];
+            const char* pIn = &pVBuffer[ rAttribute.nOffset ];
+            char* pOut = &pVertexOut[ rAttribute.nOutOffset ];
+            float pfValue[3];
+
+            switch (rAttribute.eFormat)
+            {
+                case TOOTLE_VERTEX_COPY:
+                    memcpy(pOut, pIn, rAttribute.nSize);
+                    break;
+
+                case TOOTLE_VERTEX_POSITION_UNORM16:
+                {
+                    memcpy(pfValue, pIn, 3 * sizeof(float));
+                    unsigned short pnValue[3];
+
+                    for (unsigned int c = 0; c < 3; c++)
+                    {
+                        float fScaled = (pfValue[c] - bounds[ nPosition * 6 + c ]) * scales[ nPosition * 3 + c ] + 0.5f;
+                        pnValue[c] = (unsigned short)((fScaled < 65535.0f) ? fScaled : 65535.0f);
+                    }
+
+                    memcpy(pOut, pnValue, sizeof(pnValue));
+                    nPosition++;
+                    break;
+                }
+
+                case TOOTLE_VERTEX_NORMAL_OCT8:
+                case TOOTLE_VERTEX_NORMAL_OCT16:
+                {
+                    memcpy(pfValue, pIn, 3 * sizeof(float));
+                    float fU, fV;
+                    EncodeOctahedral(pfValue, fU, fV);
+
+                    if (rAttribute.eFormat == TOOTLE_VERTEX_NORMAL_OCT8)
+                    {
+                        signed char pnValue[2] = { (signed char) ToSNorm(fU, 127), (signed char) ToSNorm(fV, 127) };
+                        memcpy(pOut, pnValue, sizeof(pnValue));
+                    }
+                    else
+                    {
+                        short pnValue[2] = { (short) ToSNorm(fU, 32767), (short) ToSNorm(fV, 32767) };
+                        memcpy(pOut, pnValue, sizeof(pnValue));
+                    }
+
+                    break;
+                }
+
+                case TOOTLE_VERTEX_TEXCOORD_HALF2:
+                {
+                    memcpy(pfValue, pIn, 2 * sizeof(float));
+                    unsigned short pnValue[2] = { FloatToHalf(pfValue[0]), FloatToHalf(pfValue[1]) };
+                    memcpy(pOut, pnValue, sizeof(pnValue));
+                    break;
+                }
+
+                case NA_TOOTLE_VERTEX_FORMAT:
+                default:
+                    break;
+            }
+        }
+    }
+}
@@ -0,0 +1,24 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _TOOTLE_VERTEXQUANTIZE_H_
+#define _TOOTLE_VERTEXQUANTIZE_H_
+
+#include "tootlelib.h"
+
+/// Returns false if the format is invalid.  Otherwise, rnInSize and rnOutSize receive the number of bytes the attribute
+/// occupies in an input and in an output vertex.
+bool GetVertexAttributeSize(const TootleVertexAttribute& rAttribute, unsigned int& rnInSize, unsigned int& rnOutSize);
+
+/// Converts the vertices of pVB to rLayout and writes input vertex i to output vertex pnVIDRemap[i] of pVBOut.
+/// The layout must have been validated with GetVertexAttributeSize.
+void QuantizeVertices(const void*               pVB,
+                      unsigned int              nVBStride,
+                      unsigned int              nVertices,
+                      const TootleVertexLayout& rLayout,
+                      const unsigned int*       pnVIDRemap,
+                      void*                     pVBOut);
+
+#endif
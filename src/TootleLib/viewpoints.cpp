@@ -0,0 +1,902 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+/**
+The viewpoint sets used to measure and optimize overdraw: the default set, and the samplings generated by
+TootleGenerateViewpoints.
+
+The geodesic sampling divides each edge of an icosahedron into N parts, fills each face with the triangular grid through those
+points and projects the grid onto the unit sphere.  Every grid point is written once: the icosahedron's vertices first, then the
+points inside each edge, then the points inside each face.  The Fibonacci sampling walks a spiral down from the axis of the
+cap, so it can stop at any count and sample a cone without wasting viewpoints outside it.
+*/
+
+#include "TootlePCH.h"
+#include "scalar.h"
+#include "viewpoints.h"
+
+#include <algorithm>
+
+/// Viewpoints on the boundary of a cone are kept, whatever the rounding of their coordinates
+#define VIEWPOINT_CONE_EPSILON  1.0e-6
+
+const unsigned int nDefaultViewpoints = 642;
+
+const float pDefaultViewpoint[] =
+{
+    0.000000f, -0.525731f, 0.850651f,
+    0.000000f, 0.525731f, 0.850651f,
+    0.000000f, -0.525731f, -0.850651f,
+    0.000000f, 0.525731f, -0.850651f,
+    0.850651f, -0.000000f, 0.525731f,
+    0.850651f, 0.000000f, -0.525731f,
+    -0.850651f, -0.000000f, 0.525731f,
+    -0.850651f, 0.000000f, -0.525731f,
+    0.525731f, 0.850651f, 0.000000f,
+    0.525731f, -0.850651f, 0.000000f,
+    -0.525731f, 0.850651f, -0.000000f,
+    -0.525731f, -0.850651f, 0.000000f,
+    0.500000f, 0.309017f, 0.809017f,
+    0.000000f, 0.000000f, 1.000000f,
+    0.500000f, -0.309017f, 0.809017f,
+    0.809017f, -0.500000f, 0.309017f,
+    0.309017f, -0.809017f, 0.500000f,
+    1.000000f, 0.000000f, 0.000000f,
+    0.809017f, -0.500000f, -0.309017f,
+    0.809017f, 0.500000f, -0.309017f,
+    0.809017f, 0.500000f, 0.309017f,
+    0.309017f, 0.809017f, 0.500000f,
+    -0.309017f, 0.809017f, 0.500000f,
+    -0.000000f, 1.000000f, 0.000000f,
+    -0.309017f, 0.809017f, -0.500000f,
+    0.309017f, 0.809017f, -0.500000f,
+    0.500000f, 0.309017f, -0.809017f,
+    0.000000f, 0.000000f, -1.000000f,
+    0.500000f, -0.309017f, -0.809017f,
+    -0.500000f, 0.309017f, -0.809017f,
+    -0.500000f, -0.309017f, -0.809017f,
+    -0.809017f, 0.500000f, -0.309017f,
+    -0.809017f, 0.500000f, 0.309017f,
+    -1.000000f, 0.000000f, 0.000000f,
+    -0.809017f, -0.500000f, 0.309017f,
+    -0.809017f, -0.500000f, -0.309017f,
+    -0.500000f, -0.309017f, 0.809017f,
+    -0.309017f, -0.809017f, 0.500000f,
+    -0.500000f, 0.309017f, 0.809017f,
+    0.000000f, -1.000000f, 0.000000f,
+    -0.309017f, -0.809017f, -0.500000f,
+    0.309017f, -0.809017f, -0.500000f,
+    0.268204f, -0.153792f, 0.951007f,
+    0.517044f, -0.000000f, 0.855959f,
+    0.268204f, 0.153792f, 0.951007f,
+    0.433963f, -0.587755f, 0.682803f,
+    0.587755f, -0.682803f, 0.433963f,
+    0.682803f, -0.433963f, 0.587755f,
+    0.855959f, -0.517044f, 0.000000f,
+    0.951007f, -0.268204f, -0.153792f,
+    0.951007f, -0.268204f, 0.153792f,
+    0.951007f, 0.268204f, 0.153792f,
+    0.951007f, 0.268204f, -0.153792f,
+    0.855959f, 0.517044f, -0.000000f,
+    0.682803f, 0.433963f, 0.587755f,
+    0.587755f, 0.682803f, 0.433963f,
+    0.433963f, 0.587755f, 0.682803f,
+    0.153792f, 0.951007f, 0.268204f,
+    -0.153792f, 0.951007f, 0.268204f,
+    0.000000f, 0.855959f, 0.517044f,
+    0.153792f, 0.951007f, -0.268204f,
+    0.000000f, 0.855959f, -0.517044f,
+    -0.153792f, 0.951007f, -0.268204f,
+    0.682803f, 0.433963f, -0.587755f,
+    0.433963f, 0.587755f, -0.682803f,
+    0.587755f, 0.682803f, -0.433963f,
+    0.517044f, 0.000000f, -0.855959f,
+    0.268204f, -0.153792f, -0.951007f,
+    0.268204f, 0.153792f, -0.951007f,
+    -0.268204f, -0.153792f, -0.951007f,
+    -0.517044f, 0.000000f, -0.855959f,
+    -0.268204f, 0.153792f, -0.951007f,
+    -0.682803f, 0.433963f, -0.587755f,
+    -0.587755f, 0.682803f, -0.433963f,
+    -0.433963f, 0.587755f, -0.682803f,
+    -0.951007f, 0.268204f, -0.153792f,
+    -0.951007f, 0.268204f, 0.153792f,
+    -0.855959f, 0.517044f, 0.000000f,
+    -0.951007f, -0.268204f, -0.153792f,
+    -0.855959f, -0.517044f, -0.000000f,
+    -0.951007f, -0.268204f, 0.153792f,
+    -0.587755f, -0.682803f, 0.433963f,
+    -0.433963f, -0.587755f, 0.682803f,
+    -0.682803f, -0.433963f, 0.587755f,
+    -0.268204f, -0.153792f, 0.951007f,
+    -0.268204f, 0.153792f, 0.951007f,
+    -0.517044f, -0.000000f, 0.855959f,
+    -0.682803f, 0.433963f, 0.587755f,
+    -0.433963f, 0.587755f, 0.682803f,
+    -0.587755f, 0.682803f, 0.433963f,
+    0.153792f, -0.951007f, 0.268204f,
+    0.000000f, -0.855959f, 0.517044f,
+    -0.153792f, -0.951007f, 0.268204f,
+    0.153792f, -0.951007f, -0.268204f,
+    -0.153792f, -0.951007f, -0.268204f,
+    -0.000000f, -0.855959f, -0.517044f,
+    0.587755f, -0.682803f, -0.433963f,
+    0.433963f, -0.587755f, -0.682803f,
+    0.682803f, -0.433963f, -0.587755f,
+    -0.682803f, -0.433963f, -0.587755f,
+    -0.433963f, -0.587755f, -0.682803f,
+    -0.587755f, -0.682803f, -0.433963f,
+    0.000000f, -0.293869f, 0.955846f,
+    0.240178f, -0.442307f, 0.864106f,
+    0.715668f, -0.148438f, 0.682485f,
+    0.715668f, 0.148438f, 0.682485f,
+    0.240178f, 0.442307f, 0.864106f,
+    0.000000f, 0.293869f, 0.955846f,
+    0.148438f, -0.682485f, 0.715668f,
+    0.442307f, -0.864106f, 0.240178f,
+    0.682485f, -0.715668f, 0.148438f,
+    0.864106f, -0.240178f, 0.442307f,
+    0.682485f, -0.715668f, -0.148438f,
+    0.864106f, -0.240178f, -0.442307f,
+    0.955846f, 0.000000f, -0.293869f,
+    0.955846f, 0.000000f, 0.293869f,
+    0.864106f, 0.240178f, 0.442307f,
+    0.864106f, 0.240178f, -0.442307f,
+    0.682485f, 0.715668f, -0.148438f,
+    0.682485f, 0.715668f, 0.148438f,
+    0.442307f, 0.864106f, 0.240178f,
+    0.148438f, 0.682485f, 0.715668f,
+    0.293869f, 0.955846f, 0.000000f,
+    -0.293869f, 0.955846f, 0.000000f,
+    -0.442307f, 0.864106f, 0.240178f,
+    -0.148438f, 0.682485f, 0.715668f,
+    0.442307f, 0.864106f, -0.240178f,
+    0.148438f, 0.682485f, -0.715668f,
+    -0.148438f, 0.682485f, -0.715668f,
+    -0.442307f, 0.864106f, -0.240178f,
+    0.715668f, 0.148438f, -0.682485f,
+    0.240178f, 0.442307f, -0.864106f,
+    0.715668f, -0.148438f, -0.682485f,
+    0.240178f, -0.442307f, -0.864106f,
+    0.000000f, -0.293869f, -0.955846f,
+    0.000000f, 0.293869f, -0.955846f,
+    -0.240178f, -0.442307f, -0.864106f,
+    -0.715668f, -0.148438f, -0.682485f,
+    -0.715668f, 0.148438f, -0.682485f,
+    -0.240178f, 0.442307f, -0.864106f,
+    -0.864106f, 0.240178f, -0.442307f,
+    -0.682485f, 0.715668f, -0.148438f,
+    -0.955846f, 0.000000f, -0.293869f,
+    -0.955846f, 0.000000f, 0.293869f,
+    -0.864106f, 0.240178f, 0.442307f,
+    -0.682485f, 0.715668f, 0.148438f,
+    -0.864106f, -0.240178f, -0.442307f,
+    -0.682485f, -0.715668f, -0.148438f,
+    -0.682485f, -0.715668f, 0.148438f,
+    -0.864106f, -0.240178f, 0.442307f,
+    -0.442307f, -0.864106f, 0.240178f,
+    -0.148438f, -0.682485f, 0.715668f,
+    -0.240178f, -0.442307f, 0.864106f,
+    -0.715668f, -0.148438f, 0.682485f,
+    -0.240178f, 0.442307f, 0.864106f,
+    -0.715668f, 0.148438f, 0.682485f,
+    0.293869f, -0.955846f, 0.000000f,
+    -0.293869f, -0.955846f, 0.000000f,
+    0.442307f, -0.864106f, -0.240178f,
+    -0.442307f, -0.864106f, -0.240178f,
+    -0.148438f, -0.682485f, -0.715668f,
+    0.148438f, -0.682485f, -0.715668f,
+    0.397581f, 0.078279f, 0.914222f,
+    0.270922f, 0.000000f, 0.962601f,
+    0.397581f, -0.078279f, 0.914222f,
+    0.643300f, -0.565020f, 0.516641f,
+    0.565020f, -0.516641f, 0.643300f,
+    0.516641f, -0.643300f, 0.565020f,
+    0.962601f, -0.270922f, 0.000000f,
+    0.914222f, -0.397581f, 0.078279f,
+    0.914222f, -0.397581f, -0.078279f,
+    0.914222f, 0.397581f, -0.078279f,
+    0.914222f, 0.397581f, 0.078279f,
+    0.962601f, 0.270922f, 0.000000f,
+    0.516641f, 0.643300f, 0.565020f,
+    0.565020f, 0.516641f, 0.643300f,
+    0.643300f, 0.565020f, 0.516641f,
+    -0.078279f, 0.914222f, 0.397581f,
+    0.078279f, 0.914222f, 0.397581f,
+    0.000000f, 0.962601f, 0.270922f,
+    -0.078279f, 0.914222f, -0.397581f,
+    0.000000f, 0.962601f, -0.270922f,
+    0.078279f, 0.914222f, -0.397581f,
+    0.516641f, 0.643300f, -0.565020f,
+    0.643300f, 0.565020f, -0.516641f,
+    0.565020f, 0.516641f, -0.643300f,
+    0.270922f, 0.000000f, -0.962601f,
+    0.397581f, 0.078279f, -0.914222f,
+    0.397581f, -0.078279f, -0.914222f,
+    -0.397581f, 0.078279f, -0.914222f,
+    -0.270922f, 0.000000f, -0.962601f,
+    -0.397581f, -0.078279f, -0.914222f,
+    -0.516641f, 0.643300f, -0.565020f,
+    -0.565020f, 0.516641f, -0.643300f,
+    -0.643300f, 0.565020f, -0.516641f,
+    -0.914222f, 0.397581f, 0.078279f,
+    -0.914222f, 0.397581f, -0.078279f,
+    -0.962601f, 0.270922f, 0.000000f,
+    -0.914222f, -0.397581f, 0.078279f,
+    -0.962601f, -0.270922f, 0.000000f,
+    -0.914222f, -0.397581f, -0.078279f,
+    -0.565020f, -0.516641f, 0.643300f,
+    -0.643300f, -0.565020f, 0.516641f,
+    -0.516641f, -0.643300f, 0.565020f,
+    -0.397581f, 0.078279f, 0.914222f,
+    -0.397581f, -0.078279f, 0.914222f,
+    -0.270922f, 0.000000f, 0.962601f,
+    -0.516641f, 0.643300f, 0.565020f,
+    -0.643300f, 0.565020f, 0.516641f,
+    -0.565020f, 0.516641f, 0.643300f,
+    -0.078279f, -0.914222f, 0.397581f,
+    0.000000f, -0.962601f, 0.270922f,
+    0.078279f, -0.914222f, 0.397581f,
+    -0.078279f, -0.914222f, -0.397581f,
+    0.078279f, -0.914222f, -0.397581f,
+    0.000000f, -0.962601f, -0.270922f,
+    0.565020f, -0.516641f, -0.643300f,
+    0.643300f, -0.565020f, -0.516641f,
+    0.516641f, -0.643300f, -0.565020f,
+    -0.516641f, -0.643300f, -0.565020f,
+    -0.643300f, -0.565020f, -0.516641f,
+    -0.565020f, -0.516641f, -0.643300f,
+    0.126613f, -0.365148f, 0.922299f,
+    0.258771f, -0.303162f, 0.917131f,
+    0.133337f, -0.225640f, 0.965043f,
+    0.717435f, -0.000000f, 0.696625f,
+    0.623864f, 0.077522f, 0.777678f,
+    0.623864f, -0.077523f, 0.777678f,
+    0.126613f, 0.365148f, 0.922299f,
+    0.133337f, 0.225640f, 0.965043f,
+    0.258771f, 0.303162f, 0.917131f,
+    0.204864f, -0.570012f, 0.795686f,
+    0.293267f, -0.644341f, 0.706271f,
+    0.341179f, -0.518907f, 0.783794f,
+    0.570012f, -0.795686f, 0.204864f,
+    0.644341f, -0.706271f, 0.293267f,
+    0.518907f, -0.783794f, 0.341179f,
+    0.795686f, -0.204864f, 0.570012f,
+    0.706271f, -0.293267f, 0.644341f,
+    0.783794f, -0.341179f, 0.518907f,
+    0.696625f, -0.717435f, 0.000000f,
+    0.777678f, -0.623864f, -0.077522f,
+    0.777678f, -0.623864f, 0.077523f,
+    0.922299f, -0.126613f, -0.365148f,
+    0.965043f, -0.133337f, -0.225640f,
+    0.917131f, -0.258771f, -0.303162f,
+    0.922299f, -0.126613f, 0.365148f,
+    0.917131f, -0.258771f, 0.303162f,
+    0.965043f, -0.133337f, 0.225640f,
+    0.922299f, 0.126613f, 0.365148f,
+    0.965043f, 0.133337f, 0.225640f,
+    0.917131f, 0.258771f, 0.303162f,
+    0.922299f, 0.126613f, -0.365148f,
+    0.917131f, 0.258771f, -0.303162f,
+    0.965043f, 0.133337f, -0.225640f,
+    0.696625f, 0.717435f, 0.000000f,
+    0.777678f, 0.623864f, 0.077523f,
+    0.777678f, 0.623864f, -0.077523f,
+    0.795686f, 0.204864f, 0.570012f,
+    0.783794f, 0.341179f, 0.518907f,
+    0.706271f, 0.293267f, 0.644341f,
+    0.570012f, 0.795686f, 0.204864f,
+    0.518907f, 0.783794f, 0.341179f,
+    0.644341f, 0.706271f, 0.293267f,
+    0.204864f, 0.570012f, 0.795686f,
+    0.341179f, 0.518907f, 0.783794f,
+    0.293267f, 0.644341f, 0.706271f,
+    0.365148f, 0.922299f, 0.126613f,
+    0.225640f, 0.965043f, 0.133337f,
+    0.303162f, 0.917131f, 0.258771f,
+    -0.365148f, 0.922299f, 0.126613f,
+    -0.303162f, 0.917131f, 0.258771f,
+    -0.225640f, 0.965043f, 0.133337f,
+    0.000000f, 0.696625f, 0.717435f,
+    0.077523f, 0.777678f, 0.623864f,
+    -0.077523f, 0.777678f, 0.623864f,
+    0.365148f, 0.922299f, -0.126613f,
+    0.303162f, 0.917131f, -0.258771f,
+    0.225640f, 0.965043f, -0.133337f,
+    0.000000f, 0.696625f, -0.717435f,
+    -0.077522f, 0.777678f, -0.623864f,
+    0.077523f, 0.777678f, -0.623864f,
+    -0.365148f, 0.922299f, -0.126613f,
+    -0.225640f, 0.965043f, -0.133337f,
+    -0.303162f, 0.917131f, -0.258771f,
+    0.795686f, 0.204864f, -0.570012f,
+    0.706271f, 0.293267f, -0.644341f,
+    0.783794f, 0.341179f, -0.518907f,
+    0.204864f, 0.570012f, -0.795686f,
+    0.293267f, 0.644341f, -0.706271f,
+    0.341179f, 0.518907f, -0.783794f,
+    0.570012f, 0.795686f, -0.204864f,
+    0.644341f, 0.706271f, -0.293267f,
+    0.518907f, 0.783794f, -0.341179f,
+    0.717435f, 0.000000f, -0.696625f,
+    0.623864f, -0.077523f, -0.777678f,
+    0.623864f, 0.077523f, -0.777678f,
+    0.126613f, -0.365148f, -0.922299f,
+    0.133337f, -0.225640f, -0.965043f,
+    0.258771f, -0.303162f, -0.917131f,
+    0.126613f, 0.365148f, -0.922299f,
+    0.258771f, 0.303162f, -0.917131f,
+    0.133337f, 0.225640f, -0.965043f,
+    -0.126613f, -0.365148f, -0.922299f,
+    -0.258771f, -0.303162f, -0.917131f,
+    -0.133337f, -0.225640f, -0.965043f,
+    -0.717435f, 0.000000f, -0.696625f,
+    -0.623864f, 0.077523f, -0.777678f,
+    -0.623864f, -0.077523f, -0.777678f,
+    -0.126613f, 0.365148f, -0.922299f,
+    -0.133337f, 0.225640f, -0.965043f,
+    -0.258771f, 0.303162f, -0.917131f,
+    -0.795686f, 0.204864f, -0.570012f,
+    -0.783794f, 0.341179f, -0.518907f,
+    -0.706271f, 0.293267f, -0.644341f,
+    -0.570012f, 0.795686f, -0.204864f,
+    -0.518907f, 0.783794f, -0.341179f,
+    -0.644341f, 0.706271f, -0.293267f,
+    -0.204864f, 0.570012f, -0.795686f,
+    -0.341179f, 0.518907f, -0.783794f,
+    -0.293267f, 0.644341f, -0.706271f,
+    -0.922299f, 0.126613f, -0.365148f,
+    -0.965043f, 0.133337f, -0.225640f,
+    -0.917131f, 0.258771f, -0.303162f,
+    -0.922299f, 0.126613f, 0.365148f,
+    -0.917131f, 0.258771f, 0.303162f,
+    -0.965043f, 0.133337f, 0.225640f,
+    -0.696625f, 0.717435f, 0.000000f,
+    -0.777678f, 0.623864f, -0.077523f,
+    -0.777678f, 0.623864f, 0.077523f,
+    -0.922299f, -0.126613f, -0.365148f,
+    -0.917131f, -0.258771f, -0.303162f,
+    -0.965043f, -0.133337f, -0.225640f,
+    -0.696625f, -0.717435f, 0.000000f,
+    -0.777678f, -0.623864f, 0.077523f,
+    -0.777678f, -0.623864f, -0.077523f,
+    -0.922299f, -0.126613f, 0.365148f,
+    -0.965043f, -0.133337f, 0.225640f,
+    -0.917131f, -0.258771f, 0.303162f,
+    -0.570012f, -0.795686f, 0.204864f,
+    -0.518907f, -0.783794f, 0.341179f,
+    -0.644341f, -0.706271f, 0.293267f,
+    -0.204864f, -0.570012f, 0.795686f,
+    -0.341179f, -0.518907f, 0.783794f,
+    -0.293267f, -0.644341f, 0.706271f,
+    -0.795686f, -0.204864f, 0.570012f,
+    -0.783794f, -0.341179f, 0.518907f,
+    -0.706271f, -0.293267f, 0.644341f,
+    -0.126613f, -0.365148f, 0.922299f,
+    -0.133337f, -0.225640f, 0.965043f,
+    -0.258771f, -0.303162f, 0.917131f,
+    -0.126613f, 0.365148f, 0.922299f,
+    -0.258771f, 0.303162f, 0.917131f,
+    -0.133337f, 0.225640f, 0.965043f,
+    -0.717435f, 0.000000f, 0.696625f,
+    -0.623864f, -0.077523f, 0.777678f,
+    -0.623864f, 0.077523f, 0.777678f,
+    -0.795686f, 0.204864f, 0.570012f,
+    -0.706271f, 0.293267f, 0.644341f,
+    -0.783794f, 0.341179f, 0.518907f,
+    -0.204864f, 0.570012f, 0.795686f,
+    -0.293267f, 0.644341f, 0.706271f,
+    -0.341179f, 0.518907f, 0.783794f,
+    -0.570012f, 0.795686f, 0.204864f,
+    -0.644341f, 0.706271f, 0.293267f,
+    -0.518907f, 0.783794f, 0.341179f,
+    0.365148f, -0.922299f, 0.126613f,
+    0.303162f, -0.917131f, 0.258771f,
+    0.225640f, -0.965043f, 0.133337f,
+    0.000000f, -0.696625f, 0.717435f,
+    -0.077523f, -0.777678f, 0.623864f,
+    0.077523f, -0.777678f, 0.623864f,
+    -0.365148f, -0.922299f, 0.126613f,
+    -0.225640f, -0.965043f, 0.133337f,
+    -0.303162f, -0.917131f, 0.258771f,
+    0.365148f, -0.922299f, -0.126613f,
+    0.225640f, -0.965043f, -0.133337f,
+    0.303162f, -0.917131f, -0.258771f,
+    -0.365148f, -0.922299f, -0.126613f,
+    -0.303162f, -0.917131f, -0.258771f,
+    -0.225640f, -0.965043f, -0.133337f,
+    0.000000f, -0.696625f, -0.717435f,
+    0.077523f, -0.777678f, -0.623864f,
+    -0.077523f, -0.777678f, -0.623864f,
+    0.570012f, -0.795686f, -0.204864f,
+    0.518907f, -0.783794f, -0.341179f,
+    0.644341f, -0.706271f, -0.293267f,
+    0.204864f, -0.570012f, -0.795686f,
+    0.341179f, -0.518907f, -0.783794f,
+    0.293267f, -0.644341f, -0.706271f,
+    0.795686f, -0.204864f, -0.570012f,
+    0.783794f, -0.341179f, -0.518907f,
+    0.706271f, -0.293267f, -0.644341f,
+    -0.795686f, -0.204864f, -0.570012f,
+    -0.706271f, -0.293267f, -0.644341f,
+    -0.783794f, -0.341179f, -0.518907f,
+    -0.204864f, -0.570012f, -0.795686f,
+    -0.293267f, -0.644341f, -0.706271f,
+    -0.341179f, -0.518907f, -0.783794f,
+    -0.570012f, -0.795686f, -0.204864f,
+    -0.644341f, -0.706271f, -0.293267f,
+    -0.518907f, -0.783794f, -0.341179f,
+    0.513044f, 0.156641f, 0.843948f,
+    0.390160f, 0.232588f, 0.890886f,
+    0.136709f, 0.075947f, 0.987696f,
+    0.136709f, -0.075947f, 0.987696f,
+    0.390160f, -0.232588f, 0.890886f,
+    0.513044f, -0.156641f, 0.843948f,
+    0.707239f, -0.597535f, 0.377841f,
+    0.754177f, -0.474651f, 0.453788f,
+    0.597535f, -0.377841f, 0.707239f,
+    0.474651f, -0.453788f, 0.754177f,
+    0.377841f, -0.707239f, 0.597535f,
+    0.453788f, -0.754177f, 0.474651f,
+    0.987696f, -0.136709f, -0.075947f,
+    0.987696f, -0.136709f, 0.075947f,
+    0.890886f, -0.390160f, 0.232588f,
+    0.843948f, -0.513044f, 0.156641f,
+    0.843948f, -0.513044f, -0.156641f,
+    0.890886f, -0.390160f, -0.232588f,
+    0.890886f, 0.390160f, -0.232588f,
+    0.843948f, 0.513044f, -0.156641f,
+    0.843948f, 0.513044f, 0.156641f,
+    0.890886f, 0.390160f, 0.232588f,
+    0.987696f, 0.136709f, 0.075947f,
+    0.987696f, 0.136709f, -0.075947f,
+    0.453788f, 0.754177f, 0.474651f,
+    0.377842f, 0.707239f, 0.597535f,
+    0.474651f, 0.453788f, 0.754177f,
+    0.597535f, 0.377841f, 0.707239f,
+    0.754177f, 0.474651f, 0.453788f,
+    0.707239f, 0.597535f, 0.377841f,
+    -0.232588f, 0.890886f, 0.390160f,
+    -0.156641f, 0.843948f, 0.513044f,
+    0.156641f, 0.843948f, 0.513044f,
+    0.232588f, 0.890886f, 0.390160f,
+    0.075947f, 0.987696f, 0.136709f,
+    -0.075947f, 0.987696f, 0.136709f,
+    -0.156641f, 0.843948f, -0.513044f,
+    -0.232588f, 0.890886f, -0.390160f,
+    -0.075947f, 0.987696f, -0.136709f,
+    0.075947f, 0.987696f, -0.136709f,
+    0.232588f, 0.890886f, -0.390160f,
+    0.156641f, 0.843948f, -0.513044f,
+    0.377841f, 0.707239f, -0.597535f,
+    0.453788f, 0.754177f, -0.474651f,
+    0.707239f, 0.597535f, -0.377841f,
+    0.754177f, 0.474651f, -0.453788f,
+    0.597535f, 0.377841f, -0.707239f,
+    0.474651f, 0.453788f, -0.754177f,
+    0.136709f, -0.075947f, -0.987696f,
+    0.136709f, 0.075947f, -0.987696f,
+    0.390160f, 0.232588f, -0.890886f,
+    0.513044f, 0.156641f, -0.843948f,
+    0.513044f, -0.156641f, -0.843948f,
+    0.390160f, -0.232588f, -0.890886f,
+    -0.513044f, 0.156641f, -0.843948f,
+    -0.390160f, 0.232588f, -0.890886f,
+    -0.136709f, 0.075947f, -0.987696f,
+    -0.136709f, -0.075947f, -0.987696f,
+    -0.390160f, -0.232588f, -0.890886f,
+    -0.513044f, -0.156641f, -0.843948f,
+    -0.453788f, 0.754177f, -0.474651f,
+    -0.377841f, 0.707239f, -0.597535f,
+    -0.474651f, 0.453788f, -0.754177f,
+    -0.597535f, 0.377841f, -0.707239f,
+    -0.754177f, 0.474651f, -0.453788f,
+    -0.707239f, 0.597535f, -0.377842f,
+    -0.890886f, 0.390160f, 0.232588f,
+    -0.843948f, 0.513044f, 0.156641f,
+    -0.843948f, 0.513044f, -0.156641f,
+    -0.890886f, 0.390160f, -0.232588f,
+    -0.987696f, 0.136709f, -0.075947f,
+    -0.987696f, 0.136709f, 0.075947f,
+    -0.843948f, -0.513044f, 0.156641f,
+    -0.890886f, -0.390160f, 0.232588f,
+    -0.987696f, -0.136709f, 0.075947f,
+    -0.987696f, -0.136709f, -0.075947f,
+    -0.890886f, -0.390160f, -0.232588f,
+    -0.843948f, -0.513044f, -0.156641f,
+    -0.474651f, -0.453788f, 0.754177f,
+    -0.597535f, -0.377842f, 0.707239f,
+    -0.754177f, -0.474651f, 0.453788f,
+    -0.707239f, -0.597535f, 0.377841f,
+    -0.453788f, -0.754177f, 0.474651f,
+    -0.377841f, -0.707239f, 0.597535f,
+    -0.390160f, 0.232588f, 0.890886f,
+    -0.513044f, 0.156641f, 0.843948f,
+    -0.513044f, -0.156641f, 0.843948f,
+    -0.390160f, -0.232588f, 0.890886f,
+    -0.136709f, -0.075947f, 0.987696f,
+    -0.136709f, 0.075947f, 0.987696f,
+    -0.377841f, 0.707239f, 0.597535f,
+    -0.453788f, 0.754177f, 0.474651f,
+    -0.707239f, 0.597535f, 0.377841f,
+    -0.754177f, 0.474651f, 0.453788f,
+    -0.597535f, 0.377841f, 0.707239f,
+    -0.474651f, 0.453788f, 0.754177f,
+    -0.156641f, -0.843948f, 0.513044f,
+    -0.232588f, -0.890886f, 0.390160f,
+    -0.075947f, -0.987696f, 0.136709f,
+    0.075947f, -0.987696f, 0.136709f,
+    0.232588f, -0.890886f, 0.390160f,
+    0.156641f, -0.843948f, 0.513044f,
+    -0.232588f, -0.890886f, -0.390160f,
+    -0.156641f, -0.843948f, -0.513044f,
+    0.156641f, -0.843948f, -0.513044f,
+    0.232588f, -0.890886f, -0.390160f,
+    0.075947f, -0.987696f, -0.136709f,
+    -0.075947f, -0.987696f, -0.136709f,
+    0.474651f, -0.453788f, -0.754177f,
+    0.597535f, -0.377841f, -0.707239f,
+    0.754177f, -0.474651f, -0.453788f,
+    0.707239f, -0.597535f, -0.377841f,
+    0.453788f, -0.754177f, -0.474651f,
+    0.377841f, -0.707239f, -0.597535f,
+    -0.377841f, -0.707239f, -0.597535f,
+    -0.453788f, -0.754177f, -0.474651f,
+    -0.707239f, -0.597535f, -0.377841f,
+    -0.754177f, -0.474651f, -0.453788f,
+    -0.597535f, -0.377841f, -0.707239f,
+    -0.474651f, -0.453788f, -0.754177f,
+    0.000000f, -0.422350f, 0.906433f,
+    0.111528f, -0.491278f, 0.863833f,
+    0.372963f, -0.380535f, 0.846222f,
+    0.000000f, -0.150031f, 0.988681f,
+    0.794905f, -0.068928f, 0.602806f,
+    0.794905f, 0.068928f, 0.602806f,
+    0.615718f, 0.230504f, 0.753498f,
+    0.615718f, -0.230504f, 0.753498f,
+    0.111528f, 0.491278f, 0.863833f,
+    0.000000f, 0.422350f, 0.906433f,
+    0.000000f, 0.150031f, 0.988681f,
+    0.372963f, 0.380535f, 0.846222f,
+    0.068928f, -0.602806f, 0.794905f,
+    0.230504f, -0.753498f, 0.615718f,
+    0.491278f, -0.863833f, 0.111528f,
+    0.602806f, -0.794905f, 0.068928f,
+    0.753498f, -0.615718f, 0.230504f,
+    0.380535f, -0.846222f, 0.372963f,
+    0.863833f, -0.111528f, 0.491278f,
+    0.846222f, -0.372963f, 0.380535f,
+    0.602806f, -0.794905f, -0.068928f,
+    0.753498f, -0.615718f, -0.230504f,
+    0.863833f, -0.111528f, -0.491278f,
+    0.906433f, 0.000000f, -0.422350f,
+    0.988681f, 0.000000f, -0.150031f,
+    0.846222f, -0.372963f, -0.380535f,
+    0.906433f, 0.000000f, 0.422350f,
+    0.988681f, 0.000000f, 0.150031f,
+    0.863833f, 0.111528f, 0.491278f,
+    0.846222f, 0.372963f, 0.380535f,
+    0.863833f, 0.111528f, -0.491278f,
+    0.846222f, 0.372963f, -0.380535f,
+    0.602806f, 0.794905f, -0.068928f,
+    0.602806f, 0.794905f, 0.068928f,
+    0.753498f, 0.615718f, 0.230504f,
+    0.753498f, 0.615718f, -0.230504f,
+    0.491278f, 0.863833f, 0.111528f,
+    0.380535f, 0.846222f, 0.372963f,
+    0.068928f, 0.602806f, 0.794905f,
+    0.230504f, 0.753498f, 0.615718f,
+    0.422350f, 0.906433f, 0.000000f,
+    0.150031f, 0.988681f, 0.000000f,
+    -0.422350f, 0.906433f, 0.000000f,
+    -0.491278f, 0.863833f, 0.111528f,
+    -0.380535f, 0.846222f, 0.372963f,
+    -0.150031f, 0.988681f, 0.000000f,
+    -0.068928f, 0.602806f, 0.794905f,
+    -0.230504f, 0.753498f, 0.615718f,
+    0.491278f, 0.863833f, -0.111528f,
+    0.380535f, 0.846222f, -0.372963f,
+    0.068928f, 0.602806f, -0.794905f,
+    -0.068928f, 0.602806f, -0.794905f,
+    -0.230504f, 0.753498f, -0.615718f,
+    0.230504f, 0.753498f, -0.615718f,
+    -0.491278f, 0.863833f, -0.111528f,
+    -0.380535f, 0.846222f, -0.372963f,
+    0.794905f, 0.068928f, -0.602806f,
+    0.615718f, 0.230504f, -0.753498f,
+    0.111528f, 0.491278f, -0.863833f,
+    0.372963f, 0.380535f, -0.846222f,
+    0.794905f, -0.068928f, -0.602806f,
+    0.615718f, -0.230504f, -0.753498f,
+    0.111528f, -0.491278f, -0.863833f,
+    0.000000f, -0.422350f, -0.906433f,
+    0.000000f, -0.150031f, -0.988681f,
+    0.372963f, -0.380535f, -0.846222f,
+    0.000000f, 0.422350f, -0.906433f,
+    0.000000f, 0.150031f, -0.988681f,
+    -0.111528f, -0.491278f, -0.863833f,
+    -0.372963f, -0.380535f, -0.846222f,
+    -0.794905f, -0.068928f, -0.602806f,
+    -0.794905f, 0.068928f, -0.602806f,
+    -0.615718f, 0.230504f, -0.753498f,
+    -0.615718f, -0.230504f, -0.753498f,
+    -0.111528f, 0.491278f, -0.863833f,
+    -0.372963f, 0.380535f, -0.846222f,
+    -0.863833f, 0.111528f, -0.491278f,
+    -0.846222f, 0.372963f, -0.380535f,
+    -0.602806f, 0.794905f, -0.068928f,
+    -0.753498f, 0.615718f, -0.230504f,
+    -0.906433f, 0.000000f, -0.422350f,
+    -0.988681f, 0.000000f, -0.150031f,
+    -0.906433f, 0.000000f, 0.422350f,
+    -0.863833f, 0.111528f, 0.491278f,
+    -0.846222f, 0.372963f, 0.380535f,
+    -0.988681f, 0.000000f, 0.150031f,
+    -0.602806f, 0.794905f, 0.068928f,
+    -0.753498f, 0.615718f, 0.230504f,
+    -0.863833f, -0.111528f, -0.491278f,
+    -0.846222f, -0.372963f, -0.380535f,
+    -0.602806f, -0.794905f, -0.068928f,
+    -0.602806f, -0.794905f, 0.068928f,
+    -0.753498f, -0.615718f, 0.230504f,
+    -0.753498f, -0.615718f, -0.230504f,
+    -0.863833f, -0.111528f, 0.491278f,
+    -0.846222f, -0.372963f, 0.380535f,
+    -0.491278f, -0.863833f, 0.111528f,
+    -0.380535f, -0.846222f, 0.372963f,
+    -0.068928f, -0.602806f, 0.794905f,
+    -0.111528f, -0.491278f, 0.863833f,
+    -0.372963f, -0.380535f, 0.846222f,
+    -0.230504f, -0.753498f, 0.615718f,
+    -0.794905f, -0.068928f, 0.602806f,
+    -0.615718f, -0.230504f, 0.753498f,
+    -0.111528f, 0.491278f, 0.863833f,
+    -0.372963f, 0.380535f, 0.846222f,
+    -0.794905f, 0.068928f, 0.602806f,
+    -0.615718f, 0.230504f, 0.753498f,
+    0.422350f, -0.906433f, 0.000000f,
+    0.150031f, -0.988681f, 0.000000f,
+    -0.422350f, -0.906433f, 0.000000f,
+    -0.150031f, -0.988681f, 0.000000f,
+    0.491278f, -0.863833f, -0.111528f,
+    0.380535f, -0.846222f, -0.372963f,
+    -0.491278f, -0.863833f, -0.111528f,
+    -0.380535f, -0.846222f, -0.372963f,
+    -0.068928f, -0.602806f, -0.794905f,
+    0.068928f, -0.602806f, -0.794905f,
+    0.230504f, -0.753498f, -0.615718f,
+    -0.230504f, -0.753498f, -0.615718f
+};
+
+//=================================================================================================================================
+/// \brief The icosahedron the geodesic sampling subdivides
+//=================================================================================================================================
+class Icosahedron
+{
+public:
+    Icosahedron()
+    {
+        // the vertices are (0, +-1, +-phi) and its cyclic permutations, in the order of pDefaultViewpoint
+        const double fPhi = (1.0 + sqrt(5.0)) / 2.0;
+        const double pfCorners[12][3] =
+        {
+            { 0, -1, fPhi }, { 0, 1, fPhi }, { 0, -1, -fPhi }, { 0, 1, -fPhi },
+            { fPhi, 0, 1 }, { fPhi, 0, -1 }, { -fPhi, 0, 1 }, { -fPhi, 0, -1 },
+            { 1, fPhi, 0 }, { 1, -fPhi, 0 }, { -1, fPhi, 0 }, { -1, -fPhi, 0 }
+        };
+
+        const double fLength = sqrt(1.0 + fPhi * fPhi);
+
+        for (unsigned int i = 0; i < 12; i++)
+        {
+            for (unsigned int c = 0; c < 3; c++)
+            {
+                m_pfVertices[i][c] = pfCorners[i][c] / fLength;
+            }
+        }
+
+        // neighboring vertices are 63 degrees apart, all others at least 116 degrees
+        unsigned int nEdges = 0;
+        unsigned int nFaces = 0;
+
+        for (unsigned int i = 0; i < 12; i++)
+        {
+            for (unsigned int j = i + 1; j < 12; j++)
+            {
+                if (!Adjacent(i, j))
+                {
+                    continue;
+                }
+
+                m_pnEdges[nEdges][0] = i;
+                m_pnEdges[nEdges][1] = j;
+                nEdges++;
+
+                for (unsigned int k = j + 1; k < 12; k++)
+                {
+                    if (Adjacent(i, k) && Adjacent(j, k))
+                    {
+                        m_pnFaces[nFaces][0] = i;
+                        m_pnFaces[nFaces][1] = j;
+                        m_pnFaces[nFaces][2] = k;
+                        nFaces++;
+                    }
+                }
+            }
+        }
+
+        assert(nEdges == 30 && nFaces == 20);
+    }
+
+    double       m_pfVertices[12][3];
+    unsigned int m_pnEdges[30][2];
+    unsigned int m_pnFaces[20][3];
+
+private:
+    bool Adjacent(unsigned int i, unsigned int j) const
+    {
+        return m_pfVertices[i][0] * m_pfVertices[j][0] + m_pfVertices[i][1] * m_pfVertices[j][1] +
+               m_pfVertices[i][2] * m_pfVertices[j][2] > 0;
+    }
+};
+
+//=================================================================================================================================
+/// Projects a weighted sum of icosahedron vertices onto the unit sphere and writes it if it lies in the cone.
+///
+/// \param rIcosahedron    The icosahedron
+/// \param pnCorners       The three vertices
+/// \param pnWeights       The weights of the vertices
+/// \param pfAxis          The axis of the cone
+/// \param fCosAngle       The cosine of the half angle of the cone
+/// \param pfViewpointsOut The array receiving the viewpoint, or NULL
+/// \param rnViewpoints    The number of viewpoints written so far.  Incremented if the viewpoint is in the cone.
+//=================================================================================================================================
+static void EmitGeodesicViewpoint(const Icosahedron&  rIcosahedron,
+                                  const unsigned int* pnCorners,
+                                  const unsigned int* pnWeights,
+                                  const float*        pfAxis,
+                                  float               fCosAngle,
+                                  float*              pfViewpointsOut,
+                                  unsigned int&       rnViewpoints)
+{
+    double pfPoint[3] = { 0, 0, 0 };
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            pfPoint[c] += pnWeights[i] * rIcosahedron.m_pfVertices[pnCorners[i]][c];
+        }
+    }
+
+    const double fLength = sqrt(pfPoint[0] * pfPoint[0] + pfPoint[1] * pfPoint[1] + pfPoint[2] * pfPoint[2]);
+    const double fDot    = (pfPoint[0] * pfAxis[0] + pfPoint[1] * pfAxis[1] + pfPoint[2] * pfAxis[2]) / fLength;
+
+    if (fDot < fCosAngle - VIEWPOINT_CONE_EPSILON)
+    {
+        return;
+    }
+
+    if (pfViewpointsOut)
+    {
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            pfViewpointsOut[3 * rnViewpoints + c] = (float)(pfPoint[c] / fLength);
+        }
+    }
+
+    rnViewpoints++;
+}
+
+unsigned int GeodesicFrequency(unsigned int nSphereViewpoints)
+{
+    unsigned int nFrequency = 1;
+
+    while (10.0 * nFrequency * nFrequency + 2 < nSphereViewpoints)
+    {
+        nFrequency++;
+    }
+
+    return nFrequency;
+}
+
+unsigned int GenerateGeodesicViewpoints(unsigned int nFrequency,
+                                        const float* pfAxis,
+                                        float        fCosAngle,
+                                        float*       pfViewpointsOut)
+{
+    assert(nFrequency > 0);
+
+    const Icosahedron icosahedron;
+    unsigned int      nViewpoints = 0;
+
+    for (unsigned int i = 0; i < 12; i++)
+    {
+        const unsigned int pnCorners[3] = { i, i, i };
+        const unsigned int pnWeights[3] = { 1, 0, 0 };
+
+        EmitGeodesicViewpoint(icosahedron, pnCorners, pnWeights, pfAxis, fCosAngle, pfViewpointsOut, nViewpoints);
+    }
+
+    for (unsigned int e = 0; e < 30; e++)
+    {
+        const unsigned int pnCorners[3] = { icosahedron.m_pnEdges[e][0], icosahedron.m_pnEdges[e][1], 0 };
+
+        for (unsigned int t = 1; t < nFrequency; t++)
+        {
+            const unsigned int pnWeights[3] = { nFrequency - t, t, 0 };
+
+            EmitGeodesicViewpoint(icosahedron, pnCorners, pnWeights, pfAxis, fCosAngle, pfViewpointsOut, nViewpoints);
+        }
+    }
+
+    for (unsigned int f = 0; f < 20; f++)
+    {
+        for (unsigned int i = 1; i + 1 < nFrequency; i++)
+        {
+            for (unsigned int j = 1; i + j < nFrequency; j++)
+            {
+                const unsigned int pnWeights[3] = { i, j, nFrequency - i - j };
+
+                EmitGeodesicViewpoint(icosahedron, icosahedron.m_pnFaces[f], pnWeights, pfAxis, fCosAngle, pfViewpointsOut,
+                                      nViewpoints);
+            }
+        }
+    }
+
+    return nViewpoints;
+}
+
+unsigned int FibonacciViewpointCount(unsigned int nSphereViewpoints, float fCosAngle)
+{
+    const double fCount = nSphereViewpoints * (1.0 - fCosAngle) / 2.0;
+
+    return (fCount < 1.5) ? 1 : (unsigned int)(fCount + 0.5);
+}
+
+void GenerateFibonacciViewpoints(unsigned int nViewpoints,
+                                 const float* pfAxis,
+                                 float        fCosAngle,
+                                 float*       pfViewpointsOut)
+{
+    // an orthonormal frame around the axis
+    const double a[3] = { pfAxis[0], pfAxis[1], pfAxis[2] };
+    double       u[3];
+
+    if (fabs(a[0]) > fabs(a[2]))
+    {
+        const double fLength = sqrt(a[0] * a[0] + a[1] * a[1]);
+        u[0] = -a[1] / fLength;
+        u[1] = a[0] / fLength;
+        u[2] = 0;
+    }
+    else
+    {
+        const double fLength = sqrt(a[1] * a[1] + a[2] * a[2]);
+        u[0] = 0;
+        u[1] = -a[2] / fLength;
+        u[2] = a[1] / fLength;
+    }
+
+    const double w[3] = { a[1] * u[2] - a[2] * u[1], a[2] * u[0] - a[0] * u[2], a[0] * u[1] - a[1] * u[0] };
+
+    // each viewpoint sits at the middle of its own band of equal area, turned by the golden angle from the previous one
+    const double fGoldenAngle = SCALAR_PI * (3.0 - sqrt(5.0));
+    const double fCapHeight   = 1.0 - fCosAngle;
+
+    for (unsigned int i = 0; i < nViewpoints; i++)
+    {
+        const double z   = 1.0 - fCapHeight * (i + 0.5) / nViewpoints;
+        const double r   = sqrt(std::max(0.0, 1.0 - z * z));
+        const double fX  = r * cos(fGoldenAngle * i);
+        const double fY  = r * sin(fGoldenAngle * i);
+
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            pfViewpointsOut[3 * i + c] = (float)(fX * u[c] + fY * w[c] + z * a[c]);
+        }
+    }
+}
@@ -0,0 +1,556 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+/**
+The vertex welding behind TootleWeldMesh and TootleUnweldIndexBuffer.
+
+Meshes split a vertex wherever one of its attributes is discontinuous, at texture seams and hard edges.  The split vertices
+share a position but not an ID, so the stages that follow the connectivity of the mesh (the clustering, the vertex fans of
+Tipsify) see a boundary at every seam.  Welding replaces each vertex by the lowest numbered vertex at its position, which
+restores the connectivity.  The optimized welded faces are mapped back to the original vertices afterwards.
+
+The positions are bucketed into a grid of cells of size fEpsilon, so that positions at most fEpsilon apart lie in the same or
+in adjacent cells.  With an fEpsilon of 0, the cell of a vertex is its position itself.  The vertices are sorted by the hash of
+their cell, which gives a run of vertices per hash, and the runs are found through an open addressing table.  The vertices are
+then processed in parallel: each one looks for the lower numbered vertices close to it in its own and the adjacent cells and
+joins them in a union-find forest.  The forest is updated with compare-and-swap, and a root is always linked below the lower
+of the two roots, so the root of every set is its lowest vertex whatever order the threads run in.
+*/
+
+#include "TootlePCH.h"
+#include "tootlelib.h"
+#include "weld.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <system_error>
+#include <thread>
+
+/// The number of vertices a thread takes at a time
+#define WELD_BATCH_SIZE  4096
+
+/// Cell coordinates are clamped to this range, so that they fit a 64 bit integer
+#define WELD_MAX_CELL    4.0e18
+
+/// A run of vertices with the same cell hash in WeldGrid::sorted
+struct WeldRun
+{
+    uint64_t     nHash;
+    unsigned int nStart;     ///< UINT_MAX for an empty table entry
+    unsigned int nEnd;
+};
+
+/// The state shared by the threads of WeldVertices
+struct WeldGrid
+{
+    const char*                             pVB;
+    unsigned int                            nVBStride;
+    float                                   fEpsilon;
+    std::vector<int64_t>                    cells;      ///< the cell of each vertex, 3 coordinates per vertex
+    std::vector< std::pair<uint64_t, unsigned int> > sorted; ///< (cell hash, vertex), sorted
+    std::vector<WeldRun>                    runs;       ///< open addressing table of the runs of sorted, by hash
+    std::vector< std::atomic<unsigned int> > parents;   ///< the union-find forest
+};
+
+//=================================================================================================================================
+//
+//          Internal functions
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Mixes the bits of a 64 bit value (the MurmurHash3 finalizer).
+//=================================================================================================================================
+static inline uint64_t MixBits(uint64_t n)
+{
+    n ^= n >> 33;
+    n *= 0xff51afd7ed558ccdull;
+    n ^= n >> 33;
+    n *= 0xc4ceb9fe1a85ec53ull;
+    n ^= n >> 33;
+    return n;
+}
+
+//=================================================================================================================================
+/// Hashes three 64 bit values: the coordinates of a cell or the vertices of a face.
+//=================================================================================================================================
+static inline uint64_t HashTriple(uint64_t a, uint64_t b, uint64_t c)
+{
+    return MixBits(a * 0x9e3779b97f4a7c15ull ^ b * 0xc2b2ae3d27d4eb4full ^ c * 0x165667b19e3779f9ull);
+}
+
+//=================================================================================================================================
+/// Returns the size of an open addressing table for nEntries entries: a power of two, at least twice nEntries.
+//=================================================================================================================================
+static size_t GetTableSize(size_t nEntries)
+{
+    size_t nSize = 16;
+
+    while (nSize < nEntries * 2)
+    {
+        nSize *= 2;
+    }
+
+    return nSize;
+}
+
+//=================================================================================================================================
+/// Runs pFunction on the range [0, nItems) on nThreads threads, the calling thread included, in batches of WELD_BATCH_SIZE.
+//=================================================================================================================================
+static void ParallelFor(void (*pFunction)(WeldGrid&, unsigned int, unsigned int), WeldGrid& rGrid, unsigned int nItems,
+                        unsigned int nThreads)
+{
+    struct Worker
+    {
+        static void Run(void (*pFunction)(WeldGrid&, unsigned int, unsigned int), WeldGrid* pGrid, unsigned int nItems,
+                        std::atomic<unsigned int>* pnNext)
+        {
+            for (;;)
+            {
+                unsigned int nBegin = pnNext->fetch_add(WELD_BATCH_SIZE);
+
+                if (nBegin >= nItems)
+                {
+                    break;
+                }
+
+                pFunction(*pGrid, nBegin, std::min(nItems, nBegin + WELD_BATCH_SIZE));
+            }
+        }
+    };
+
+    std::atomic<unsigned int> nNext(0);
+    std::vector<std::thread> workers;
+
+    nThreads = std::min(nThreads, (nItems + WELD_BATCH_SIZE - 1) / WELD_BATCH_SIZE);
+
+    for (unsigned int i = 1; i < nThreads; i++)
+    {
+        try
+        {
+            workers.push_back(std::thread(Worker::Run, pFunction, &rGrid, nItems, &nNext));
+        }
+        catch (const std::system_error&)
+        {
+            // carry on with the threads we have
+            break;
+        }
+    }
+
+    // the calling thread works too
+    Worker::Run(pFunction, &rGrid, nItems, &nNext);
+
+    for (unsigned int i = 0; i < workers.size(); i++)
+    {
+        workers[ i ].join();
+    }
+}
+
+//=================================================================================================================================
+/// Finds the root of a vertex in the union-find forest, halving the path on the way.  Parents are always lower than their
+/// children, so a parent can only be replaced by an ancestor and a failed compare-and-swap is harmless.
+//=================================================================================================================================
+static inline unsigned int FindRoot(std::atomic<unsigned int>* pParents, unsigned int n)
+{
+    for (;;)
+    {
+        unsigned int nParent = pParents[ n ].load();
+
+        if (nParent == n)
+        {
+            return n;
+        }
+
+        unsigned int nGrandParent = pParents[ nParent ].load();
+
+        if (nGrandParent != nParent)
+        {
+            pParents[ n ].compare_exchange_weak(nParent, nGrandParent);
+        }
+
+        n = nGrandParent;
+    }
+}
+
+//=================================================================================================================================
+/// Joins the sets of two vertices.  The higher root is linked below the lower one.
+//=================================================================================================================================
+static inline void JoinVertices(std::atomic<unsigned int>* pParents, unsigned int a, unsigned int b)
+{
+    for (;;)
+    {
+        a = FindRoot(pParents, a);
+        b = FindRoot(pParents, b);
+
+        if (a == b)
+        {
+            return;
+        }
+
+        if (a < b)
+        {
+            std::swap(a, b);
+        }
+
+        // another thread may have linked a in the meantime, in which case we start over from the new roots
+        unsigned int nExpected = a;
+
+        if (pParents[ a ].compare_exchange_strong(nExpected, b))
+        {
+            return;
+        }
+    }
+}
+
+//=================================================================================================================================
+/// Returns the position of a vertex in the vertex buffer.
+//=================================================================================================================================
+static inline const float* GetPosition(const WeldGrid& rGrid, unsigned int nVertex)
+{
+    return (const float*)(rGrid.pVB + (size_t) nVertex * rGrid.nVBStride);
+}
+
+//=================================================================================================================================
+/// Finds the run of the vertices whose cell has the given hash.
+/// \return The run, or NULL if no vertex has this hash.
+//=================================================================================================================================
+static inline const WeldRun* FindRun(const WeldGrid& rGrid, uint64_t nHash)
+{
+    size_t nMask = rGrid.runs.size() - 1;
+
+    for (size_t nSlot = (size_t) nHash & nMask; rGrid.runs[ nSlot ].nStart != UINT_MAX; nSlot = (nSlot + 1) & nMask)
+    {
+        if (rGrid.runs[ nSlot ].nHash == nHash)
+        {
+            return &rGrid.runs[ nSlot ];
+        }
+    }
+
+    return NULL;
+}
+
+//=================================================================================================================================
+/// Computes the cell and its hash for vertices [nBegin, nEnd), and makes each vertex a set of its own.
+//=================================================================================================================================
+static void ComputeCells(WeldGrid& rGrid, unsigned int nBegin, unsigned int nEnd)
+{
+    double fInvEpsilon = (rGrid.fEpsilon > 0) ? 1.0 / rGrid.fEpsilon : 0.0;
+
+    for (unsigned int v = nBegin; v < nEnd; v++)
+    {
+        const float* pfPosition = GetPosition(rGrid, v);
+        int64_t* pnCell = &rGrid.cells[ 3 * v ];
+
+        for (int k = 0; k < 3; k++)
+        {
+            if (rGrid.fEpsilon > 0)
+            {
+                double fCell = floor(pfPosition[ k ] * fInvEpsilon);
+
+                // a NaN is never close to anything, so any cell will do
+                fCell = (fCell == fCell) ? std::min(std::max(fCell, -WELD_MAX_CELL), WELD_MAX_CELL) : 0.0;
+                pnCell[ k ] = (int64_t) fCell;
+            }
+            else
+            {
+                // the cell is the position itself, with -0 and 0 in the same cell
+                float fValue = (pfPosition[ k ] == 0.0f) ? 0.0f : pfPosition[ k ];
+                uint32_t nBits;
+                memcpy(&nBits, &fValue, sizeof(nBits));
+                pnCell[ k ] = nBits;
+            }
+        }
+
+        rGrid.sorted[ v ] = std::make_pair(HashTriple(pnCell[ 0 ], pnCell[ 1 ], pnCell[ 2 ]), v);
+        rGrid.parents[ v ].store(v);
+    }
+}
+
+//=================================================================================================================================
+/// Joins each vertex of [nBegin, nEnd) with the lower numbered vertices close to it.
+//=================================================================================================================================
+static void JoinCloseVertices(WeldGrid& rGrid, unsigned int nBegin, unsigned int nEnd)
+{
+    double fEpsilon2 = (double) rGrid.fEpsilon * rGrid.fEpsilon;
+    int nReach = (rGrid.fEpsilon > 0) ? 1 : 0;
+
+    for (unsigned int v = nBegin; v < nEnd; v++)
+    {
+        const int64_t* pnCell = &rGrid.cells[ 3 * v ];
+        const float* pfPosition = GetPosition(rGrid, v);
+
+        for (int dz = -nReach; dz <= nReach; dz++)
+        {
+            for (int dy = -nReach; dy <= nReach; dy++)
+            {
+                for (int dx = -nReach; dx <= nReach; dx++)
+                {
+                    const WeldRun* pRun = FindRun(rGrid, HashTriple(pnCell[ 0 ] + dx, pnCell[ 1 ] + dy, pnCell[ 2 ] + dz));
+
+                    if (pRun == NULL)
+                    {
+                        continue;
+                    }
+
+                    // the vertices of a run are sorted, so the lower numbered ones come first
+                    for (unsigned int s = pRun->nStart; s < pRun->nEnd && rGrid.sorted[ s ].second < v; s++)
+                    {
+                        unsigned int u = rGrid.sorted[ s ].second;
+
+                        if (nReach == 0)
+                        {
+                            // equal positions are transitive, joining the first one is enough
+                            if (memcmp(pnCell, &rGrid.cells[ 3 * u ], 3 * sizeof(int64_t)) == 0)
+                            {
+                                JoinVertices(&rGrid.parents[ 0 ], u, v);
+                                break;
+                            }
+
+                            continue;
+                        }
+
+                        const float* pfOther = GetPosition(rGrid, u);
+                        double fDX = (double) pfPosition[ 0 ] - pfOther[ 0 ];
+                        double fDY = (double) pfPosition[ 1 ] - pfOther[ 1 ];
+                        double fDZ = (double) pfPosition[ 2 ] - pfOther[ 2 ];
+
+                        if (fDX * fDX + fDY * fDY + fDZ * fDZ <= fEpsilon2)
+                        {
+                            JoinVertices(&rGrid.parents[ 0 ], u, v);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+//=================================================================================================================================
+/// Writes the welded vertices of a face in a canonical rotation, with the lowest vertex first.
+/// \return false if the welded face is degenerate.
+//=================================================================================================================================
+static inline bool GetWeldedFace(const unsigned int* pnFace, const unsigned int* pnWeld, unsigned int* pnFaceOut)
+{
+    unsigned int a = pnWeld[ pnFace[ 0 ] ];
+    unsigned int b = pnWeld[ pnFace[ 1 ] ];
+    unsigned int c = pnWeld[ pnFace[ 2 ] ];
+
+    if (a == b || b == c || c == a)
+    {
+        return false;
+    }
+
+    if (b < a && b < c)
+    {
+        pnFaceOut[ 0 ] = b;
+        pnFaceOut[ 1 ] = c;
+        pnFaceOut[ 2 ] = a;
+    }
+    else if (c < a && c < b)
+    {
+        pnFaceOut[ 0 ] = c;
+        pnFaceOut[ 1 ] = a;
+        pnFaceOut[ 2 ] = b;
+    }
+    else
+    {
+        pnFaceOut[ 0 ] = a;
+        pnFaceOut[ 1 ] = b;
+        pnFaceOut[ 2 ] = c;
+    }
+
+    return true;
+}
+
+//=================================================================================================================================
+/// Looks up a canonical welded face in a table of faces of pnIB.
+/// \return The table slot holding the face, or the empty slot where it belongs.
+//=================================================================================================================================
+static inline size_t FindFace(const std::vector<unsigned int>& rTable, const unsigned int* pnIB, const unsigned int* pnWeld,
+                              const unsigned int* pnFace)
+{
+    size_t nMask = rTable.size() - 1;
+    size_t nSlot = (size_t) HashTriple(pnFace[ 0 ], pnFace[ 1 ], pnFace[ 2 ]) & nMask;
+
+    for (; rTable[ nSlot ] != UINT_MAX; nSlot = (nSlot + 1) & nMask)
+    {
+        unsigned int pnOther[ 3 ];
+
+        // the table only holds faces that are not degenerate, but pnOther is only valid if GetWeldedFace filled it
+        if (GetWeldedFace(&pnIB[ 3 * rTable[ nSlot ] ], pnWeld, pnOther) &&
+            pnOther[ 0 ] == pnFace[ 0 ] && pnOther[ 1 ] == pnFace[ 1 ] && pnOther[ 2 ] == pnFace[ 2 ])
+        {
+            break;
+        }
+    }
+
+    return nSlot;
+}
+
+//=================================================================================================================================
+//
+//          Weld functions
+//
+//=================================================================================================================================
+
+void WeldVertices(const void*   pVB,
+                  unsigned int  nVertices,
+                  unsigned int  nVBStride,
+                  float         fEpsilon,
+                  unsigned int  nThreads,
+                  unsigned int* pnWeldOut)
+{
+    WeldGrid grid;
+    grid.pVB       = (const char*) pVB;
+    grid.nVBStride = nVBStride;
+    grid.fEpsilon  = fEpsilon;
+    grid.cells.resize(3 * (size_t) nVertices);
+    grid.sorted.resize(nVertices);
+    std::vector< std::atomic<unsigned int> >(nVertices).swap(grid.parents);
+
+    ParallelFor(ComputeCells, grid, nVertices, nThreads);
+
+    std::sort(grid.sorted.begin(), grid.sorted.end());
+
+    // index the runs of equal hashes
+    unsigned int nRuns = 0;
+
+    for (unsigned int s = 0; s < nVertices; s++)
+    {
+        if (s == 0 || grid.sorted[ s ].first != grid.sorted[ s - 1 ].first)
+        {
+            nRuns++;
+        }
+    }
+
+    WeldRun emptyRun = { 0, UINT_MAX, 0 };
+    grid.runs.resize(GetTableSize(nRuns), emptyRun);
+    size_t nMask = grid.runs.size() - 1;
+
+    for (unsigned int s = 0; s < nVertices;)
+    {
+        unsigned int nEnd = s + 1;
+
+        while (nEnd < nVertices && grid.sorted[ nEnd ].first == grid.sorted[ s ].first)
+        {
+            nEnd++;
+        }
+
+        size_t nSlot = (size_t) grid.sorted[ s ].first & nMask;
+
+        while (grid.runs[ nSlot ].nStart != UINT_MAX)
+        {
+            nSlot = (nSlot + 1) & nMask;
+        }
+
+        grid.runs[ nSlot ].nHash  = grid.sorted[ s ].first;
+        grid.runs[ nSlot ].nStart = s;
+        grid.runs[ nSlot ].nEnd   = nEnd;
+
+        s = nEnd;
+    }
+
+    ParallelFor(JoinCloseVertices, grid, nVertices, nThreads);
+
+    for (unsigned int v = 0; v < nVertices; v++)
+    {
+        pnWeldOut[ v ] = FindRoot(&grid.parents[ 0 ], v);
+    }
+}
+
+unsigned int WeldFaces(const unsigned int* pnIB,
+                       unsigned int        nFaces,
+                       const unsigned int* pnWeld,
+                       unsigned int*       pnIBOut,
+                       unsigned int*       pnFaceRemapOut)
+{
+    // the table holds output faces, which are already welded
+    std::vector<unsigned int> table(GetTableSize(nFaces), UINT_MAX);
+    unsigned int nFacesOut = 0;
+
+    for (unsigned int f = 0; f < nFaces; f++)
+    {
+        unsigned int pnFace[ 3 ] = { pnWeld[ pnIB[ 3 * f ] ], pnWeld[ pnIB[ 3 * f + 1 ] ], pnWeld[ pnIB[ 3 * f + 2 ] ] };
+        unsigned int pnCanonical[ 3 ];
+        unsigned int nFaceOut = TOOTLE_MAX_FACES;
+
+        if (GetWeldedFace(pnFace, pnWeld, pnCanonical))
+        {
+            size_t nSlot = FindFace(table, pnIBOut, pnWeld, pnCanonical);
+
+            if (table[ nSlot ] == UINT_MAX)
+            {
+                // written after reading the input face, so pnIBOut may equal pnIB
+                table[ nSlot ] = nFacesOut;
+                memcpy(&pnIBOut[ 3 * nFacesOut ], pnFace, sizeof(pnFace));
+                nFaceOut = nFacesOut++;
+            }
+        }
+
+        if (pnFaceRemapOut)
+        {
+            pnFaceRemapOut[ f ] = nFaceOut;
+        }
+    }
+
+    return nFacesOut;
+}
+
+bool UnweldFaces(const unsigned int* pnIB,
+                 unsigned int        nFaces,
+                 const unsigned int* pnWeld,
+                 const unsigned int* pnWeldedIB,
+                 unsigned int        nWeldedFaces,
+                 unsigned int*       pnIBOut)
+{
+    // index the input faces that WeldFaces keeps, by their welded vertices
+    std::vector<unsigned int> table(GetTableSize(nFaces), UINT_MAX);
+
+    for (unsigned int f = 0; f < nFaces; f++)
+    {
+        unsigned int pnCanonical[ 3 ];
+
+        if (GetWeldedFace(&pnIB[ 3 * f ], pnWeld, pnCanonical))
+        {
+            size_t nSlot = FindFace(table, pnIB, pnWeld, pnCanonical);
+
+            if (table[ nSlot ] == UINT_MAX)
+            {
+                table[ nSlot ] = f;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < nWeldedFaces; i++)
+    {
+        unsigned int nFirst = pnWeld[ pnWeldedIB[ 3 * i ] ];
+        unsigned int pnCanonical[ 3 ];
+
+        if (!GetWeldedFace(&pnWeldedIB[ 3 * i ], pnWeld, pnCanonical))
+        {
+            return false;
+        }
+
+        unsigned int f = table[ FindFace(table, pnIB, pnWeld, pnCanonical) ];
+
+        if (f == UINT_MAX)
+        {
+            return false;
+        }
+
+        // rotate the input face so that it starts at the same vertex as the welded face
+        const unsigned int* pnFace = &pnIB[ 3 * f ];
+        int k = (pnWeld[ pnFace[ 0 ] ] == nFirst) ? 0 : (pnWeld[ pnFace[ 1 ] ] == nFirst) ? 1 : 2;
+
+        pnIBOut[ 3 * i ]     = pnFace[ k ];
+        pnIBOut[ 3 * i + 1 ] = pnFace[ (k + 1) % 3 ];
+        pnIBOut[ 3 * i + 2 ] = pnFace[ (k + 2) % 3 ];
+    }
+
+    return true;
+}
@@ -0,0 +1,40 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _TOOTLE_WELD_H_
+#define _TOOTLE_WELD_H_
+
+/// Fills pnWeldOut with the welded vertex of every vertex: the lowest numbered vertex that is connected to it by a chain of
+/// vertices whose positions are at most fEpsilon apart.  With an fEpsilon of 0, only equal positions are welded.
+/// The work is spread over nThreads threads (at least one).  The result does not depend on the number of threads.
+void WeldVertices(const void*   pVB,
+                  unsigned int  nVertices,
+                  unsigned int  nVBStride,
+                  float         fEpsilon,
+                  unsigned int  nThreads,
+                  unsigned int* pnWeldOut);
+
+/// Writes the faces to pnIBOut with their vertices replaced by their welded vertices, in their input order.  Faces that
+/// become degenerate and repeats of an earlier face (in any rotation) are dropped.  pnIBOut may equal pnIB.
+/// If pnFaceRemapOut is not NULL, element i receives the position of input face i in the output, or TOOTLE_MAX_FACES if the
+/// face was dropped.
+/// \return The number of faces written.
+unsigned int WeldFaces(const unsigned int* pnIB,
+                       unsigned int        nFaces,
+                       const unsigned int* pnWeld,
+                       unsigned int*       pnIBOut,
+                       unsigned int*       pnFaceRemapOut);
+
+/// Replaces each face of pnWeldedIB, a re-ordering of the output of WeldFaces in which faces may have been rotated, by the
+/// input face it was welded from, rotated the same way.  pnIBOut may equal pnWeldedIB.
+/// \return false if a face of pnWeldedIB is not one of the welded faces.
+bool UnweldFaces(const unsigned int* pnIB,
+                 unsigned int        nFaces,
+                 const unsigned int* pnWeld,
+                 const unsigned int* pnWeldedIB,
+                 unsigned int        nWeldedFaces,
+                 unsigned int*       pnIBOut);
+
+#endif
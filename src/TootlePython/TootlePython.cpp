@@ -0,0 +1,1516 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief The tootle Python module, a thin layer over the C API in tootlelib.h.
+///
+/// The mesh arguments are any objects that support the buffer protocol, such as NumPy arrays, array.array, bytearray or
+///  memoryview, and they are read in place.  Vertex buffers may be strided, as long as the X,Y,Z position of each vertex is 3
+///  consecutive 32-bit floats.  Index buffers hold 16- or 32-bit indices.  32-bit indices are read in place; 16-bit
+///  indices are widened into a temporary, because the library reads 32-bit indices.
+///
+/// The results are memoryviews of buffers that the library writes into directly, so numpy.asarray() wraps them without
+///  copying.  An index buffer result has the index size and the shape of the input index buffer.  Passing an existing buffer
+///  as the out argument makes the library write into it instead, which may be the input index buffer.
+///
+/// The GIL is released while the library runs, so meshes can be optimized on several Python threads at once.
+****************************************************************************************/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "tootlelib.h"
+
+
+//=================================================================================================================================
+//
+//          Internal state
+//
+//=================================================================================================================================
+
+/// Raised when the library fails for a reason other than invalid arguments or lack of memory
+static PyObject* s_pTootleError = NULL;
+
+/// The overdraw orderings that render the clusters keep the mesh in the global state of the overdraw module, so only one of
+///  them may run at a time.  TOOTLE_OVERDRAW_FAST and the other functions need no lock.
+static std::mutex s_overdrawModuleLock;
+
+
+//=================================================================================================================================
+//
+//          Internal helper functions
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Sets the Python exception for a failed library call.
+///
+/// \param eResult     The result of the call
+/// \param pszFunction The name of the Python function
+///
+/// \return NULL, so that the caller can return the result
+//=================================================================================================================================
+static PyObject* SetTootleError(TootleResult eResult, const char* pszFunction)
+{
+    switch (eResult)
+    {
+        case TOOTLE_INVALID_ARGS:
+            PyErr_Format(PyExc_ValueError, "%s: invalid arguments", pszFunction);
+            break;
+
+        case TOOTLE_OUT_OF_MEMORY:
+            PyErr_Format(PyExc_MemoryError, "%s: out of memory, or the memory budget is too small", pszFunction);
+            break;
+
+        case TOOTLE_NOT_INITIALIZED:
+            PyErr_Format(s_pTootleError, "%s: Tootle is not initialized", pszFunction);
+            break;
+
+        case TOOTLE_3D_API_ERROR:
+            PyErr_Format(s_pTootleError, "%s: the 3D API failed", pszFunction);
+            break;
+
+        default:
+            PyErr_Format(s_pTootleError, "%s: internal error %d", pszFunction, (int) eResult);
+            break;
+    }
+
+    return NULL;
+}
+
+//=================================================================================================================================
+/// Returns the struct module code of a buffer format with a single element, or 0 for any other format.  The native and
+///  little-endian byte order prefixes are accepted, as Tootle only runs on little-endian hosts.
+//=================================================================================================================================
+static char FormatCode(const char* pszFormat)
+{
+    if (!pszFormat)
+    {
+        return 'B';
+    }
+
+    if (pszFormat[0] == '@' || pszFormat[0] == '=' || pszFormat[0] == '<')
+    {
+        pszFormat++;
+    }
+
+    return (pszFormat[0] != '\0' && pszFormat[1] == '\0') ? pszFormat[0] : 0;
+}
+
+//=================================================================================================================================
+/// Returns true if a buffer holds integers of nSize bytes
+//=================================================================================================================================
+static bool IsIntegerFormat(const Py_buffer& rView, Py_ssize_t nSize)
+{
+    const char cCode = FormatCode(rView.format);
+
+    if (rView.itemsize != nSize)
+    {
+        return false;
+    }
+
+    return (nSize == 2 && (cCode == 'H' || cCode == 'h')) ||
+           (nSize == 4 && (cCode == 'I' || cCode == 'i' || cCode == 'L' || cCode == 'l'));
+}
+
+//=================================================================================================================================
+/// Returns a memoryview of a bytearray, cast to an array of nRows rows of nColumns elements.
+///
+/// \param pBytes    The bytearray.  The reference is not stolen.
+/// \param pszFormat The struct module code of the elements
+/// \param nRows     The number of rows
+/// \param nColumns  The number of elements per row, or 0 for a 1-dimensional array of nRows elements
+///
+/// \return A new reference, or NULL with an exception set
+//=================================================================================================================================
+static PyObject* CastBytes(PyObject* pBytes, const char* pszFormat, Py_ssize_t nRows, Py_ssize_t nColumns)
+{
+    PyObject* pView = PyMemoryView_FromObject(pBytes);
+
+    if (!pView)
+    {
+        return NULL;
+    }
+
+    PyObject* pShape = (nColumns > 0) ? Py_BuildValue("[nn]", nRows, nColumns) : Py_BuildValue("[n]", nRows);
+    PyObject* pCast  = pShape ? PyObject_CallMethod(pView, "cast", "sO", pszFormat, pShape) : NULL;
+
+    Py_XDECREF(pShape);
+    Py_DECREF(pView);
+
+    return pCast;
+}
+
+//=================================================================================================================================
+/// Copies a buffer of floats into a vector, in C order.  Used for the small arguments, such as viewpoints.
+///
+/// \return False with an exception set if the buffer does not hold 32-bit floats
+//=================================================================================================================================
+static bool CopyFloats(PyObject* pObject, const char* pszName, std::vector<float>& rFloatsOut)
+{
+    Py_buffer view;
+
+    if (PyObject_GetBuffer(pObject, &view, PyBUF_RECORDS_RO) != 0)
+    {
+        return false;
+    }
+
+    bool bOK = (FormatCode(view.format) == 'f' && view.itemsize == 4);
+
+    if (bOK)
+    {
+        rFloatsOut.resize(view.len / sizeof(float));
+        bOK = (rFloatsOut.empty() || PyBuffer_ToContiguous(&rFloatsOut[0], &view, view.len, 'C') == 0);
+    }
+    else
+    {
+        PyErr_Format(PyExc_TypeError, "%s must hold 32-bit floats", pszName);
+    }
+
+    PyBuffer_Release(&view);
+    return bOK;
+}
+
+
+//=================================================================================================================================
+//
+//          Mesh buffers
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// \brief A vertex buffer passed from Python.
+///
+/// The buffer may be:
+///  - a 2-dimensional array of floats with at least 3 columns, whose rows may be strided;
+///  - a 1-dimensional array of floats, holding X,Y,Z for each vertex;
+///  - a 1-dimensional array of records, such as a NumPy structured array, whose first field is the position;
+///  - any contiguous buffer, together with the distance between vertices in bytes.
+//=================================================================================================================================
+class VertexBuffer
+{
+public:
+    VertexBuffer() : m_bHasView(false), m_pVB(NULL), m_nVertices(0), m_nVBStride(0)
+    {
+    }
+
+    ~VertexBuffer()
+    {
+        if (m_bHasView)
+        {
+            PyBuffer_Release(&m_view);
+        }
+    }
+
+    //=============================================================================================================================
+    /// Gets the buffer of a Python object.
+    ///
+    /// \param pObject   The object
+    /// \param nVBStride The distance between successive vertices, in bytes, or 0 to take it from the buffer
+    ///
+    /// \return False with an exception set if the object is not a vertex buffer
+    //=============================================================================================================================
+    bool Parse(PyObject* pObject, unsigned int nVBStride)
+    {
+        if (PyObject_GetBuffer(pObject, &m_view, PyBUF_RECORDS_RO) != 0)
+        {
+            return false;
+        }
+
+        m_bHasView = true;
+        m_pVB      = (const char*) m_view.buf;
+
+        const char       cCode = FormatCode(m_view.format);
+        const Py_ssize_t nSize = 3 * sizeof(float);
+
+        if (nVBStride != 0)
+        {
+            if (!PyBuffer_IsContiguous(&m_view, 'C'))
+            {
+                PyErr_SetString(PyExc_ValueError, "vb must be contiguous when stride is given");
+                return false;
+            }
+
+            m_nVBStride = nVBStride;
+            m_nVertices = (m_view.len >= nSize) ? (unsigned int)((m_view.len - nSize) / nVBStride + 1) : 0;
+        }
+        else if (m_view.ndim == 2 && cCode == 'f' && m_view.itemsize == 4 && m_view.strides[1] == 4 && m_view.shape[1] >= 3 &&
+                 m_view.strides[0] >= nSize)
+        {
+            m_nVBStride = (unsigned int) m_view.strides[0];
+            m_nVertices = (unsigned int) m_view.shape[0];
+        }
+        else if (m_view.ndim == 1 && cCode == 'f' && m_view.itemsize == 4 && m_view.strides[0] == 4)
+        {
+            m_nVBStride = (unsigned int) nSize;
+            m_nVertices = (unsigned int)(m_view.shape[0] / 3);
+        }
+        else if (m_view.ndim == 1 && m_view.itemsize >= nSize && m_view.strides[0] >= nSize)
+        {
+            m_nVBStride = (unsigned int) m_view.strides[0];
+            m_nVertices = (unsigned int) m_view.shape[0];
+        }
+        else
+        {
+            PyErr_SetString(PyExc_ValueError, "vb must hold the X,Y,Z position of each vertex as 3 consecutive 32-bit floats, "
+                                              "with increasing addresses");
+            return false;
+        }
+
+        if (m_nVBStride < nSize || m_nVertices == 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "vb is empty, or its stride is less than 12 bytes");
+            return false;
+        }
+
+        return true;
+    }
+
+    /// Returns true if the buffer holds the whole of each vertex, as required to reorder the vertices
+    bool HasWholeVertices() const
+    {
+        return PyBuffer_IsContiguous(&m_view, 'C') && m_view.len >= (Py_ssize_t) m_nVertices * m_nVBStride;
+    }
+
+    /// Returns the struct module code of the elements of the buffer
+    char Format() const { return FormatCode(m_view.format); }
+
+    const void*  Vertices() const { return m_pVB; }
+    unsigned int Count() const    { return m_nVertices; }
+    unsigned int Stride() const   { return m_nVBStride; }
+
+private:
+    Py_buffer    m_view;
+    bool         m_bHasView;
+    const char*  m_pVB;
+    unsigned int m_nVertices;
+    unsigned int m_nVBStride;
+};
+
+//=================================================================================================================================
+/// \brief An index buffer passed from Python: a triangle list of 16- or 32-bit indices.
+///
+/// 32-bit indices in a C-contiguous buffer are read in place.  Other buffers are converted to a contiguous array of 32-bit
+///  indices.
+//=================================================================================================================================
+class IndexBuffer
+{
+public:
+    IndexBuffer() : m_bHasView(false), m_pnIB(NULL), m_nFaces(0), m_nMaxIndex(0), m_nIndexSize(4), m_nDimensions(1)
+    {
+    }
+
+    ~IndexBuffer()
+    {
+        if (m_bHasView)
+        {
+            PyBuffer_Release(&m_view);
+        }
+    }
+
+    //=============================================================================================================================
+    /// Gets the buffer of a Python object.
+    ///
+    /// \return False with an exception set if the object is not an index buffer
+    //=============================================================================================================================
+    bool Parse(PyObject* pObject, const char* pszName)
+    {
+        if (PyObject_GetBuffer(pObject, &m_view, PyBUF_RECORDS_RO) != 0)
+        {
+            return false;
+        }
+
+        m_bHasView    = true;
+        m_nIndexSize  = (unsigned int) m_view.itemsize;
+        m_nDimensions = m_view.ndim;
+
+        if (!IsIntegerFormat(m_view, 2) && !IsIntegerFormat(m_view, 4))
+        {
+            PyErr_Format(PyExc_TypeError, "%s must hold 16- or 32-bit integers", pszName);
+            return false;
+        }
+
+        const Py_ssize_t nIndices = m_view.len / m_view.itemsize;
+
+        if (nIndices == 0 || nIndices % 3 != 0)
+        {
+            PyErr_Format(PyExc_ValueError, "%s must hold 3 indices per face", pszName);
+            return false;
+        }
+
+        m_nFaces = (unsigned int)(nIndices / 3);
+
+        if (m_nIndexSize == 4 && PyBuffer_IsContiguous(&m_view, 'C'))
+        {
+            m_pnIB = (const unsigned int*) m_view.buf;
+        }
+        else if (m_nIndexSize == 4)
+        {
+            m_copy.resize(nIndices);
+
+            if (PyBuffer_ToContiguous(&m_copy[0], &m_view, m_view.len, 'C') != 0)
+            {
+                return false;
+            }
+
+            m_pnIB = &m_copy[0];
+        }
+        else
+        {
+            std::vector<unsigned short> narrow(nIndices);
+
+            if (PyBuffer_ToContiguous(&narrow[0], &m_view, m_view.len, 'C') != 0)
+            {
+                return false;
+            }
+
+            m_copy.assign(narrow.begin(), narrow.end());
+            m_pnIB = &m_copy[0];
+        }
+
+        for (Py_ssize_t i = 0; i < nIndices; i++)
+        {
+            m_nMaxIndex = (m_pnIB[i] > m_nMaxIndex) ? m_pnIB[i] : m_nMaxIndex;
+        }
+
+        return true;
+    }
+
+    //=============================================================================================================================
+    /// Checks that the indices refer to nVertices vertices.
+    ///
+    /// \param rnVertices The number of vertices.  If 0, it is set to one more than the largest index.
+    ///
+    /// \return False with an exception set if an index is out of range
+    //=============================================================================================================================
+    bool CheckVertexCount(unsigned int& rnVertices) const
+    {
+        if (rnVertices == 0)
+        {
+            rnVertices = m_nMaxIndex + 1;
+        }
+        else if (m_nMaxIndex >= rnVertices)
+        {
+            PyErr_Format(PyExc_ValueError, "index %u is out of range for %u vertices", m_nMaxIndex, rnVertices);
+            return false;
+        }
+
+        return true;
+    }
+
+    const unsigned int* Indices() const    { return m_pnIB; }
+    unsigned int        Faces() const      { return m_nFaces; }
+    unsigned int        IndexSize() const  { return m_nIndexSize; }
+    int                 Dimensions() const { return m_nDimensions; }
+
+private:
+    Py_buffer                 m_view;
+    bool                      m_bHasView;
+    const unsigned int*       m_pnIB;
+    std::vector<unsigned int> m_copy;
+    unsigned int              m_nFaces;
+    unsigned int              m_nMaxIndex;
+    unsigned int              m_nIndexSize;
+    int                       m_nDimensions;
+};
+
+//=================================================================================================================================
+/// \brief An array of unsigned ints returned to Python.
+///
+/// The library writes into the memory of the returned object: either a new bytearray, or the buffer passed as the out
+///  argument.  Outputs with 16-bit elements are written as 32-bit values and narrowed when the call is done, in place for a
+///  new bytearray.
+//=================================================================================================================================
+class ArrayOutput
+{
+public:
+    ArrayOutput() : m_pObject(NULL), m_bHasView(false), m_pnOut(NULL), m_nElements(0), m_nRows(0), m_nColumns(0),
+        m_nElementSize(4)
+    {
+    }
+
+    ~ArrayOutput()
+    {
+        if (m_bHasView)
+        {
+            PyBuffer_Release(&m_view);
+        }
+
+        Py_XDECREF(m_pObject);
+    }
+
+    //=============================================================================================================================
+    /// Prepares the output.
+    ///
+    /// \param pOut         The out argument, or NULL to return a new array
+    /// \param nRows        The number of rows
+    /// \param nColumns     The number of elements per row, or 0 for a 1-dimensional array of nRows elements
+    /// \param nElementSize The size of the elements of a new array: 2 or 4 bytes
+    ///
+    /// \return False with an exception set if the out argument is not suitable, or out of memory
+    //=============================================================================================================================
+    bool Init(PyObject* pOut, Py_ssize_t nRows, Py_ssize_t nColumns, unsigned int nElementSize)
+    {
+        m_nRows        = nRows;
+        m_nColumns     = nColumns;
+        m_nElements    = (nColumns > 0) ? nRows * nColumns : nRows;
+        m_nElementSize = nElementSize;
+
+        if (pOut && pOut != Py_None)
+        {
+            if (PyObject_GetBuffer(pOut, &m_view, PyBUF_CONTIG | PyBUF_FORMAT) != 0)
+            {
+                return false;
+            }
+
+            m_bHasView = true;
+
+            if (!IsIntegerFormat(m_view, 2) && !IsIntegerFormat(m_view, 4))
+            {
+                PyErr_SetString(PyExc_TypeError, "out must hold 16- or 32-bit integers");
+                return false;
+            }
+
+            if (m_view.len / m_view.itemsize != m_nElements)
+            {
+                PyErr_Format(PyExc_ValueError, "out must hold %zd elements", m_nElements);
+                return false;
+            }
+
+            m_nElementSize = (unsigned int) m_view.itemsize;
+            Py_INCREF(pOut);
+            m_pObject = pOut;
+        }
+        else
+        {
+            m_pObject = PyByteArray_FromStringAndSize(NULL, m_nElements * sizeof(unsigned int));
+
+            if (!m_pObject)
+            {
+                return false;
+            }
+        }
+
+        if (m_bHasView && m_nElementSize == 4)
+        {
+            m_pnOut = (unsigned int*) m_view.buf;
+        }
+        else if (m_bHasView)
+        {
+            m_wide.resize(m_nElements);
+            m_pnOut = &m_wide[0];
+        }
+        else
+        {
+            m_pnOut = (unsigned int*) PyByteArray_AS_STRING(m_pObject);
+        }
+
+        return true;
+    }
+
+    /// Returns the array the library writes into
+    unsigned int* Elements() const { return m_pnOut; }
+
+    //=============================================================================================================================
+    /// Narrows the output if needed, and returns it.
+    ///
+    /// \return A new reference, or NULL with an exception set
+    //=============================================================================================================================
+    PyObject* Finish()
+    {
+        if (m_nElementSize == 2)
+        {
+            unsigned short* pnNarrow = m_bHasView ? (unsigned short*) m_view.buf : (unsigned short*) m_pnOut;
+
+            // element i is read before it is overwritten, so this works in place
+            for (Py_ssize_t i = 0; i < m_nElements; i++)
+            {
+                pnNarrow[i] = (unsigned short) m_pnOut[i];
+            }
+        }
+
+        if (m_bHasView)
+        {
+            PyBuffer_Release(&m_view);
+            m_bHasView = false;
+
+            PyObject* pResult = m_pObject;
+            m_pObject = NULL;
+            return pResult;
+        }
+
+        if (m_nElementSize == 2 && PyByteArray_Resize(m_pObject, m_nElements * sizeof(unsigned short)) != 0)
+        {
+            return NULL;
+        }
+
+        return CastBytes(m_pObject, (m_nElementSize == 2) ? "H" : "I", m_nRows, m_nColumns);
+    }
+
+private:
+    PyObject*                 m_pObject;
+    Py_buffer                 m_view;
+    bool                      m_bHasView;
+    unsigned int*             m_pnOut;
+    std::vector<unsigned int> m_wide;
+    Py_ssize_t                m_nElements;
+    Py_ssize_t                m_nRows;
+    Py_ssize_t                m_nColumns;
+    unsigned int              m_nElementSize;
+};
+
+//=================================================================================================================================
+/// Prepares the output index buffer of a call, with the index size and shape of its input.
+//=================================================================================================================================
+static bool InitIndexOutput(ArrayOutput& rOutput, PyObject* pOut, const IndexBuffer& rIB)
+{
+    const bool bRows = (rIB.Dimensions() == 2);
+
+    return rOutput.Init(pOut, bRows ? rIB.Faces() : 3 * (Py_ssize_t) rIB.Faces(), bRows ? 3 : 0, rIB.IndexSize());
+}
+
+//=================================================================================================================================
+/// Copies the cluster array argument of a call.  The library may convert the array between its two formats in place, so it
+///  is never used in place.
+///
+/// \return False with an exception set if the array does not hold nFaces+1 32-bit integers
+//=================================================================================================================================
+static bool CopyFaceClusters(PyObject* pObject, unsigned int nFaces, std::vector<unsigned int>& rClustersOut)
+{
+    Py_buffer view;
+
+    if (PyObject_GetBuffer(pObject, &view, PyBUF_RECORDS_RO) != 0)
+    {
+        return false;
+    }
+
+    bool bOK = IsIntegerFormat(view, 4) && view.len / view.itemsize == (Py_ssize_t) nFaces + 1;
+
+    if (bOK)
+    {
+        rClustersOut.resize(nFaces + 1);
+        bOK = (PyBuffer_ToContiguous(&rClustersOut[0], &view, view.len, 'C') == 0);
+    }
+    else
+    {
+        PyErr_SetString(PyExc_ValueError, "face_clusters must hold nFaces+1 32-bit integers");
+    }
+
+    PyBuffer_Release(&view);
+    return bOK;
+}
+
+
+//=================================================================================================================================
+//
+//          Module functions
+//
+//=================================================================================================================================
+
+PyDoc_STRVAR(s_szEstimateMemoryDoc,
+             "estimate_memory(function, vertex_count, face_count, cache_size=16, clusters=0, vcache_optimizer=VCACHE_AUTO,\n"
+             "                overdraw_optimizer=OVERDRAW_FAST, memory_budget_mb=0) -> (kilobytes, fits)\n\n"
+             "Predicts the peak memory of a function, one of the FUNCTION_* constants.  fits is False if the function would\n"
+             "fail with memory_budget_mb.");
+
+static PyObject* PyEstimateMemory(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "function", "vertex_count", "face_count", "cache_size", "clusters",
+                                          "vcache_optimizer", "overdraw_optimizer", "memory_budget_mb", NULL };
+    int          eFunction;
+    unsigned int nVertices;
+    unsigned int nFaces;
+    unsigned int nCacheSize         = TOOTLE_DEFAULT_VCACHE_SIZE;
+    unsigned int nClusters          = 0;
+    int          eVCacheOptimizer   = TOOTLE_VCACHE_AUTO;
+    int          eOverdrawOptimizer = TOOTLE_OVERDRAW_FAST;
+    unsigned int nMemoryBudgetMB    = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "iII|IIiiI:estimate_memory", (char**) ppszKeywords, &eFunction,
+                                     &nVertices, &nFaces, &nCacheSize, &nClusters, &eVCacheOptimizer, &eOverdrawOptimizer,
+                                     &nMemoryBudgetMB))
+    {
+        return NULL;
+    }
+
+    unsigned int nKilobytes = 0;
+    TootleResult eResult = TootleEstimateMemory((TootleFunction) eFunction, nVertices, nFaces, nCacheSize, nClusters,
+                                                (TootleVCacheOptimizer) eVCacheOptimizer,
+                                                (TootleOverdrawOptimizer) eOverdrawOptimizer, nMemoryBudgetMB, &nKilobytes);
+
+    if (eResult != TOOTLE_OK && eResult != TOOTLE_OUT_OF_MEMORY)
+    {
+        return SetTootleError(eResult, "estimate_memory");
+    }
+
+    return Py_BuildValue("(IO)", nKilobytes, (eResult == TOOTLE_OK) ? Py_True : Py_False);
+}
+
+PyDoc_STRVAR(s_szOptimizeVCacheDoc,
+             "optimize_vcache(ib, vertex_count=0, cache_size=16, optimizer=VCACHE_AUTO, memory_budget_mb=0, out=None) -> ib\n\n"
+             "Reorders the faces of an index buffer for the vertex cache.  vertex_count 0 means one more than the largest\n"
+             "index.");
+
+static PyObject* PyOptimizeVCache(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "ib", "vertex_count", "cache_size", "optimizer", "memory_budget_mb", "out", NULL };
+    PyObject*    pIB;
+    unsigned int nVertices        = 0;
+    unsigned int nCacheSize       = TOOTLE_DEFAULT_VCACHE_SIZE;
+    int          eVCacheOptimizer = TOOTLE_VCACHE_AUTO;
+    unsigned int nMemoryBudgetMB  = 0;
+    PyObject*    pOut             = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "O|IIiIO:optimize_vcache", (char**) ppszKeywords, &pIB, &nVertices,
+                                     &nCacheSize, &eVCacheOptimizer, &nMemoryBudgetMB, &pOut))
+    {
+        return NULL;
+    }
+
+    IndexBuffer ib;
+    ArrayOutput ibOut;
+
+    if (!ib.Parse(pIB, "ib") || !ib.CheckVertexCount(nVertices) || !InitIndexOutput(ibOut, pOut, ib))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+
+    Py_BEGIN_ALLOW_THREADS
+    eResult = TootleOptimizeVCacheEx(ib.Indices(), ib.Faces(), nVertices, nCacheSize, ibOut.Elements(), NULL,
+                                     (TootleVCacheOptimizer) eVCacheOptimizer, nMemoryBudgetMB);
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "optimize_vcache");
+    }
+
+    return ibOut.Finish();
+}
+
+PyDoc_STRVAR(s_szClusterMeshDoc,
+             "cluster_mesh(vb, ib, target_clusters=0, stride=0, memory_budget_mb=0, out=None) -> (ib, face_clusters)\n\n"
+             "Groups the faces into clusters and sorts them by cluster.  face_clusters holds the cluster of each face of the\n"
+             "result, followed by the number of clusters.  target_clusters 0 chooses the number automatically.");
+
+static PyObject* PyClusterMesh(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "vb", "ib", "target_clusters", "stride", "memory_budget_mb", "out", NULL };
+    PyObject*    pVB;
+    PyObject*    pIB;
+    unsigned int nTargetClusters = 0;
+    unsigned int nVBStride       = 0;
+    unsigned int nMemoryBudgetMB = 0;
+    PyObject*    pOut            = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "OO|IIIO:cluster_mesh", (char**) ppszKeywords, &pVB, &pIB,
+                                     &nTargetClusters, &nVBStride, &nMemoryBudgetMB, &pOut))
+    {
+        return NULL;
+    }
+
+    VertexBuffer vb;
+    IndexBuffer  ib;
+    ArrayOutput  ibOut;
+    ArrayOutput  clustersOut;
+    unsigned int nVertices = 0;
+
+    if (!vb.Parse(pVB, nVBStride) || !ib.Parse(pIB, "ib"))
+    {
+        return NULL;
+    }
+
+    nVertices = vb.Count();
+
+    if (!ib.CheckVertexCount(nVertices) || !InitIndexOutput(ibOut, pOut, ib) ||
+        !clustersOut.Init(NULL, ib.Faces() + 1, 0, 4))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+
+    Py_BEGIN_ALLOW_THREADS
+    eResult = TootleClusterMeshEx(vb.Vertices(), ib.Indices(), nVertices, ib.Faces(), vb.Stride(), nTargetClusters,
+                                  ibOut.Elements(), clustersOut.Elements(), NULL, nMemoryBudgetMB);
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "cluster_mesh");
+    }
+
+    PyObject* pIBOut       = ibOut.Finish();
+    PyObject* pClustersOut = pIBOut ? clustersOut.Finish() : NULL;
+
+    if (!pClustersOut)
+    {
+        Py_XDECREF(pIBOut);
+        return NULL;
+    }
+
+    return Py_BuildValue("(NN)", pIBOut, pClustersOut);
+}
+
+PyDoc_STRVAR(s_szVCacheClustersDoc,
+             "vcache_clusters(ib, face_clusters, vertex_count=0, cache_size=16, optimizer=VCACHE_AUTO, memory_budget_mb=0,\n"
+             "                vb=None, stride=0, winding=CCW, max_acmr_increase=0.0, out=None) -> ib\n\n"
+             "Reorders the faces within each cluster for the vertex cache.  With vb and a positive max_acmr_increase, the\n"
+             "faces of each cluster are then ordered front to back within that increase of its ACMR.");
+
+static PyObject* PyVCacheClusters(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "ib", "face_clusters", "vertex_count", "cache_size", "optimizer",
+                                          "memory_budget_mb", "vb", "stride", "winding", "max_acmr_increase", "out", NULL };
+    PyObject*    pIB;
+    PyObject*    pFaceClusters;
+    unsigned int nVertices        = 0;
+    unsigned int nCacheSize       = TOOTLE_DEFAULT_VCACHE_SIZE;
+    int          eVCacheOptimizer = TOOTLE_VCACHE_AUTO;
+    unsigned int nMemoryBudgetMB  = 0;
+    PyObject*    pVB              = NULL;
+    unsigned int nVBStride        = 0;
+    int          eFrontWinding    = TOOTLE_CCW;
+    float        fMaxACMRIncrease = 0.0f;
+    PyObject*    pOut             = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "OO|IIiIOIifO:vcache_clusters", (char**) ppszKeywords, &pIB,
+                                     &pFaceClusters, &nVertices, &nCacheSize, &eVCacheOptimizer, &nMemoryBudgetMB, &pVB,
+                                     &nVBStride, &eFrontWinding, &fMaxACMRIncrease, &pOut))
+    {
+        return NULL;
+    }
+
+    VertexBuffer              vb;
+    IndexBuffer               ib;
+    ArrayOutput               ibOut;
+    std::vector<unsigned int> faceClusters;
+    const bool                bHasVB = (pVB && pVB != Py_None);
+
+    if (bHasVB)
+    {
+        if (!vb.Parse(pVB, nVBStride))
+        {
+            return NULL;
+        }
+
+        if (nVertices == 0)
+        {
+            nVertices = vb.Count();
+        }
+        else if (nVertices > vb.Count())
+        {
+            PyErr_Format(PyExc_ValueError, "vertex_count %u exceeds the %u vertices of vb", nVertices, vb.Count());
+            return NULL;
+        }
+    }
+
+    if (!ib.Parse(pIB, "ib") || !ib.CheckVertexCount(nVertices) ||
+        !CopyFaceClusters(pFaceClusters, ib.Faces(), faceClusters) || !InitIndexOutput(ibOut, pOut, ib))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+
+    Py_BEGIN_ALLOW_THREADS
+    eResult = TootleVCacheClustersEx(ib.Indices(), ib.Faces(), nVertices, nCacheSize, &faceClusters[0], ibOut.Elements(),
+                                     NULL, (TootleVCacheOptimizer) eVCacheOptimizer, nMemoryBudgetMB,
+                                     bHasVB ? vb.Vertices() : NULL, vb.Stride(), (TootleFaceWinding) eFrontWinding,
+                                     fMaxACMRIncrease);
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "vcache_clusters");
+    }
+
+    return ibOut.Finish();
+}
+
+PyDoc_STRVAR(s_szGenerateViewpointsDoc,
+             "generate_viewpoints(density=642, sampling=VIEWPOINT_GEODESIC, axis=None, angle=90.0) -> viewpoints\n\n"
+             "Samples the viewpoint sphere with density viewpoints over the whole sphere, keeping those within angle degrees\n"
+             "of axis if it is given.  Returns an array of X,Y,Z floats, one row per viewpoint.");
+
+static PyObject* PyGenerateViewpoints(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "density", "sampling", "axis", "angle", NULL };
+    unsigned int nSphereViewpoints = 642;
+    int          eSampling         = TOOTLE_VIEWPOINT_GEODESIC;
+    PyObject*    pAxis             = NULL;
+    float        fConeAngle        = 90.0f;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "|IiOf:generate_viewpoints", (char**) ppszKeywords,
+                                     &nSphereViewpoints, &eSampling, &pAxis, &fConeAngle))
+    {
+        return NULL;
+    }
+
+    std::vector<float> axis;
+
+    if (pAxis && pAxis != Py_None)
+    {
+        PyObject* pSequence = PySequence_Fast(pAxis, "axis must be a sequence of 3 numbers");
+
+        if (!pSequence)
+        {
+            return NULL;
+        }
+
+        for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(pSequence); i++)
+        {
+            axis.push_back((float) PyFloat_AsDouble(PySequence_Fast_GET_ITEM(pSequence, i)));
+        }
+
+        Py_DECREF(pSequence);
+
+        if (PyErr_Occurred())
+        {
+            return NULL;
+        }
+
+        if (axis.size() != 3)
+        {
+            PyErr_SetString(PyExc_ValueError, "axis must be a sequence of 3 numbers");
+            return NULL;
+        }
+    }
+
+    const float* pfConeAxis  = axis.empty() ? NULL : &axis[0];
+    unsigned int nViewpoints = 0;
+    TootleResult eResult     = TootleGenerateViewpoints((TootleViewpointSampling) eSampling, nSphereViewpoints, pfConeAxis,
+                                                        fConeAngle, NULL, &nViewpoints);
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "generate_viewpoints");
+    }
+
+    PyObject* pBytes = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t) nViewpoints * 3 * sizeof(float));
+
+    if (!pBytes)
+    {
+        return NULL;
+    }
+
+    float* pfViewpoints = (float*) PyByteArray_AS_STRING(pBytes);
+
+    Py_BEGIN_ALLOW_THREADS
+    eResult = TootleGenerateViewpoints((TootleViewpointSampling) eSampling, nSphereViewpoints, pfConeAxis, fConeAngle,
+                                       pfViewpoints, &nViewpoints);
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        Py_DECREF(pBytes);
+        return SetTootleError(eResult, "generate_viewpoints");
+    }
+
+    PyObject* pViewpoints = CastBytes(pBytes, "f", nViewpoints, 3);
+    Py_DECREF(pBytes);
+    return pViewpoints;
+}
+
+PyDoc_STRVAR(s_szOptimizeOverdrawDoc,
+             "optimize_overdraw(vb, ib, face_clusters, viewpoints=None, winding=CCW, optimizer=OVERDRAW_FAST, stride=0,\n"
+             "                  memory_budget_mb=0, cost_model=OVERDRAW_COST_PLAIN, out=None) -> ib\n\n"
+             "Orders the clusters to reduce overdraw.  viewpoints is an optional array of X,Y,Z floats.  cost_model\n"
+             "selects the fragments counted: OVERDRAW_COST_HIZ and OVERDRAW_COST_PREPASS model a hierarchical Z buffer.");
+
+static PyObject* PyOptimizeOverdraw(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "vb", "ib", "face_clusters", "viewpoints", "winding", "optimizer", "stride",
+                                          "memory_budget_mb", "cost_model", "out", NULL };
+    PyObject*    pVB;
+    PyObject*    pIB;
+    PyObject*    pFaceClusters;
+    PyObject*    pViewpoints        = NULL;
+    int          eFrontWinding      = TOOTLE_CCW;
+    int          eOverdrawOptimizer = TOOTLE_OVERDRAW_FAST;
+    unsigned int nVBStride          = 0;
+    unsigned int nMemoryBudgetMB    = 0;
+    int          eCostModel         = TOOTLE_OVERDRAW_COST_PLAIN;
+    PyObject*    pOut               = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "OOO|OiiIIiO:optimize_overdraw", (char**) ppszKeywords, &pVB, &pIB,
+                                     &pFaceClusters, &pViewpoints, &eFrontWinding, &eOverdrawOptimizer, &nVBStride,
+                                     &nMemoryBudgetMB, &eCostModel, &pOut))
+    {
+        return NULL;
+    }
+
+    VertexBuffer              vb;
+    IndexBuffer               ib;
+    ArrayOutput               ibOut;
+    std::vector<unsigned int> faceClusters;
+    std::vector<float>        viewpoints;
+    unsigned int              nVertices = 0;
+
+    if (!vb.Parse(pVB, nVBStride) || !ib.Parse(pIB, "ib"))
+    {
+        return NULL;
+    }
+
+    nVertices = vb.Count();
+
+    if (!ib.CheckVertexCount(nVertices) || !CopyFaceClusters(pFaceClusters, ib.Faces(), faceClusters) ||
+        (pViewpoints && pViewpoints != Py_None && !CopyFloats(pViewpoints, "viewpoints", viewpoints)) ||
+        !InitIndexOutput(ibOut, pOut, ib))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::unique_lock<std::mutex> lock(s_overdrawModuleLock, std::defer_lock);
+
+        if (eOverdrawOptimizer != TOOTLE_OVERDRAW_FAST)
+        {
+            lock.lock();
+        }
+
+        eResult = TootleOptimizeOverdrawEx(vb.Vertices(), ib.Indices(), nVertices, ib.Faces(), vb.Stride(),
+                                           viewpoints.empty() ? NULL : &viewpoints[0], (unsigned int)(viewpoints.size() / 3),
+                                           (TootleFaceWinding) eFrontWinding, &faceClusters[0], ibOut.Elements(), NULL,
+                                           (TootleOverdrawOptimizer) eOverdrawOptimizer, nMemoryBudgetMB,
+                                           (TootleOverdrawCostModel) eCostModel);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "optimize_overdraw");
+    }
+
+    return ibOut.Finish();
+}
+
+PyDoc_STRVAR(s_szOptimizeDoc,
+             "optimize(vb, ib, cache_size=16, viewpoints=None, winding=CCW, vcache_optimizer=VCACHE_AUTO,\n"
+             "         overdraw_optimizer=OVERDRAW_FAST, stride=0, memory_budget_mb=0, cost_model=OVERDRAW_COST_PLAIN,\n"
+             "         out=None) -> (ib, cluster_count)\n\n"
+             "Clusters the mesh, optimizes each cluster for the vertex cache and orders the clusters to reduce overdraw.");
+
+static PyObject* PyOptimize(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "vb", "ib", "cache_size", "viewpoints", "winding", "vcache_optimizer",
+                                          "overdraw_optimizer", "stride", "memory_budget_mb", "cost_model", "out", NULL };
+    PyObject*    pVB;
+    PyObject*    pIB;
+    unsigned int nCacheSize         = TOOTLE_DEFAULT_VCACHE_SIZE;
+    PyObject*    pViewpoints        = NULL;
+    int          eFrontWinding      = TOOTLE_CCW;
+    int          eVCacheOptimizer   = TOOTLE_VCACHE_AUTO;
+    int          eOverdrawOptimizer = TOOTLE_OVERDRAW_FAST;
+    unsigned int nVBStride          = 0;
+    unsigned int nMemoryBudgetMB    = 0;
+    int          eCostModel         = TOOTLE_OVERDRAW_COST_PLAIN;
+    PyObject*    pOut               = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "OO|IOiiiIIiO:optimize", (char**) ppszKeywords, &pVB, &pIB,
+                                     &nCacheSize, &pViewpoints, &eFrontWinding, &eVCacheOptimizer, &eOverdrawOptimizer,
+                                     &nVBStride, &nMemoryBudgetMB, &eCostModel, &pOut))
+    {
+        return NULL;
+    }
+
+    VertexBuffer       vb;
+    IndexBuffer        ib;
+    ArrayOutput        ibOut;
+    std::vector<float> viewpoints;
+    unsigned int       nVertices = 0;
+
+    if (!vb.Parse(pVB, nVBStride) || !ib.Parse(pIB, "ib"))
+    {
+        return NULL;
+    }
+
+    nVertices = vb.Count();
+
+    if (!ib.CheckVertexCount(nVertices) ||
+        (pViewpoints && pViewpoints != Py_None && !CopyFloats(pViewpoints, "viewpoints", viewpoints)) ||
+        !InitIndexOutput(ibOut, pOut, ib))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+    unsigned int nClusters = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    {
+        std::unique_lock<std::mutex> lock(s_overdrawModuleLock, std::defer_lock);
+
+        if (eOverdrawOptimizer != TOOTLE_OVERDRAW_FAST)
+        {
+            lock.lock();
+        }
+
+        eResult = TootleOptimizeEx(vb.Vertices(), ib.Indices(), nVertices, ib.Faces(), vb.Stride(), nCacheSize,
+                                   viewpoints.empty() ? NULL : &viewpoints[0], (unsigned int)(viewpoints.size() / 3),
+                                   (TootleFaceWinding) eFrontWinding, ibOut.Elements(), &nClusters,
+                                   (TootleVCacheOptimizer) eVCacheOptimizer, (TootleOverdrawOptimizer) eOverdrawOptimizer,
+                                   nMemoryBudgetMB, (TootleOverdrawCostModel) eCostModel);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "optimize");
+    }
+
+    PyObject* pIBOut = ibOut.Finish();
+    return pIBOut ? Py_BuildValue("(NI)", pIBOut, nClusters) : NULL;
+}
+
+PyDoc_STRVAR(s_szFastOptimizeDoc,
+             "fast_optimize(vb, ib, cache_size=16, winding=CCW, alpha=0.75, stride=0, memory_budget_mb=0,\n"
+             "              max_acmr_increase=0.0, out=None) -> (ib, cluster_count)\n\n"
+             "Optimizes the mesh for the vertex cache and overdraw with the fast algorithm from SIGGRAPH 2007.  A positive\n"
+             "max_acmr_increase also orders the faces of each cluster front to back, as vcache_clusters does.");
+
+static PyObject* PyFastOptimize(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "vb", "ib", "cache_size", "winding", "alpha", "stride", "memory_budget_mb",
+                                          "max_acmr_increase", "out", NULL };
+    PyObject*    pVB;
+    PyObject*    pIB;
+    unsigned int nCacheSize       = TOOTLE_DEFAULT_VCACHE_SIZE;
+    int          eFrontWinding    = TOOTLE_CCW;
+    float        fAlpha           = TOOTLE_DEFAULT_ALPHA;
+    unsigned int nVBStride        = 0;
+    unsigned int nMemoryBudgetMB  = 0;
+    float        fMaxACMRIncrease = 0.0f;
+    PyObject*    pOut             = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "OO|IifIIfO:fast_optimize", (char**) ppszKeywords, &pVB, &pIB,
+                                     &nCacheSize, &eFrontWinding, &fAlpha, &nVBStride, &nMemoryBudgetMB, &fMaxACMRIncrease,
+                                     &pOut))
+    {
+        return NULL;
+    }
+
+    VertexBuffer vb;
+    IndexBuffer  ib;
+    ArrayOutput  ibOut;
+    unsigned int nVertices = 0;
+
+    if (!vb.Parse(pVB, nVBStride) || !ib.Parse(pIB, "ib"))
+    {
+        return NULL;
+    }
+
+    nVertices = vb.Count();
+
+    if (!ib.CheckVertexCount(nVertices) || !InitIndexOutput(ibOut, pOut, ib))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+    unsigned int nClusters = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    eResult = TootleFastOptimizeEx(vb.Vertices(), ib.Indices(), nVertices, ib.Faces(), vb.Stride(), nCacheSize,
+                                   (TootleFaceWinding) eFrontWinding, ibOut.Elements(), &nClusters, fAlpha, nMemoryBudgetMB,
+                                   fMaxACMRIncrease);
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "fast_optimize");
+    }
+
+    PyObject* pIBOut = ibOut.Finish();
+    return pIBOut ? Py_BuildValue("(NI)", pIBOut, nClusters) : NULL;
+}
+
+PyDoc_STRVAR(s_szOptimizeVertexMemoryDoc,
+             "optimize_vertex_memory(vb, ib, optimizer=VMEMORY_FIRST_USE, cache_size=16, stride=0, out_vb=None, out_ib=None)\n"
+             "    -> (vb, ib, vertex_remap)\n\n"
+             "Reorders the vertices in the order the index buffer uses them.  vb must hold whole vertices: a strided view of\n"
+             "the positions is not enough.  out_vb may be vb, and out_ib may be ib.");
+
+static PyObject* PyOptimizeVertexMemory(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "vb", "ib", "optimizer", "cache_size", "stride", "out_vb", "out_ib", NULL };
+    PyObject*    pVB;
+    PyObject*    pIB;
+    int          eVertexMemoryOptimizer = TOOTLE_VMEMORY_FIRST_USE;
+    unsigned int nCacheSize             = TOOTLE_DEFAULT_VCACHE_SIZE;
+    unsigned int nVBStride              = 0;
+    PyObject*    pVBOut                 = NULL;
+    PyObject*    pIBOut                 = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "OO|iIIOO:optimize_vertex_memory", (char**) ppszKeywords, &pVB, &pIB,
+                                     &eVertexMemoryOptimizer, &nCacheSize, &nVBStride, &pVBOut, &pIBOut))
+    {
+        return NULL;
+    }
+
+    VertexBuffer vb;
+    IndexBuffer  ib;
+    ArrayOutput  ibOut;
+    ArrayOutput  remapOut;
+    unsigned int nVertices = 0;
+
+    if (!vb.Parse(pVB, nVBStride) || !ib.Parse(pIB, "ib"))
+    {
+        return NULL;
+    }
+
+    if (!vb.HasWholeVertices())
+    {
+        PyErr_SetString(PyExc_ValueError, "vb must be a contiguous buffer of whole vertices");
+        return NULL;
+    }
+
+    nVertices = vb.Count();
+
+    if (!ib.CheckVertexCount(nVertices) || !InitIndexOutput(ibOut, pIBOut, ib) || !remapOut.Init(NULL, nVertices, 0, 4))
+    {
+        return NULL;
+    }
+
+    // the vertices are written into out_vb, or into a new bytearray returned as rows of floats or bytes
+    const Py_ssize_t nVBBytes = (Py_ssize_t) nVertices * vb.Stride();
+    PyObject*        pVBObject = NULL;
+    Py_buffer        vbOutView;
+    bool             bHasVBOutView = false;
+    void*            pVBOutData;
+
+    if (pVBOut && pVBOut != Py_None)
+    {
+        if (PyObject_GetBuffer(pVBOut, &vbOutView, PyBUF_CONTIG) != 0)
+        {
+            return NULL;
+        }
+
+        bHasVBOutView = true;
+
+        if (vbOutView.len != nVBBytes)
+        {
+            PyBuffer_Release(&vbOutView);
+            PyErr_Format(PyExc_ValueError, "out_vb must hold %zd bytes", nVBBytes);
+            return NULL;
+        }
+
+        Py_INCREF(pVBOut);
+        pVBObject  = pVBOut;
+        pVBOutData = vbOutView.buf;
+    }
+    else
+    {
+        pVBObject = PyByteArray_FromStringAndSize(NULL, nVBBytes);
+
+        if (!pVBObject)
+        {
+            return NULL;
+        }
+
+        pVBOutData = PyByteArray_AS_STRING(pVBObject);
+    }
+
+    TootleResult eResult;
+
+    Py_BEGIN_ALLOW_THREADS
+    eResult = TootleOptimizeVertexMemoryEx(vb.Vertices(), ib.Indices(), nVertices, ib.Faces(), vb.Stride(), pVBOutData,
+                                           ibOut.Elements(), remapOut.Elements(),
+                                           (TootleVertexMemoryOptimizer) eVertexMemoryOptimizer, nCacheSize);
+    Py_END_ALLOW_THREADS
+
+    if (bHasVBOutView)
+    {
+        PyBuffer_Release(&vbOutView);
+    }
+
+    if (eResult != TOOTLE_OK)
+    {
+        Py_DECREF(pVBObject);
+        return SetTootleError(eResult, "optimize_vertex_memory");
+    }
+
+    if (!bHasVBOutView)
+    {
+        PyObject* pBytes = pVBObject;
+        const bool bFloats = (vb.Format() == 'f' && vb.Stride() % sizeof(float) == 0);
+
+        pVBObject = bFloats ? CastBytes(pBytes, "f", nVertices, vb.Stride() / sizeof(float)) :
+                              CastBytes(pBytes, "B", nVertices, vb.Stride());
+        Py_DECREF(pBytes);
+
+        if (!pVBObject)
+        {
+            return NULL;
+        }
+    }
+
+    PyObject* pIBResult    = ibOut.Finish();
+    PyObject* pRemapResult = pIBResult ? remapOut.Finish() : NULL;
+
+    if (!pRemapResult)
+    {
+        Py_XDECREF(pIBResult);
+        Py_DECREF(pVBObject);
+        return NULL;
+    }
+
+    return Py_BuildValue("(NNN)", pVBObject, pIBResult, pRemapResult);
+}
+
+PyDoc_STRVAR(s_szMeasureCacheEfficiencyDoc,
+             "measure_cache_efficiency(ib, cache_size=16) -> float\n\n"
+             "Returns the average number of vertex cache misses per face (ACMR).");
+
+static PyObject* PyMeasureCacheEfficiency(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "ib", "cache_size", NULL };
+    PyObject*    pIB;
+    unsigned int nCacheSize = TOOTLE_DEFAULT_VCACHE_SIZE;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "O|I:measure_cache_efficiency", (char**) ppszKeywords, &pIB,
+                                     &nCacheSize))
+    {
+        return NULL;
+    }
+
+    IndexBuffer ib;
+
+    if (!ib.Parse(pIB, "ib"))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+    float        fEfficiency = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    eResult = TootleMeasureCacheEfficiency(ib.Indices(), ib.Faces(), nCacheSize, &fEfficiency);
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "measure_cache_efficiency");
+    }
+
+    return PyFloat_FromDouble(fEfficiency);
+}
+
+PyDoc_STRVAR(s_szMeasureOverdrawDoc,
+             "measure_overdraw(vb, ib, viewpoints=None, winding=CCW, optimizer=OVERDRAW_RAYTRACE, stride=0,\n"
+             "                 memory_budget_mb=0, cost_model=OVERDRAW_COST_PLAIN) -> (average, maximum)\n\n"
+             "Measures the overdraw of the mesh over a set of views.  The cost models other than OVERDRAW_COST_PLAIN are\n"
+             "always measured with the ray tracer.");
+
+static PyObject* PyMeasureOverdraw(PyObject*, PyObject* pArgs, PyObject* pKeywords)
+{
+    static const char* ppszKeywords[] = { "vb", "ib", "viewpoints", "winding", "optimizer", "stride", "memory_budget_mb",
+                                          "cost_model", NULL };
+    PyObject*    pVB;
+    PyObject*    pIB;
+    PyObject*    pViewpoints        = NULL;
+    int          eFrontWinding      = TOOTLE_CCW;
+    int          eOverdrawOptimizer = TOOTLE_OVERDRAW_RAYTRACE;
+    unsigned int nVBStride          = 0;
+    unsigned int nMemoryBudgetMB    = 0;
+    int          eCostModel         = TOOTLE_OVERDRAW_COST_PLAIN;
+
+    if (!PyArg_ParseTupleAndKeywords(pArgs, pKeywords, "OO|OiiIIi:measure_overdraw", (char**) ppszKeywords, &pVB, &pIB,
+                                     &pViewpoints, &eFrontWinding, &eOverdrawOptimizer, &nVBStride, &nMemoryBudgetMB,
+                                     &eCostModel))
+    {
+        return NULL;
+    }
+
+    VertexBuffer       vb;
+    IndexBuffer        ib;
+    std::vector<float> viewpoints;
+    unsigned int       nVertices = 0;
+
+    if (!vb.Parse(pVB, nVBStride) || !ib.Parse(pIB, "ib"))
+    {
+        return NULL;
+    }
+
+    nVertices = vb.Count();
+
+    if (!ib.CheckVertexCount(nVertices) ||
+        (pViewpoints && pViewpoints != Py_None && !CopyFloats(pViewpoints, "viewpoints", viewpoints)))
+    {
+        return NULL;
+    }
+
+    TootleResult eResult;
+    float        fAvgOD = 0;
+    float        fMaxOD = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    {
+        // the Direct3D measurement renders with the overdraw module
+        std::unique_lock<std::mutex> lock(s_overdrawModuleLock, std::defer_lock);
+
+        if (eOverdrawOptimizer != TOOTLE_OVERDRAW_RAYTRACE && eCostModel == TOOTLE_OVERDRAW_COST_PLAIN)
+        {
+            lock.lock();
+        }
+
+        eResult = TootleMeasureOverdrawEx(vb.Vertices(), ib.Indices(), nVertices, ib.Faces(), vb.Stride(),
+                                          viewpoints.empty() ? NULL : &viewpoints[0], (unsigned int)(viewpoints.size() / 3),
+                                          (TootleFaceWinding) eFrontWinding, &fAvgOD, &fMaxOD,
+                                          (TootleOverdrawOptimizer) eOverdrawOptimizer, nMemoryBudgetMB,
+                                          (TootleOverdrawCostModel) eCostModel);
+    }
+    Py_END_ALLOW_THREADS
+
+    if (eResult != TOOTLE_OK)
+    {
+        return SetTootleError(eResult, "measure_overdraw");
+    }
+
+    return Py_BuildValue("(dd)", (double) fAvgOD, (double) fMaxOD);
+}
+
+
+//=================================================================================================================================
+//
+//          Module definition
+//
+//=================================================================================================================================
+
+/// The method table holds PyCFunction, which takes no keywords.  Casting through a function without parameters tells the
+///  compiler that the different signature is intended.
+#define KEYWORDS_FUNCTION(pfnFunction) ((PyCFunction)(void (*)(void)) (pfnFunction))
+
+static PyMethodDef s_methods[] =
+{
+    { "estimate_memory",          KEYWORDS_FUNCTION(PyEstimateMemory),         METH_VARARGS | METH_KEYWORDS,
+      s_szEstimateMemoryDoc },
+    { "optimize_vcache",          KEYWORDS_FUNCTION(PyOptimizeVCache),         METH_VARARGS | METH_KEYWORDS,
+      s_szOptimizeVCacheDoc },
+    { "cluster_mesh",             KEYWORDS_FUNCTION(PyClusterMesh),            METH_VARARGS | METH_KEYWORDS,
+      s_szClusterMeshDoc },
+    { "vcache_clusters",          KEYWORDS_FUNCTION(PyVCacheClusters),         METH_VARARGS | METH_KEYWORDS,
+      s_szVCacheClustersDoc },
+    { "generate_viewpoints",      KEYWORDS_FUNCTION(PyGenerateViewpoints),     METH_VARARGS | METH_KEYWORDS,
+      s_szGenerateViewpointsDoc },
+    { "optimize_overdraw",        KEYWORDS_FUNCTION(PyOptimizeOverdraw),       METH_VARARGS | METH_KEYWORDS,
+      s_szOptimizeOverdrawDoc },
+    { "optimize",                 KEYWORDS_FUNCTION(PyOptimize),               METH_VARARGS | METH_KEYWORDS,
+      s_szOptimizeDoc },
+    { "fast_optimize",            KEYWORDS_FUNCTION(PyFastOptimize),           METH_VARARGS | METH_KEYWORDS,
+      s_szFastOptimizeDoc },
+    { "optimize_vertex_memory",   KEYWORDS_FUNCTION(PyOptimizeVertexMemory),   METH_VARARGS | METH_KEYWORDS,
+      s_szOptimizeVertexMemoryDoc },
+    { "measure_cache_efficiency", KEYWORDS_FUNCTION(PyMeasureCacheEfficiency), METH_VARARGS | METH_KEYWORDS,
+      s_szMeasureCacheEfficiencyDoc },
+    { "measure_overdraw",         KEYWORDS_FUNCTION(PyMeasureOverdraw),        METH_VARARGS | METH_KEYWORDS,
+      s_szMeasureOverdrawDoc },
+    { NULL, NULL, 0, NULL }
+};
+
+/// Releases the resources of the library when the module is unloaded
+static void FreeModule(void*)
+{
+    TootleCleanup();
+}
+
+static PyModuleDef s_module =
+{
+    PyModuleDef_HEAD_INIT,
+    "tootle",
+    "AMD Tootle triangle order optimization.  See the documentation of tootlelib.h for the algorithms.",
+    -1,
+    s_methods,
+    NULL,
+    NULL,
+    NULL,
+    FreeModule
+};
+
+PyMODINIT_FUNC PyInit_tootle(void)
+{
+    TootleResult eResult = TootleInit();
+
+    if (eResult != TOOTLE_OK)
+    {
+        PyErr_Format(PyExc_ImportError, "TootleInit failed (%d)", (int) eResult);
+        return NULL;
+    }
+
+    PyObject* pModule = PyModule_Create(&s_module);
+
+    if (!pModule)
+    {
+        return NULL;
+    }
+
+    s_pTootleError = PyErr_NewException("tootle.TootleError", PyExc_RuntimeError, NULL);
+
+    if (!s_pTootleError || PyModule_AddObject(pModule, "TootleError", s_pTootleError) != 0)
+    {
+        Py_DECREF(pModule);
+        return NULL;
+    }
+
+    Py_INCREF(s_pTootleError);
+
+    static const struct
+    {
+        const char* pszName;
+        long        nValue;
+    } constants[] =
+    {
+        { "CCW",                        TOOTLE_CCW },
+        { "CW",                         TOOTLE_CW },
+        { "VCACHE_AUTO",                TOOTLE_VCACHE_AUTO },
+        { "VCACHE_DIRECT3D",            TOOTLE_VCACHE_DIRECT3D },
+        { "VCACHE_LSTRIPS",             TOOTLE_VCACHE_LSTRIPS },
+        { "VCACHE_TIPSY",               TOOTLE_VCACHE_TIPSY },
+        { "VCACHE_TIPSY_COMPRESS",      TOOTLE_VCACHE_TIPSY_COMPRESS },
+        { "OVERDRAW_AUTO",              TOOTLE_OVERDRAW_AUTO },
+        { "OVERDRAW_DIRECT3D",          TOOTLE_OVERDRAW_DIRECT3D },
+        { "OVERDRAW_RAYTRACE",          TOOTLE_OVERDRAW_RAYTRACE },
+        { "OVERDRAW_FAST",              TOOTLE_OVERDRAW_FAST },
+        { "OVERDRAW_COST_PLAIN",        TOOTLE_OVERDRAW_COST_PLAIN },
+        { "OVERDRAW_COST_HIZ",          TOOTLE_OVERDRAW_COST_HIZ },
+        { "OVERDRAW_COST_PREPASS",      TOOTLE_OVERDRAW_COST_PREPASS },
+        { "VIEWPOINT_GEODESIC",         TOOTLE_VIEWPOINT_GEODESIC },
+        { "VIEWPOINT_FIBONACCI",        TOOTLE_VIEWPOINT_FIBONACCI },
+        { "VMEMORY_FIRST_USE",          TOOTLE_VMEMORY_FIRST_USE },
+        { "VMEMORY_FETCH_AWARE",        TOOTLE_VMEMORY_FETCH_AWARE },
+        { "FUNCTION_OPTIMIZE_VCACHE",   TOOTLE_FUNCTION_OPTIMIZE_VCACHE },
+        { "FUNCTION_CLUSTER_MESH",      TOOTLE_FUNCTION_CLUSTER_MESH },
+        { "FUNCTION_VCACHE_CLUSTERS",   TOOTLE_FUNCTION_VCACHE_CLUSTERS },
+        { "FUNCTION_OPTIMIZE_OVERDRAW", TOOTLE_FUNCTION_OPTIMIZE_OVERDRAW },
+        { "FUNCTION_MEASURE_OVERDRAW",  TOOTLE_FUNCTION_MEASURE_OVERDRAW },
+        { "FUNCTION_OPTIMIZE",          TOOTLE_FUNCTION_OPTIMIZE },
+        { "FUNCTION_FAST_OPTIMIZE",     TOOTLE_FUNCTION_FAST_OPTIMIZE },
+        { "DEFAULT_VCACHE_SIZE",        TOOTLE_DEFAULT_VCACHE_SIZE },
+    };
+
+    for (size_t i = 0; i < sizeof(constants) / sizeof(constants[0]); i++)
+    {
+        if (PyModule_AddIntConstant(pModule, constants[i].pszName, constants[i].nValue) != 0)
+        {
+            Py_DECREF(pModule);
+            return NULL;
+        }
+    }
+
+    if (PyModule_AddObject(pModule, "DEFAULT_ALPHA", PyFloat_FromDouble(TOOTLE_DEFAULT_ALPHA)) != 0)
+    {
+        Py_DECREF(pModule);
+        return NULL;
+    }
+
+    return pModule;
+}
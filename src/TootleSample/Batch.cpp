@@ -0,0 +1,945 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+// Batch mode of the sample application.  A directory of OBJ files, or a manifest file listing them, is optimized with the
+// settings given on the command line.  Meshes are processed by a pool of worker threads, and the statistics of all meshes
+// are written to a single CSV or JSON report.
+//
+// The Tootle library keeps global state in the overdraw module and the feedback arc set solver, so OptimizeMesh() takes turns
+// with the other workers for the overdraw orderings that render the clusters and for the Direct3D overdraw measurement.
+// Everything else, the vertex cache and fast overdraw optimizations included, runs in parallel.
+//
+// Optionally, results are kept in a content addressed cache.  A result is identified by the hash of the OBJ file together
+// with every setting that influences the output, so a batch that is run again only optimizes the meshes that changed.
+
+// ignore VC++ warnings about fopen, sprintf, etc being deprecated
+#if defined( _MSC_VER )
+    #if _MSC_VER >= 1400
+        #define _CRT_SECURE_NO_DEPRECATE
+    #endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <direct.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+    #include <sys/types.h>
+#endif
+
+#include "Timer.h"
+#include "Tootle.h"
+
+#define RESULTCACHE_MAGIC   0x52435454u   // "TTCR"
+#define RESULTCACHE_VERSION 4u
+
+/// The statistics record stored next to each cached result
+struct ResultCacheRecord
+{
+    uint32_t    nMagic;
+    uint32_t    nVersion;
+    uint32_t    nVertices;
+    uint32_t    nFaces;
+    TootleStats stats;
+}; // End of ResultCacheRecord
+
+
+/// The outcome of processing one mesh
+struct BatchResult
+{
+    BatchResult() : bSucceeded(false), bCached(false), nVertices(0), nFaces(0)
+    {
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    bool         bSucceeded;
+    bool         bCached;         // true if the result was taken from the result cache
+    unsigned int nVertices;
+    unsigned int nFaces;
+    TootleStats  stats;
+}; // End of BatchResult
+
+
+/// The state shared by all workers
+struct BatchContext
+{
+    const TootleSettings*    pSettings;
+    const float*             pViewpoints;
+    unsigned int             nViewpoints;
+    uint64_t                 nViewpointHash;
+    std::vector<std::string> meshes;
+    std::vector<BatchResult> results;
+    std::atomic<size_t>      nNextMesh;
+}; // End of BatchContext
+
+
+//=================================================================================================================================
+//
+//          File system helpers
+//
+//=================================================================================================================================
+
+static bool IsPathSeparator(char c)
+{
+#ifdef _WIN32
+    return c == '/' || c == '\\' || c == ':';
+#else
+    return c == '/';
+#endif
+}
+
+static bool IsAbsolutePath(const std::string& strPath)
+{
+#ifdef _WIN32
+    return (strPath.size() > 1 && strPath[1] == ':') || (!strPath.empty() && IsPathSeparator(strPath[0]));
+#else
+    return !strPath.empty() && strPath[0] == '/';
+#endif
+}
+
+static std::string JoinPath(const std::string& strDirectory, const std::string& strName)
+{
+    if (strDirectory.empty() || IsPathSeparator(strDirectory[strDirectory.size() - 1]))
+    {
+        return strDirectory + strName;
+    }
+
+    return strDirectory + "/" + strName;
+}
+
+static std::string GetFileName(const std::string& strPath)
+{
+    size_t i = strPath.size();
+
+    while (i > 0 && !IsPathSeparator(strPath[i - 1]))
+    {
+        i--;
+    }
+
+    return strPath.substr(i);
+}
+
+static std::string GetDirectory(const std::string& strPath)
+{
+    return strPath.substr(0, strPath.size() - GetFileName(strPath).size());
+}
+
+static bool HasExtension(const std::string& strName, const char* pExtension)
+{
+    size_t nLength = strlen(pExtension);
+
+    if (strName.size() < nLength)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < nLength; i++)
+    {
+        if (tolower((unsigned char) strName[strName.size() - nLength + i]) != tolower((unsigned char) pExtension[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool IsDirectory(const char* pPath)
+{
+#ifdef _WIN32
+    DWORD nAttributes = GetFileAttributesA(pPath);
+    return nAttributes != INVALID_FILE_ATTRIBUTES && (nAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+    struct stat info;
+    return stat(pPath, &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
+
+static bool MakeDirectory(const char* pPath)
+{
+    if (IsDirectory(pPath))
+    {
+        return true;
+    }
+
+#ifdef _WIN32
+    return _mkdir(pPath) == 0;
+#else
+    return mkdir(pPath, 0777) == 0;
+#endif
+}
+
+static bool FileExists(const std::string& strPath)
+{
+    FILE* pFile = fopen(strPath.c_str(), "rb");
+
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    fclose(pFile);
+    return true;
+}
+
+//=================================================================================================================================
+/// Collects the OBJ files in a directory, sorted by name so that reports do not depend on the directory order
+/// \param pDirectory  The directory
+/// \param rMeshes     Receives the paths of the OBJ files
+/// \return False if the directory could not be read
+//=================================================================================================================================
+static bool ListDirectory(const char* pDirectory, std::vector<std::string>& rMeshes)
+{
+    std::vector<std::string> names;
+
+#ifdef _WIN32
+    WIN32_FIND_DATAA findData;
+    HANDLE hFind = FindFirstFileA(JoinPath(pDirectory, "*.obj").c_str(), &findData);
+
+    if (hFind == INVALID_HANDLE_VALUE)
+    {
+        return GetLastError() == ERROR_FILE_NOT_FOUND;
+    }
+
+    do
+    {
+        if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+        {
+            names.push_back(findData.cFileName);
+        }
+    }
+    while (FindNextFileA(hFind, &findData));
+
+    FindClose(hFind);
+#else
+    DIR* pDir = opendir(pDirectory);
+
+    if (pDir == NULL)
+    {
+        return false;
+    }
+
+    struct dirent* pEntry;
+
+    while ((pEntry = readdir(pDir)) != NULL)
+    {
+        std::string strName = pEntry->d_name;
+
+        if (HasExtension(strName, ".obj") && !IsDirectory(JoinPath(pDirectory, strName).c_str()))
+        {
+            names.push_back(strName);
+        }
+    }
+
+    closedir(pDir);
+#endif
+
+    std::sort(names.begin(), names.end());
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        rMeshes.push_back(JoinPath(pDirectory, names[i]));
+    }
+
+    return true;
+}
+
+//=================================================================================================================================
+/// Reads a manifest file.  Each line holds the path of one OBJ file, relative paths are relative to the manifest.
+/// Empty lines and lines starting with '#' are ignored.
+/// \param pFileName  The manifest file
+/// \param rMeshes    Receives the paths of the OBJ files
+/// \return False if the manifest could not be read
+//=================================================================================================================================
+static bool ReadManifest(const char* pFileName, std::vector<std::string>& rMeshes)
+{
+    MappedFile manifest;
+
+    if (!manifest.Open(pFileName))
+    {
+        return false;
+    }
+
+    std::string strBase = GetDirectory(pFileName);
+
+    const char* p    = manifest.GetData();
+    const char* pEnd = p + manifest.GetSize();
+
+    while (p < pEnd)
+    {
+        const char* pLineEnd = (const char*) memchr(p, '\n', pEnd - p);
+
+        if (pLineEnd == NULL)
+        {
+            pLineEnd = pEnd;
+        }
+
+        const char* pFirst = p;
+        const char* pLast  = pLineEnd;
+
+        while (pFirst < pLast && isspace((unsigned char) *pFirst))
+        {
+            pFirst++;
+        }
+
+        while (pLast > pFirst && isspace((unsigned char) pLast[-1]))
+        {
+            pLast--;
+        }
+
+        if (pFirst < pLast && *pFirst != '#')
+        {
+            std::string strPath(pFirst, pLast);
+            rMeshes.push_back(IsAbsolutePath(strPath) ? strPath : JoinPath(strBase, strPath));
+        }
+
+        p = pLineEnd + 1;
+    }
+
+    return true;
+}
+
+//=================================================================================================================================
+/// Copies a file
+/// \return False if the source could not be read or the destination could not be written
+//=================================================================================================================================
+static bool CopyFileContents(const std::string& strSource, const std::string& strDestination)
+{
+    MappedFile source;
+
+    if (!source.Open(strSource.c_str()))
+    {
+        return false;
+    }
+
+    FILE* pFile = fopen(strDestination.c_str(), "wb");
+
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    bool bResult = (fwrite(source.GetData(), 1, source.GetSize(), pFile) == source.GetSize());
+
+    if (fclose(pFile) != 0)
+    {
+        bResult = false;
+    }
+
+    return bResult;
+}
+
+//=================================================================================================================================
+/// Moves a finished temporary file to its final name
+//=================================================================================================================================
+static bool ReplaceFile(const std::string& strTempName, const std::string& strFileName)
+{
+#ifdef _WIN32
+    // rename() does not replace existing files on Windows
+    remove(strFileName.c_str());
+#endif
+
+    if (rename(strTempName.c_str(), strFileName.c_str()) != 0)
+    {
+        remove(strTempName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+//=================================================================================================================================
+//
+//          Result cache
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Computes the result cache key of a mesh: the hash of the OBJ file combined with every setting that changes the output
+//=================================================================================================================================
+static uint64_t ComputeResultKey(const BatchContext& rContext, const SampleMesh& rMesh)
+{
+    const TootleSettings& settings = *rContext.pSettings;
+
+    // every negative overdraw weight means that alpha is not chosen
+    uint32_t nOverdrawWeight = 0xffffffffu;
+
+    if (settings.fOverdrawWeight >= 0)
+    {
+        memcpy(&nOverdrawWeight, &settings.fOverdrawWeight, sizeof(nOverdrawWeight));
+    }
+
+    uint64_t key[] =
+    {
+        RESULTCACHE_VERSION,
+        rMesh.nObjHash,
+        rMesh.objFile.GetSize(),
+        rContext.nViewpointHash,
+        settings.nClustering,
+        settings.nCacheSize,
+        (uint64_t) settings.eWinding,
+        (uint64_t) settings.algorithmChoice,
+        (uint64_t) settings.eVCacheOptimizer,
+        (uint64_t) settings.eVertexMemoryOptimizer,
+        settings.bOptimizeVertexMemory ? 1u : 0u,
+        settings.bMeasureOverdraw ? 1u : 0u,
+        nOverdrawWeight,
+    };
+
+    return MeshCache::Hash(key, sizeof(key));
+}
+
+static std::string GetResultCacheName(const TootleSettings& settings, uint64_t nKey, const char* pExtension)
+{
+    char strKey[32];
+    sprintf(strKey, "%016llx%s", (unsigned long long) nKey, pExtension);
+
+    return JoinPath(settings.pResultCacheDirectory, strKey);
+}
+
+//=================================================================================================================================
+/// Looks up a mesh in the result cache
+/// \param settings  The sample settings
+/// \param nKey      The result cache key of the mesh
+/// \param rResult   Receives the statistics of the cached result
+/// \return True if the result is cached and, if an output directory is given, the optimized mesh is cached too
+//=================================================================================================================================
+static bool ReadCachedResult(const TootleSettings& settings, uint64_t nKey, BatchResult& rResult)
+{
+    FILE* pFile = fopen(GetResultCacheName(settings, nKey, ".stats").c_str(), "rb");
+
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    ResultCacheRecord record;
+    bool bResult = (fread(&record, sizeof(record), 1, pFile) == 1);
+    fclose(pFile);
+
+    if (!bResult || record.nMagic != RESULTCACHE_MAGIC || record.nVersion != RESULTCACHE_VERSION)
+    {
+        return false;
+    }
+
+    if (settings.pOutputDirectory != NULL && !FileExists(GetResultCacheName(settings, nKey, ".obj")))
+    {
+        return false;
+    }
+
+    rResult.nVertices = record.nVertices;
+    rResult.nFaces    = record.nFaces;
+    rResult.stats     = record.stats;
+    return true;
+}
+
+//=================================================================================================================================
+/// Stores the statistics of a result in the result cache.  The optimized mesh must have been stored before.
+//=================================================================================================================================
+static bool WriteCachedResult(const TootleSettings& settings, uint64_t nKey, const BatchResult& rResult)
+{
+    ResultCacheRecord record;
+    memset(&record, 0, sizeof(record));
+
+    record.nMagic    = RESULTCACHE_MAGIC;
+    record.nVersion  = RESULTCACHE_VERSION;
+    record.nVertices = rResult.nVertices;
+    record.nFaces    = rResult.nFaces;
+    record.stats     = rResult.stats;
+
+    std::string strFileName = GetResultCacheName(settings, nKey, ".stats");
+    std::string strTempName = strFileName + ".tmp";
+
+    FILE* pFile = fopen(strTempName.c_str(), "wb");
+
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    bool bResult = (fwrite(&record, sizeof(record), 1, pFile) == 1);
+
+    if (fclose(pFile) != 0 || !bResult)
+    {
+        remove(strTempName.c_str());
+        return false;
+    }
+
+    return ReplaceFile(strTempName, strFileName);
+}
+
+
+//=================================================================================================================================
+//
+//          Workers
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Writes an optimized mesh, preceded by its statistics, the same way the sample does on standard output
+//=================================================================================================================================
+static bool WriteOptimizedMesh(const std::string& strFileName, const TootleSettings& settings, const SampleMesh& rMesh,
+                               const OptimizedMesh& rOptimized, TootleStats& rStats)
+{
+    std::string strTempName = strFileName + ".tmp";
+
+    FILE* pFile = fopen(strTempName.c_str(), "wb");
+
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    PrintAlgorithm(pFile, settings.eVCacheOptimizer, settings.algorithmChoice, settings.nCacheSize, rStats.nClusters);
+    PrintStats(pFile, &rStats);
+
+    bool bResult = EmitMesh(settings, rMesh, rOptimized, NULL, pFile);
+
+    if (fclose(pFile) != 0 || !bResult)
+    {
+        remove(strTempName.c_str());
+        return false;
+    }
+
+    return ReplaceFile(strTempName, strFileName);
+}
+
+//=================================================================================================================================
+/// Processes one mesh of the batch
+/// \param rContext  The batch
+/// \param nMesh     The index of the mesh in rContext.meshes
+/// \param rResult   Receives the outcome
+//=================================================================================================================================
+static void ProcessMesh(BatchContext& rContext, size_t nMesh, BatchResult& rResult)
+{
+    const TootleSettings& settings = *rContext.pSettings;
+    const std::string& strMeshName = rContext.meshes[nMesh];
+
+    std::string strOutputName;
+
+    if (settings.pOutputDirectory != NULL)
+    {
+        strOutputName = JoinPath(settings.pOutputDirectory, GetFileName(strMeshName));
+    }
+
+    SampleMesh mesh;
+
+    if (!mesh.objFile.Open(strMeshName.c_str()))
+    {
+        std::cerr << "Error loading mesh file: " << strMeshName << std::endl;
+        return;
+    }
+
+    mesh.nObjHash = MeshCache::Hash(mesh.objFile.GetData(), mesh.objFile.GetSize());
+
+    uint64_t nKey = 0;
+
+    if (settings.pResultCacheDirectory != NULL)
+    {
+        nKey = ComputeResultKey(rContext, mesh);
+
+        if (ReadCachedResult(settings, nKey, rResult))
+        {
+            if (!strOutputName.empty() && !CopyFileContents(GetResultCacheName(settings, nKey, ".obj"), strOutputName))
+            {
+                std::cerr << "Unable to write mesh file: " << strOutputName << std::endl;
+                return;
+            }
+
+            rResult.bSucceeded = true;
+            rResult.bCached    = true;
+            return;
+        }
+    }
+
+    // the file is already mapped and hashed, so this only parses it (or reads the binary mesh cache)
+    if (!LoadMesh(settings, strMeshName.c_str(), mesh))
+    {
+        return;
+    }
+
+    rResult.nVertices = mesh.mesh.nVertices;
+    rResult.nFaces    = mesh.mesh.nFaces;
+
+    OptimizedMesh optimized;
+
+    if (!OptimizeMesh(settings, mesh, rContext.pViewpoints, rContext.nViewpoints, optimized, rResult.stats))
+    {
+        std::cerr << "Error optimizing mesh file: " << strMeshName << std::endl;
+        return;
+    }
+
+    if (settings.pResultCacheDirectory != NULL)
+    {
+        // the optimized mesh is written to the cache first and copied from there
+        std::string strCachedName = GetResultCacheName(settings, nKey, ".obj");
+
+        if (!WriteOptimizedMesh(strCachedName, settings, mesh, optimized, rResult.stats) ||
+            !WriteCachedResult(settings, nKey, rResult))
+        {
+            std::cerr << "Unable to write result cache file: " << strCachedName << std::endl;
+        }
+        else if (!strOutputName.empty())
+        {
+            if (!CopyFileContents(strCachedName, strOutputName))
+            {
+                std::cerr << "Unable to write mesh file: " << strOutputName << std::endl;
+                return;
+            }
+
+            strOutputName.clear();
+        }
+    }
+
+    if (!strOutputName.empty() && !WriteOptimizedMesh(strOutputName, settings, mesh, optimized, rResult.stats))
+    {
+        std::cerr << "Unable to write mesh file: " << strOutputName << std::endl;
+        return;
+    }
+
+    rResult.bSucceeded = true;
+}
+
+//=================================================================================================================================
+/// The worker thread function.  Takes meshes from the batch until none are left.
+//=================================================================================================================================
+static void BatchWorker(BatchContext* pContext)
+{
+    size_t nMesh;
+
+    while ((nMesh = pContext->nNextMesh++) < pContext->meshes.size())
+    {
+        BatchResult& rResult = pContext->results[nMesh];
+
+        ProcessMesh(*pContext, nMesh, rResult);
+
+        if (rResult.bSucceeded)
+        {
+            fprintf(stderr, "%s: %u faces, cache %.3f/%.3f, %u clusters%s\n", pContext->meshes[nMesh].c_str(), rResult.nFaces,
+                    rResult.stats.fVCacheIn, rResult.stats.fVCacheOut, rResult.stats.nClusters,
+                    rResult.bCached ? " (cached)" : "");
+        }
+        else
+        {
+            fprintf(stderr, "%s: failed\n", pContext->meshes[nMesh].c_str());
+        }
+    }
+}
+
+
+//=================================================================================================================================
+//
+//          Report
+//
+//=================================================================================================================================
+
+// writes a time column, or nothing if the step was skipped
+static void WriteTime(FILE* fp, double fTime, const char* pSkipped)
+{
+    if (fTime >= 0)
+    {
+        fprintf(fp, "%.4f", fTime);
+    }
+    else
+    {
+        fputs(pSkipped, fp);
+    }
+}
+
+static void WriteJSONString(FILE* fp, const std::string& str)
+{
+    fputc('"', fp);
+
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        unsigned char c = (unsigned char) str[i];
+
+        if (c == '"' || c == '\\')
+        {
+            fputc('\\', fp);
+            fputc(c, fp);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(fp, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, fp);
+        }
+    }
+
+    fputc('"', fp);
+}
+
+static void WriteCSVString(FILE* fp, const std::string& str)
+{
+    fputc('"', fp);
+
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        if (str[i] == '"')
+        {
+            fputc('"', fp);
+        }
+
+        fputc(str[i], fp);
+    }
+
+    fputc('"', fp);
+}
+
+//=================================================================================================================================
+/// Writes the statistics of all meshes to a report file
+/// \param pFileName  The report file.  It is written in JSON format if its name ends in .json, and in CSV format otherwise.
+/// \param rContext   The finished batch
+/// \return False if the file could not be written
+//=================================================================================================================================
+static bool WriteReport(const char* pFileName, const BatchContext& rContext)
+{
+    static const char* s_pTimeNames[] =
+    {
+        "optimize_vcache_time", "cluster_mesh_time", "vcache_clusters_time", "optimize_vcache_and_cluster_mesh_time",
+        "optimize_overdraw_time", "tootle_optimize_time", "tootle_fast_optimize_time", "measure_overdraw_time",
+        "optimize_vertex_memory_time"
+    };
+
+    const size_t nTimes = sizeof(s_pTimeNames) / sizeof(s_pTimeNames[0]);
+
+    FILE* fp = fopen(pFileName, "w");
+
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    bool bJSON = HasExtension(pFileName, ".json");
+
+    if (bJSON)
+    {
+        fprintf(fp, "{\n  \"meshes\": [");
+    }
+    else
+    {
+        fprintf(fp, "mesh,status,cached,vertices,faces,clusters,vcache_in,vcache_out,fetch_in,fetch_out,overfetch_in,"
+                "overfetch_out,index_size_in,index_size_out,overdraw_in,overdraw_out,max_overdraw_in,max_overdraw_out");
+
+        for (size_t j = 0; j < nTimes; j++)
+        {
+            fprintf(fp, ",%s", s_pTimeNames[j]);
+        }
+
+        fprintf(fp, "\n");
+    }
+
+    for (size_t i = 0; i < rContext.meshes.size(); i++)
+    {
+        const BatchResult& rResult = rContext.results[i];
+        const TootleStats& stats   = rResult.stats;
+
+        const double pfTimes[nTimes] =
+        {
+            stats.fOptimizeVCacheTime, stats.fClusterMeshTime, stats.fVCacheClustersTime,
+            stats.fOptimizeVCacheAndClusterMeshTime, stats.fOptimizeOverdrawTime, stats.fTootleOptimizeTime,
+            stats.fTootleFastOptimizeTime, stats.fMeasureOverdrawTime, stats.fOptimizeVertexMemoryTime
+        };
+
+        bool bOverdraw = rResult.bSucceeded && stats.fMeasureOverdrawTime >= 0;
+
+        if (bJSON)
+        {
+            fprintf(fp, "%s\n    { \"mesh\": ", (i > 0) ? "," : "");
+            WriteJSONString(fp, rContext.meshes[i]);
+            fprintf(fp, ", \"status\": \"%s\"", rResult.bSucceeded ? "ok" : "failed");
+
+            if (rResult.bSucceeded)
+            {
+                fprintf(fp, ", \"cached\": %s, \"vertices\": %u, \"faces\": %u, \"clusters\": %u, "
+                        "\"vcache_in\": %g, \"vcache_out\": %g, \"fetch_in\": %g, \"fetch_out\": %g, \"overfetch_in\": %g, "
+                        "\"overfetch_out\": %g, \"index_size_in\": %g, \"index_size_out\": %g",
+                        rResult.bCached ? "true" : "false", rResult.nVertices, rResult.nFaces, stats.nClusters,
+                        stats.fVCacheIn, stats.fVCacheOut, stats.fFetchIn, stats.fFetchOut, stats.fOverfetchIn,
+                        stats.fOverfetchOut, stats.fIndexSizeIn, stats.fIndexSizeOut);
+
+                if (bOverdraw)
+                {
+                    fprintf(fp, ", \"overdraw_in\": %g, \"overdraw_out\": %g, \"max_overdraw_in\": %g, \"max_overdraw_out\": %g",
+                            stats.fOverdrawIn, stats.fOverdrawOut, stats.fMaxOverdrawIn, stats.fMaxOverdrawOut);
+                }
+
+                for (size_t j = 0; j < nTimes; j++)
+                {
+                    fprintf(fp, ", \"%s\": ", s_pTimeNames[j]);
+                    WriteTime(fp, pfTimes[j], "null");
+                }
+            }
+
+            fprintf(fp, " }");
+        }
+        else
+        {
+            WriteCSVString(fp, rContext.meshes[i]);
+            fprintf(fp, ",%s", rResult.bSucceeded ? "ok" : "failed");
+
+            if (rResult.bSucceeded)
+            {
+                fprintf(fp, ",%d,%u,%u,%u,%g,%g,%g,%g,%g,%g,%g,%g", rResult.bCached ? 1 : 0, rResult.nVertices,
+                        rResult.nFaces, stats.nClusters, stats.fVCacheIn, stats.fVCacheOut, stats.fFetchIn, stats.fFetchOut,
+                        stats.fOverfetchIn, stats.fOverfetchOut, stats.fIndexSizeIn, stats.fIndexSizeOut);
+
+                if (bOverdraw)
+                {
+                    fprintf(fp, ",%g,%g,%g,%g", stats.fOverdrawIn, stats.fOverdrawOut, stats.fMaxOverdrawIn,
+                            stats.fMaxOverdrawOut);
+                }
+                else
+                {
+                    fprintf(fp, ",,,,");
+                }
+
+                for (size_t j = 0; j < nTimes; j++)
+                {
+                    fputc(',', fp);
+                    WriteTime(fp, pfTimes[j], "");
+                }
+            }
+            else
+            {
+                for (size_t j = 0; j < 16 + nTimes; j++)
+                {
+                    fputc(',', fp);
+                }
+            }
+
+            fprintf(fp, "\n");
+        }
+    }
+
+    if (bJSON)
+    {
+        fprintf(fp, "\n  ]\n}\n");
+    }
+
+    return fclose(fp) == 0;
+}
+
+
+//=================================================================================================================================
+//
+//          Public functions block
+//
+//=================================================================================================================================
+
+//=================================================================================================================================
+/// Optimizes all meshes of a batch
+/// \param settings     The sample settings.  settings.pBatchInput names a directory or a manifest file.
+/// \param pViewpoints  The viewpoints used for overdraw measurement and optimization, may be NULL
+/// \param nViewpoints  The number of viewpoints
+/// \return The exit code of the sample: 0 if all meshes were processed, 1 otherwise
+//=================================================================================================================================
+int RunBatch(const TootleSettings& settings, const float* pViewpoints, unsigned int nViewpoints)
+{
+    BatchContext context;
+    context.pSettings      = &settings;
+    context.pViewpoints    = pViewpoints;
+    context.nViewpoints    = nViewpoints;
+    context.nViewpointHash = MeshCache::Hash(pViewpoints, nViewpoints * 3 * sizeof(float));
+    context.nNextMesh      = 0;
+
+    bool bListed = IsDirectory(settings.pBatchInput) ? ListDirectory(settings.pBatchInput, context.meshes) :
+                   ReadManifest(settings.pBatchInput, context.meshes);
+
+    if (!bListed)
+    {
+        std::cerr << "Unable to read batch input: " << settings.pBatchInput << std::endl;
+        return 1;
+    }
+
+    if (settings.pOutputDirectory != NULL && !MakeDirectory(settings.pOutputDirectory))
+    {
+        std::cerr << "Unable to create output directory: " << settings.pOutputDirectory << std::endl;
+        return 1;
+    }
+
+    if (settings.pResultCacheDirectory != NULL && !MakeDirectory(settings.pResultCacheDirectory))
+    {
+        std::cerr << "Unable to create result cache directory: " << settings.pResultCacheDirectory << std::endl;
+        return 1;
+    }
+
+    context.results.resize(context.meshes.size());
+
+    TootleResult result = TootleInit();
+
+    if (result != TOOTLE_OK)
+    {
+        DisplayTootleErrorMessage(result);
+        return 1;
+    }
+
+    Timer timer;
+    timer.Reset();
+
+    unsigned int nWorkers = settings.nWorkerThreads;
+
+    if (nWorkers == 0)
+    {
+        nWorkers = std::thread::hardware_concurrency();
+    }
+
+    nWorkers = std::max(1u, std::min(nWorkers, (unsigned int) context.meshes.size()));
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 1; i < nWorkers; i++)
+    {
+        workers.push_back(std::thread(BatchWorker, &context));
+    }
+
+    // the main thread works too
+    BatchWorker(&context);
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+
+    double fTime = timer.GetElapsed();
+
+    TootleCleanup();
+
+    size_t nCached = 0;
+    size_t nFailed = 0;
+
+    for (size_t i = 0; i < context.results.size(); i++)
+    {
+        nCached += context.results[i].bCached ? 1 : 0;
+        nFailed += context.results[i].bSucceeded ? 0 : 1;
+    }
+
+    fprintf(stderr, "\n#Batch: %u meshes (%u cached, %u failed), %u workers, %.4lf seconds\n",
+            (unsigned int) context.meshes.size(), (unsigned int) nCached, (unsigned int) nFailed, nWorkers, fTime);
+
+    if (settings.pReportName != NULL && !WriteReport(settings.pReportName, context))
+    {
+        std::cerr << "Unable to write report file: " << settings.pReportName << std::endl;
+        return 1;
+    }
+
+    return (nFailed == 0) ? 0 : 1;
+}
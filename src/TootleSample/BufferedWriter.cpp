@@ -0,0 +1,271 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+// ignore VC++ warnings about snprintf being deprecated
+#if defined( _MSC_VER )
+    #if _MSC_VER >= 1400
+        #define _CRT_SECURE_NO_DEPRECATE
+    #endif
+#endif
+
+#include <cmath>
+#include "BufferedWriter.h"
+
+#if defined( _MSC_VER ) && _MSC_VER < 1900
+    #define snprintf _snprintf
+#endif
+
+
+BufferedWriter::BufferedWriter(FILE* pFile, size_t nBufferSize) :
+    m_pFile(pFile),
+    m_buffer(nBufferSize < 64 ? 64 : nBufferSize),
+    m_nUsed(0),
+    m_bGood(pFile != NULL)
+{
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    Flush();
+}
+
+
+//=================================================================================================================================
+/// Hands the buffered output to the stream
+/// \return False if the stream reported an error
+//=================================================================================================================================
+bool BufferedWriter::Flush()
+{
+    if (m_nUsed > 0 && m_bGood)
+    {
+        if (fwrite(&m_buffer[0], 1, m_nUsed, m_pFile) != m_nUsed)
+        {
+            m_bGood = false;
+        }
+    }
+
+    m_nUsed = 0;
+    return m_bGood;
+}
+
+
+//=================================================================================================================================
+/// Writes a block that does not fit into the remaining buffer space.  Blocks larger than the buffer bypass it.
+//=================================================================================================================================
+void BufferedWriter::WriteLarge(const char* pData, size_t nSize)
+{
+    Flush();
+
+    if (nSize >= m_buffer.size())
+    {
+        if (m_bGood && fwrite(pData, 1, nSize, m_pFile) != nSize)
+        {
+            m_bGood = false;
+        }
+
+        return;
+    }
+
+    memcpy(&m_buffer[0], pData, nSize);
+    m_nUsed = nSize;
+}
+
+
+//=================================================================================================================================
+/// Writes an unsigned integer in decimal
+//=================================================================================================================================
+void BufferedWriter::Write(unsigned int n)
+{
+    char cDigits[10];
+    int  nDigits = 0;
+
+    do
+    {
+        cDigits[nDigits++] = (char)('0' + n % 10);
+        n /= 10;
+    }
+    while (n != 0);
+
+    char* p = Reserve(nDigits);
+
+    while (nDigits > 0)
+    {
+        *p++ = cDigits[--nDigits];
+    }
+
+    m_nUsed = p - &m_buffer[0];
+}
+
+
+//=================================================================================================================================
+/// Writes a float with 6 significant digits, choosing between fixed and scientific notation and removing trailing zeros
+/// exactly like printf's %g.  The value is rounded with one double precision multiply or divide by an exact power of ten;
+/// values too close to a rounding boundary for that to be reliable, and values outside the range of exact powers, are
+/// formatted with snprintf instead.
+//=================================================================================================================================
+void BufferedWriter::Write(float f)
+{
+    static const double s_pPow10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    char* pStart = Reserve(32);
+    char* p      = pStart;
+    double x     = f;
+
+    if (x != x || x - x != 0.0)
+    {
+        // nan or inf
+        m_nUsed += snprintf(pStart, 32, "%g", x);
+        return;
+    }
+
+    if (x < 0.0 || (x == 0.0 && 1.0 / x < 0.0))
+    {
+        *p++ = '-';
+        x = -x;
+    }
+
+    if (x == 0.0)
+    {
+        *p++ = '0';
+        m_nUsed += p - pStart;
+        return;
+    }
+
+    // find the decimal exponent, and scale the value to 6 digits before the decimal point
+    int nExp = (int) floor(log10(x));
+    double fScaled = 0.0;
+    bool bExact = false;
+
+    int nAttempt;
+
+    for (nAttempt = 0; nAttempt < 3; nAttempt++)
+    {
+        int nShift = 5 - nExp;
+
+        if (nShift > 22 || nShift < -22)
+        {
+            break;
+        }
+
+        fScaled = (nShift >= 0) ? x * s_pPow10[nShift] : x / s_pPow10[-nShift];
+
+        if (fScaled < 100000.0)
+        {
+            nExp--;
+        }
+        else if (fScaled >= 1000000.0)
+        {
+            nExp++;
+        }
+        else
+        {
+            bExact = true;
+            break;
+        }
+    }
+
+    double fRounded = floor(fScaled + 0.5);
+    double fFraction = fScaled - floor(fScaled);
+
+    if (!bExact || fabs(fFraction - 0.5) < 1e-9)
+    {
+        m_nUsed += snprintf(pStart, 32, "%g", (double) f);
+        return;
+    }
+
+    if (fRounded >= 1000000.0)
+    {
+        fRounded = 100000.0;
+        nExp++;
+    }
+
+    unsigned int nMantissa = (unsigned int) fRounded;
+    char cDigits[6];
+    int i;
+
+    for (i = 5; i >= 0; i--)
+    {
+        cDigits[i] = (char)('0' + nMantissa % 10);
+        nMantissa /= 10;
+    }
+
+    // number of significant digits left after dropping trailing zeros
+    int nDigits = 6;
+
+    while (nDigits > 1 && cDigits[nDigits - 1] == '0')
+    {
+        nDigits--;
+    }
+
+    if (nExp < -4 || nExp >= 6)
+    {
+        // scientific notation
+        *p++ = cDigits[0];
+
+        if (nDigits > 1)
+        {
+            *p++ = '.';
+
+            for (i = 1; i < nDigits; i++)
+            {
+                *p++ = cDigits[i];
+            }
+        }
+
+        *p++ = 'e';
+        *p++ = (nExp < 0) ? '-' : '+';
+
+        int nAbsExp = (nExp < 0) ? -nExp : nExp;
+
+        if (nAbsExp >= 100)
+        {
+            *p++ = (char)('0' + nAbsExp / 100);
+        }
+
+        *p++ = (char)('0' + (nAbsExp / 10) % 10);
+        *p++ = (char)('0' + nAbsExp % 10);
+    }
+    else if (nExp >= 0)
+    {
+        // fixed notation, at least one digit before the decimal point
+        for (i = 0; i <= nExp; i++)
+        {
+            *p++ = cDigits[i];
+        }
+
+        if (nDigits > nExp + 1)
+        {
+            *p++ = '.';
+
+            for (i = nExp + 1; i < nDigits; i++)
+            {
+                *p++ = cDigits[i];
+            }
+        }
+    }
+    else
+    {
+        // fixed notation, value below 1
+        *p++ = '0';
+        *p++ = '.';
+
+        for (i = 0; i < -nExp - 1; i++)
+        {
+            *p++ = '0';
+        }
+
+        for (i = 0; i < nDigits; i++)
+        {
+            *p++ = cDigits[i];
+        }
+    }
+
+    m_nUsed += p - pStart;
+}
@@ -0,0 +1,92 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _BUFFEREDWRITER_H_
+#define _BUFFEREDWRITER_H_
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//=================================================================================================================================
+/// \brief A buffered text writer with fast number formatting
+///  Output is collected in a large buffer and handed to the stream in big blocks.  Numbers are formatted exactly like
+///  std::ostream does with its default settings, without going through locales or format strings.
+//=================================================================================================================================
+class BufferedWriter
+{
+public:
+
+    /// \param pFile         The stream to write to.  The writer does not close it.
+    /// \param nBufferSize   The size of the output buffer in bytes
+    BufferedWriter(FILE* pFile, size_t nBufferSize = (1 << 20));
+    ~BufferedWriter();
+
+    /// Writes a block of characters
+    void Write(const char* pData, size_t nSize)
+    {
+        if (nSize > m_buffer.size() - m_nUsed)
+        {
+            WriteLarge(pData, nSize);
+            return;
+        }
+
+        memcpy(&m_buffer[m_nUsed], pData, nSize);
+        m_nUsed += nSize;
+    }
+
+    /// Writes a null terminated string
+    void Write(const char* pString) { Write(pString, strlen(pString)); }
+
+    /// Writes one character
+    void Write(char c)
+    {
+        if (m_nUsed == m_buffer.size())
+        {
+            Flush();
+        }
+
+        m_buffer[m_nUsed++] = c;
+    }
+
+    /// Writes an unsigned integer in decimal
+    void Write(unsigned int n);
+
+    /// Writes a float the way std::ostream does by default (%g with 6 significant digits)
+    void Write(float f);
+
+    /// Hands the buffered output to the stream
+    bool Flush();
+
+    /// Returns false if any write to the stream failed
+    bool IsGood() const { return m_bGood; }
+
+private:
+
+    // not copyable
+    BufferedWriter(const BufferedWriter&);
+    BufferedWriter& operator=(const BufferedWriter&);
+
+    // Writes a block that does not fit into the remaining buffer space
+    void WriteLarge(const char* pData, size_t nSize);
+
+    // Makes sure at least nSize bytes are free in the buffer
+    char* Reserve(size_t nSize)
+    {
+        if (nSize > m_buffer.size() - m_nUsed)
+        {
+            Flush();
+        }
+
+        return &m_buffer[m_nUsed];
+    }
+
+    FILE*             m_pFile;
+    std::vector<char> m_buffer;
+    size_t            m_nUsed;
+    bool              m_bGood;
+}; // End of BufferedWriter
+
+#endif // _BUFFEREDWRITER_H_
@@ -0,0 +1,161 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile() :
+    m_pData(NULL),
+    m_nSize(0),
+    m_bOpen(false)
+#ifdef _WIN32
+    , m_hFile(INVALID_HANDLE_VALUE)
+    , m_hMapping(NULL)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+
+//=================================================================================================================================
+/// Maps the given file into memory for reading
+/// \param strFileName  The file to map
+/// \return False if the file could not be opened or mapped
+//=================================================================================================================================
+bool MappedFile::Open(const char* strFileName)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(strFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(hFile, &size))
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    m_hFile = hFile;
+    m_nSize = (size_t) size.QuadPart;
+
+    if (m_nSize > 0)
+    {
+        m_hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+        if (m_hMapping == NULL)
+        {
+            Close();
+            return false;
+        }
+
+        m_pData = (const char*) MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+
+        if (m_pData == NULL)
+        {
+            Close();
+            return false;
+        }
+    }
+
+#else
+    int fd = open(strFileName, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+
+    m_nSize = (size_t) st.st_size;
+
+    if (m_nSize > 0)
+    {
+        void* pView = mmap(NULL, m_nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (pView == MAP_FAILED)
+        {
+            close(fd);
+            m_nSize = 0;
+            return false;
+        }
+
+        // the whole file is parsed front to back, so ask for aggressive read-ahead
+        madvise(pView, m_nSize, MADV_SEQUENTIAL);
+        m_pData = (const char*) pView;
+    }
+
+    // the mapping keeps its own reference to the file
+    close(fd);
+#endif
+
+    m_bOpen = true;
+    return true;
+}
+
+
+//=================================================================================================================================
+/// Unmaps the file.  Safe to call on a closed object.
+//=================================================================================================================================
+void MappedFile::Close()
+{
+#ifdef _WIN32
+
+    if (m_pData != NULL)
+    {
+        UnmapViewOfFile(m_pData);
+    }
+
+    if (m_hMapping != NULL)
+    {
+        CloseHandle(m_hMapping);
+        m_hMapping = NULL;
+    }
+
+    if (m_hFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+
+#else
+
+    if (m_pData != NULL)
+    {
+        munmap((void*) m_pData, m_nSize);
+    }
+
+#endif
+
+    m_pData = NULL;
+    m_nSize = 0;
+    m_bOpen = false;
+}
@@ -0,0 +1,54 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+#include <cstddef>
+
+//=================================================================================================================================
+/// \brief A read-only memory mapped view of an entire file
+///  The view stays valid until Close() is called or the object is destroyed.  Empty files are opened successfully
+///  and report a NULL data pointer with a size of zero.
+//=================================================================================================================================
+class MappedFile
+{
+public:
+
+    MappedFile();
+    ~MappedFile();
+
+    /// Maps the given file into memory.  Any previously mapped file is closed first.
+    bool Open(const char* strFileName);
+
+    /// Unmaps the file
+    void Close();
+
+    /// Returns true if a file is currently mapped
+    bool IsOpen() const { return m_bOpen; }
+
+    /// Returns a pointer to the first byte of the file
+    const char* GetData() const { return m_pData; }
+
+    /// Returns the size of the file in bytes
+    size_t GetSize() const { return m_nSize; }
+
+private:
+
+    // not copyable
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* m_pData;
+    size_t      m_nSize;
+    bool        m_bOpen;
+
+#ifdef _WIN32
+    void*       m_hFile;
+    void*       m_hMapping;
+#endif
+}; // End of MappedFile
+
+#endif // _MAPPEDFILE_H_
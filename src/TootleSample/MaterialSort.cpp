@@ -12,7 +12,8 @@ typedef unsigned int UINT;
 //=================================================================================================================================
 /// A utility function to sort the materials in a mesh to minimize overdraw, without optimizing within materials.  This kind of
 ///  optimization can be very effective by itself, or it can be combined with inter-material optimization for even better results.
-///  This function is currently not used in the sample, it is provided for illustrative purposes only.
+///  This function is currently not used in the sample, it is provided for illustrative purposes only.  To optimize within
+///  materials as well, use TootleOptimizeSubmeshes, which also returns a material order.
 ///
 ///  - pTriMaterialIDs is an array containing a material index for each triangle
 ///  - nMaterials is the number of materials in the mesh
@@ -0,0 +1,338 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+
+// ignore VC++ warnings about fopen being deprecated
+#if defined( _MSC_VER )
+    #if _MSC_VER >= 1400
+        #define _CRT_SECURE_NO_DEPRECATE
+    #endif
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "MeshCache.h"
+
+// alignment of every section in the file
+#define MESHCACHE_ALIGNMENT 16
+
+
+//=================================================================================================================================
+//
+//          Internal functions block
+//
+//=================================================================================================================================
+
+static inline uint64_t RotateLeft(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t MixBlock(uint64_t h, uint64_t k)
+{
+    k *= 0x87C37B91114253D5ull;
+    k  = RotateLeft(k, 31);
+    k *= 0x4CF5AD432745937Full;
+
+    h ^= k;
+    h  = RotateLeft(h, 27);
+    return h * 5 + 0x52DCE729;
+}
+
+static inline size_t AlignUp(size_t n)
+{
+    return (n + MESHCACHE_ALIGNMENT - 1) & ~(size_t)(MESHCACHE_ALIGNMENT - 1);
+}
+
+
+//=================================================================================================================================
+/// Appends one section to the payload of a cache file
+/// \param rPayload   The payload, which starts right after the header
+/// \param rSection   Receives the location of the section in the file
+/// \param pData      The contents of the section, or NULL if it is absent
+/// \param nSize      The size of the section in bytes
+//=================================================================================================================================
+static void AppendSection(std::vector<char>& rPayload, MeshCacheSection& rSection, const void* pData, size_t nSize)
+{
+    if (pData == NULL || nSize == 0)
+    {
+        rSection.nOffset = 0;
+        rSection.nSize   = 0;
+        return;
+    }
+
+    size_t nStart = AlignUp(rPayload.size());
+
+    rSection.nOffset = sizeof(MeshCacheHeader) + nStart;
+    rSection.nSize   = nSize;
+
+    rPayload.resize(AlignUp(nStart + nSize), 0);
+    memcpy(&rPayload[nStart], pData, nSize);
+}
+
+
+//=================================================================================================================================
+/// Returns a pointer to a section of a mapped cache file, or NULL if it is absent or malformed
+/// \param pFile     The start of the mapped file
+/// \param nFileSize The size of the mapped file
+/// \param rSection  The section
+/// \param nSize     The size the section must have
+//=================================================================================================================================
+static const void* GetSection(const char* pFile, size_t nFileSize, const MeshCacheSection& rSection, uint64_t nSize)
+{
+    if (rSection.nOffset == 0 ||
+        rSection.nSize != nSize ||
+        rSection.nOffset % MESHCACHE_ALIGNMENT != 0 ||
+        rSection.nOffset > nFileSize ||
+        rSection.nSize > nFileSize - rSection.nOffset)
+    {
+        return NULL;
+    }
+
+    return pFile + rSection.nOffset;
+}
+
+
+//=================================================================================================================================
+//
+//          Public methods block
+//
+//=================================================================================================================================
+
+
+//=================================================================================================================================
+/// Computes a 64 bit hash of a block of memory.  This is not a cryptographic hash; it is only meant to detect stale or
+/// damaged cache files.  It consumes 8 bytes per step, so hashing a source file is much cheaper than parsing it.
+/// \param pData  The data to hash
+/// \param nSize  The size of the data in bytes
+/// \return The hash value
+//=================================================================================================================================
+uint64_t MeshCache::Hash(const void* pData, size_t nSize)
+{
+    const unsigned char* pBytes = (const unsigned char*) pData;
+
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ ((uint64_t) nSize * 0xC2B2AE3D27D4EB4Full);
+
+    size_t nBlocks = nSize / 8;
+    size_t i;
+
+    for (i = 0; i < nBlocks; i++)
+    {
+        uint64_t k;
+        memcpy(&k, pBytes + i * 8, sizeof(k));
+        h = MixBlock(h, k);
+    }
+
+    size_t nTail = nSize - nBlocks * 8;
+
+    if (nTail > 0)
+    {
+        uint64_t k = 0;
+        memcpy(&k, pBytes + nBlocks * 8, nTail);
+        h = MixBlock(h, k);
+    }
+
+    // final avalanche
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+
+    return h;
+}
+
+
+//=================================================================================================================================
+/// Maps a cache file and validates it.  On success the arrays in GetData() point into the mapped file.
+/// \param strFileName  The cache file
+/// \param nSourceSize  The size of the file the mesh should have been built from
+/// \param nSourceHash  The hash of the file the mesh should have been built from
+/// \return False if the file does not exist, is malformed, or is out of date
+//=================================================================================================================================
+bool MeshCache::Open(const char* strFileName, uint64_t nSourceSize, uint64_t nSourceHash)
+{
+    Close();
+
+    if (!m_file.Open(strFileName))
+    {
+        return false;
+    }
+
+    const char* pFile = m_file.GetData();
+    size_t nFileSize  = m_file.GetSize();
+
+    if (nFileSize < sizeof(MeshCacheHeader))
+    {
+        Close();
+        return false;
+    }
+
+    MeshCacheHeader header;
+    memcpy(&header, pFile, sizeof(header));
+
+    if (header.nMagic != MESHCACHE_MAGIC ||
+        header.nVersion != MESHCACHE_VERSION ||
+        header.nHeaderSize != sizeof(MeshCacheHeader) ||
+        header.nSourceSize != nSourceSize ||
+        header.nSourceHash != nSourceHash ||
+        header.nVertices == 0 || header.nFaces == 0)
+    {
+        Close();
+        return false;
+    }
+
+    if (Hash(pFile + sizeof(header), nFileSize - sizeof(header)) != header.nContentHash)
+    {
+        Close();
+        return false;
+    }
+
+    uint64_t nVertices = header.nVertices;
+    uint64_t nFaces    = header.nFaces;
+    bool b16BitIndices = (header.nFlags & MESHCACHE_FLAG_16BIT_INDICES) != 0;
+
+    m_data.nVertices   = header.nVertices;
+    m_data.nFaces      = header.nFaces;
+    m_data.pfPositions = (const float*) GetSection(pFile, nFileSize, header.positions, nVertices * 3 * sizeof(float));
+    m_data.pfNormals   = (const float*) GetSection(pFile, nFileSize, header.normals, nVertices * 3 * sizeof(float));
+    m_data.pfTexCoords = (const float*) GetSection(pFile, nFileSize, header.texCoords, nVertices * 2 * sizeof(float));
+    m_data.pSources    = (const MeshCacheSource*) GetSection(pFile, nFileSize, header.sources,
+                                                             nVertices * sizeof(MeshCacheSource));
+    m_data.pnClusters  = (const unsigned int*) GetSection(pFile, nFileSize, header.clusters, (nFaces + 1) * sizeof(uint32_t));
+
+    if (b16BitIndices)
+    {
+        m_data.pnIndices16 = (const unsigned short*) GetSection(pFile, nFileSize, header.indices, nFaces * 3 * sizeof(uint16_t));
+    }
+    else
+    {
+        m_data.pnIndices = (const unsigned int*) GetSection(pFile, nFileSize, header.indices, nFaces * 3 * sizeof(uint32_t));
+    }
+
+    // positions and indices are mandatory
+    if (m_data.pfPositions == NULL || (m_data.pnIndices == NULL && m_data.pnIndices16 == NULL))
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+//=================================================================================================================================
+/// Unmaps the cache file.  The arrays returned by GetData() become invalid.
+//=================================================================================================================================
+void MeshCache::Close()
+{
+    m_file.Close();
+    m_data = MeshCacheData();
+}
+
+
+//=================================================================================================================================
+/// Writes a mesh to a cache file
+/// \param strFileName    The file to write
+/// \param rData          The mesh.  Positions and one of the index arrays are required.
+/// \param b16BitIndices  If true, 32 bit indices are stored as 16 bit indices when the mesh has at most 65536 vertices
+/// \param nSourceSize    The size of the file the mesh was built from
+/// \param nSourceHash    The hash of the file the mesh was built from
+/// \return False if the mesh is incomplete or the file could not be written
+//=================================================================================================================================
+bool MeshCache::Write(const char* strFileName, const MeshCacheData& rData, bool b16BitIndices,
+                      uint64_t nSourceSize, uint64_t nSourceHash)
+{
+    if (rData.nVertices == 0 || rData.nFaces == 0 || rData.pfPositions == NULL ||
+        (rData.pnIndices == NULL && rData.pnIndices16 == NULL))
+    {
+        return false;
+    }
+
+    size_t nVertices = rData.nVertices;
+    size_t nIndices  = (size_t) rData.nFaces * 3;
+
+    MeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+
+    header.nMagic      = MESHCACHE_MAGIC;
+    header.nVersion    = MESHCACHE_VERSION;
+    header.nHeaderSize = sizeof(MeshCacheHeader);
+    header.nVertices   = rData.nVertices;
+    header.nFaces      = rData.nFaces;
+    header.nSourceSize = nSourceSize;
+    header.nSourceHash = nSourceHash;
+
+    std::vector<char> payload;
+
+    AppendSection(payload, header.positions, rData.pfPositions, nVertices * 3 * sizeof(float));
+    AppendSection(payload, header.normals,   rData.pfNormals,   nVertices * 3 * sizeof(float));
+    AppendSection(payload, header.texCoords, rData.pfTexCoords, nVertices * 2 * sizeof(float));
+    AppendSection(payload, header.sources,   rData.pSources,    nVertices * sizeof(MeshCacheSource));
+
+    if (rData.pnIndices16 != NULL)
+    {
+        header.nFlags |= MESHCACHE_FLAG_16BIT_INDICES;
+        AppendSection(payload, header.indices, rData.pnIndices16, nIndices * sizeof(uint16_t));
+    }
+    else if (b16BitIndices && rData.nVertices <= 65536)
+    {
+        std::vector<uint16_t> indices16(nIndices);
+
+        size_t i;
+
+        for (i = 0; i < nIndices; i++)
+        {
+            indices16[i] = (uint16_t) rData.pnIndices[i];
+        }
+
+        header.nFlags |= MESHCACHE_FLAG_16BIT_INDICES;
+        AppendSection(payload, header.indices, &indices16[0], nIndices * sizeof(uint16_t));
+    }
+    else
+    {
+        AppendSection(payload, header.indices, rData.pnIndices, nIndices * sizeof(uint32_t));
+    }
+
+    AppendSection(payload, header.clusters, rData.pnClusters, ((size_t) rData.nFaces + 1) * sizeof(uint32_t));
+
+    header.nContentHash = Hash(payload.empty() ? NULL : &payload[0], payload.size());
+
+    // write to a temporary file first, so readers never see a partially written cache
+    std::string strTempName = std::string(strFileName) + ".tmp";
+
+    FILE* pFile = fopen(strTempName.c_str(), "wb");
+
+    if (pFile == NULL)
+    {
+        return false;
+    }
+
+    bool bResult = (fwrite(&header, sizeof(header), 1, pFile) == 1) &&
+                   (fwrite(&payload[0], 1, payload.size(), pFile) == payload.size());
+
+    if (fclose(pFile) != 0)
+    {
+        bResult = false;
+    }
+
+#ifdef _WIN32
+    // rename() does not replace existing files on Windows
+    if (bResult)
+    {
+        remove(strFileName);
+    }
+#endif
+
+    if (!bResult || rename(strTempName.c_str(), strFileName) != 0)
+    {
+        remove(strTempName.c_str());
+        return false;
+    }
+
+    return bResult;
+}
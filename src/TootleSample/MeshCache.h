@@ -0,0 +1,126 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _MESHCACHE_H_
+#define _MESHCACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MappedFile.h"
+
+//..............................................................................................................//
+//..............................................................................................................//
+//..............................................................................................................//
+// Binary mesh cache file structure
+//
+//  All values are little endian.  The file starts with a MeshCacheHeader, followed by the sections listed in it.
+//  Every section starts on a 16 byte boundary so that it can be used in place once the file is memory mapped.
+//
+//   positions   nVertices * 3 floats
+//   normals     nVertices * 3 floats                   (optional)
+//   texcoords   nVertices * 2 floats                   (optional)
+//   sources     nVertices * MeshCacheSource            (optional)
+//   indices     nFaces * 3 uint32 or uint16
+//   clusters    nFaces + 1 uint32, in the "full" format (optional)
+//..............................................................................................................//
+//..............................................................................................................//
+//..............................................................................................................//
+
+#define MESHCACHE_MAGIC                 0x434D5454u   // "TTMC"
+#define MESHCACHE_VERSION               1u
+
+#define MESHCACHE_FLAG_16BIT_INDICES    0x1u          // the index section holds 16 bit indices
+
+/// The elements of the source OBJ file a vertex was built from.  Indices are 1 based, 0 means not present.
+struct MeshCacheSource
+{
+    uint32_t nVertexIndex;
+    uint32_t nTexcoordIndex;
+    uint32_t nNormalIndex;
+}; // End of MeshCacheSource
+
+
+/// A section of the cache file
+struct MeshCacheSection
+{
+    uint64_t nOffset;     // from the start of the file, 0 if the section is absent
+    uint64_t nSize;       // in bytes
+}; // End of MeshCacheSection
+
+
+/// The header at the start of every mesh cache file
+struct MeshCacheHeader
+{
+    uint32_t         nMagic;
+    uint32_t         nVersion;
+    uint32_t         nFlags;
+    uint32_t         nHeaderSize;
+    uint32_t         nVertices;
+    uint32_t         nFaces;
+    uint64_t         nSourceSize;     // size of the file the mesh was built from
+    uint64_t         nSourceHash;     // MeshCache::Hash() of the file the mesh was built from
+    uint64_t         nContentHash;    // MeshCache::Hash() of everything after the header
+    MeshCacheSection positions;
+    MeshCacheSection normals;
+    MeshCacheSection texCoords;
+    MeshCacheSection sources;
+    MeshCacheSection indices;
+    MeshCacheSection clusters;
+}; // End of MeshCacheHeader
+
+
+/// A view of a mesh, either built by the caller or pointing into a mapped cache file
+struct MeshCacheData
+{
+    MeshCacheData() :
+        nVertices(0), nFaces(0), pfPositions(NULL), pfNormals(NULL), pfTexCoords(NULL), pSources(NULL),
+        pnIndices(NULL), pnIndices16(NULL), pnClusters(NULL)
+    {
+    }
+
+    unsigned int           nVertices;
+    unsigned int           nFaces;
+    const float*           pfPositions;    // 3 floats per vertex
+    const float*           pfNormals;      // 3 floats per vertex, may be NULL
+    const float*           pfTexCoords;    // 2 floats per vertex, may be NULL
+    const MeshCacheSource* pSources;       // may be NULL
+    const unsigned int*    pnIndices;      // 32 bit triangle list.  Exactly one of pnIndices and pnIndices16 is set.
+    const unsigned short*  pnIndices16;    // 16 bit triangle list
+    const unsigned int*    pnClusters;     // nFaces + 1 entries, may be NULL
+}; // End of MeshCacheData
+
+
+//=================================================================================================================================
+/// \brief Reads and writes the binary mesh cache format
+///  A cache file is only accepted if it was built from a source file with the same size and hash, and its contents are
+///  intact.  The arrays returned by GetData() point directly into the mapped file and remain valid until Close().
+//=================================================================================================================================
+class MeshCache
+{
+public:
+
+    /// Maps a cache file and validates it against its source
+    bool Open(const char* strFileName, uint64_t nSourceSize, uint64_t nSourceHash);
+
+    /// Unmaps the cache file
+    void Close();
+
+    /// Returns the mesh stored in the mapped cache file
+    const MeshCacheData& GetData() const { return m_data; }
+
+    /// Writes a mesh to a cache file.  32 bit indices are narrowed to 16 bits if b16BitIndices is set and they fit.
+    static bool Write(const char* strFileName, const MeshCacheData& rData, bool b16BitIndices,
+                      uint64_t nSourceSize, uint64_t nSourceHash);
+
+    /// Computes the 64 bit content hash used by the cache
+    static uint64_t Hash(const void* pData, size_t nSize);
+
+private:
+
+    MappedFile    m_file;
+    MeshCacheData m_data;
+}; // End of MeshCache
+
+#endif // _MESHCACHE_H_
@@ -10,7 +10,7 @@
 //
 //=================================================================================================================================
 
-// ignore VC++ warnings about fopen, fscanf, etc being deprecated
+// ignore VC++ warnings about strncpy, etc being deprecated
 #if defined( _MSC_VER )
     #if _MSC_VER >= 1400
         #define _CRT_SECURE_NO_DEPRECATE
@@ -19,20 +19,99 @@
 
 
 #include "ObjLoader.h"
-#include <assert.h>
-#include <cstdio>
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
-#include <map>
+#include <thread>
+#include <utility>
 
 
+// Files are only split across threads in pieces of at least this many bytes
+#define OBJ_MIN_CHUNK_SIZE (1 << 20)
+
+// Marks an empty slot in the vertex hash table
+#define OBJ_EMPTY_SLOT 0xFFFFFFFFu
 
 
 //=================================================================================================================================
 //
-//          Constructor(s) / Destructor(s) Block
+//          Internal functions block
 //
 //=================================================================================================================================
 
+static inline bool IsBlank(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\r');
+}
+
+static inline bool IsDigit(char c)
+{
+    return (c >= '0' && c <= '9');
+}
+
+static inline const char* SkipBlanks(const char* p, const char* pEnd)
+{
+    while (p < pEnd && IsBlank(*p))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static inline const char* SkipToNextLine(const char* p, const char* pEnd)
+{
+    const char* pNewLine = (const char*) memchr(p, '\n', pEnd - p);
+    return (pNewLine == NULL) ? pEnd : pNewLine + 1;
+}
+
+
+//=================================================================================================================================
+/// Parses an optionally signed integer
+/// \param p       The first character to parse
+/// \param pEnd    The end of the buffer
+/// \param rnValue Receives the parsed value, or 0 if there is no number
+/// \return A pointer to the first character after the number
+//=================================================================================================================================
+static const char* ParseIndex(const char* p, const char* pEnd, long long& rnValue)
+{
+    bool bNegative = false;
+
+    if (p < pEnd && (*p == '-' || *p == '+'))
+    {
+        bNegative = (*p == '-');
+        p++;
+    }
+
+    long long nValue = 0;
+
+    for (; p < pEnd && IsDigit(*p); p++)
+    {
+        if (nValue < 0x7FFFFFFF)
+        {
+            nValue = nValue * 10 + (*p - '0');
+        }
+    }
+
+    rnValue = bNegative ? -nValue : nValue;
+    return p;
+}
+
+
+//=================================================================================================================================
+/// Mixes the three OBJ indices of a vertex into a hash value
+//=================================================================================================================================
+static inline unsigned int HashVertex(unsigned int nVertex, unsigned int nTexCoord, unsigned int nNormal)
+{
+    unsigned int h = nVertex * 0x9E3779B1u;
+    h ^= nTexCoord * 0x85EBCA77u + (h << 6) + (h >> 2);
+    h ^= nNormal * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    return h;
+}
 
 
 //=================================================================================================================================
@@ -43,176 +122,274 @@
 
 
 //=================================================================================================================================
-/// Loads a mesh from an OBJ file
-/// \param strFileName   The file name to load from
-/// \param rVerticesOut  A set of vertices that is created from the OBJ
-/// \param rFacesOut     A set of faces that is created from the OBJ
+/// Parses one floating point number.  Numbers whose digits fit in a double's mantissa and that have a small exponent
+/// (which covers virtually every OBJ file) are converted with a single double precision multiply or divide.  Anything else,
+/// including "nan" and "inf", is handed to strtod.
+/// \param p       The first character to parse.  Leading blanks are skipped.
+/// \param pEnd    The end of the buffer
+/// \param rfValue Receives the parsed value, or 0 if there is no number
+/// \return A pointer to the first character after the number
 //=================================================================================================================================
-bool ObjLoader::LoadGeometry(const char* strFileName, std::vector<ObjVertexFinal>& rVerticesOut, std::vector<ObjFace>& rFacesOut)
+const char* ObjLoader::ParseFloat(const char* p, const char* pEnd, float& rfValue)
 {
-    //----------------------------------------------------------------------
-    // Data
-    //----------------------------------------------------------------------
-    std::vector<ObjVertex3D> vertices;
-    std::vector<ObjVertex3D> normals;
-    std::vector<ObjVertex2D> texCoords;
+    static const double s_pPow10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
 
-    bool bHasTexCoords = false;
-    bool bHasNormals   = false;
+    p = SkipBlanks(p, pEnd);
 
-    char cLine[256];    //A line of the obj file
+    const char* pStart = p;
+    bool bNegative = false;
 
-    //----------------------------------------------------------------------
-    // Read OBJ file
-    //----------------------------------------------------------------------
-    FILE* pFile = fopen(strFileName, "rt");
+    if (p < pEnd && (*p == '-' || *p == '+'))
+    {
+        bNegative = (*p == '-');
+        p++;
+    }
 
-    // Check if the file was opened
-    if (NULL == pFile)
+    unsigned long long nMantissa = 0;
+    int  nDigits   = 0;        // significant digits accumulated in nMantissa
+    int  nExponent = 0;
+    bool bAnyDigit = false;
+    bool bExact    = true;     // false if digits had to be dropped
+
+    for (; p < pEnd && IsDigit(*p); p++)
     {
-        // Open failed
-        return (false);
+        bAnyDigit = true;
 
-    } // end if ( NULL == pFile )
+        if (nDigits < 19)
+        {
+            nMantissa = nMantissa * 10 + (*p - '0');
+            nDigits += (nMantissa != 0) ? 1 : 0;
+        }
+        else
+        {
+            nExponent++;
+            bExact = false;
+        }
+    }
 
-    //Read until we hit the end of the file
-    while (!feof(pFile))
+    if (p < pEnd && *p == '.')
     {
-        //Check the first char in the line
-        int iStart = fgetc(pFile);
+        for (p++; p < pEnd && IsDigit(*p); p++)
+        {
+            bAnyDigit = true;
 
-        // skip blank lines
-        while ((iStart == 10) && (!feof(pFile))) { iStart = fgetc(pFile); }
+            if (nDigits < 19)
+            {
+                nMantissa = nMantissa * 10 + (*p - '0');
+                nDigits += (nMantissa != 0) ? 1 : 0;
+                nExponent--;
+            }
+            else
+            {
+                bExact = false;
+            }
+        }
+    }
+
+    if (bAnyDigit && p < pEnd && (*p == 'e' || *p == 'E'))
+    {
+        const char* pExp = p + 1;
+        bool bNegativeExp = false;
 
-        if (feof(pFile))
+        if (pExp < pEnd && (*pExp == '-' || *pExp == '+'))
         {
-            break;
+            bNegativeExp = (*pExp == '-');
+            pExp++;
         }
 
-        //If the first letter is v, it is either a vertex, a text coord, or a vertex normal
-        if (iStart == 'v')
+        if (pExp < pEnd && IsDigit(*pExp))
         {
-            //get the second char
-            int iNext = fgetc(pFile);
+            int nExp = 0;
 
-            //if its a space, its a vertex coordinate
-            if (iNext == ' ' || iNext == '\t')
+            for (; pExp < pEnd && IsDigit(*pExp); pExp++)
             {
-                ObjVertex3D vertex;
+                if (nExp < 100000)
+                {
+                    nExp = nExp * 10 + (*pExp - '0');
+                }
+            }
 
-                //get the line
-                fgets(cLine, 256, pFile);
+            nExponent += bNegativeExp ? -nExp : nExp;
+            p = pExp;
+        }
+    }
 
-                //get the vertex coords
-                sscanf(cLine, " %f %f %f", &vertex.x, &vertex.y, &vertex.z);
+    if (bAnyDigit && bExact && nMantissa < (1ull << 53) && nExponent >= -22 && nExponent <= 22)
+    {
+        double fValue = (double) nMantissa;
+        fValue = (nExponent < 0) ? fValue / s_pPow10[-nExponent] : fValue * s_pPow10[nExponent];
+        rfValue = (float)(bNegative ? -fValue : fValue);
+        return p;
+    }
 
-                //add to the vertex array
-                vertices.push_back(vertex);
-            } // End if
+    // slow path: strtod needs a null terminated copy of the token
+    const char* pToken = pStart;
 
-            //if its a t, its a texture coord
-            else if (iNext == 't')
-            {
-                ObjVertex2D texCoord;
+    while (pToken < pEnd && !IsBlank(*pToken) && *pToken != '\n')
+    {
+        pToken++;
+    }
 
-                //get the line
-                fgets(cLine, 256, pFile);
+    char cToken[128];
+    size_t nLength = pToken - pStart;
 
-                //get the vertex coords
-                sscanf(cLine, " %f %f", &texCoord.x, &texCoord.y);
+    if (nLength >= sizeof(cToken))
+    {
+        nLength = sizeof(cToken) - 1;
+    }
 
-                //add to the vertex array
-                texCoords.push_back(texCoord);
+    memcpy(cToken, pStart, nLength);
+    cToken[nLength] = '\0';
 
-                bHasTexCoords = true;
-            } // End else if
+    char* pParsedEnd = NULL;
+    double fValue = strtod(cToken, &pParsedEnd);
 
-            //if its an n its a normal
-            else if (iNext == 'n')
-            {
-                ObjVertex3D normal;
+    if (pParsedEnd == cToken)
+    {
+        rfValue = 0.0f;
+        return pStart;
+    }
 
-                //get the line
-                fgets(cLine, 256, pFile);
+    rfValue = (float) fValue;
+    return pStart + (pParsedEnd - cToken);
+} // End of ParseFloat
 
-                //get the vertex coords
-                sscanf(cLine, " %f %f %f", &normal.x, &normal.y, &normal.z);
 
-                //add to the vertex array
-                normals.push_back(normal);
+//=================================================================================================================================
+/// Loads a mesh from an OBJ file
+/// \param strFileName   The file name to load from
+/// \param rVerticesOut  A set of vertices that is created from the OBJ
+/// \param rFacesOut     A set of faces that is created from the OBJ
+//=================================================================================================================================
+bool ObjLoader::LoadGeometry(const char* strFileName, std::vector<ObjVertexFinal>& rVerticesOut, std::vector<ObjFace>& rFacesOut)
+{
+    MappedFile file;
 
-                bHasNormals = true;
-            } // End else if
+    // Check if the file was opened
+    if (!file.Open(strFileName))
+    {
+        // Open failed
+        return (false);
 
-            //else its something we don't support
-            else
-            {
-                //scan the line and discard it
-                fgets(cLine, 256, pFile);
-            } // End else
-        } // End if
+    } // end if ( !file.Open( strFileName ) )
 
-        //if the first letter is f, its a face
-        else if (iStart == 'f')
-        {
-            //read in the line
-            fgets(cLine, 256, pFile);
+    return LoadGeometry(file.GetData(), file.GetSize(), rVerticesOut, rFacesOut);
+} // End of LoadGeometry
 
-            int numVerts = GetNumberOfVerticesInLine(cLine);
 
-            int vertexIndices[256];
-            int texCoordIndices[256];
-            int normalIndices[256];
+//=================================================================================================================================
+/// Loads a mesh from an OBJ file that has already been read or mapped into memory
+/// \param pData         The contents of the OBJ file.  Does not need to be null terminated.
+/// \param nSize         The size of the OBJ file in bytes
+/// \param rVerticesOut  A set of vertices that is created from the OBJ
+/// \param rFacesOut     A set of faces that is created from the OBJ
+//=================================================================================================================================
+bool ObjLoader::LoadGeometry(const char* pData, size_t nSize, std::vector<ObjVertexFinal>& rVerticesOut, std::vector<ObjFace>& rFacesOut)
+{
+    //----------------------------------------------------------------------
+    // Split the file into line aligned chunks
+    //----------------------------------------------------------------------
+    size_t nChunks = 1;
+    unsigned int nThreads = std::thread::hardware_concurrency();
 
-            assert(numVerts < 256);
-            assert(numVerts > 0);
+    if (nThreads > 1 && nSize >= 2 * OBJ_MIN_CHUNK_SIZE)
+    {
+        nChunks = std::min((size_t) nThreads, nSize / OBJ_MIN_CHUNK_SIZE);
+    }
 
-            ReadVertexIndices(cLine, numVerts, bHasTexCoords, bHasNormals,
-                              vertexIndices, texCoordIndices, normalIndices);
+    const char* pEnd = pData + nSize;
+    std::vector<const char*> chunkStart(nChunks + 1, pEnd);
+    chunkStart[0] = pData;
 
-            int fCount; // face count
+    size_t i;
 
-            // Create triangles.
-            //
-            // Make a triangle fan if more than 3 vertices are specified
-            //
-            // If there are 3 vertices, 1 triangle
-            // If there are 4 vertices, 2 triangles
-            // If there are 5 vertices, 3 triangles
-            // :
-            for (fCount = 0; fCount < numVerts - 2; fCount++)
-            {
-                ObjFace face;
-                face.vertexIndices[0] = vertexIndices[0];
-                face.vertexIndices[1] = vertexIndices[fCount + 1];
-                face.vertexIndices[2] = vertexIndices[fCount + 2];
+    for (i = 1; i < nChunks; i++)
+    {
+        const char* pSplit = std::max(pData + (nSize * i) / nChunks, chunkStart[i - 1]);
+        chunkStart[i] = (pSplit == pData) ? pData : SkipToNextLine(pSplit - 1, pEnd);
+    }
 
-                face.texCoordIndices[0] = texCoordIndices[0];
-                face.texCoordIndices[1] = texCoordIndices[fCount + 1];
-                face.texCoordIndices[2] = texCoordIndices[fCount + 2];
+    //----------------------------------------------------------------------
+    // Parse all chunks, the first one on this thread
+    //----------------------------------------------------------------------
+    std::vector<ObjChunk> chunks(nChunks);
+    std::vector<std::thread> workers;
 
-                face.normalIndices[0] = normalIndices[0];
-                face.normalIndices[1] = normalIndices[fCount + 1];
-                face.normalIndices[2] = normalIndices[fCount + 2];
+    for (i = 1; i < nChunks; i++)
+    {
+        workers.push_back(std::thread(ParseChunk, chunkStart[i], chunkStart[i + 1], &chunks[i]));
+    }
 
-                rFacesOut.push_back(face);
-            } // End for
-        } // End else if
+    ParseChunk(chunkStart[0], chunkStart[1], &chunks[0]);
 
-        //if it isn't any of those, we don't care about it
-        else
+    for (i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+
+    //----------------------------------------------------------------------
+    // Merge the chunks in file order
+    //----------------------------------------------------------------------
+    std::vector<ObjVertex3D> vertices;
+    std::vector<ObjVertex3D> normals;
+    std::vector<ObjVertex2D> texCoords;
+
+    size_t nTotalFaces = rFacesOut.size();
+
+    for (i = 0; i < nChunks; i++)
+    {
+        nTotalFaces += chunks[i].faces.size();
+    }
+
+    rFacesOut.reserve(nTotalFaces);
+
+    for (i = 0; i < nChunks; i++)
+    {
+        ObjChunk& chunk = chunks[i];
+
+        // resolve the relative indices now that the number of preceding elements is known
+        size_t j;
+
+        for (j = 0; j < chunk.relativeIndices.size(); j++)
         {
-            //read the whole line to advance
-            fgets(cLine, 256, pFile);
-        } // End else
-    } // End while
+            const RelativeIndex& rel = chunk.relativeIndices[j];
+            ObjFace& face = chunk.faces[rel.nFace];
+
+            long long nBase = (rel.nSlot < 3) ? vertices.size() : ((rel.nSlot < 6) ? texCoords.size() : normals.size());
+            long long nIndex = nBase + rel.nOffset;
+            unsigned int nResolved = (nIndex > 0) ? (unsigned int) nIndex : 0;
 
-    fclose(pFile);
+            if (rel.nSlot < 3)
+            {
+                face.vertexIndices[rel.nSlot] = nResolved;
+            }
+            else if (rel.nSlot < 6)
+            {
+                face.texCoordIndices[rel.nSlot - 3] = nResolved;
+            }
+            else
+            {
+                face.normalIndices[rel.nSlot - 6] = nResolved;
+            }
+        } // End for
+
+        vertices.insert(vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+        rFacesOut.insert(rFacesOut.end(), chunk.faces.begin(), chunk.faces.end());
+
+        // release the chunk's memory early, large meshes are otherwise held twice
+        chunk = ObjChunk();
+    } // End for
 
     BuildFinalVertices(vertices, normals, texCoords, rFacesOut, rVerticesOut);
 
     return true;
-} // End of LoadGeometry for CRmObjLoaderPlugIn
+} // End of LoadGeometry
 
 
 
@@ -225,119 +402,228 @@ bool ObjLoader::LoadGeometry(const char* strFileName, std::vector<ObjVertexFinal
 
 
 //=================================================================================================================================
-/// Returns how many vertices are specified in one line read from OBJ
-/// \param szLine  The line of text to count vertices in
+/// Parses every line in a range of the file.  The range must start at the beginning of a line.
+/// \param pBegin  The first character of the range
+/// \param pEnd    One past the last character of the range
+/// \param pChunk  Receives the elements found in the range
 //=================================================================================================================================
-
-int ObjLoader::GetNumberOfVerticesInLine(const char* szLine)
+void ObjLoader::ParseChunk(const char* pBegin, const char* pEnd, ObjChunk* pChunk)
 {
-    int pos = 0;
-    int vertCount = 0;
-    bool bInsideVertex = false;
+    ObjChunk& chunk = *pChunk;
+
+    // scratch space for the corners of one polygon, reused across lines
+    std::vector<unsigned int> polygon[3];
 
-    while (szLine[pos] != 0)
+    const char* p = pBegin;
+
+    while (p < pEnd)
     {
-        if (((szLine[pos] >= '0') && (szLine[pos] <= '9')) ||
-            (szLine[pos] == '/'))
+        p = SkipBlanks(p, pEnd);
+
+        if (p + 1 >= pEnd)
         {
-            if (bInsideVertex == false)
-            {
-                vertCount++;
-                bInsideVertex = true;
-            } // End if
+            break;
+        }
+
+        //If the first letter is v, it is either a vertex, a text coord, or a vertex normal
+        if (p[0] == 'v' && IsBlank(p[1]))
+        {
+            ObjVertex3D vertex;
+
+            p = ParseFloat(p + 1, pEnd, vertex.x);
+            p = ParseFloat(p, pEnd, vertex.y);
+            p = ParseFloat(p, pEnd, vertex.z);
+
+            chunk.vertices.push_back(vertex);
         } // End if
-        else if (szLine[pos] == ' ')
+
+        //if its a t, its a texture coord
+        else if (p[0] == 'v' && p[1] == 't')
         {
-            if (bInsideVertex)
-            {
-                bInsideVertex = false;
-            } // End if
-        } // End else
+            ObjVertex2D texCoord;
 
-        pos++;
-    } // End while
+            p = ParseFloat(p + 2, pEnd, texCoord.x);
+            p = ParseFloat(p, pEnd, texCoord.y);
+
+            chunk.texCoords.push_back(texCoord);
+        } // End else if
 
-    return vertCount;
-} // End of GetNumberOfVerticesInLine for CRmObjLoaderPlugIn
+        //if its an n its a normal
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            ObjVertex3D normal;
 
+            p = ParseFloat(p + 2, pEnd, normal.x);
+            p = ParseFloat(p, pEnd, normal.y);
+            p = ParseFloat(p, pEnd, normal.z);
 
+            chunk.normals.push_back(normal);
+        } // End else if
 
+        //if the first letter is f, its a face
+        else if (p[0] == 'f' && IsBlank(p[1]))
+        {
+            ParseFace(p + 1, pEnd, chunk, polygon);
+        } // End else if
+
+        //if it isn't any of those, we don't care about it
+        p = SkipToNextLine(p, pEnd);
+    } // End while
+} // End of ParseChunk
+
+
+//=================================================================================================================================
+/// Parses a face line of the form "f v[/vt][/vn] ..." and emits it as a triangle fan
+/// \param pLine     The first character after the 'f'
+/// \param pEnd      The end of the buffer
+/// \param rChunk    The chunk to add the triangles to
+/// \param rIndices  Scratch space for the vertex, texcoord and normal indices of the polygon
 //=================================================================================================================================
-/// Parses a face line
-//=============================================================================================================================
-void ObjLoader::ReadVertexIndices(const char* szLine, int numVertsInLine,
-                                  bool bHasTexCoords, bool bHasNormals,
-                                  int* pVertIndices, int* pTexCoords, int* pNormals)
+void ObjLoader::ParseFace(const char* pLine, const char* pEnd, ObjChunk& rChunk, std::vector<unsigned int> (&rIndices)[3])
 {
-    const char* szNext = szLine;
+    // number of elements seen so far in this chunk, for relative indices
+    const long long nCounts[3] = { (long long) rChunk.vertices.size(),
+                                   (long long) rChunk.texCoords.size(),
+                                   (long long) rChunk.normals.size()
+                                 };
 
-    while (((*szNext) < '0') || ((*szNext) > '9'))
+    // corners with relative indices, stored as (corner * 3 + component, offset)
+    std::vector<std::pair<unsigned int, int> > relative;
+
+    int k;
+
+    for (k = 0; k < 3; k++)
     {
-        // Skip any character that's not a number
-        assert(*szNext != '\0');
-        szNext++;
-    } // End while
+        rIndices[k].clear();
+    }
 
-    int i;
+    const char* p = SkipBlanks(pLine, pEnd);
 
-    for (i = 0; i < numVertsInLine; i++)
+    while (p < pEnd && *p != '\n' && *p != '#')
     {
-        pVertIndices[i] = 0;
-        pTexCoords[i] = 0;
-        pNormals[i] = 0;
+        unsigned int nCorner = (unsigned int) rIndices[0].size();
+        int nComponent = 0;
 
-        int numRead;
+        for (k = 0; k < 3; k++)
+        {
+            rIndices[k].push_back(0);
+        }
 
-        if (bHasTexCoords && bHasNormals)
+        // read up to three '/' separated indices, any of which but the first may be empty
+        while (nComponent < 3)
         {
-            numRead = sscanf(szNext, "%i/%i/%i", &pVertIndices[i], &pTexCoords[i], &pNormals[i]);
+            long long nIndex;
+            const char* pNext = ParseIndex(p, pEnd, nIndex);
 
-            if (numRead != 3)
+            if (nIndex > 0)
             {
-                sscanf(szNext, "%i//%i//%i", &pVertIndices[i], &pTexCoords[i], &pNormals[i]);
+                rIndices[nComponent][nCorner] = (unsigned int) nIndex;
             }
-        } // End if
-
-        else if (!bHasTexCoords && bHasNormals)
-        {
-            numRead = sscanf(szNext, "%i/%i", &pVertIndices[i], &pNormals[i]);
-
-            if (numRead != 2)
+            else if (nIndex < 0)
             {
-                sscanf(szNext, "%i//%i", &pVertIndices[i], &pNormals[i]);
+                relative.push_back(std::make_pair(nCorner * 3 + nComponent, (int)(nCounts[nComponent] + nIndex + 1)));
             }
-        } // End if
 
-        else if (bHasTexCoords && !bHasNormals)
-        {
-            numRead = sscanf(szNext, "%i/%i", &pVertIndices[i], &pTexCoords[i]);
+            p = pNext;
 
-            if (numRead != 2)
+            if (p < pEnd && *p == '/')
             {
-                sscanf(szNext, "%i//%i", &pVertIndices[i], &pTexCoords[i]);
+                p++;
+                nComponent++;
             }
-        } // End if
+            else
+            {
+                break;
+            }
+        } // End while
 
-        else
+        // skip anything we did not understand up to the next corner
+        while (p < pEnd && !IsBlank(*p) && *p != '\n')
         {
-            numRead = sscanf(szNext, "%i", &pVertIndices[i]);
-        } // End else
+            p++;
+        }
+
+        p = SkipBlanks(p, pEnd);
+    } // End while
+
+    size_t numVerts = rIndices[0].size();
+
+    if (numVerts < 3)
+    {
+        return;
+    }
+
+    // Create triangles.
+    //
+    // Make a triangle fan if more than 3 vertices are specified
+    //
+    // If there are 3 vertices, 1 triangle
+    // If there are 4 vertices, 2 triangles
+    // If there are 5 vertices, 3 triangles
+    // :
+    size_t nFirstFace = rChunk.faces.size();
+    size_t fCount; // face count
+
+    for (fCount = 0; fCount < numVerts - 2; fCount++)
+    {
+        ObjFace face;
+        face.vertexIndices[0] = rIndices[0][0];
+        face.vertexIndices[1] = rIndices[0][fCount + 1];
+        face.vertexIndices[2] = rIndices[0][fCount + 2];
 
-        szNext = strchr(szNext, ' ');
+        face.texCoordIndices[0] = rIndices[1][0];
+        face.texCoordIndices[1] = rIndices[1][fCount + 1];
+        face.texCoordIndices[2] = rIndices[1][fCount + 2];
 
-        if (i < numVertsInLine - 1)
+        face.normalIndices[0] = rIndices[2][0];
+        face.normalIndices[1] = rIndices[2][fCount + 1];
+        face.normalIndices[2] = rIndices[2][fCount + 2];
+
+        rChunk.faces.push_back(face);
+    } // End for
+
+    // register the relative indices of every triangle that references them
+    size_t r;
+
+    for (r = 0; r < relative.size(); r++)
+    {
+        size_t nCorner      = relative[r].first / 3;
+        unsigned int nBase  = (relative[r].first % 3) * 3;
+
+        for (fCount = 0; fCount < numVerts - 2; fCount++)
         {
-            // If this is not the last one
-            assert(szNext != NULL);
-            szNext++;
-        } // End if
+            RelativeIndex rel;
+            rel.nFace   = nFirstFace + fCount;
+            rel.nOffset = relative[r].second;
+
+            if (nCorner == 0)
+            {
+                rel.nSlot = nBase;
+            }
+            else if (nCorner == fCount + 1)
+            {
+                rel.nSlot = nBase + 1;
+            }
+            else if (nCorner == fCount + 2)
+            {
+                rel.nSlot = nBase + 2;
+            }
+            else
+            {
+                continue;
+            }
+
+            rChunk.relativeIndices.push_back(rel);
+        } // End for
     } // End for
-} // End of ReadVertexIndices for CRmObjLoaderPlugIn
+} // End of ParseFace
 
 
 //=================================================================================================================================
 /// Buildup vertex hash map and update each face's final vertex index
 /// Build final vertex array
+///
+/// Final vertices are numbered in order of first use.  The lookup is an open addressing hash table with linear probing.
 //=================================================================================================================================
 void ObjLoader::BuildFinalVertices(const std::vector<ObjVertex3D>& vertices,
                                    const std::vector<ObjVertex3D>& normals,
@@ -345,63 +631,118 @@ void ObjLoader::BuildFinalVertices(const std::vector<ObjVertex3D>& vertices,
                                    std::vector<ObjFace>&     faces,
                                    std::vector<ObjVertexFinal>& finalVertices)
 {
-    std::map<VertexHashData, VertexHashData, vertex_less> vertexHashMap;
+    // most meshes have about as many final vertices as positions, size the table for a load factor of 1/2
+    size_t nCapacity = 16;
+
+    while (nCapacity < 2 * vertices.size())
+    {
+        nCapacity *= 2;
+    }
+
+    VertexHashData emptySlot;
+    emptySlot.vertexIndex   = 0;
+    emptySlot.texCoordIndex = 0;
+    emptySlot.normalIndex   = 0;
+    emptySlot.finalIndex    = OBJ_EMPTY_SLOT;
 
-    int count = 0;
-    unsigned int i;
+    std::vector<VertexHashData> vertexHashTable(nCapacity, emptySlot);
+    size_t nMask = nCapacity - 1;
+
+    unsigned int count = 0;
+    finalVertices.reserve(finalVertices.size() + vertices.size());
+
+    size_t i;
 
     for (i = 0; i < faces.size(); i++)
     {
         ObjFace& face = faces[i];
 
-        // OBj's index is 1 based, so subtract 1 to make it zero based indices
         int j;
 
         for (j = 0; j < 3; j++)
         {
-            VertexHashData vHash;
+            unsigned int nVertex   = face.vertexIndices[j];
+            unsigned int nTexCoord = face.texCoordIndices[j];
+            unsigned int nNormal   = face.normalIndices[j];
+
+            size_t nSlot = HashVertex(nVertex, nTexCoord, nNormal) & nMask;
+
+            while (vertexHashTable[nSlot].finalIndex != OBJ_EMPTY_SLOT &&
+                   (vertexHashTable[nSlot].vertexIndex   != nVertex   ||
+                    vertexHashTable[nSlot].texCoordIndex != nTexCoord ||
+                    vertexHashTable[nSlot].normalIndex   != nNormal))
+            {
+                nSlot = (nSlot + 1) & nMask;
+            }
+
+            if (vertexHashTable[nSlot].finalIndex != OBJ_EMPTY_SLOT)
+            {
+                face.finalVertexIndices[j] = vertexHashTable[nSlot].finalIndex;
+                continue;
+            }
+
+            // If this combination of vertexIndex,texCoordIndex and normalIndex is not found in the table
+            VertexHashData& vHash = vertexHashTable[nSlot];
+            vHash.vertexIndex   = nVertex;
+            vHash.texCoordIndex = nTexCoord;
+            vHash.normalIndex   = nNormal;
             vHash.finalIndex    = count;
-            vHash.vertexIndex   = face.vertexIndices[j];
-            vHash.texCoordIndex = face.texCoordIndices[j];
-            vHash.normalIndex   = face.normalIndices[j];
 
-            std::map<VertexHashData, VertexHashData, vertex_less>::iterator itr = vertexHashMap.find(vHash);
+            face.finalVertexIndices[j] = count;
+            count++;
 
-            if (itr == vertexHashMap.end())
+            ObjVertexFinal finalVertex;
+
+            // OBJ's indices are 1 base, so subtract 1.  Indices past the end of the file's data are ignored.
+            if (nVertex > 0 && nVertex <= vertices.size())
             {
-                // If this combination of vertexIndex,texCoordIndex and normalIndex is nout found in map
-                vertexHashMap.insert(std::map<VertexHashData, VertexHashData, vertex_less>::value_type(vHash, vHash));
-                face.finalVertexIndices[j] = vHash.finalIndex;
-                count++;
+                finalVertex.pos = vertices[nVertex - 1];
+            }
 
-                ObjVertexFinal finalVertex;
+            if (nTexCoord > 0 && nTexCoord <= texCoords.size())
+            {
+                finalVertex.texCoord = texCoords[nTexCoord - 1];
+            }
 
-                // OBJ's indices are 1 base, so subtract 1
-                if (vHash.vertexIndex > 0)
-                {
-                    finalVertex.pos = vertices[vHash.vertexIndex - 1];
-                }
+            if (nNormal > 0 && nNormal <= normals.size())
+            {
+                finalVertex.normal = normals[nNormal - 1];
+            }
 
-                if (vHash.texCoordIndex > 0)
-                {
-                    finalVertex.texCoord = texCoords[vHash.texCoordIndex - 1];
-                }
+            finalVertex.nNormalIndex = nNormal;
+            finalVertex.nTexcoordIndex = nTexCoord;
+            finalVertex.nVertexIndex = nVertex;
+            finalVertices.push_back(finalVertex);
+
+            // grow the table before the probe sequences get long
+            if (2 * (size_t) count > nCapacity)
+            {
+                std::vector<VertexHashData> oldTable(nCapacity * 2, emptySlot);
+                oldTable.swap(vertexHashTable);
+                nCapacity *= 2;
+                nMask = nCapacity - 1;
 
-                if (vHash.normalIndex > 0)
+                size_t k;
+
+                for (k = 0; k < oldTable.size(); k++)
                 {
-                    finalVertex.normal = normals[vHash.normalIndex - 1];
-                }
+                    const VertexHashData& entry = oldTable[k];
+
+                    if (entry.finalIndex == OBJ_EMPTY_SLOT)
+                    {
+                        continue;
+                    }
+
+                    size_t nNewSlot = HashVertex(entry.vertexIndex, entry.texCoordIndex, entry.normalIndex) & nMask;
 
-                finalVertex.nNormalIndex = vHash.normalIndex;
-                finalVertex.nTexcoordIndex = vHash.texCoordIndex;
-                finalVertex.nVertexIndex = vHash.vertexIndex;
-                finalVertices.push_back(finalVertex);
+                    while (vertexHashTable[nNewSlot].finalIndex != OBJ_EMPTY_SLOT)
+                    {
+                        nNewSlot = (nNewSlot + 1) & nMask;
+                    }
+
+                    vertexHashTable[nNewSlot] = entry;
+                } // End for
             } // End if
-            else
-            {
-                VertexHashData& vHashFound = (*itr).second;
-                face.finalVertexIndices[j] = vHashFound.finalIndex;
-            } // End else
         } // End for
     } // End for
-} // End of BuildFinalVertices for CRmObjLoaderPlugIn
+} // End of BuildFinalVertices
@@ -7,9 +7,8 @@
 #ifndef _OBJLOADER_H_
 #define _OBJLOADER_H_
 
-#include <algorithm>
+#include <cstddef>
 #include <vector>
-#include <functional>
 
 //..............................................................................................................//
 //..............................................................................................................//
@@ -100,6 +99,8 @@ struct ObjFace
 ///    - It does not support materials
 ///    - It does not support texture coordinates with three channels
 ///
+///  The file is memory mapped and split into line-aligned chunks that are parsed in parallel.  Lines may be of any
+///  length, and negative (relative) face indices are supported.
 //=================================================================================================================================
 class ObjLoader
 {
@@ -108,9 +109,36 @@ public:
     /// Loads a mesh from a wavefront OBJ file
     bool LoadGeometry(const char* strFileName, std::vector<ObjVertexFinal>& rVerticesOut, std::vector<ObjFace>& rFacesOut);
 
+    /// Loads a mesh from the contents of a wavefront OBJ file that is already in memory
+    bool LoadGeometry(const char* pData, size_t nSize, std::vector<ObjVertexFinal>& rVerticesOut, std::vector<ObjFace>& rFacesOut);
+
+    /// Parses a floating point number in an OBJ file, returns a pointer to the first character after it
+    static const char* ParseFloat(const char* p, const char* pEnd, float& rfValue);
+
 
 private:
 
+    // A face index that is relative to the number of elements seen so far (negative index in the file).
+    // It can only be resolved once the number of elements in the preceding chunks is known.
+    struct RelativeIndex
+    {
+        size_t       nFace;     // face within the chunk
+        unsigned int nSlot;     // 0-2 vertex, 3-5 texcoord, 6-8 normal
+        int          nOffset;   // 1 based index, relative to the first element of the chunk
+    }; // End of RelativeIndex
+
+
+    // The result of parsing one chunk of the file
+    struct ObjChunk
+    {
+        std::vector<ObjVertex3D>   vertices;
+        std::vector<ObjVertex3D>   normals;
+        std::vector<ObjVertex2D>   texCoords;
+        std::vector<ObjFace>       faces;
+        std::vector<RelativeIndex> relativeIndices;
+    }; // End of ObjChunk
+
+
     // VertexHashData
     struct VertexHashData
     {
@@ -122,58 +150,12 @@ private:
     }; // End of VertexHashData
 
 
-    struct vertex_less : public std::less<VertexHashData>
-    {
-        bool operator()(const VertexHashData& x, const VertexHashData& y) const
-        {
-            if (x.vertexIndex < y.vertexIndex)
-            {
-                return true;
-            }
-
-            if (x.vertexIndex > y.vertexIndex)
-            {
-                return false;
-            }
-
-            if (x.texCoordIndex < y.texCoordIndex)
-            {
-                return true;
-            }
-
-            if (x.texCoordIndex > y.texCoordIndex)
-            {
-                return false;
-            }
-
-            if (x.normalIndex < y.normalIndex)
-            {
-                return true;
-            }
-
-            if (x.normalIndex > y.normalIndex)
-            {
-                return false;
-            }
-
-            return false;
-        }; // End of operator()
-    }; // End of vertex_less
-
-
-    bool BuildModel(const std::vector<ObjVertex3D>& vertices,
-                    const std::vector<ObjVertex3D>& normals,
-                    const std::vector<ObjVertex2D>& texCoords,
-                    std::vector<ObjVertexFinal>& finalVertices,
-                    std::vector<ObjFace>& faces);
-
-    // Returns how many vertices are specified in one line read from OBJ
-    int  GetNumberOfVerticesInLine(const char* szLine);
-
-    // Read vertex indices
-    void ReadVertexIndices(const char* szLine, int numVertsInLine,
-                           bool bHasTexCoords, bool bHasNormals,
-                           int* pVertIndices, int* pTexCoords, int* pNormals);
+    // Parses the lines in [pBegin, pEnd) into a chunk
+    static void ParseChunk(const char* pBegin, const char* pEnd, ObjChunk* pChunk);
+
+    // Parses a face line and appends the resulting triangle fan to the chunk
+    static void ParseFace(const char* pLine, const char* pEnd, ObjChunk& rChunk,
+                          std::vector<unsigned int> (&rIndices)[3]);
 
     // Buildup vertex hash map
     void BuildFinalVertices(const std::vector<ObjVertex3D>& vertices,
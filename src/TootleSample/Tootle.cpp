@@ -36,70 +36,15 @@
 #include <string.h>
 #include <string>
 #include <iostream>
-#include <fstream>
 #include <cassert>
+#include <mutex>
 #include "option.h"
+#include "BufferedWriter.h"
 #include "ObjLoader.h"
+#include "MeshCache.h"
 #include "tootlelib.h"
 #include "Timer.h"
-
-//=================================================================================================================================
-/// Enumeration for the choice of test cases for tootle.
-//=================================================================================================================================
-enum TootleAlgorithm
-{
-    NA_TOOTLE_ALGORITHM,                // Default invalid choice.
-    TOOTLE_VCACHE_ONLY,                 // Only perform vertex cache optimization.
-    TOOTLE_CLUSTER_VCACHE_OVERDRAW,     // Call the clustering, optimize vertex cache and overdraw individually.
-    TOOTLE_FAST_VCACHECLUSTER_OVERDRAW, // Call the functions to optimize vertex cache and overdraw individually.  This is using
-    //  the algorithm from SIGGRAPH 2007.
-    TOOTLE_OPTIMIZE,                    // Call a single function to optimize vertex cache, cluster and overdraw.
-    TOOTLE_FAST_OPTIMIZE                // Call a single function to optimize vertex cache, cluster and overdraw using
-    //  a fast algorithm from SIGGRAPH 2007.
-};
-
-//=================================================================================================================================
-/// A simple structure to store the settings for this sample app
-//=================================================================================================================================
-struct TootleSettings
-{
-    const char*           pMeshName ;
-    const char*           pViewpointName ;
-    unsigned int          nClustering ;
-    unsigned int          nCacheSize;
-    TootleFaceWinding     eWinding;
-    TootleAlgorithm       algorithmChoice;         // five different types of algorithm to test Tootle
-    TootleVCacheOptimizer eVCacheOptimizer;        // the choice for vertex cache optimization algorithm, it can be either
-    //  TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_LSTRIPS, TOOTLE_VCACHE_DIRECT3D or
-    //  TOOTLE_VCACHE_TIPSY.
-    bool                  bOptimizeVertexMemory;   // true if you want to optimize vertex memory location, false to skip
-    bool                  bMeasureOverdraw;        // true if you want to measure overdraw, false to skip
-};
-
-//=================================================================================================================================
-/// A simple structure to hold Tootle statistics
-//=================================================================================================================================
-struct TootleStats
-{
-    unsigned int nClusters;
-    float        fVCacheIn;
-    float        fVCacheOut;
-    float        fOverdrawIn;
-    float        fOverdrawOut;
-    float        fMaxOverdrawIn;
-    float        fMaxOverdrawOut;
-    double       fOptimizeVCacheTime;
-    double       fClusterMeshTime;
-    double       fOptimizeOverdrawTime;
-    double       fVCacheClustersTime;
-    double       fOptimizeVCacheAndClusterMeshTime;
-    double       fTootleOptimizeTime;
-    double       fTootleFastOptimizeTime;
-    double       fMeasureOverdrawTime;
-    double       fOptimizeVertexMemoryTime;
-};
-
-const float INVALID_TIME = -1;
+#include "Tootle.h"
 
 //=================================================================================================================================
 /// Reads a list of camera positions from a viewpoint file.
@@ -149,45 +94,60 @@ bool LoadViewpoints(const char* pFileName, std::vector<ObjVertex3D>& rViewPoints
 
 //=================================================================================================================================
 /// This function reads an obj file and re-emits its vertices and faces in the specified order
-/// \param rInput      Input stream from which to read the obj
-/// \param rOutput     Output stream on which to emit
-/// \param rVertices   A vector containing the vertices that were referenced in the OBJ file
+/// \param pInput      The contents of the obj file
+/// \param nInputSize  The size of the obj file in bytes
+/// \param rOutput     Writer on which to emit
+/// \param pVertices   The OBJ elements each vertex in the index buffer was built from
+/// \param nVertices   The number of vertices in pVertices
 /// \param rIndices    A vector containing the sorted index buffer
 /// \param vertexRemap A vector containing the remapped ID of the vertices.  Element i in the array will contain the new output
 ///                     location of the vertex i.  This is the result of TootleOptimizeVertexMemory().  May be NULL.
-/// \param nVertices   The total number of vertices referenced in vertexRemap.
+/// \param nRemapVertices The total number of vertices referenced in vertexRemap.
 ///
 /// \return True if successful.  False otherwise
 //=================================================================================================================================
-bool EmitModifiedObj(std::istream& rInput, std::ostream& rOutput, const std::vector<ObjVertexFinal>& rVertices,
-                     const std::vector<unsigned int>& rIndices, const unsigned int* vertexRemap,
-                     unsigned int nVertices)
+bool EmitModifiedObj(const char* pInput, size_t nInputSize, BufferedWriter& rOutput, const MeshCacheSource* pVertices,
+                     unsigned int nVertices, const std::vector<unsigned int>& rIndices, const unsigned int* vertexRemap,
+                     unsigned int nRemapVertices)
 {
     // store the original copy of vertices into an array
-    // we need to do this because rVertices contains the reordered vertex by ObjLoader using a hash map.
+    // we need to do this because pVertices contains the reordered vertex by ObjLoader using a hash map.
     std::vector<ObjVertex3D> inputVertices;
-    inputVertices.reserve(rVertices.size());    // reserve at least this size, but the total input vertices might be larger.
+    inputVertices.reserve(nVertices);    // reserve at least this size, but the total input vertices might be larger.
 
     unsigned int nCount = 0;
 
-    while (!rInput.eof())
+    const char* pEnd  = pInput + nInputSize;
+    const char* pLine = pInput;
+
+    while (true)
     {
-        std::string currentLine;
-        std::getline(rInput, currentLine, '\n');
-        const char* pLineText = currentLine.c_str();
+        const char* pLineEnd = (const char*) memchr(pLine, '\n', pEnd - pLine);
 
-        //if there is an "f " before the first space, then this is a face line
-        if (strstr(pLineText, "f ") == strstr(pLineText, " ") - 1)
+        if (pLineEnd == NULL)
+        {
+            pLineEnd = pEnd;
+        }
+
+        // the character before the first space tells the line type, e.g. "f " for a face line and "v " for a vertex line
+        const char* pSpace = (const char*) memchr(pLine, ' ', pLineEnd - pLine);
+        char cType = (pSpace != NULL && pSpace > pLine) ? pSpace[ -1 ] : 0;
+
+        if (cType == 'f')
         {
             // face line
         }
-        else if (strstr(pLineText, "v ") == strstr(pLineText, " ") - 1)        // vertex line
+        else if (cType == 'v')        // vertex line
         {
-            ObjVertex3D vert;
+            ObjVertex3D vert = { 0.0f, 0.0f, 0.0f };
 
             // vertex line
-            sscanf(pLineText, "v %f %f %f", &vert.x, &vert.y,
-                   &vert.z);
+            if (*pLine == 'v')
+            {
+                const char* p = ObjLoader::ParseFloat(pLine + 1, pLineEnd, vert.x);
+                p = ObjLoader::ParseFloat(p, pLineEnd, vert.y);
+                ObjLoader::ParseFloat(p, pLineEnd, vert.z);
+            }
 
             inputVertices.push_back(vert);
 
@@ -196,13 +156,21 @@ bool EmitModifiedObj(std::istream& rInput, std::ostream& rOutput, const std::vec
         else
         {
             // not a face line, pass it through
-            rOutput << currentLine << std::endl;
+            rOutput.Write(pLine, pLineEnd - pLine);
+            rOutput.Write('\n');
         }
+
+        if (pLineEnd == pEnd)
+        {
+            break;
+        }
+
+        pLine = pLineEnd + 1;
     }
 
     // Create a local copy of the vertex remapping array.
     //  Note that because the input vertices in the OBJ file might be larger than the vertex buffer
-    //  in rVertices, vertexRemapping buffer might be larger than vertexRemap.
+    //  in pVertices, vertexRemapping buffer might be larger than vertexRemap.
     std::vector<unsigned int> vertexRemapping;
 
     // if there is no vertex remapping, create a default one
@@ -218,36 +186,37 @@ bool EmitModifiedObj(std::istream& rInput, std::ostream& rOutput, const std::vec
     else
     {
         vertexRemapping.reserve (nCount);
-        if (nVertices >= nCount)
+        if (nRemapVertices >= nCount)
         {
             vertexRemapping.assign (vertexRemap, vertexRemap + nCount);
         }
         else
         {
-            vertexRemapping.assign (vertexRemap, vertexRemap + rVertices.size ());
+            vertexRemapping.assign (vertexRemap, vertexRemap + nVertices);
         }
 
-        // It is possible for the input list of vertices to be larger than the one in rVertices, thus,
+        // It is possible for the input list of vertices to be larger than the one in pVertices, thus,
         //  they are not mapped by TootleOptimizeVertexMemory().
         //  In that case, we will reassign the unmapped vertices to the end of the vertex buffer.
 
-        for (unsigned int i = nVertices; i < nCount; i++)
+        for (unsigned int i = nRemapVertices; i < nCount; i++)
         {
             vertexRemapping.push_back (i);
         }
 
         // print out the vertex mapping indexes in the output obj
         const unsigned int NUM_ITEMS_PER_LINE = 50;
-        rOutput << "#vertexRemap = ";
+        rOutput.Write("#vertexRemap = ");
         for (unsigned int i = 0; i < nCount; ++i)
         {
-            rOutput << vertexRemapping[i] << " ";
+            rOutput.Write(vertexRemapping[i]);
+            rOutput.Write(' ');
             if ((i+1) % NUM_ITEMS_PER_LINE == 0)
             {
-                rOutput << std::endl << "#vertexRemap = ";
+                rOutput.Write("\n#vertexRemap = ");
             }
         }
-        rOutput << std::endl;
+        rOutput.Write('\n');
     }
 
     // compute the inverse vertex mapping to output the remapped vertices
@@ -275,45 +244,127 @@ bool EmitModifiedObj(std::istream& rInput, std::ostream& rOutput, const std::vec
     // output the vertices
     for (unsigned int i = 0; i < nCount; i++)
     {
-        rOutput << "v ";
-
         // output the remapped vertices (require an inverse mapping).
-        nVID = inverseVertexRemapping[ i ];
-
-        rOutput << inputVertices[ nVID ].x << " " << inputVertices[ nVID ].y << " "
-                << inputVertices[ nVID ].z << std::endl;
+        const ObjVertex3D& rVert = inputVertices[ inverseVertexRemapping[ i ] ];
+
+        rOutput.Write("v ", 2);
+        rOutput.Write(rVert.x);
+        rOutput.Write(' ');
+        rOutput.Write(rVert.y);
+        rOutput.Write(' ');
+        rOutput.Write(rVert.z);
+        rOutput.Write('\n');
     }
 
     // generate a new set of faces, using re-ordered index buffer
     for (unsigned int i = 0; i < rIndices.size(); i += 3)
     {
-        rOutput << "f " ;
+        rOutput.Write("f ", 2);
 
         for (int j = 0; j < 3; j++)
         {
-            const ObjVertexFinal& rVertex = rVertices[ rIndices[ i + j ] ];
-            rOutput << 1 + vertexRemapping[ rVertex.nVertexIndex - 1 ];
+            const MeshCacheSource& rVertex = pVertices[ rIndices[ i + j ] ];
+            rOutput.Write(1 + vertexRemapping[ rVertex.nVertexIndex - 1 ]);
 
             if (rVertex.nNormalIndex > 0 && rVertex.nTexcoordIndex)
             {
-                rOutput << "/" << rVertex.nTexcoordIndex << "/" << rVertex.nNormalIndex;
+                rOutput.Write('/');
+                rOutput.Write(rVertex.nTexcoordIndex);
+                rOutput.Write('/');
+                rOutput.Write(rVertex.nNormalIndex);
             }
             else if (rVertex.nNormalIndex > 0)
             {
-                rOutput << "//" << rVertex.nNormalIndex;
+                rOutput.Write("//", 2);
+                rOutput.Write(rVertex.nNormalIndex);
             }
             else if (rVertex.nTexcoordIndex > 0)
             {
-                rOutput << "/" << rVertex.nTexcoordIndex;
+                rOutput.Write('/');
+                rOutput.Write(rVertex.nTexcoordIndex);
             }
 
-            rOutput << " ";
+            rOutput.Write(' ');
         }
 
-        rOutput << std::endl;
+        rOutput.Write('\n');
     }
 
-    return true;
+    return rOutput.Flush();
+}
+
+//=================================================================================================================================
+/// Writes the optimized mesh in the binary mesh format (see MeshCache.h)
+/// \param strFileName   The file to write
+/// \param rMesh         The mesh as it was loaded
+/// \param rIndices      The optimized index buffer
+/// \param pnVertexRemap Element i contains the new location of vertex i, as computed by TootleOptimizeVertexMemory().  May be NULL.
+/// \param nSourceSize   The size of the obj file the mesh was loaded from
+/// \param nSourceHash   The hash of the obj file the mesh was loaded from
+///
+/// \return True if successful.  False otherwise
+//=================================================================================================================================
+bool EmitBinaryMesh(const char* strFileName, const MeshCacheData& rMesh, const std::vector<unsigned int>& rIndices,
+                    const unsigned int* pnVertexRemap, uint64_t nSourceSize, uint64_t nSourceHash)
+{
+    MeshCacheData outMesh = rMesh;
+    outMesh.pnIndices   = &rIndices[0];
+    outMesh.pnIndices16 = NULL;
+    outMesh.pnClusters  = NULL;
+
+    std::vector<float>           positions;
+    std::vector<float>           normals;
+    std::vector<float>           texCoords;
+    std::vector<MeshCacheSource> sources;
+    std::vector<unsigned int>    indices;
+
+    if (pnVertexRemap != NULL)
+    {
+        // move every vertex attribute to its new location
+        unsigned int nVertices = rMesh.nVertices;
+
+        positions.resize(nVertices * 3);
+        normals.resize(rMesh.pfNormals != NULL ? nVertices * 3 : 0);
+        texCoords.resize(rMesh.pfTexCoords != NULL ? nVertices * 2 : 0);
+        sources.resize(rMesh.pSources != NULL ? nVertices : 0);
+
+        for (unsigned int i = 0; i < nVertices; i++)
+        {
+            unsigned int nVID = pnVertexRemap[ i ];
+
+            memcpy(&positions[ nVID * 3 ], &rMesh.pfPositions[ i * 3 ], 3 * sizeof(float));
+
+            if (rMesh.pfNormals != NULL)
+            {
+                memcpy(&normals[ nVID * 3 ], &rMesh.pfNormals[ i * 3 ], 3 * sizeof(float));
+            }
+
+            if (rMesh.pfTexCoords != NULL)
+            {
+                memcpy(&texCoords[ nVID * 2 ], &rMesh.pfTexCoords[ i * 2 ], 2 * sizeof(float));
+            }
+
+            if (rMesh.pSources != NULL)
+            {
+                sources[ nVID ] = rMesh.pSources[ i ];
+            }
+        }
+
+        indices.resize(rIndices.size());
+
+        for (unsigned int i = 0; i < rIndices.size(); i++)
+        {
+            indices[ i ] = pnVertexRemap[ rIndices[ i ] ];
+        }
+
+        outMesh.pfPositions = &positions[0];
+        outMesh.pfNormals   = normals.empty() ? NULL : &normals[0];
+        outMesh.pfTexCoords = texCoords.empty() ? NULL : &texCoords[0];
+        outMesh.pSources    = sources.empty() ? NULL : &sources[0];
+        outMesh.pnIndices   = &indices[0];
+    }
+
+    return MeshCache::Write(strFileName, outMesh, false, nSourceSize, nSourceHash);
 }
 
 //=================================================================================================================================
@@ -324,21 +375,35 @@ void ShowHelpAndExit(int nRet)
 {
     fprintf(stderr,
             "Syntax:\n"
-            " TootleSample [-v viewpointfile] [-c clusters] [-s cachesize] [-f] [-a [1-5]] [-o [1-4]] [-m] [-p] in.obj > out.obj\n"
+            " TootleSample [-v viewpointfile] [-c clusters] [-s cachesize] [-f] [-a [1-5]] [-l weight] [-o [1-5]] [-m] [-n] [-p] [-e] [-b out.tmc] in.obj > out.obj\n"
+            " TootleSample [options] -i meshdir|manifest.txt [-t threads] [-d outdir] [-k cachedir] [-r report.csv|report.json]\n"
             "  If -a is specified, the argument (below) that follows it will decide on the algorithm to use for Tootle.\n"
             "     1 -> perform vertex cache optimization only.\n"
             "     2 -> call the clustering, optimize vertex cache and overdraw using 3 separate function calls (mix-matching the old and new library).\n"
             "     3 -> call the functions to optimize vertex cache, cluster and overdraw individually (mix-matching the old and new library).\n"
             "     4 -> use a single utility function to optimize vertex cache, cluster and overdraw.\n"
             "     5 -> use a single utility function to optimize vertex cache, cluster and overdraw (SIGGRAPH 2007 version).\n"
+            "  If -l is specified with -a 5, alpha is chosen for the mesh by trying several values, scoring each result as\n"
+            "   ACMR + weight * estimated overdraw (from 0 to 1).\n"
             "  If -f is specified, counter-clockwise faces are front facing.  Otherwise, clockwise faces are front facing.\n"
             "  If -m is specified, the algorithm to measure overdraw will be skipped.\n"
+            "  If -n is specified, the binary mesh cache (in.obj.tmc) will be neither read nor written.\n"
             "  If -o is specified, the argument that follows it will decide on the algorithm used for vertex cache optimization.\n"
             "     1 -> the choice of algorithm for vertex cache optimization will depend on the vertex cache size.\n"
             "     2 -> use the D3DXOptimizeFaces to optimize vertex cache.\n"
             "     3 -> use a list like triangle strips to optimize vertex cache (good for cache size <=6).\n"
             "     4 -> use Tipsy algorithm from SIGGRAPH 2007 to optimize vertex cache.\n"
-            "   If -p is specified, the algorithm to optimize the vertex memory for prefetch cache will be skipped.\n");
+            "     5 -> use Tipsy, ordering the faces so that the index buffer compresses better (see #IndexSizeIn/Out).\n"
+            "   If -p is specified, the algorithm to optimize the vertex memory for prefetch cache will be skipped.\n"
+            "   If -e is specified, vertex memory is optimized for cache line fetches instead of numbering vertices by first use.\n"
+            "   If -b is specified, the optimized mesh is written to the given file in the binary mesh format instead of as an OBJ file.\n"
+            "  If -i is specified, all .obj files in the given directory, or all files listed in the given manifest (one per line),\n"
+            "   are optimized in batch mode with the other settings:\n"
+            "     -t -> the number of meshes processed at once (default: one per core).\n"
+            "     -d -> the directory receiving the optimized meshes.  Without it, only statistics are computed.\n"
+            "     -k -> the directory of the result cache.  Meshes optimized before with identical contents and settings are\n"
+            "           not optimized again.\n"
+            "     -r -> the file receiving the statistics of all meshes, in JSON format if its name ends in .json, CSV otherwise.\n");
 
     exit(nRet);
 }
@@ -416,7 +481,7 @@ TootleAlgorithm UIntToTootleAlgorithm(unsigned int nArgument)
 
 //=================================================================================================================================
 /// Convert from the command line argument type to the enum TootleVCacheOptimizer type.
-/// \param nArgument  the command line argument (1 to 4)
+/// \param nArgument  the command line argument (1 to 5)
 /// \return One of the type of TootleVCacheOptimizer enum.  It will display how to use the command line argument and exit
 ///          when error occurs.
 //=================================================================================================================================
@@ -436,6 +501,9 @@ TootleVCacheOptimizer UIntToTootleVCacheOptimizer(unsigned int nArgument)
         case 4:
             return TOOTLE_VCACHE_TIPSY;
 
+        case 5:
+            return TOOTLE_VCACHE_TIPSY_COMPRESS;
+
         default:
             ShowHelpAndExit(0);
             return NA_TOOTLE_VCACHE_OPTIMIZER;
@@ -454,13 +522,22 @@ void ParseCommandLine(int argc, char* argv[], TootleSettings* pSettings)
     Option::Definition options[] =
     {
         { 'a', "Algorithm to use for TootleSample (1 to 5)" },
+        { 'b', "Binary mesh output file" },
         { 'c', "Number of clusters" },
+        { 'd', "Batch mode output directory" },
+        { 'e', "Fetch-aware vertex memory optimization" },
         { 'f', "Treat counter-clockwise faces as front facing (instead clockwise faces)." },
         { 'h', "Help" },
+        { 'i', "Batch mode input directory or manifest file" },
+        { 'k', "Batch mode result cache directory" },
+        { 'l', "Overdraw weight used to choose alpha for algorithm 5" },
         { 'm', "Skip measuring overdraw" },
-        { 'o', "Algorithm to use to optimize vertex cache (1 to 4)." },
+        { 'n', "Do not use the binary mesh cache" },
+        { 'o', "Algorithm to use to optimize vertex cache (1 to 5)." },
         { 'p', "Skip vertex prefetch cache optimization" },
+        { 'r', "Batch mode statistics report file" },
         { 's', "Post TnL vcache size" },
+        { 't', "Batch mode worker threads" },
         { 'v', "Viewpoint file" },
         { 0, NULL },
     };
@@ -480,10 +557,22 @@ void ParseCommandLine(int argc, char* argv[], TootleSettings* pSettings)
                 pSettings->algorithmChoice = UIntToTootleAlgorithm(nAlgorithmChoice);
                 break;
 
+            case 'b':
+                pSettings->pBinaryOutputName = opt.GetArgument(argc, argv);
+                break;
+
             case 'c':
                 pSettings->nClustering = atoi(opt.GetArgument(argc, argv));
                 break;
 
+            case 'd':
+                pSettings->pOutputDirectory = opt.GetArgument(argc, argv);
+                break;
+
+            case 'e':
+                pSettings->eVertexMemoryOptimizer = TOOTLE_VMEMORY_FETCH_AWARE;
+                break;
+
             case 'f':
                 pSettings->eWinding = TOOTLE_CCW;
                 break;
@@ -492,10 +581,26 @@ void ParseCommandLine(int argc, char* argv[], TootleSettings* pSettings)
                 ShowHelpAndExit(0);
                 break;
 
+            case 'i':
+                pSettings->pBatchInput = opt.GetArgument(argc, argv);
+                break;
+
+            case 'k':
+                pSettings->pResultCacheDirectory = opt.GetArgument(argc, argv);
+                break;
+
+            case 'l':
+                pSettings->fOverdrawWeight = (float) atof(opt.GetArgument(argc, argv));
+                break;
+
             case 'm':
                 pSettings->bMeasureOverdraw = false;
                 break;
 
+            case 'n':
+                pSettings->bUseMeshCache = false;
+                break;
+
             case 'o':
                 nVCacheOptimizer = atoi(opt.GetArgument(argc, argv));
                 pSettings->eVCacheOptimizer = UIntToTootleVCacheOptimizer(nVCacheOptimizer);
@@ -505,10 +610,18 @@ void ParseCommandLine(int argc, char* argv[], TootleSettings* pSettings)
                 pSettings->bOptimizeVertexMemory = false;
                 break;
 
+            case 'r':
+                pSettings->pReportName = opt.GetArgument(argc, argv);
+                break;
+
             case 's':
                 pSettings->nCacheSize = atoi(opt.GetArgument(argc, argv));
                 break;
 
+            case 't':
+                pSettings->nWorkerThreads = atoi(opt.GetArgument(argc, argv));
+                break;
+
             case 'v':
                 if (!pSettings->pViewpointName)
                 {
@@ -542,8 +655,14 @@ void ParseCommandLine(int argc, char* argv[], TootleSettings* pSettings)
         cOption = opt.Parse(argc, argv, options);
     }
 
-    // make sure we got a mesh name
-    if (!pSettings->pMeshName)
+    // make sure we got either a mesh name or a batch input, but not both
+    if ((pSettings->pMeshName == NULL) == (pSettings->pBatchInput == NULL))
+    {
+        ShowHelpAndExit(1);
+    }
+
+    // batch mode writes one OBJ file per mesh into the output directory
+    if (pSettings->pBatchInput != NULL && pSettings->pBinaryOutputName != NULL)
     {
         ShowHelpAndExit(1);
     }
@@ -586,6 +705,10 @@ void PrintVCacheOptimizer(FILE* fp, TootleVCacheOptimizer eVCacheOptimizer, unsi
             fprintf(fp, "#Vertex Cache Optimizer: Tipsy (an algorithm from SIGGRAPH 2007)\n");
             break;
 
+        case TOOTLE_VCACHE_TIPSY_COMPRESS:
+            fprintf(fp, "#Vertex Cache Optimizer: Tipsy, ordered for index buffer compression\n");
+            break;
+
         case NA_TOOTLE_VCACHE_OPTIMIZER:
         default:
             fprintf(fp, "#Vertex Cache Optimizer: Error input\n");
@@ -714,6 +837,25 @@ void PrintStats(FILE* fp, TootleStats* pStats)
             pStats->fVCacheIn,
             pStats->fVCacheOut);
 
+    if (pStats->fAlpha >= 0)
+    {
+        fprintf(fp, "#Alpha            : %.3f\n", pStats->fAlpha);
+    }
+
+    fprintf(fp, "#FetchIn/Out      : %.3fx (%.1f/%.1f bytes per triangle)\n"
+            "#OverfetchIn/Out  : %.3fx (%.3f/%.3f)\n",
+            pStats->fFetchIn / pStats->fFetchOut,
+            pStats->fFetchIn,
+            pStats->fFetchOut,
+            pStats->fOverfetchIn / pStats->fOverfetchOut,
+            pStats->fOverfetchIn,
+            pStats->fOverfetchOut);
+
+    fprintf(fp, "#IndexSizeIn/Out  : %.3fx (%.3f/%.3f bytes per triangle)\n",
+            pStats->fIndexSizeIn / pStats->fIndexSizeOut,
+            pStats->fIndexSizeIn,
+            pStats->fIndexSizeOut);
+
     if (pStats->fMeasureOverdrawTime >= 0)
     {
         fprintf(fp, "#OverdrawIn/Out   : %.3fx (%.3f/%.3f)\n"
@@ -776,94 +918,255 @@ void PrintStats(FILE* fp, TootleStats* pStats)
 }
 
 //=================================================================================================================================
-/// The main function.
+/// Loads a mesh from an OBJ file.  The parsed mesh is kept in a binary cache file next to the OBJ file.  The cache is only
+/// used if it was built from an OBJ file with identical contents.  Its arrays are passed to Tootle straight from the mapped
+/// file, so repeated runs on the same mesh (e.g. to compare settings) skip parsing altogether.
+///
+/// \param settings   The sample settings
+/// \param pMeshName  The OBJ file to load
+/// \param rMesh      Receives the mesh.  If the OBJ file is already mapped into rMesh.objFile, rMesh.nObjHash must hold its
+///                    hash and both are used as they are.  It must not be reused otherwise.
+///
+/// \return True if successful.  False otherwise
 //=================================================================================================================================
-int main(int argc, char* argv[])
+bool LoadMesh(const TootleSettings& settings, const char* pMeshName, SampleMesh& rMesh)
 {
-    // initialize settings to defaults
-    TootleSettings settings;
-    settings.pMeshName             = NULL;
-    settings.pViewpointName        = NULL;
-    settings.nClustering           = 0;
-    settings.nCacheSize            = TOOTLE_DEFAULT_VCACHE_SIZE;
-    settings.eWinding              = TOOTLE_CW;
-    settings.algorithmChoice       = TOOTLE_OPTIMIZE;
-    settings.eVCacheOptimizer      = TOOTLE_VCACHE_AUTO;             // the auto selection as the default to optimize vertex cache
-    settings.bOptimizeVertexMemory = true;                           // default value is to optimize the vertex memory
-    settings.bMeasureOverdraw      = true;                           // default is to measure overdraw
-    
-    // parse the command line
-    ParseCommandLine(argc, argv, &settings);
+    if (!rMesh.objFile.IsOpen())
+    {
+        if (!rMesh.objFile.Open(pMeshName))
+        {
+            std::cerr << "Error loading mesh file: " << pMeshName << std::endl;
+            return false;
+        }
 
-    // ***************************************************
-    //   Load the mesh
-    // ***************************************************
+        rMesh.nObjHash = MeshCache::Hash(rMesh.objFile.GetData(), rMesh.objFile.GetSize());
+    }
 
-    // read the mesh from the OBJ file
-    std::vector<ObjVertexFinal> objVertices;
-    std::vector<ObjFace>        objFaces;
+    std::string strCacheName = std::string(pMeshName) + ".tmc";
 
-    ObjLoader loader;
+    MeshCacheData& mesh = rMesh.mesh;
 
-    if (!loader.LoadGeometry(settings.pMeshName, objVertices, objFaces))
+    if (settings.bUseMeshCache &&
+        rMesh.meshCache.Open(strCacheName.c_str(), rMesh.objFile.GetSize(), rMesh.nObjHash) &&
+        rMesh.meshCache.GetData().pSources != NULL)
     {
-        std::cerr << "Error loading mesh file: " << settings.pMeshName << std::endl;
-        return 1;
+        mesh = rMesh.meshCache.GetData();
     }
+    else
+    {
+        // read the mesh from the OBJ file
+        std::vector<ObjVertexFinal> objVertices;
+        std::vector<ObjFace>        objFaces;
 
-    // build buffers containing only the vertex positions and indices, since this is what Tootle requires
-    std::vector<ObjVertex3D> vertices;
-    vertices.resize(objVertices.size());
+        ObjLoader loader;
 
-    for (unsigned int i = 0; i < vertices.size(); i++)
-    {
-        vertices[i] = objVertices[i].pos;
-    }
+        if (!loader.LoadGeometry(rMesh.objFile.GetData(), rMesh.objFile.GetSize(), objVertices, objFaces) || objFaces.empty())
+        {
+            std::cerr << "Error loading mesh file: " << pMeshName << std::endl;
+            return false;
+        }
 
-    std::vector<unsigned int> indices;
-    indices.resize(objFaces.size() * 3);
+        // build buffers containing only the vertex positions and indices, since this is what Tootle requires
+        rMesh.vertices.resize(objVertices.size());
+        rMesh.sources.resize(objVertices.size());
+
+        bool bHasNormals   = false;
+        bool bHasTexCoords = false;
+
+        for (unsigned int i = 0; i < rMesh.vertices.size(); i++)
+        {
+            rMesh.vertices[i] = objVertices[i].pos;
+
+            rMesh.sources[i].nVertexIndex   = objVertices[i].nVertexIndex;
+            rMesh.sources[i].nTexcoordIndex = objVertices[i].nTexcoordIndex;
+            rMesh.sources[i].nNormalIndex   = objVertices[i].nNormalIndex;
+
+            bHasNormals   = bHasNormals   || (objVertices[i].nNormalIndex > 0);
+            bHasTexCoords = bHasTexCoords || (objVertices[i].nTexcoordIndex > 0);
+        }
+
+        // keep the other attributes too, so that they end up in the cache and in binary output files
+        if (bHasNormals)
+        {
+            rMesh.normals.resize(objVertices.size());
+
+            for (unsigned int i = 0; i < rMesh.normals.size(); i++)
+            {
+                rMesh.normals[i] = objVertices[i].normal;
+            }
+        }
+
+        if (bHasTexCoords)
+        {
+            rMesh.texCoords.resize(objVertices.size());
+
+            for (unsigned int i = 0; i < rMesh.texCoords.size(); i++)
+            {
+                rMesh.texCoords[i] = objVertices[i].texCoord;
+            }
+        }
+
+        rMesh.inputIndices.resize(objFaces.size() * 3);
+
+        for (unsigned int i = 0; i < rMesh.inputIndices.size(); i++)
+        {
+            rMesh.inputIndices[i] = objFaces[ i / 3 ].finalVertexIndices[ i % 3 ];
+        }
+
+        mesh.nVertices   = (unsigned int) rMesh.vertices.size();
+        mesh.nFaces      = (unsigned int) objFaces.size();
+        mesh.pfPositions = &rMesh.vertices[0].x;
+        mesh.pfNormals   = bHasNormals ? &rMesh.normals[0].x : NULL;
+        mesh.pfTexCoords = bHasTexCoords ? &rMesh.texCoords[0].x : NULL;
+        mesh.pSources    = &rMesh.sources[0];
+        mesh.pnIndices   = &rMesh.inputIndices[0];
+
+        if (settings.bUseMeshCache &&
+            !MeshCache::Write(strCacheName.c_str(), mesh, false, rMesh.objFile.GetSize(), rMesh.nObjHash))
+        {
+            std::cerr << "Unable to write mesh cache file: " << strCacheName << std::endl;
+        }
+    }
 
-    for (unsigned int i = 0; i < indices.size(); i++)
+    // caches written by other tools may hold 16 bit indices, Tootle needs 32 bit ones
+    if (mesh.pnIndices == NULL)
     {
-        indices[i] = objFaces[ i / 3 ].finalVertexIndices[ i % 3 ];
+        rMesh.inputIndices.assign(mesh.pnIndices16, mesh.pnIndices16 + mesh.nFaces * 3);
+        mesh.pnIndices = &rMesh.inputIndices[0];
     }
 
-    // ******************************************
-    //    Load viewpoints if necessary
-    // ******************************************
+    return true;
+}
 
-    // read viewpoints if needed
-    std::vector<ObjVertex3D> viewpoints;
+/// The overdraw orderings that render the clusters, and the Direct3D overdraw measurement, keep the mesh in the global state of
+///  the library's overdraw module, so only one of them may run at a time.  Batch mode optimizes several meshes at once.
+static std::mutex s_overdrawModuleLock;
 
-    if (settings.pViewpointName != NULL)
+//=================================================================================================================================
+/// Measures the overdraw of a mesh with TootleMeasureOverdraw, taking turns with the other threads if it renders with Direct3D
+///
+/// \param settings     The sample settings
+/// \param pfVB         The vertex positions
+/// \param pnIB         The index buffer
+/// \param nVertices    The number of vertices
+/// \param nFaces       The number of faces
+/// \param pViewpoints  The viewpoints, may be NULL
+/// \param nViewpoints  The number of viewpoints
+/// \param pfAvgODOut   Receives the average overdraw
+/// \param pfMaxODOut   Receives the maximum overdraw
+///
+/// \return The result of TootleMeasureOverdraw
+//=================================================================================================================================
+static TootleResult MeasureOverdraw(const TootleSettings& settings, const float* pfVB, const unsigned int* pnIB,
+                                    unsigned int nVertices, unsigned int nFaces, const float* pViewpoints,
+                                    unsigned int nViewpoints, float* pfAvgODOut, float* pfMaxODOut)
+{
+#ifndef _SOFTWARE_ONLY_VERSION
+    std::lock_guard<std::mutex> lock(s_overdrawModuleLock);
+#endif
+
+    return TootleMeasureOverdraw(pfVB, pnIB, nVertices, nFaces, 3 * sizeof(float), pViewpoints, nViewpoints, settings.eWinding,
+                                 pfAvgODOut, pfMaxODOut);
+}
+
+//=================================================================================================================================
+/// Translates an index buffer of vertices created by ObjLoader into an index buffer of positions in the OBJ file
+///
+/// \param pSources     The OBJ elements each vertex was built from
+/// \param pnIB         The index buffer to translate
+/// \param nIndices     The number of indices
+/// \param rObjIndices  Receives the translated index buffer
+///
+/// \return The number of OBJ file positions referenced, that is the largest translated index plus one
+//=================================================================================================================================
+static unsigned int GetObjIndices(const MeshCacheSource* pSources, const unsigned int* pnIB, unsigned int nIndices,
+                                  std::vector<unsigned int>& rObjIndices)
+{
+    unsigned int nReferencedVertices = 0;
+
+    rObjIndices.resize(nIndices);
+
+    for (unsigned int i = 0; i < nIndices; i++)
     {
-        if (!LoadViewpoints(settings.pViewpointName, viewpoints))
+        const MeshCacheSource& rVertex = pSources[ pnIB[ i ] ];
+        rObjIndices[ i ] = rVertex.nVertexIndex - 1; // index is off by 1
+
+        // compute the max vertices
+        if (rVertex.nVertexIndex > nReferencedVertices)
         {
-            std::cerr << "Unable to load viewpoints from file: " << settings.pViewpointName;
-            return 1;
+            nReferencedVertices = rVertex.nVertexIndex;
         }
     }
 
-    // if we didn't get any viewpoints, then use a NULL array
-    const float* pViewpoints = NULL;
-    unsigned int nViewpoints = (unsigned int) viewpoints.size();
+    return nReferencedVertices;
+}
 
-    if (viewpoints.size() > 0)
+//=================================================================================================================================
+/// Measures how well an index buffer compresses with TootleEncodeIndexBuffer
+///
+/// \param pnIB                   The index buffer
+/// \param nVertices              The number of vertices referenced by the index buffer
+/// \param nFaces                 The number of faces
+/// \param pfBytesPerTriangleOut  Receives the size of the compressed index buffer per triangle
+///
+/// \return The result of the Tootle calls
+//=================================================================================================================================
+static TootleResult MeasureIndexSize(const unsigned int* pnIB, unsigned int nVertices, unsigned int nFaces,
+                                     float* pfBytesPerTriangleOut)
+{
+    unsigned int nBufferSize;
+    TootleResult result = TootleEncodeIndexBufferBound(nFaces, &nBufferSize);
+
+    if (result != TOOTLE_OK)
     {
-        pViewpoints = (const float*) &viewpoints[0];
+        return result;
+    }
+
+    std::vector<unsigned char> buffer(nBufferSize);
+    unsigned int nEncodedSize;
+
+    result = TootleEncodeIndexBuffer(pnIB, nVertices, nFaces, &buffer[0], nBufferSize, &nEncodedSize);
+
+    if (result == TOOTLE_OK)
+    {
+        *pfBytesPerTriangleOut = (float) nEncodedSize / (float) nFaces;
     }
 
+    return result;
+}
+
+//=================================================================================================================================
+/// Optimizes a mesh with the algorithm selected in the settings and measures the result.  TootleInit() must have been called.
+///
+/// \param settings     The sample settings
+/// \param rMesh        The mesh to optimize.  Its index buffer is only read, it may point into a mapped cache file.
+/// \param pViewpoints  The viewpoints used for overdraw measurement and optimization, may be NULL
+/// \param nViewpoints  The number of viewpoints
+/// \param rResult      Receives the optimized index buffer and the vertex memory remapping
+/// \param rStats       Receives the statistics
+///
+/// \return True if successful.  False otherwise
+//=================================================================================================================================
+bool OptimizeMesh(const TootleSettings& settings, SampleMesh& rMesh, const float* pViewpoints, unsigned int nViewpoints,
+                  OptimizedMesh& rResult, TootleStats& rStats)
+{
     // *****************************************************************
     //   Prepare the mesh and initialize stats variables
     // *****************************************************************
 
-    unsigned int  nFaces    = (unsigned int)  indices.size() / 3;
-    unsigned int  nVertices = (unsigned int)  vertices.size();
-    float*        pfVB      = (float*)        &vertices[0];
-    unsigned int* pnIB      = (unsigned int*) &indices[0];
-    unsigned int  nStride   = 3 * sizeof(float);
+    const MeshCacheData& mesh = rMesh.mesh;
+
+    std::vector<unsigned int>& indices = rResult.indices;
+    indices.resize(mesh.nFaces * 3);
+
+    unsigned int        nFaces    = mesh.nFaces;
+    unsigned int        nVertices = mesh.nVertices;
+    const float*        pfVB      = mesh.pfPositions;
+    const unsigned int* pnIBIn    = mesh.pnIndices;
+    unsigned int*       pnIB      = &indices[0];
+    unsigned int        nStride   = 3 * sizeof(float);
 
-    TootleStats stats;
+    TootleStats& stats = rStats;
 
     // initialize the timing variables
     stats.fOptimizeVCacheTime               = INVALID_TIME;
@@ -875,40 +1178,60 @@ int main(int argc, char* argv[])
     stats.fTootleFastOptimizeTime           = INVALID_TIME;
     stats.fMeasureOverdrawTime              = INVALID_TIME;
     stats.fOptimizeVertexMemoryTime         = INVALID_TIME;
+    stats.fAlpha                            = -1.0f;
 
     TootleResult result;
 
-    // initialize Tootle
-    result = TootleInit();
-
-    if (result != TOOTLE_OK)
-    {
-        DisplayTootleErrorMessage(result);
-        return 1;
-    }
-
     // measure input VCache efficiency
-    result = TootleMeasureCacheEfficiency(pnIB, nFaces, settings.nCacheSize, &stats.fVCacheIn);
+    result = TootleMeasureCacheEfficiency(pnIBIn, nFaces, settings.nCacheSize, &stats.fVCacheIn);
 
     if (result != TOOTLE_OK)
     {
         DisplayTootleErrorMessage(result);
-        return 1;
+        return false;
     }
 
     if (settings.bMeasureOverdraw)
     {
         // measure input overdraw.  Note that we assume counter-clockwise vertex winding.
-        result = TootleMeasureOverdraw(pfVB, pnIB, nVertices, nFaces, nStride, pViewpoints, nViewpoints, settings.eWinding,
-                                       &stats.fOverdrawIn, &stats.fMaxOverdrawIn);
+        result = MeasureOverdraw(settings, pfVB, pnIBIn, nVertices, nFaces, pViewpoints, nViewpoints,
+                                 &stats.fOverdrawIn, &stats.fMaxOverdrawIn);
 
         if (result != TOOTLE_OK)
         {
             DisplayTootleErrorMessage(result);
-            return 1;
+            return false;
         }
     }
 
+    // measure input vertex fetch.  An OBJ output file keeps the positions of the OBJ file rather than the vertices
+    //  created by ObjLoader, so its index buffer is measured against those.
+    bool bObjVertices = (settings.pBinaryOutputName == NULL);
+
+    std::vector<unsigned int> fetchIndices;
+    unsigned int nFetchVertices = nVertices;
+    const unsigned int* pnFetchIB = pnIBIn;
+
+    if (bObjVertices)
+    {
+        nFetchVertices = GetObjIndices(mesh.pSources, pnIBIn, nFaces * 3, fetchIndices);
+        pnFetchIB = &fetchIndices[0];
+    }
+
+    result = TootleMeasureVertexFetch(pnFetchIB, nFetchVertices, nFaces, nStride, settings.nCacheSize,
+                                      &stats.fFetchIn, &stats.fOverfetchIn);
+
+    if (result == TOOTLE_OK)
+    {
+        result = MeasureIndexSize(pnFetchIB, nFetchVertices, nFaces, &stats.fIndexSizeIn);
+    }
+
+    if (result != TOOTLE_OK)
+    {
+        DisplayTootleErrorMessage(result);
+        return false;
+    }
+
     // allocate an array to hold the cluster ID for each face
     std::vector<unsigned int> faceClusters;
     faceClusters.resize(nFaces + 1);
@@ -952,13 +1275,13 @@ int main(int argc, char* argv[])
             stats.nClusters = 1;
 
             // Optimize vertex cache
-            result = TootleOptimizeVCache(pnIB, nFaces, nVertices, settings.nCacheSize,
+            result = TootleOptimizeVCache(pnIBIn, nFaces, nVertices, settings.nCacheSize,
                                           pnIB, NULL, settings.eVCacheOptimizer);
 
             if (result != TOOTLE_OK)
             {
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fOptimizeVCacheTime = timer.GetElapsed();
@@ -971,12 +1294,12 @@ int main(int argc, char* argv[])
             // *******************************************************************************************************************
 
             // Cluster the mesh, and sort faces by cluster.
-            result = TootleClusterMesh(pfVB, pnIB, nVertices, nFaces, nStride, settings.nClustering, pnIB, &faceClusters[0], NULL);
+            result = TootleClusterMesh(pfVB, pnIBIn, nVertices, nFaces, nStride, settings.nClustering, pnIB, &faceClusters[0], NULL);
 
             if (result != TOOTLE_OK)
             {
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fClusterMeshTime = timer.GetElapsed();
@@ -992,20 +1315,23 @@ int main(int argc, char* argv[])
             if (result != TOOTLE_OK)
             {
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fVCacheClustersTime = timer.GetElapsed();
             timer.Reset();
 
             // Optimize the draw order (using v1.2 path: TOOTLE_OVERDRAW_AUTO, the default path is from v2.0--SIGGRAPH version).
-            result = TootleOptimizeOverdraw(pfVB, pnIB, nVertices, nFaces, nStride, pViewpoints, nViewpoints, settings.eWinding,
-                                            &faceClusters[0], pnIB, NULL, TOOTLE_OVERDRAW_AUTO);
+            {
+                std::lock_guard<std::mutex> lock(s_overdrawModuleLock);
+                result = TootleOptimizeOverdraw(pfVB, pnIB, nVertices, nFaces, nStride, pViewpoints, nViewpoints,
+                                                settings.eWinding, &faceClusters[0], pnIB, NULL, TOOTLE_OVERDRAW_AUTO);
+            }
 
             if (result != TOOTLE_OK)
             {
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fOptimizeOverdrawTime = timer.GetElapsed();
@@ -1018,14 +1344,14 @@ int main(int argc, char* argv[])
 
             // Optimize vertex cache and create cluster
             // The algorithm from SIGGRAPH combine the vertex cache optimization and clustering mesh into a single step
-            result = TootleFastOptimizeVCacheAndClusterMesh(pnIB, nFaces, nVertices, settings.nCacheSize, pnIB,
+            result = TootleFastOptimizeVCacheAndClusterMesh(pnIBIn, nFaces, nVertices, settings.nCacheSize, pnIB,
                                                             &faceClusters[0], &nNumClusters, TOOTLE_DEFAULT_ALPHA);
 
             if (result != TOOTLE_OK)
             {
                 // an error detected
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fOptimizeVCacheAndClusterMeshTime = timer.GetElapsed();
@@ -1037,14 +1363,17 @@ int main(int argc, char* argv[])
             //  vcache computation from the new library with the overdraw optimization from the old library.
             //  TOOTLE_OVERDRAW_AUTO will choose between using Direct3D or CPU raytracing path.  This path is
             //  much slower than TOOTLE_OVERDRAW_FAST but usually produce 2x better results.
-            result = TootleOptimizeOverdraw(pfVB, pnIB, nVertices, nFaces, nStride, NULL, 0,
-                                            settings.eWinding, &faceClusters[0], pnIB, NULL, TOOTLE_OVERDRAW_AUTO);
+            {
+                std::lock_guard<std::mutex> lock(s_overdrawModuleLock);
+                result = TootleOptimizeOverdraw(pfVB, pnIB, nVertices, nFaces, nStride, NULL, 0,
+                                                settings.eWinding, &faceClusters[0], pnIB, NULL, TOOTLE_OVERDRAW_AUTO);
+            }
 
             if (result != TOOTLE_OK)
             {
                 // an error detected
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fOptimizeOverdrawTime = timer.GetElapsed();
@@ -1058,13 +1387,13 @@ int main(int argc, char* argv[])
 
             // This function will compute the entire optimization (cluster mesh, vcache per cluster, and optimize overdraw).
             // It will use TOOTLE_OVERDRAW_FAST as the default overdraw optimization
-            result = TootleOptimize(pfVB, pnIB, nVertices, nFaces, nStride, settings.nCacheSize,
+            result = TootleOptimize(pfVB, pnIBIn, nVertices, nFaces, nStride, settings.nCacheSize,
                                     pViewpoints, nViewpoints, settings.eWinding, pnIB, &nNumClusters, settings.eVCacheOptimizer);
 
             if (result != TOOTLE_OK)
             {
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fTootleOptimizeTime = timer.GetElapsed();
@@ -1079,13 +1408,23 @@ int main(int argc, char* argv[])
 
             // This function will compute the entire optimization (optimize vertex cache, cluster mesh, and optimize overdraw).
             // It will use TOOTLE_OVERDRAW_FAST as the default overdraw optimization
-            result = TootleFastOptimize(pfVB, pnIB, nVertices, nFaces, nStride, settings.nCacheSize,
-                                        settings.eWinding, pnIB, &nNumClusters, TOOTLE_DEFAULT_ALPHA);
+            if (settings.fOverdrawWeight >= 0)
+            {
+                // try several values of alpha, and keep the best result for the given overdraw weight
+                result = TootleFastOptimizeAutoAlpha(pfVB, pnIBIn, nVertices, nFaces, nStride, settings.nCacheSize,
+                                                     settings.eWinding, pnIB, &nNumClusters, settings.fOverdrawWeight,
+                                                     &stats.fAlpha);
+            }
+            else
+            {
+                result = TootleFastOptimize(pfVB, pnIBIn, nVertices, nFaces, nStride, settings.nCacheSize,
+                                            settings.eWinding, pnIB, &nNumClusters, TOOTLE_DEFAULT_ALPHA);
+            }
 
             if (result != TOOTLE_OK)
             {
                 DisplayTootleErrorMessage(result);
-                return 1;
+                return false;
             }
 
             stats.fTootleFastOptimizeTime = timer.GetElapsed();
@@ -1095,7 +1434,8 @@ int main(int argc, char* argv[])
             break;
 
         default:
-            // wrong algorithm choice
+            // wrong algorithm choice, emit the mesh unchanged
+            indices.assign(pnIBIn, pnIBIn + nFaces * 3);
             break;
     }
 
@@ -1105,21 +1445,21 @@ int main(int argc, char* argv[])
     if (result != TOOTLE_OK)
     {
         DisplayTootleErrorMessage(result);
-        return 1;
+        return false;
     }
 
     if (settings.bMeasureOverdraw)
     {
         // measure output overdraw
         timer.Reset();
-        result = TootleMeasureOverdraw(pfVB, pnIB, nVertices, nFaces, nStride, pViewpoints, nViewpoints, settings.eWinding,
-                                       &stats.fOverdrawOut, &stats.fMaxOverdrawOut);
+        result = MeasureOverdraw(settings, pfVB, pnIB, nVertices, nFaces, pViewpoints, nViewpoints,
+                                 &stats.fOverdrawOut, &stats.fMaxOverdrawOut);
         stats.fMeasureOverdrawTime = timer.GetElapsed();
 
         if (result != TOOTLE_OK)
         {
             DisplayTootleErrorMessage(result);
-            return 1;
+            return false;
         }
     }
 
@@ -1135,48 +1475,241 @@ int main(int argc, char* argv[])
     //-----------------------------------------------------------------------------------------------------
     timer.Reset();
 
-    std::vector<unsigned int> pnVertexRemapping;
-    unsigned int nReferencedVertices = 0;          // The actual total number of vertices referenced by the indices
+    std::vector<unsigned int>& pnVertexRemapping = rResult.vertexRemap;
+    unsigned int& nReferencedVertices = rResult.nReferencedVertices;   // The actual total number of vertices referenced by the indices
 
-    if (settings.bOptimizeVertexMemory)
+    pnVertexRemapping.clear();
+    nReferencedVertices = 0;
+
+    if (settings.bOptimizeVertexMemory && settings.pBinaryOutputName != NULL)
     {
-        std::vector<unsigned int> pnIBTmp;
-        pnIBTmp.resize(nFaces * 3);
+        // The binary output stores the vertices created by ObjLoader rather than the ones in the obj file, so their
+        //  memory locations can be optimized directly.
+        //  All the attributes are stored in separate streams that share the new vertex order.
+        pnVertexRemapping.resize(nVertices);
 
-        // compute the indices to be optimized for (the original pointed by the obj file).
-        for (unsigned int i = 0; i < indices.size(); i += 3)
+        TootleVertexStream streams[3];
+        unsigned int nStreams = 0;
+
+        streams[nStreams].pVB          = pfVB;
+        streams[nStreams].pVBOut       = NULL;
+        streams[nStreams].nVBStride    = nStride;
+        streams[nStreams].pVBOutLayout = NULL;
+        nStreams++;
+
+        if (mesh.pfNormals != NULL)
         {
-            for (int j = 0; j < 3; j++)
-            {
-                const ObjVertexFinal& rVertex = objVertices[ pnIB[ i + j ] ];
-                pnIBTmp[ i + j ] = rVertex.nVertexIndex - 1; // index is off by 1
+            streams[nStreams].pVB          = mesh.pfNormals;
+            streams[nStreams].pVBOut       = NULL;
+            streams[nStreams].nVBStride    = 3 * sizeof(float);
+            streams[nStreams].pVBOutLayout = NULL;
+            nStreams++;
+        }
 
-                // compute the max vertices
-                if (rVertex.nVertexIndex > nReferencedVertices)
-                {
-                    nReferencedVertices = rVertex.nVertexIndex;
-                }
-            }
+        if (mesh.pfTexCoords != NULL)
+        {
+            streams[nStreams].pVB          = mesh.pfTexCoords;
+            streams[nStreams].pVBOut       = NULL;
+            streams[nStreams].nVBStride    = 2 * sizeof(float);
+            streams[nStreams].pVBOutLayout = NULL;
+            nStreams++;
         }
 
+        result = TootleOptimizeVertexStreams(pnIB, nVertices, nFaces, streams, nStreams, NULL, &pnVertexRemapping[0],
+                                             settings.eVertexMemoryOptimizer, settings.nCacheSize);
+
+        if (result != TOOTLE_OK)
+        {
+            DisplayTootleErrorMessage(result);
+            return false;
+        }
+
+        stats.fOptimizeVertexMemoryTime = timer.GetElapsed();
+    }
+    else if (settings.bOptimizeVertexMemory)
+    {
+        std::vector<unsigned int> pnIBTmp;
+
+        // compute the indices to be optimized for (the original pointed by the obj file).
+        nReferencedVertices = GetObjIndices(mesh.pSources, pnIB, nFaces * 3, pnIBTmp);
+
         pnVertexRemapping.resize(nReferencedVertices);
 
         // For this sample code, we are just going to use vertexRemapping array result.  This is to support general obj
         //  file input and output.
         //  In fact, we are sending the wrong vertex buffer here (it should be based on the original file instead of the
         //  rehashed vertices).  But, it is ok because we do not request the reordered vertex buffer as an output.
-        result = TootleOptimizeVertexMemory(pfVB, &pnIBTmp[0], nReferencedVertices, nFaces, nStride, NULL, NULL,
-                                            &pnVertexRemapping[0]);
+        result = TootleOptimizeVertexMemoryEx(pfVB, &pnIBTmp[0], nReferencedVertices, nFaces, nStride, NULL, NULL,
+                                              &pnVertexRemapping[0], settings.eVertexMemoryOptimizer, settings.nCacheSize);
 
         if (result != TOOTLE_OK)
         {
             DisplayTootleErrorMessage(result);
-            return 1;
+            return false;
         }
 
         stats.fOptimizeVertexMemoryTime = timer.GetElapsed();
     }
 
+    // measure output vertex fetch, with the vertices in their final order
+    if (bObjVertices)
+    {
+        nFetchVertices = GetObjIndices(mesh.pSources, pnIB, nFaces * 3, fetchIndices);
+    }
+    else
+    {
+        fetchIndices = indices;
+    }
+
+    if (settings.bOptimizeVertexMemory)
+    {
+        for (unsigned int i = 0; i < fetchIndices.size(); i++)
+        {
+            fetchIndices[i] = pnVertexRemapping[ fetchIndices[i] ];
+        }
+    }
+
+    result = TootleMeasureVertexFetch(&fetchIndices[0], nFetchVertices, nFaces, nStride, settings.nCacheSize,
+                                      &stats.fFetchOut, &stats.fOverfetchOut);
+
+    if (result == TOOTLE_OK)
+    {
+        result = MeasureIndexSize(&fetchIndices[0], nFetchVertices, nFaces, &stats.fIndexSizeOut);
+    }
+
+    if (result != TOOTLE_OK)
+    {
+        DisplayTootleErrorMessage(result);
+        return false;
+    }
+
+    return true;
+}
+
+//=================================================================================================================================
+/// Emits an optimized mesh, either as a modified copy of its OBJ file or in the binary mesh format
+///
+/// \param settings           The sample settings
+/// \param rMesh              The mesh that was optimized
+/// \param rResult            The result of OptimizeMesh()
+/// \param pBinaryOutputName  If not NULL, the mesh is written to this file in the binary mesh format
+/// \param pOutput            Otherwise, the OBJ file is written to this stream
+///
+/// \return True if successful.  False otherwise
+//=================================================================================================================================
+bool EmitMesh(const TootleSettings& settings, const SampleMesh& rMesh, const OptimizedMesh& rResult,
+              const char* pBinaryOutputName, FILE* pOutput)
+{
+    const unsigned int* pnVertexRemap = settings.bOptimizeVertexMemory ? &rResult.vertexRemap[0] : NULL;
+
+    if (pBinaryOutputName != NULL)
+    {
+        // emit the optimized mesh in the binary mesh format
+        if (!EmitBinaryMesh(pBinaryOutputName, rMesh.mesh, rResult.indices, pnVertexRemap, rMesh.objFile.GetSize(),
+                            rMesh.nObjHash))
+        {
+            std::cerr << "Unable to write binary mesh file: " << pBinaryOutputName << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    // emit a modified .OBJ file.  The lines that are passed through are read from the mapped input file.
+    BufferedWriter writer(pOutput);
+
+    return EmitModifiedObj(rMesh.objFile.GetData(), rMesh.objFile.GetSize(), writer, rMesh.mesh.pSources,
+                           rMesh.mesh.nVertices, rResult.indices, pnVertexRemap,
+                           (pnVertexRemap != NULL) ? rResult.nReferencedVertices : 0);
+}
+
+//=================================================================================================================================
+/// The main function.
+//=================================================================================================================================
+int main(int argc, char* argv[])
+{
+    // initialize settings to defaults
+    TootleSettings settings;
+    settings.pMeshName             = NULL;
+    settings.pViewpointName        = NULL;
+    settings.pBinaryOutputName     = NULL;
+    settings.pBatchInput           = NULL;
+    settings.pOutputDirectory      = NULL;
+    settings.pReportName           = NULL;
+    settings.pResultCacheDirectory = NULL;
+    settings.nClustering           = 0;
+    settings.nCacheSize            = TOOTLE_DEFAULT_VCACHE_SIZE;
+    settings.nWorkerThreads        = 0;                              // default is one worker per core in batch mode
+    settings.fOverdrawWeight       = -1.0f;                          // default is to use TOOTLE_DEFAULT_ALPHA
+    settings.eWinding              = TOOTLE_CW;
+    settings.algorithmChoice       = TOOTLE_OPTIMIZE;
+    settings.eVCacheOptimizer      = TOOTLE_VCACHE_AUTO;             // the auto selection as the default to optimize vertex cache
+    settings.eVertexMemoryOptimizer = TOOTLE_VMEMORY_FIRST_USE;      // default is to number vertices in first use order
+    settings.bOptimizeVertexMemory = true;                           // default value is to optimize the vertex memory
+    settings.bMeasureOverdraw      = true;                           // default is to measure overdraw
+    settings.bUseMeshCache         = true;                           // default is to reuse the parsed mesh between runs
+
+    // parse the command line
+    ParseCommandLine(argc, argv, &settings);
+
+    // ******************************************
+    //    Load viewpoints if necessary
+    // ******************************************
+
+    // read viewpoints if needed
+    std::vector<ObjVertex3D> viewpoints;
+
+    if (settings.pViewpointName != NULL)
+    {
+        if (!LoadViewpoints(settings.pViewpointName, viewpoints))
+        {
+            std::cerr << "Unable to load viewpoints from file: " << settings.pViewpointName;
+            return 1;
+        }
+    }
+
+    // if we didn't get any viewpoints, then use a NULL array
+    const float* pViewpoints = NULL;
+    unsigned int nViewpoints = (unsigned int) viewpoints.size();
+
+    if (viewpoints.size() > 0)
+    {
+        pViewpoints = (const float*) &viewpoints[0];
+    }
+
+    if (settings.pBatchInput != NULL)
+    {
+        return RunBatch(settings, pViewpoints, nViewpoints);
+    }
+
+    // ***************************************************
+    //   Load the mesh
+    // ***************************************************
+
+    SampleMesh mesh;
+
+    if (!LoadMesh(settings, settings.pMeshName, mesh))
+    {
+        return 1;
+    }
+
+    // initialize Tootle
+    TootleResult result = TootleInit();
+
+    if (result != TOOTLE_OK)
+    {
+        DisplayTootleErrorMessage(result);
+        return 1;
+    }
+
+    OptimizedMesh optimized;
+    TootleStats   stats;
+
+    if (!OptimizeMesh(settings, mesh, pViewpoints, nViewpoints, optimized, stats))
+    {
+        return 1;
+    }
+
     // clean up tootle
     TootleCleanup();
 
@@ -1188,19 +1721,7 @@ int main(int argc, char* argv[])
     PrintStats(stdout, &stats);
     PrintStats(stderr, &stats);
 
-    // emit a modified .OBJ file
-    std::ifstream inputStream(settings.pMeshName);
-
-    bool bResult;
-
-    if (settings.bOptimizeVertexMemory)
-    {
-        bResult = EmitModifiedObj(inputStream, std::cout, objVertices, indices, &pnVertexRemapping[0], nReferencedVertices);
-    }
-    else
-    {
-        bResult = EmitModifiedObj(inputStream, std::cout, objVertices, indices, NULL, 0);
-    }
+    bool bResult = EmitMesh(settings, mesh, optimized, settings.pBinaryOutputName, stdout);
 
     if (bResult)
     {
@@ -1209,4 +1730,3 @@ int main(int argc, char* argv[])
 
     return 0;
 }
-
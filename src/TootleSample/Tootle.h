@@ -0,0 +1,133 @@
+/************************************************************************************//**
+// Copyright (c) 2006-2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+****************************************************************************************/
+#ifndef _TOOTLE_H_
+#define _TOOTLE_H_
+
+#include <cstdio>
+#include <vector>
+#include "tootlelib.h"
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+
+//=================================================================================================================================
+/// Enumeration for the choice of test cases for tootle.
+//=================================================================================================================================
+enum TootleAlgorithm
+{
+    NA_TOOTLE_ALGORITHM,                // Default invalid choice.
+    TOOTLE_VCACHE_ONLY,                 // Only perform vertex cache optimization.
+    TOOTLE_CLUSTER_VCACHE_OVERDRAW,     // Call the clustering, optimize vertex cache and overdraw individually.
+    TOOTLE_FAST_VCACHECLUSTER_OVERDRAW, // Call the functions to optimize vertex cache and overdraw individually.  This is using
+    //  the algorithm from SIGGRAPH 2007.
+    TOOTLE_OPTIMIZE,                    // Call a single function to optimize vertex cache, cluster and overdraw.
+    TOOTLE_FAST_OPTIMIZE                // Call a single function to optimize vertex cache, cluster and overdraw using
+    //  a fast algorithm from SIGGRAPH 2007.
+};
+
+//=================================================================================================================================
+/// A simple structure to store the settings for this sample app
+//=================================================================================================================================
+struct TootleSettings
+{
+    const char*           pMeshName ;
+    const char*           pViewpointName ;
+    const char*           pBinaryOutputName;       // if set, the optimized mesh is written to this file in the binary mesh format
+    const char*           pBatchInput;             // if set, a directory or a manifest file listing the meshes to process
+    const char*           pOutputDirectory;        // batch mode: directory receiving the optimized meshes, may be NULL
+    const char*           pReportName;             // batch mode: CSV or JSON file receiving the statistics of all meshes
+    const char*           pResultCacheDirectory;   // batch mode: directory holding previously computed results, may be NULL
+    unsigned int          nClustering ;
+    unsigned int          nCacheSize;
+    unsigned int          nWorkerThreads;          // batch mode: number of meshes processed at once, 0 for one per core
+    float                 fOverdrawWeight;         // if not negative, TOOTLE_FAST_OPTIMIZE chooses alpha with this overdraw weight
+    TootleFaceWinding     eWinding;
+    TootleAlgorithm       algorithmChoice;         // five different types of algorithm to test Tootle
+    TootleVCacheOptimizer eVCacheOptimizer;        // the choice for vertex cache optimization algorithm, it can be either
+    //  TOOTLE_VCACHE_AUTO, TOOTLE_VCACHE_LSTRIPS, TOOTLE_VCACHE_DIRECT3D,
+    //  TOOTLE_VCACHE_TIPSY or TOOTLE_VCACHE_TIPSY_COMPRESS.
+    TootleVertexMemoryOptimizer eVertexMemoryOptimizer; // the algorithm used to optimize the vertex memory locations
+    bool                  bOptimizeVertexMemory;   // true if you want to optimize vertex memory location, false to skip
+    bool                  bMeasureOverdraw;        // true if you want to measure overdraw, false to skip
+    bool                  bUseMeshCache;           // true to read and write the binary mesh cache next to the mesh file
+};
+
+//=================================================================================================================================
+/// A simple structure to hold Tootle statistics
+//=================================================================================================================================
+struct TootleStats
+{
+    unsigned int nClusters;
+    float        fAlpha;                 // the alpha chosen by TootleFastOptimizeAutoAlpha, negative if it was not called
+    float        fVCacheIn;
+    float        fVCacheOut;
+    float        fFetchIn;               // bytes fetched per triangle, see TootleMeasureVertexFetch
+    float        fFetchOut;
+    float        fOverfetchIn;
+    float        fOverfetchOut;
+    float        fIndexSizeIn;           // bytes per triangle of the index buffer compressed by TootleEncodeIndexBuffer
+    float        fIndexSizeOut;
+    float        fOverdrawIn;
+    float        fOverdrawOut;
+    float        fMaxOverdrawIn;
+    float        fMaxOverdrawOut;
+    double       fOptimizeVCacheTime;
+    double       fClusterMeshTime;
+    double       fOptimizeOverdrawTime;
+    double       fVCacheClustersTime;
+    double       fOptimizeVCacheAndClusterMeshTime;
+    double       fTootleOptimizeTime;
+    double       fTootleFastOptimizeTime;
+    double       fMeasureOverdrawTime;
+    double       fOptimizeVertexMemoryTime;
+};
+
+const float INVALID_TIME = -1;
+
+//=================================================================================================================================
+/// A mesh loaded from an OBJ file, either parsed or read from its binary mesh cache
+//=================================================================================================================================
+struct SampleMesh
+{
+    MappedFile                   objFile;        // the OBJ file, mapped for as long as the mesh is in use
+    uint64_t                     nObjHash;       // MeshCache::Hash() of the OBJ file
+    MeshCache                    meshCache;      // the cache file, if the mesh was read from it
+    MeshCacheData                mesh;           // the mesh.  The arrays point either into meshCache or into the vectors below.
+
+    // storage for the mesh if it has to be parsed from the OBJ file
+    std::vector<ObjVertex3D>     vertices;
+    std::vector<ObjVertex3D>     normals;
+    std::vector<ObjVertex2D>     texCoords;
+    std::vector<MeshCacheSource> sources;
+    std::vector<unsigned int>    inputIndices;
+}; // End of SampleMesh
+
+//=================================================================================================================================
+/// The result of optimizing a SampleMesh
+//=================================================================================================================================
+struct OptimizedMesh
+{
+    std::vector<unsigned int> indices;              // the optimized index buffer
+    std::vector<unsigned int> vertexRemap;          // the result of TootleOptimizeVertexMemory, empty if it was skipped
+    unsigned int              nReferencedVertices;  // the number of OBJ file vertices referenced by vertexRemap
+}; // End of OptimizedMesh
+
+// functions shared by the single mesh and the batch code paths (Tootle.cpp)
+bool LoadViewpoints(const char* pFileName, std::vector<ObjVertex3D>& rViewPoints);
+bool LoadMesh(const TootleSettings& settings, const char* pMeshName, SampleMesh& rMesh);
+bool OptimizeMesh(const TootleSettings& settings, SampleMesh& rMesh, const float* pViewpoints, unsigned int nViewpoints,
+                  OptimizedMesh& rResult, TootleStats& rStats);
+bool EmitMesh(const TootleSettings& settings, const SampleMesh& rMesh, const OptimizedMesh& rResult,
+              const char* pBinaryOutputName, FILE* pOutput);
+void PrintAlgorithm(FILE* fp, TootleVCacheOptimizer eVCacheOptimizer, TootleAlgorithm eAlgorithmChoice, unsigned int nCacheSize,
+                    unsigned int nClusters);
+void PrintStats(FILE* fp, TootleStats* pStats);
+void DisplayTootleErrorMessage(TootleResult eResult);
+
+// batch processing of many meshes (Batch.cpp)
+int RunBatch(const TootleSettings& settings, const float* pViewpoints, unsigned int nViewpoints);
+
+#endif // _TOOTLE_H_